@@ -24,14 +24,16 @@ typedef void os_timer_func_t(void* timer_arg);
 
 /**
  * @brief This is the structure used by the Espressif timer API
- * @note This is used as an element in a linked list
- * The Espressif implementation orders the list according to next expiry time.
+ * @note This is used as an element in a doubly-linked list
+ * The Espressif implementation orders a single list according to next expiry time.
+ * The Host implementation uses a hierarchical timing wheel, with a list per slot.
  * os_timer_setfn and os_timer_disarm set timer_next to -1
- * When expired, timer_next is 0
  */
 struct os_timer_t {
-	/// If disarmed, set to -1, otherwise points to the next queued timer (or NULL if last in the list)
+	/// If disarmed, set to -1, otherwise points to the next queued timer
 	struct os_timer_t* timer_next;
+	/// Points to the previous queued timer
+	struct os_timer_t* timer_prev;
 	/// Set to the next Timer2 count value when the timer will expire
 	uint32_t timer_expire;
 	/// 0 if this is a one-shot timer, otherwise defines the interval in Timer2 ticks
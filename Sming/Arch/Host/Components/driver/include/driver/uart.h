@@ -7,3 +7,19 @@
 #define UART_COUNT 3		  ///< Number of UARTs on the system, virtual or otherwise
 
 #include_next <driver/uart.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Emulate a uart interrupt by passing status flags accumulated in `uart->status` to the callback
+ * @param uart
+ * @note Host only. Error flags are retained for reporting via smg_uart_get_status().
+ * Callers on threads other than the main thread must wrap this in interrupt_begin()/interrupt_end().
+ */
+void smg_uart_host_interrupt(smg_uart_t* uart);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,3 +1,18 @@
+/*
+ * Timers are held in a hierarchical timing wheel, so arming and disarming are O(1) operations.
+ *
+ * The root level has 256 slots of one Timer2 tick each, covering the next 256 ticks.
+ * Each of the four upper levels has 64 slots, each slot covering a full revolution of the level below.
+ * Together these span the full 32-bit tick range.
+ *
+ * A timer is placed in the lowest level which can hold its expiry time.
+ * When the wheel position crosses a slot boundary in an upper level, timers in that slot are 'cascaded'
+ * down into the lower levels. Root slots therefore only contain timers due at exactly that tick.
+ *
+ * Occupied slots are tracked in a bitmap so the wheel position can skip directly to the next slot
+ * requiring attention, and the time until the next event can be determined quickly.
+ */
+
 #include <driver/os_timer.h>
 #include <hostlib/threads.h>
 #include <driver/hw_timer.h>
@@ -6,30 +21,230 @@
 
 namespace
 {
-os_timer_t* timer_list;
-CMutex mutex;
+class TimerWheel
+{
+public:
+	static constexpr unsigned rootBits{8};
+	static constexpr unsigned levelBits{6};
+	static constexpr unsigned levelCount{4};
+	static constexpr unsigned rootSize{1U << rootBits};
+	static constexpr unsigned levelSize{1U << levelBits};
+	static constexpr unsigned slotCount{rootSize + levelCount * levelSize};
+
+	TimerWheel()
+	{
+		for(auto& slot : slots) {
+			slot.timer_next = slot.timer_prev = &slot;
+		}
+	}
+
+	bool isEmpty() const
+	{
+		return timerCount == 0;
+	}
+
+	void add(os_timer_t* ptimer, uint32_t expire);
+	void remove(os_timer_t* ptimer);
+
+	/**
+	 * @brief Advance wheel position
+	 * @param now Current Timer2 tick count
+	 * @retval os_timer_t* The next expired timer, removed from the wheel. nullptr if none.
+	 */
+	os_timer_t* expire(uint32_t now);
+
+	/**
+	 * @brief Get tick count for next wheel event
+	 * @note For timers in the root level this is the expiry time.
+	 * Otherwise, it's the time at which the timer is cascaded into a lower level.
+	 */
+	uint32_t nextEvent() const;
+
+private:
+	static unsigned getShift(unsigned level)
+	{
+		return rootBits + (level - 1) * levelBits;
+	}
+
+	static unsigned getSlotIndex(unsigned level, unsigned index)
+	{
+		return (level == 0) ? index : rootSize + (level - 1) * levelSize + index;
+	}
+
+	bool isSlot(const os_timer_t* t) const
+	{
+		return t >= &slots[0] && t < &slots[slotCount];
+	}
+
+	void insert(os_timer_t* ptimer);
+	void cascade();
+	int findSlot(unsigned first, unsigned size, unsigned start) const;
+
+	os_timer_t slots[slotCount]{};
+	uint64_t occupied[slotCount / 64]{};
+	uint32_t base{0}; ///< All ticks prior to this have been processed
+	unsigned timerCount{0};
+};
 
-// Called with mutex locked
-void timer_insert(uint32_t expire, os_timer_t* ptimer)
+void TimerWheel::add(os_timer_t* ptimer, uint32_t expire)
 {
-	os_timer_t* t_prev = nullptr;
-	auto t = timer_list;
-	while(t != nullptr) {
-		if(int(t->timer_expire - expire) > 0) {
+	if(timerCount == 0) {
+		base = hw_timer2_read();
+	}
+	ptimer->timer_expire = expire;
+	insert(ptimer);
+	++timerCount;
+}
+
+void TimerWheel::insert(os_timer_t* ptimer)
+{
+	auto expire = ptimer->timer_expire;
+	int ticks = expire - base;
+	unsigned slotIndex;
+	if(ticks < 0) {
+		// Already due, so process at next opportunity
+		slotIndex = base % rootSize;
+	} else if(unsigned(ticks) < rootSize) {
+		slotIndex = expire % rootSize;
+	} else {
+		unsigned level = 1;
+		while(level < levelCount && uint32_t(ticks) >= (1U << getShift(level + 1))) {
+			++level;
+		}
+		slotIndex = getSlotIndex(level, (expire >> getShift(level)) % levelSize);
+	}
+
+	// Append to slot list so timers due at the same time are serviced in order of arming
+	auto& slot = slots[slotIndex];
+	ptimer->timer_next = &slot;
+	ptimer->timer_prev = slot.timer_prev;
+	slot.timer_prev->timer_next = ptimer;
+	slot.timer_prev = ptimer;
+	occupied[slotIndex / 64] |= 1ULL << (slotIndex % 64);
+}
+
+void TimerWheel::remove(os_timer_t* ptimer)
+{
+	auto prev = ptimer->timer_prev;
+	auto next = ptimer->timer_next;
+	prev->timer_next = next;
+	next->timer_prev = prev;
+	ptimer->timer_next = reinterpret_cast<os_timer_t*>(-1);
+	ptimer->timer_prev = nullptr;
+	--timerCount;
+
+	// If list is now empty then prev is the slot
+	if(prev == next && isSlot(prev)) {
+		unsigned slotIndex = prev - &slots[0];
+		occupied[slotIndex / 64] &= ~(1ULL << (slotIndex % 64));
+	}
+}
+
+/*
+ * Re-insert timers from upper level slots which the wheel position has now reached.
+ * Called when base is a multiple of rootSize.
+ */
+void TimerWheel::cascade()
+{
+	for(unsigned level = 1; level <= levelCount; ++level) {
+		unsigned index = (base >> getShift(level)) % levelSize;
+		unsigned slotIndex = getSlotIndex(level, index);
+		auto& slot = slots[slotIndex];
+		auto t = slot.timer_next;
+		slot.timer_next = slot.timer_prev = &slot;
+		occupied[slotIndex / 64] &= ~(1ULL << (slotIndex % 64));
+		while(t != &slot) {
+			auto next = t->timer_next;
+			insert(t);
+			t = next;
+		}
+		if(index != 0) {
 			break;
 		}
-		t_prev = t;
-		t = t->timer_next;
 	}
-	if(t_prev == nullptr) {
-		timer_list = ptimer;
-	} else {
-		t_prev->timer_next = ptimer;
+}
+
+/*
+ * Find distance to next occupied slot within a level, searching circularly.
+ * Returns -1 if level is empty.
+ */
+int TimerWheel::findSlot(unsigned first, unsigned size, unsigned start) const
+{
+	for(unsigned distance = 0; distance < size;) {
+		unsigned i = first + (start + distance) % size;
+		auto bits = occupied[i / 64] >> (i % 64);
+		if(bits != 0) {
+			distance += __builtin_ctzll(bits);
+			return (distance < size) ? int(distance) : -1;
+		}
+		distance += 64 - (i % 64);
 	}
-	ptimer->timer_next = t;
-	ptimer->timer_expire = expire;
+	return -1;
+}
+
+uint32_t TimerWheel::nextEvent() const
+{
+	uint32_t event{base - 1};
+	unsigned minTicks{UINT32_MAX};
+	int distance = findSlot(0, rootSize, base % rootSize);
+	if(distance >= 0) {
+		minTicks = distance;
+		event = base + distance;
+	}
+	for(unsigned level = 1; level <= levelCount; ++level) {
+		auto shift = getShift(level);
+		unsigned index = (base >> shift) % levelSize;
+		distance = findSlot(getSlotIndex(level, 0), levelSize, (index + 1) % levelSize);
+		if(distance < 0) {
+			continue;
+		}
+		uint32_t cascadeTime = ((base >> shift) + distance + 1) << shift;
+		if(cascadeTime - base < minTicks) {
+			minTicks = cascadeTime - base;
+			event = cascadeTime;
+		}
+	}
+	return event;
+}
+
+os_timer_t* TimerWheel::expire(uint32_t now)
+{
+	while(int(now - base) >= 0) {
+		if(timerCount == 0) {
+			base = now + 1;
+			break;
+		}
+
+		auto& slot = slots[base % rootSize];
+		if(slot.timer_next != &slot) {
+			auto t = slot.timer_next;
+			remove(t);
+			return t;
+		}
+
+		// Skip directly to next event
+		auto event = nextEvent();
+		if(int(event - now) > 0) {
+			base = now + 1;
+			if(int(event - base) > 0) {
+				break;
+			}
+		} else {
+			base = event;
+		}
+		if(base % rootSize == 0) {
+			cascade();
+		}
+	}
+
+	return nullptr;
 }
 
+TimerWheel wheel;
+CMutex mutex;
+bool wakeTimeValid;
+uint32_t wakeTime; ///< When main thread next services timers
+
 } // namespace
 
 void os_timer_arm_ticks(os_timer_t* ptimer, uint32_t ticks, bool repeat_flag)
@@ -40,11 +255,17 @@ void os_timer_arm_ticks(os_timer_t* ptimer, uint32_t ticks, bool repeat_flag)
 	os_timer_disarm(ptimer);
 	ptimer->timer_period = repeat_flag ? ticks : 0;
 	mutex.lock();
-	timer_insert(hw_timer2_read() + ticks, ptimer);
+	auto expire = hw_timer2_read() + ticks;
+	wheel.add(ptimer, expire);
+	bool kick = !wakeTimeValid || int(expire - wakeTime) < 0;
+	if(kick) {
+		wakeTimeValid = true;
+		wakeTime = expire;
+	}
 	mutex.unlock();
 
 	// Kick main thread (which services timers) if we're due next
-	if(timer_list == ptimer) {
+	if(kick) {
 		host_thread_kick();
 	}
 }
@@ -67,26 +288,16 @@ void os_timer_disarm(struct os_timer_t* ptimer)
 {
 	assert(ptimer != nullptr);
 
-	if(intptr_t(ptimer->timer_next) == -1) {
+	// Armed timers are always linked into a (circular) slot list
+	auto isArmed = [ptimer]() { return ptimer->timer_next != nullptr && intptr_t(ptimer->timer_next) != -1; };
+
+	if(!isArmed()) {
 		return;
 	}
 
 	mutex.lock();
-	if(timer_list != nullptr) {
-		// Remove timer from list
-		if(ptimer == timer_list) {
-			timer_list = ptimer->timer_next;
-		} else {
-			auto t = timer_list;
-			while(t->timer_next != nullptr) {
-				if(t->timer_next == ptimer) {
-					t->timer_next = ptimer->timer_next;
-					break;
-				}
-				t = t->timer_next;
-			}
-		}
-		ptimer->timer_next = reinterpret_cast<os_timer_t*>(-1);
+	if(isArmed()) {
+		wheel.remove(ptimer);
 	}
 	mutex.unlock();
 }
@@ -108,26 +319,27 @@ void os_timer_done(struct os_timer_t* ptimer)
 
 int host_service_timers()
 {
-	if(timer_list == nullptr) {
-		return -1;
-	}
-
+	mutex.lock();
 	auto ticks_now = hw_timer2_read();
-	auto t = timer_list;
-	int ticks = t->timer_expire - ticks_now;
-	if(ticks > 0) {
+	auto t = wheel.expire(ticks_now);
+	if(t == nullptr) {
+		if(wheel.isEmpty()) {
+			wakeTimeValid = false;
+			mutex.unlock();
+			return -1;
+		}
+		wakeTimeValid = true;
+		wakeTime = wheel.nextEvent();
+		int ticks = wakeTime - ticks_now;
+		mutex.unlock();
 		// Return milliseconds until timer due
 		using R = std::ratio<1000, HW_TIMER2_CLK>;
-		return muldiv<R::num, R::den>(unsigned(ticks));
+		return (ticks > 0) ? muldiv<R::num, R::den>(unsigned(ticks)) : 0;
 	}
 
-	mutex.lock();
-	// Pop timer from queue
-	timer_list = t->timer_next;
-	t->timer_next = reinterpret_cast<os_timer_t*>(-1);
 	// Repeating timer?
 	if(t->timer_period != 0) {
-		timer_insert(t->timer_expire + t->timer_period, t);
+		wheel.add(t, t->timer_expire + t->timer_period);
 	}
 	mutex.unlock();
 
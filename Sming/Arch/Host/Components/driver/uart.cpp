@@ -29,6 +29,7 @@
 #include <BitManipulations.h>
 #include <Clock.h>
 #include <cstring>
+#include <atomic>
 #include <esp_system.h>
 
 /*
@@ -61,6 +62,11 @@ smg_uart_t* uartInstances[UART_COUNT];
 // Registered port callback functions
 smg_uart_notify_callback_t notifyCallbacks[UART_COUNT];
 
+// Error flags reported to callback since last call to smg_uart_get_status()
+std::atomic<uint8_t> errorStatus[UART_COUNT];
+constexpr uint8_t errorStatusMask{UART_STATUS_BRK_DET | UART_STATUS_RXFIFO_OVF | UART_STATUS_FRM_ERR |
+								  UART_STATUS_PARITY_ERR};
+
 /** @brief Invoke a port callback, if one has been registered
  *  @param uart
  *  @param code
@@ -222,11 +228,19 @@ void smg_uart_set_break(smg_uart_t* uart, bool state)
 	// Not implemented
 }
 
+void smg_uart_host_interrupt(smg_uart_t* uart)
+{
+	auto status = uart->status;
+	uart->status = 0;
+	errorStatus[uart->uart_nr] |= uint8_t(status & errorStatusMask);
+	if(status != 0 && uart->callback != nullptr) {
+		uart->callback(uart, status);
+	}
+}
+
 uint8_t smg_uart_get_status(smg_uart_t* uart)
 {
-	// Not implemented
-	(void)uart;
-	return 0;
+	return (uart == nullptr) ? 0 : errorStatus[uart->uart_nr].exchange(0);
 }
 
 void smg_uart_flush(smg_uart_t* uart, smg_uart_mode_t mode)
@@ -320,6 +334,7 @@ smg_uart_t* smg_uart_init_ex(const smg_uart_config_t& cfg)
 	smg_uart_set_baudrate(uart, cfg.baudrate);
 	smg_uart_set_format(uart, cfg.format);
 	smg_uart_flush(uart);
+	errorStatus[cfg.uart_nr] = 0;
 	uartInstances[cfg.uart_nr] = uart;
 	smg_uart_start_isr(uart);
 
@@ -78,13 +78,7 @@ void* KeyboardThread::thread_routine()
 		uart->status |= UART_STATUS_RXFIFO_TOUT;
 
 		interrupt_begin();
-
-		auto status = uart->status;
-		uart->status = 0;
-		if(status != 0 && uart->callback != nullptr) {
-			uart->callback(uart, status);
-		}
-
+		smg_uart_host_interrupt(uart);
 		interrupt_end();
 	}
 	keyb_restore();
@@ -224,7 +218,7 @@ void CUart::onNotify(smg_uart_t* uart, smg_uart_notify_code_t code)
 	case UART_NOTIFY_AFTER_WRITE: {
 		if(this->uart != nullptr) {
 			// Kick the thread to send now
-			txsem.post();
+			kickTx();
 		} else {
 			// Not connected, discard data
 			uart->tx_buffer->clear();
@@ -277,6 +271,19 @@ int CUart::serviceRead()
 	return read;
 }
 
+bool CUart::canReceive()
+{
+	if(!smg_uart_rx_enabled(uart)) {
+		return false;
+	}
+
+	interrupt_begin();
+	bool res = uart->rx_buffer != nullptr && uart->rx_buffer->getFreeSpace() != 0;
+	interrupt_end();
+
+	return res;
+}
+
 int CUart::serviceWrite()
 {
 	if(!smg_uart_tx_enabled(uart)) {
@@ -307,7 +314,7 @@ int CUart::serviceWrite()
 	if(txbuf->isEmpty()) {
 		uart->status |= UART_STATUS_TXFIFO_EMPTY;
 	} else {
-		txsem.post();
+		kickTx();
 	}
 
 	interrupt_end();
@@ -315,6 +322,20 @@ int CUart::serviceWrite()
 	return result;
 }
 
+bool CUart::waitTx()
+{
+	if(!reactor.isValid()) {
+		return txsem.timedwait(IDLE_SLEEP_MS * 1000);
+	}
+
+	reactor.wait(IDLE_SLEEP_MS * 1000);
+	bool pending{false};
+	while(txsem.trywait()) {
+		pending = true;
+	}
+	return pending;
+}
+
 /* CUartPort */
 
 CUartPort::CUartPort(unsigned uart_nr) : CUart(uart_nr)
@@ -362,30 +383,47 @@ void* CUartPort::thread_routine()
 
 		host_debug_i("Uart #%u socket open", uart_nr);
 
+		// Incoming data wakes the thread immediately; serviceRead() does the work
+		int fd = socket->fd();
+		auto onSocketEvent = [](void* param, unsigned events) {
+			static_cast<CUartPort*>(param)->socketEvents = events;
+		};
+		bool watchRead = reactor.add(fd, REACTOR_READ, onSocketEvent, this);
+
 		while(socket->active()) {
-			if(txsem.timedwait(IDLE_SLEEP_MS * 1000)) {
+			/*
+			 * Socket is level-triggered so only watch it whilst received data can be stored,
+			 * otherwise wait() returns immediately. Space is re-checked after each timed wait.
+			 */
+			if(reactor.isValid() && canReceive() != watchRead) {
+				watchRead = !watchRead;
+				reactor.modify(fd, watchRead ? REACTOR_READ : 0);
+			}
+
+			socketEvents = 0;
+			if(waitTx()) {
 				if(serviceWrite() < 0) {
 					break;
 				}
 			}
 
+			// Readable with nothing to read means the client has disconnected
+			if((socketEvents & REACTOR_ERROR) || ((socketEvents & REACTOR_READ) && available() <= 0)) {
+				break;
+			}
+
 			if(serviceRead() < 0) {
 				break;
 			}
 
 			if(uart != nullptr) {
 				interrupt_begin();
-
-				auto status = uart->status;
-				uart->status = 0;
-				if(status != 0 && uart->callback != nullptr) {
-					uart->callback(uart, status);
-				}
-
+				smg_uart_host_interrupt(uart);
 				interrupt_end();
 			}
 		}
 
+		reactor.remove(fd);
 		socket->close();
 		host_debug_i("Uart #%u socket closed", uart_nr);
 	}
@@ -475,13 +513,7 @@ void* CUartDevice::thread_routine()
 
 		if(uart != nullptr) {
 			interrupt_begin();
-
-			auto status = uart->status;
-			uart->status = 0;
-			if(status != 0 && uart->callback != nullptr) {
-				uart->callback(uart, status);
-			}
-
+			smg_uart_host_interrupt(uart);
 			interrupt_end();
 		}
 	}
@@ -22,6 +22,7 @@
 #include <driver/uart.h>
 #include <hostlib/sockets.h>
 #include <hostlib/threads.h>
+#include <hostlib/reactor.h>
 #include <memory>
 
 class SerialDevice;
@@ -73,7 +74,28 @@ protected:
 	int serviceRead();
 	int serviceWrite();
 
+	/*
+	 * Determine if received data can be stored
+	 */
+	bool canReceive();
+
+	/*
+	 * Signal thread that there's data to be sent out
+	 */
+	void kickTx()
+	{
+		txsem.post();
+		reactor.kick();
+	}
+
+	/*
+	 * Wait for data to send or, if the reactor is in use, activity on a watched descriptor.
+	 * Returns true if there may be data to send.
+	 */
+	bool waitTx();
+
 	CSemaphore txsem;			///< Signals when there's data to be sent out
+	CReactor reactor;			///< Where supported, wakes thread on socket activity instead of polling
 	unsigned uart_nr;			///< Which port we represent
 	smg_uart_t* uart = nullptr; ///< On set if port is open by application
 };
@@ -95,6 +117,7 @@ protected:
 	void* thread_routine() override;
 
 	CSocket* socket{nullptr}; ///< Connected client
+	unsigned socketEvents{0}; ///< REACTOR_xxx flags reported for socket during last wait
 };
 
 /*
@@ -1 +1,6 @@
 COMPONENT_DEPENDS	:= hostlib
+
+# Minimum capacity for Host task queues
+COMPONENT_VARS			+= HOST_TASK_QUEUE_LENGTH
+HOST_TASK_QUEUE_LENGTH	?= 256
+COMPONENT_CXXFLAGS		+= -DHOST_TASK_QUEUE_LENGTH=$(HOST_TASK_QUEUE_LENGTH)
@@ -36,6 +36,26 @@ typedef void (*host_task_callback_t)(os_param_t param);
 
 bool host_queue_callback(host_task_callback_t callback, os_param_t param);
 
+/**
+ * @brief Task queue statistics
+ */
+typedef struct {
+	unsigned capacity;  ///< Number of events queue can hold
+	unsigned count;		///< Number of events currently queued
+	unsigned max_count; ///< High watermark for count
+	unsigned posted;	///< Total number of events successfully posted
+	unsigned dropped;	///< Number of events rejected because queue was full
+} host_task_queue_stats_t;
+
+/**
+ * @brief Get task queue statistics
+ * @param prio Queue priority. Use USER_TASK_PRIO_MAX for the internal host queue.
+ * @param stats On return, contains statistics for the queue
+ * @param reset If true, reset max_count, posted and dropped values after reading
+ * @retval bool false if queue has not been initialised
+ */
+bool host_get_task_queue_stats(uint8_t prio, host_task_queue_stats_t* stats, bool reset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,60 +1,133 @@
+/*
+ * Task queues are bounded lock-free rings, one per priority.
+ *
+ * Events may be posted from any thread (main thread, UART server, lwIP, timer callbacks)
+ * but are only ever serviced by the main thread. Each slot carries a sequence number which
+ * producers use to claim and publish entries without locking (Vyukov's bounded queue).
+ * The single consumer drains a batch of published events on each call to `host_service_tasks()`.
+ */
+
 #include "include/esp_tasks.h"
 #include <hostlib/hostmsg.h>
 #include <stringutil.h>
 #include <hostlib/threads.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#ifndef HOST_TASK_QUEUE_LENGTH
+#define HOST_TASK_QUEUE_LENGTH 256
+#endif
 
 namespace
 {
 class TaskQueue
 {
 public:
-	TaskQueue(os_task_t callback, os_event_t* events, uint8_t length)
-		: callback(callback), events(events), length(length)
+	TaskQueue(os_task_t callback, unsigned length) : callback(callback)
 	{
+		capacity = 1;
+		while(capacity < length) {
+			capacity <<= 1;
+		}
+		slots.reset(new Slot[capacity]);
+		for(unsigned i = 0; i < capacity; ++i) {
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
 	}
 
 	bool post(os_signal_t sig, os_param_t par)
 	{
-		mutex.lock();
-		bool full = (count == length);
-		if(!full) {
-			events[(read + count) % length] = os_event_t{sig, par};
-			++count;
+		auto pos = writePos.load(std::memory_order_relaxed);
+		Slot* slot;
+		for(;;) {
+			slot = &slots[pos & (capacity - 1)];
+			auto seq = slot->sequence.load(std::memory_order_acquire);
+			int diff = int(seq - pos);
+			if(diff == 0) {
+				if(writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(diff < 0) {
+				// Slot not yet released by consumer, so queue is full
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			} else {
+				pos = writePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		slot->event = os_event_t{sig, par};
+		slot->sequence.store(pos + 1, std::memory_order_release);
+
+		posted.fetch_add(1, std::memory_order_relaxed);
+		unsigned depth = pos + 1 - readPos.load(std::memory_order_relaxed);
+		auto max = maxCount.load(std::memory_order_relaxed);
+		while(depth > max && !maxCount.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
 		}
-		mutex.unlock();
-		return !full;
+
+		return true;
 	}
 
 	void process()
 	{
 		// Don't service any newly queued events
-		for(unsigned n = count; n != 0; --n) {
-			mutex.lock();
-			auto evt = events[read];
-			read = (read + 1) % length;
-			--count;
-			mutex.unlock();
+		auto end = writePos.load(std::memory_order_acquire);
+		auto pos = readPos.load(std::memory_order_relaxed);
+		while(pos != end) {
+			auto& slot = slots[pos & (capacity - 1)];
+			if(slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+				// Claimed by a producer but not yet published
+				break;
+			}
+			auto evt = slot.event;
+			// Release slot before invoking callback so it's available to producers
+			slot.sequence.store(pos + capacity, std::memory_order_release);
+			++pos;
+			readPos.store(pos, std::memory_order_relaxed);
 			callback(&evt);
 		}
 	}
 
+	void getStats(host_task_queue_stats_t& stats) const
+	{
+		stats.capacity = capacity;
+		stats.count = writePos.load(std::memory_order_relaxed) - readPos.load(std::memory_order_relaxed);
+		stats.max_count = maxCount.load(std::memory_order_relaxed);
+		stats.posted = posted.load(std::memory_order_relaxed);
+		stats.dropped = dropped.load(std::memory_order_relaxed);
+	}
+
+	void resetStats()
+	{
+		maxCount.store(0, std::memory_order_relaxed);
+		posted.store(0, std::memory_order_relaxed);
+		dropped.store(0, std::memory_order_relaxed);
+	}
+
 private:
-	static CMutex mutex;
+	struct Slot {
+		std::atomic<unsigned> sequence;
+		os_event_t event;
+	};
+
 	os_task_t callback;
-	os_event_t* events;
-	uint8_t read{0};
-	uint8_t count{0};
-	uint8_t length;
+	std::unique_ptr<Slot[]> slots;
+	unsigned capacity;
+	std::atomic<unsigned> writePos{0};
+	std::atomic<unsigned> readPos{0};
+	std::atomic<unsigned> maxCount{0};
+	std::atomic<unsigned> posted{0};
+	std::atomic<unsigned> dropped{0};
 };
 
-CMutex TaskQueue::mutex;
 TaskQueue* task_queues[USER_TASK_PRIO_MAX + 1];
 
 const uint8_t HOST_TASK_PRIO = USER_TASK_PRIO_MAX;
 
 } // namespace
 
-bool system_os_task(os_task_t callback, uint8_t prio, os_event_t* events, uint8_t qlen)
+bool system_os_task(os_task_t callback, uint8_t prio, os_event_t*, uint8_t qlen)
 {
 	if(prio >= USER_TASK_PRIO_MAX) {
 		host_debug_e("Invalid priority %u", prio);
@@ -66,7 +139,8 @@ bool system_os_task(os_task_t callback, uint8_t prio, os_event_t* events, uint8_
 		return false;
 	}
 
-	queue = new TaskQueue(callback, events, qlen);
+	// Queue provides its own storage, which may be larger than requested
+	queue = new TaskQueue(callback, std::max(unsigned(qlen), unsigned(HOST_TASK_QUEUE_LENGTH)));
 	return queue != nullptr;
 }
 
@@ -92,8 +166,6 @@ bool system_os_post(uint8_t prio, os_signal_t sig, os_param_t par)
 
 void host_init_tasks()
 {
-	static os_event_t events[32];
-
 	auto hostTaskCallback = [](os_event_t* event) {
 		auto callback = host_task_callback_t(event->sig);
 		if(callback != nullptr) {
@@ -101,7 +173,7 @@ void host_init_tasks()
 		}
 	};
 
-	task_queues[HOST_TASK_PRIO] = new TaskQueue(hostTaskCallback, events, ARRAY_SIZE(events));
+	task_queues[HOST_TASK_PRIO] = new TaskQueue(hostTaskCallback, HOST_TASK_QUEUE_LENGTH);
 }
 
 void host_service_tasks()
@@ -118,3 +190,21 @@ bool host_queue_callback(host_task_callback_t callback, os_param_t param)
 {
 	return task_queues[HOST_TASK_PRIO]->post(os_signal_t(callback), param);
 }
+
+bool host_get_task_queue_stats(uint8_t prio, host_task_queue_stats_t* stats, bool reset)
+{
+	if(prio > HOST_TASK_PRIO || stats == nullptr) {
+		return false;
+	}
+	auto queue = task_queues[prio];
+	if(queue == nullptr) {
+		*stats = host_task_queue_stats_t{};
+		return false;
+	}
+
+	queue->getStats(*stats);
+	if(reset) {
+		queue->resetStats();
+	}
+	return true;
+}
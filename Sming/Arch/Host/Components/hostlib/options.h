@@ -53,6 +53,9 @@
 	   nullptr)                                                                                                        \
 	XX(flashsize, required_argument, "Change default flash size if file doesn't exist", "SIZE",                        \
 	   "Size of flash in bytes (e.g. 512K, 524288, 0x80000)", nullptr)                                                 \
+	XX(flashmap, optional_argument, "Map flash backing file into memory", "MODE",                                      \
+	   "Omit to write changes back to file, `private` to discard them on exit", nullptr)                               \
+	XX(flashstats, no_argument, "Print flash sector access statistics on exit", nullptr, nullptr, nullptr)             \
 	XX(initonly, no_argument, "Initialise only, do not start Sming", nullptr, nullptr, nullptr)                        \
 	XX(loopcount, required_argument, "Run Sming loop a fixed number of times then exit", nullptr, nullptr,             \
 	   "Useful for running samples in CI\0")                                                                           \
@@ -0,0 +1,248 @@
+/**
+ * reactor.cpp
+ *
+ * Copyright 2019 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the Sming Framework Project
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with SHEM.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "reactor.h"
+#include "include/hostlib/hostmsg.h"
+
+#if HOST_REACTOR_SUPPORTED
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace
+{
+uint32_t getEpollEvents(unsigned events)
+{
+	uint32_t res{0};
+	if(events & REACTOR_READ) {
+		res |= EPOLLIN;
+	}
+	if(events & REACTOR_WRITE) {
+		res |= EPOLLOUT;
+	}
+	return res;
+}
+
+} // namespace
+
+CReactor::CReactor()
+{
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if(epollFd < 0 || eventFd < 0 || timerFd < 0) {
+		host_debug_e("Reactor initialisation failed: %s", strerror(errno));
+		release();
+		return;
+	}
+
+	// Internal descriptors are identified by a null data pointer
+	struct epoll_event ev {
+	};
+	ev.events = EPOLLIN;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, eventFd, &ev);
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &ev);
+}
+
+CReactor::~CReactor()
+{
+	release();
+}
+
+void CReactor::release()
+{
+	for(auto fd : {timerFd, eventFd, epollFd}) {
+		if(fd >= 0) {
+			close(fd);
+		}
+	}
+	timerFd = eventFd = epollFd = -1;
+
+	for(auto& e : entries) {
+		delete e.second;
+	}
+	entries.clear();
+	for(auto e : removed) {
+		delete e;
+	}
+	removed.clear();
+}
+
+bool CReactor::add(int fd, unsigned events, Callback callback, void* param)
+{
+	if(!isValid() || callback == nullptr || entries.count(fd) != 0) {
+		return false;
+	}
+
+	auto entry = new Entry{fd, callback, param};
+	struct epoll_event ev {
+	};
+	ev.events = getEpollEvents(events);
+	ev.data.ptr = entry;
+	if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		host_debug_e("epoll_ctl(ADD, %d): %s", fd, strerror(errno));
+		delete entry;
+		return false;
+	}
+
+	entries[fd] = entry;
+	return true;
+}
+
+bool CReactor::modify(int fd, unsigned events)
+{
+	auto it = entries.find(fd);
+	if(it == entries.end()) {
+		return false;
+	}
+
+	struct epoll_event ev {
+	};
+	ev.events = getEpollEvents(events);
+	ev.data.ptr = it->second;
+	return epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void CReactor::remove(int fd)
+{
+	auto it = entries.find(fd);
+	if(it == entries.end()) {
+		return;
+	}
+
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+	// Events for this entry may already have been collected, so defer deletion
+	it->second->callback = nullptr;
+	removed.push_back(it->second);
+	entries.erase(it);
+}
+
+int CReactor::wait(int64_t timeout_us)
+{
+	if(!isValid()) {
+		return -1;
+	}
+
+	// Zero timeout polls without blocking, so timer isn't required
+	int epollTimeout{0};
+	if(timeout_us != 0) {
+		struct itimerspec its {
+		};
+		if(timeout_us > 0) {
+			its.it_value.tv_sec = timeout_us / 1000000;
+			its.it_value.tv_nsec = (timeout_us % 1000000) * 1000;
+		}
+		timerfd_settime(timerFd, 0, &its, nullptr);
+		epollTimeout = -1;
+	}
+
+	constexpr unsigned maxEvents{16};
+	struct epoll_event events[maxEvents];
+	int n = epoll_wait(epollFd, events, maxEvents, epollTimeout);
+	if(n < 0) {
+		// Interrupted by signal
+		return (errno == EINTR) ? 0 : -1;
+	}
+
+	int count{0};
+	for(int i = 0; i < n; ++i) {
+		auto& ev = events[i];
+		auto entry = static_cast<Entry*>(ev.data.ptr);
+		if(entry == nullptr) {
+			// Clear wakeup/timer: both use an 8-byte counter
+			uint64_t value;
+			(void)read(eventFd, &value, sizeof(value));
+			(void)read(timerFd, &value, sizeof(value));
+			continue;
+		}
+		if(entry->callback == nullptr) {
+			continue;
+		}
+		unsigned flags{0};
+		if(ev.events & EPOLLIN) {
+			flags |= REACTOR_READ;
+		}
+		if(ev.events & EPOLLOUT) {
+			flags |= REACTOR_WRITE;
+		}
+		if(ev.events & (EPOLLERR | EPOLLHUP)) {
+			flags |= REACTOR_ERROR;
+		}
+		entry->callback(entry->param, flags);
+		++count;
+	}
+
+	for(auto e : removed) {
+		delete e;
+	}
+	removed.clear();
+
+	return count;
+}
+
+void CReactor::kick()
+{
+	if(eventFd >= 0) {
+		uint64_t value{1};
+		(void)write(eventFd, &value, sizeof(value));
+	}
+}
+
+#else
+
+CReactor::CReactor()
+{
+}
+
+CReactor::~CReactor()
+{
+}
+
+void CReactor::release()
+{
+}
+
+bool CReactor::add(int, unsigned, Callback, void*)
+{
+	return false;
+}
+
+bool CReactor::modify(int, unsigned)
+{
+	return false;
+}
+
+void CReactor::remove(int)
+{
+}
+
+int CReactor::wait(int64_t)
+{
+	return -1;
+}
+
+void CReactor::kick()
+{
+}
+
+#endif
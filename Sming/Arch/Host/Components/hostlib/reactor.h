@@ -0,0 +1,111 @@
+/**
+ * reactor.h - Event multiplexer for file descriptors, timeouts and cross-thread wakeups
+ *
+ * Copyright 2019 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the Sming Framework Project
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with SHEM.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#ifdef __linux__
+#define HOST_REACTOR_SUPPORTED 1
+#else
+#define HOST_REACTOR_SUPPORTED 0
+#endif
+
+// CReactor event flags
+#define REACTOR_READ 0x01
+#define REACTOR_WRITE 0x02
+#define REACTOR_ERROR 0x04
+
+/**
+ * @brief Waits for activity on a set of file descriptors, a timeout, or a wakeup from another thread
+ *
+ * Uses epoll with an eventfd for wakeups and a timerfd for accurate timeouts.
+ * Only supported on Linux: check `isValid()` and fall back to other mechanisms if it fails.
+ *
+ * File descriptors must be added and removed by the thread which calls `wait()`.
+ * `kick()` may be called from any thread.
+ */
+class CReactor
+{
+public:
+	/**
+	 * @brief Callback invoked from `wait()` when a file descriptor is ready
+	 * @param param As passed to `add()`
+	 * @param events Combination of REACTOR_xxx flags
+	 */
+	using Callback = void (*)(void* param, unsigned events);
+
+	CReactor();
+	~CReactor();
+
+	bool isValid() const
+	{
+		return epollFd >= 0;
+	}
+
+	/**
+	 * @brief Start monitoring a file descriptor
+	 * @param fd
+	 * @param events REACTOR_READ and/or REACTOR_WRITE. Errors are always reported.
+	 * @param callback
+	 * @param param
+	 */
+	bool add(int fd, unsigned events, Callback callback, void* param);
+
+	/**
+	 * @brief Change the events being monitored for a file descriptor
+	 */
+	bool modify(int fd, unsigned events);
+
+	/**
+	 * @brief Stop monitoring a file descriptor
+	 * @note Safe to call from within a callback
+	 */
+	void remove(int fd);
+
+	/**
+	 * @brief Wait for events and dispatch callbacks
+	 * @param timeout_us Maximum time to wait in microseconds, negative to wait indefinitely, 0 to poll
+	 * @retval int Number of file descriptor callbacks invoked, or -1 on error
+	 * @note Returns early if `kick()` is called or a signal is received
+	 */
+	int wait(int64_t timeout_us);
+
+	/**
+	 * @brief Cause a current or subsequent call to `wait()` to return immediately
+	 */
+	void kick();
+
+private:
+	void release();
+
+	struct Entry {
+		int fd;
+		Callback callback;
+		void* param;
+	};
+
+	int epollFd{-1};
+	int eventFd{-1};
+	int timerFd{-1};
+	std::map<int, Entry*> entries;
+	std::vector<Entry*> removed; ///< Freed after dispatch completes
+};
@@ -32,6 +32,7 @@
 #include <driver/hw_timer.h>
 #include <esp_tasks.h>
 #include <cstdlib>
+#include <cstring>
 #include "include/hostlib/emu.h"
 #include "include/hostlib/hostlib.h"
 #include "include/hostlib/CommandLine.h"
@@ -221,6 +222,21 @@ int main(int argc, char* argv[])
 			config.flash.createSize = parse_flash_size(arg);
 			break;
 
+		case opt_flashmap:
+			if(arg == nullptr) {
+				config.flash.mode = FlashmemMode::mapped;
+			} else if(strcmp(arg, "private") == 0) {
+				config.flash.mode = FlashmemMode::mappedPrivate;
+			} else {
+				host_printf("flashmap mode '%s' invalid\r\n", arg);
+				return 0;
+			}
+			break;
+
+		case opt_flashstats:
+			config.flash.printStats = true;
+			break;
+
 		case opt_initonly:
 			config.initonly = true;
 			break;
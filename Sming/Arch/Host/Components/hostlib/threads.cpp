@@ -18,6 +18,7 @@
  ****/
 
 #include "threads.h"
+#include "reactor.h"
 #include <cstring>
 #include <cstdarg>
 #include <csignal>
@@ -30,6 +31,7 @@ namespace
 {
 pthread_t mainThread;
 CBasicMutex* interrupt;
+CReactor* mainReactor; ///< Used for idle waits where supported
 pthread_cond_t interruptCond = PTHREAD_COND_INITIALIZER;
 
 #ifdef __WIN32
@@ -183,6 +185,12 @@ void CThread::startup([[maybe_unused]] unsigned cpulimit)
 	mainThread = pthread_self();
 	interrupt = new CBasicMutex;
 
+	mainReactor = new CReactor;
+	if(!mainReactor->isValid()) {
+		delete mainReactor;
+		mainReactor = nullptr;
+	}
+
 #ifdef __WIN32
 	host_thread_semaphore = CreateSemaphore(nullptr, 0, 1024, nullptr);
 #elif defined(__APPLE__)
@@ -262,6 +270,13 @@ void CThread::interrupt_end()
 
 void host_thread_wait(int ms)
 {
+	if(mainReactor != nullptr) {
+		// Timeouts are accurate so no scheduling allowance required.
+		// Always called so watched descriptors get serviced even when busy.
+		mainReactor->wait((ms < 0) ? -1 : int64_t(ms) * 1000);
+		return;
+	}
+
 	constexpr int SCHED_WAIT{2};
 	if(ms >= 0 && ms <= SCHED_WAIT) {
 		return;
@@ -279,9 +294,28 @@ void host_thread_wait(int ms)
 
 void host_thread_kick()
 {
+	if(mainReactor != nullptr) {
+		mainReactor->kick();
+		return;
+	}
+
 #ifdef __WIN32
 	ReleaseSemaphore(host_thread_semaphore, 1, nullptr);
 #else
 	host_thread_semaphore.post();
 #endif
 }
+
+bool host_thread_watch(int fd, unsigned events, void (*callback)(void* param, unsigned events), void* param)
+{
+	assert(isMainThread());
+	return mainReactor != nullptr && mainReactor->add(fd, events, callback, param);
+}
+
+void host_thread_unwatch(int fd)
+{
+	assert(isMainThread());
+	if(mainReactor != nullptr) {
+		mainReactor->remove(fd);
+	}
+}
@@ -270,3 +270,20 @@ void host_thread_wait(int ms);
  * Cancels wait, e.g. when new event is posted to queue
  */
 void host_thread_kick();
+
+/*
+ * Monitor a file descriptor whilst the main thread is waiting.
+ * The callback is invoked in the main thread when the descriptor is ready.
+ * @param fd
+ * @param events REACTOR_READ and/or REACTOR_WRITE (see reactor.h)
+ * @param callback
+ * @param param
+ * @retval bool false if not supported, in which case the descriptor must be polled
+ * @note Must be called from the main thread
+ */
+bool host_thread_watch(int fd, unsigned events, void (*callback)(void* param, unsigned events), void* param);
+
+/*
+ * Stop monitoring a file descriptor
+ */
+void host_thread_unwatch(int fd);
@@ -20,9 +20,18 @@
 #include <hostlib/hostlib.h>
 #include "flashmem.h"
 #include <cstring>
+#include <cerrno>
 #include <esp_spi_flash.h>
 #include <IFS/File.h>
 #include <hostlib/hostmsg.h>
+#include <vector>
+#include <algorithm>
+
+#ifndef __WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace
 {
@@ -30,11 +39,68 @@ IFS::File flashFile(&IFS::Host::getFileSystem());
 size_t flashFileSize{0x400000U};
 char flashFileName[256];
 const char defaultFlashFileName[]{"flash.bin"};
+FlashmemConfig flashConfig;
+uint8_t* flashMap; ///< Start of mapped backing file, if in use
+std::vector<FlashmemSectorStats> sectorStats;
 
 // Top bit of flash address is set to indicate it's actually program memory
 constexpr flash_addr_t FLASHMEM_REAL_BIT{1UL << (sizeof(flash_addr_t) * 8 - 1)};
 constexpr flash_addr_t FLASHMEM_REAL_MASK{~FLASHMEM_REAL_BIT};
 
+/*
+ * Apply a function to statistics for all sectors touched by an operation
+ */
+template <typename Func> void updateStats(uint32_t offset, size_t count, Func func)
+{
+	if(count == 0 || sectorStats.empty()) {
+		return;
+	}
+	auto first = offset / INTERNAL_FLASH_SECTOR_SIZE;
+	auto last = std::min(size_t(offset + count - 1) / INTERNAL_FLASH_SECTOR_SIZE, sectorStats.size() - 1);
+	for(auto i = first; i <= last; ++i) {
+		func(sectorStats[i]);
+	}
+}
+
+bool mapFlashFile()
+{
+#ifdef __WIN32
+	host_debug_w("Flash mapping not supported, using file I/O");
+	return true;
+#else
+	int fd = ::open(flashFileName, O_RDWR);
+	if(fd < 0) {
+		host_debug_e("Error opening \"%s\" for mapping: %s", flashFileName, strerror(errno));
+		return false;
+	}
+	int flags = (flashConfig.mode == FlashmemMode::mappedPrivate) ? MAP_PRIVATE : MAP_SHARED;
+	void* addr = mmap(nullptr, flashFileSize, PROT_READ | PROT_WRITE, flags, fd, 0);
+	::close(fd);
+	if(addr == MAP_FAILED) {
+		host_debug_e("Error mapping \"%s\": %s", flashFileName, strerror(errno));
+		return false;
+	}
+	flashMap = static_cast<uint8_t*>(addr);
+	host_debug_i("Mapped \"%s\"%s", flashFileName,
+				 (flags == MAP_PRIVATE) ? ", changes will be discarded on exit" : "");
+	return true;
+#endif
+}
+
+void unmapFlashFile()
+{
+#ifndef __WIN32
+	if(flashMap == nullptr) {
+		return;
+	}
+	if(flashConfig.mode == FlashmemMode::mapped) {
+		msync(flashMap, flashFileSize, MS_SYNC);
+	}
+	munmap(flashMap, flashFileSize);
+	flashMap = nullptr;
+#endif
+}
+
 } // namespace
 
 #define CHECK_ALIGNMENT(_x) assert((uintptr_t(_x) & 0x00000003) == 0)
@@ -88,18 +154,79 @@ bool host_flashmem_init(FlashmemConfig& config)
 
 	flashFileSize = res;
 	config.createSize = flashFileSize;
+	flashConfig = config;
+	sectorStats.assign((flashFileSize + INTERNAL_FLASH_SECTOR_SIZE - 1) / INTERNAL_FLASH_SECTOR_SIZE, {});
+
+	if(config.mode != FlashmemMode::file && !mapFlashFile()) {
+		flashFile.close();
+		return false;
+	}
 
 	return true;
 }
 
 void host_flashmem_cleanup()
 {
+	if(flashConfig.printStats) {
+		host_flashmem_print_stats();
+	}
+	unmapFlashFile();
 	flashFile.close();
 	host_debug_i("Closed \"%s\"", flashFileName);
 }
 
+bool host_flashmem_get_stats(unsigned sector, FlashmemSectorStats& stats)
+{
+	if(sector >= sectorStats.size()) {
+		return false;
+	}
+	stats = sectorStats[sector];
+	return true;
+}
+
+void host_flashmem_reset_stats()
+{
+	std::fill(sectorStats.begin(), sectorStats.end(), FlashmemSectorStats{});
+}
+
+void host_flashmem_print_stats(unsigned maxSectors)
+{
+	FlashmemSectorStats total{};
+	std::vector<unsigned> used;
+	for(unsigned i = 0; i < sectorStats.size(); ++i) {
+		auto& st = sectorStats[i];
+		total.reads += st.reads;
+		total.writes += st.writes;
+		total.erases += st.erases;
+		if(st.reads + st.writes + st.erases != 0) {
+			used.push_back(i);
+		}
+	}
+
+	host_printf("Flash statistics: %u reads, %u writes, %u erases over %u of %u sectors\r\n", total.reads,
+				total.writes, total.erases, unsigned(used.size()), unsigned(sectorStats.size()));
+
+	// Rank by wear first, then by reads
+	auto rank = [](const FlashmemSectorStats& st) { return (uint64_t(st.erases + st.writes) << 32) | st.reads; };
+	std::sort(used.begin(), used.end(),
+			  [&](unsigned a, unsigned b) { return rank(sectorStats[a]) > rank(sectorStats[b]); });
+	if(used.size() > maxSectors) {
+		used.resize(maxSectors);
+	}
+	for(auto i : used) {
+		auto& st = sectorStats[i];
+		host_printf("  Sector #%u @ 0x%08x: %u reads, %u writes, %u erases\r\n", i, i * INTERNAL_FLASH_SECTOR_SIZE,
+					st.reads, st.writes, st.erases);
+	}
+}
+
 static int readFlashFile(uint32_t offset, void* buffer, size_t count)
 {
+	updateStats(offset, count, [](FlashmemSectorStats& st) { ++st.reads; });
+	if(flashMap != nullptr) {
+		memcpy(buffer, &flashMap[offset], count);
+		return count;
+	}
 	if(!flashFile) {
 		return -1;
 	}
@@ -115,6 +242,10 @@ static int readFlashFile(uint32_t offset, void* buffer, size_t count)
 
 static int writeFlashFile(uint32_t offset, const void* data, size_t count)
 {
+	if(flashMap != nullptr) {
+		memcpy(&flashMap[offset], data, count);
+		return count;
+	}
 	if(!flashFile) {
 		return -1;
 	}
@@ -189,6 +320,7 @@ uint32_t flashmem_read_internal(void* to, uintptr_t fromaddr, uint32_t size)
 uint32_t flashmem_write(const void* from, flash_addr_t toaddr, uint32_t size)
 {
 	CHECK_RANGE(toaddr, size);
+	updateStats(toaddr, size, [](FlashmemSectorStats& st) { ++st.writes; });
 	int res = writeFlashFile(toaddr, from, size);
 	return (res < 0) ? 0 : res;
 }
@@ -208,6 +340,11 @@ bool flashmem_erase_sector(uint32_t sector_id)
 {
 	uint32_t addr = sector_id * INTERNAL_FLASH_SECTOR_SIZE;
 	CHECK_RANGE(addr, INTERNAL_FLASH_SECTOR_SIZE);
+	++sectorStats[sector_id].erases;
+	if(flashMap != nullptr) {
+		memset(&flashMap[addr], 0xFF, INTERNAL_FLASH_SECTOR_SIZE);
+		return true;
+	}
 	uint8_t tmp[INTERNAL_FLASH_SECTOR_SIZE];
 	memset(tmp, 0xFF, sizeof(tmp));
 	return writeFlashFile(addr, tmp, sizeof(tmp)) == sizeof(tmp);
@@ -20,10 +20,29 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+
+enum class FlashmemMode {
+	file,		   ///< Access backing file using regular file I/O
+	mapped,		   ///< Map backing file into memory, changes are written back to file
+	mappedPrivate, ///< Map backing file into memory, changes are discarded on exit
+};
 
 struct FlashmemConfig {
 	const char* filename; ///< Path to flash backing file
 	size_t createSize;	///< If file doesn't exist, created with this size
+	FlashmemMode mode;	///< How backing file is accessed
+	bool printStats;	  ///< Print sector access statistics on exit
+};
+
+/**
+ * @brief Access counts for a single flash sector
+ * @note An operation which spans several sectors is counted once for each sector
+ */
+struct FlashmemSectorStats {
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t erases;
 };
 
 /**
@@ -38,3 +57,22 @@ struct FlashmemConfig {
 bool host_flashmem_init(FlashmemConfig& config);
 
 void host_flashmem_cleanup();
+
+/**
+ * @brief Get access statistics for a flash sector
+ * @param sector Sector number
+ * @param stats On success, contains the statistics
+ * @retval bool false if sector is out of range
+ */
+bool host_flashmem_get_stats(unsigned sector, FlashmemSectorStats& stats);
+
+/**
+ * @brief Reset all sector statistics to zero
+ */
+void host_flashmem_reset_stats();
+
+/**
+ * @brief Print totals and the most heavily used sectors
+ * @param maxSectors Maximum number of sectors to list
+ */
+void host_flashmem_print_stats(unsigned maxSectors = 10);
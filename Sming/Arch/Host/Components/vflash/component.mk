@@ -15,6 +15,15 @@ CACHE_VARS			+= HOST_FLASH_OPTIONS
 HOST_FLASH_OPTIONS	?= --flashfile=$(FLASH_BIN) --flashsize=$(SPI_SIZE)
 override CLI_TARGET_OPTIONS += $(HOST_FLASH_OPTIONS)
 
+# Map flash backing file into memory: 0 to use file I/O, 1 to write changes back, `private` to discard them
+CACHE_VARS			+= HOST_FLASH_MAP
+HOST_FLASH_MAP		?= 0
+ifeq ($(HOST_FLASH_MAP),1)
+override CLI_TARGET_OPTIONS += --flashmap
+else ifeq ($(HOST_FLASH_MAP),private)
+override CLI_TARGET_OPTIONS += --flashmap=private
+endif
+
 # Virtual flasher tool
 VFLASH := $(PYTHON) $(COMPONENT_PATH)/vflash.py $(FLASH_BIN) $(STORAGE_DEVICE_spiFlash_SIZE_BYTES)
 
@@ -20,7 +20,8 @@ COMPONENT_DEPENDS := \
 	libb64 \
 	ws_parser \
 	mqtt-codec \
-	libyuarel
+	libyuarel \
+	uzlib
 
 # WiFi settings may be provide via Environment variables
 CONFIG_VARS				+= WIFI_SSID WIFI_PWD
@@ -94,6 +95,22 @@ endif
 
 endif
 
+##@Building
+
+# Web asset bundle, see AssetBundle class
+CACHE_VARS			+= ASSET_BUNDLE_FILES
+ifdef ASSET_BUNDLE_FILES
+ASSET_BUNDLE_TOOL	:= $(PYTHON) $(COMPONENT_PATH)/tools/assetbundle.py
+DEBUG_VARS			+= ASSET_BUNDLE_BIN
+ASSET_BUNDLE_BIN	:= $(PROJECT_DIR)/$(OUT_BASE)/assets.bin
+APP_CFLAGS			+= -DASSET_BUNDLE_BIN=\"$(ASSET_BUNDLE_BIN)\"
+CUSTOM_TARGETS		+= $(ASSET_BUNDLE_BIN)
+$(ASSET_BUNDLE_BIN): $(call ListAllFiles,$(ASSET_BUNDLE_FILES),*)
+	$(info Creating asset bundle '$@')
+	$(Q) mkdir -p $(@D)
+	$(Q) $(ASSET_BUNDLE_TOOL) $(ASSET_BUNDLE_FILES) $@
+endif
+
 ##@Testing
 
 # Websocket Server
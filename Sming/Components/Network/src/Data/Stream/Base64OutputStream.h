@@ -31,17 +31,6 @@ public:
 
 	size_t transform(const uint8_t* source, size_t sourceLength, uint8_t* target, size_t targetLength) override;
 
-	void saveState() override
-	{
-		savedState = state;
-	}
-
-	void restoreState() override
-	{
-		state = savedState;
-	}
-
 private:
 	base64_encodestate state{};
-	base64_encodestate savedState{};
 };
@@ -0,0 +1,154 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * DeflateOutputStream.cpp
+ *
+ ****/
+
+#include "DeflateOutputStream.h"
+#include <debug_progmem.h>
+
+namespace
+{
+constexpr unsigned maxWindowSize{32768};
+
+// Worst case for static huffman coding is 9 bits per literal, plus header and trailer
+constexpr size_t getResultSize(size_t blockSize)
+{
+	return blockSize + (blockSize / 8) + 32;
+}
+
+} // namespace
+
+DeflateOutputStream::DeflateOutputStream(IDataSourceStream* stream, Format format, uint16_t windowSize,
+										 uint8_t hashBits, size_t blockSize)
+	: StreamTransformer(stream, getResultSize(blockSize), blockSize),
+	  windowSize(std::min(unsigned(windowSize), maxWindowSize)), blockSize(blockSize), format(format)
+{
+	window.reset(new uint8_t[this->windowSize + blockSize]);
+	comp.hash_bits = hashBits;
+	comp.dict_size = this->windowSize;
+	comp.hash_table = new uzlib_hash_entry_t[1U << hashBits]{};
+	checksum = (format == Format::gzip) ? ~0U : 1U;
+}
+
+DeflateOutputStream::~DeflateOutputStream()
+{
+	delete[] comp.hash_table;
+	free(comp.out.outbuf);
+}
+
+void DeflateOutputStream::slideWindow()
+{
+	// Retain most recent history, adjusting hash table to match
+	size_t keep = std::min(windowUsed, size_t(windowSize));
+	size_t shift = windowUsed - keep;
+	memmove(&window[0], &window[shift], keep);
+	windowUsed = keep;
+
+	auto limit = &window[shift];
+	for(unsigned i = 0; i < (1U << comp.hash_bits); ++i) {
+		auto& entry = comp.hash_table[i];
+		if(entry == nullptr) {
+			continue;
+		}
+		entry = (entry < limit) ? nullptr : entry - shift;
+	}
+}
+
+void DeflateOutputStream::compress(const uint8_t* data, size_t length)
+{
+	if(format == Format::gzip) {
+		checksum = uzlib_crc32(data, length, checksum);
+	} else {
+		checksum = uzlib_adler32(data, length, checksum);
+	}
+	inputLength += length;
+
+	while(length != 0) {
+		auto n = std::min(length, size_t(blockSize));
+		if(windowUsed + n > size_t(windowSize) + blockSize) {
+			slideWindow();
+		}
+		auto ptr = &window[windowUsed];
+		memcpy(ptr, data, n);
+		uzlib_compress(&comp, ptr, n);
+		windowUsed += n;
+		data += n;
+		length -= n;
+	}
+}
+
+size_t DeflateOutputStream::drain(uint8_t* out, size_t outLength)
+{
+	auto& buf = comp.out;
+	size_t n = std::min(size_t(buf.outlen), outLength);
+	memcpy(out, buf.outbuf, n);
+	if(n < size_t(buf.outlen)) {
+		debug_w("[DEFLATE] Output buffer too small");
+		memmove(buf.outbuf, &buf.outbuf[n], buf.outlen - n);
+	}
+	buf.outlen -= n;
+	return n;
+}
+
+size_t DeflateOutputStream::transform(const uint8_t* in, size_t inLength, uint8_t* out, size_t outLength)
+{
+	size_t offset{0};
+
+	if(!started) {
+		if(format == Format::gzip) {
+			// ID1, ID2, CM (deflate), FLG, MTIME (4), XFL, OS (unknown)
+			const uint8_t header[]{0x1f, 0x8b, 0x08, 0, 0, 0, 0, 0, 0, 0xff};
+			memcpy(out, header, sizeof(header));
+			offset = sizeof(header);
+		} else {
+			// CMF (deflate, 32K window), FLG (fastest compression, FCHECK)
+			out[0] = 0x78;
+			out[1] = 0x01;
+			offset = 2;
+		}
+		zlib_start_block(&comp.out);
+		started = true;
+	}
+
+	if(in != nullptr) {
+		compress(in, inLength);
+		offset += drain(&out[offset], outLength - offset);
+		outputLength += offset;
+		return offset;
+	}
+
+	// End of input: complete the block and discard any padding bits
+	zlib_finish_block(&comp.out);
+	comp.out.outbits = 0;
+	comp.out.noutbits = 0;
+	offset += drain(&out[offset], outLength - offset);
+
+	uint8_t trailer[8];
+	size_t trailerLength;
+	if(format == Format::gzip) {
+		// CRC32 and ISIZE, both little-endian
+		uint32_t crc = ~checksum;
+		for(unsigned i = 0; i < 4; ++i) {
+			trailer[i] = crc >> (i * 8);
+			trailer[4 + i] = inputLength >> (i * 8);
+		}
+		trailerLength = 8;
+	} else {
+		// ADLER32, big-endian
+		for(unsigned i = 0; i < 4; ++i) {
+			trailer[i] = checksum >> (24 - i * 8);
+		}
+		trailerLength = 4;
+	}
+	trailerLength = std::min(trailerLength, outLength - offset);
+	memcpy(&out[offset], trailer, trailerLength);
+	offset += trailerLength;
+
+	outputLength += offset;
+	return offset;
+}
@@ -0,0 +1,107 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * DeflateOutputStream.h
+ *
+ ****/
+
+#pragma once
+
+#include <Data/StreamTransformer.h>
+#include <uzlib.h>
+
+#ifndef DEFLATE_WINDOW_SIZE
+/**
+ * @brief Default amount of previous input retained for matching, in bytes
+ */
+#define DEFLATE_WINDOW_SIZE 1024
+#endif
+
+#ifndef DEFLATE_HASH_BITS
+/**
+ * @brief Default size of match hash table, as a power of 2
+ */
+#define DEFLATE_HASH_BITS 8
+#endif
+
+/**
+ * @brief Read-only stream to emit deflate-compressed content from source stream
+ *
+ * Content is compressed on the fly using uzlib, so memory usage is fixed regardless of the source size.
+ * This is approximately `windowSize + blockSize + 4 * 2^hashBits` bytes plus the StreamTransformer buffers.
+ *
+ * A larger window finds more matches (up to a maximum of 32768 bytes) at the expense of RAM.
+ * The default settings are suitable for the ESP8266.
+ *
+ * @ingroup stream data
+ */
+class DeflateOutputStream : public StreamTransformer
+{
+public:
+	enum class Format {
+		zlib, ///< RFC 1950, corresponds to HTTP "deflate" content coding
+		gzip, ///< RFC 1952
+	};
+
+	/**
+	 * @brief Construct a compression stream
+	 * @param stream Source stream, owned by this object
+	 * @param format Output framing
+	 * @param windowSize Size of history buffer
+	 * @param hashBits Size of hash table
+	 * @param blockSize Amount of source data compressed in each step
+	 */
+	DeflateOutputStream(IDataSourceStream* stream, Format format = Format::gzip,
+						uint16_t windowSize = DEFLATE_WINDOW_SIZE, uint8_t hashBits = DEFLATE_HASH_BITS,
+						size_t blockSize = 256);
+
+	~DeflateOutputStream();
+
+	bool isValid() const override
+	{
+		return window && comp.hash_table != nullptr && StreamTransformer::isValid();
+	}
+
+	Format getFormat() const
+	{
+		return format;
+	}
+
+	/**
+	 * @brief Get number of source bytes processed
+	 */
+	size_t getInputLength() const
+	{
+		return inputLength;
+	}
+
+	/**
+	 * @brief Get number of compressed bytes produced
+	 */
+	size_t getOutputLength() const
+	{
+		return outputLength;
+	}
+
+protected:
+	size_t transform(const uint8_t* in, size_t inLength, uint8_t* out, size_t outLength) override;
+
+private:
+	void compress(const uint8_t* data, size_t length);
+	void slideWindow();
+	size_t drain(uint8_t* out, size_t outLength);
+
+	uzlib_comp comp{};
+	std::unique_ptr<uint8_t[]> window;
+	size_t windowUsed{0};
+	size_t inputLength{0};
+	size_t outputLength{0};
+	uint32_t checksum;
+	uint16_t windowSize;
+	uint16_t blockSize;
+	Format format;
+	bool started{false};
+};
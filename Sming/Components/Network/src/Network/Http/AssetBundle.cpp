@@ -0,0 +1,161 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * AssetBundle.cpp
+ *
+ ****/
+
+#include "AssetBundle.h"
+#include "HttpServerConnection.h"
+#include <Data/Stream/FlashMemoryStream.h>
+#include <Data/Stream/LimitedReadStream.h>
+#include <Data/HexString.h>
+#include <debug_progmem.h>
+
+namespace
+{
+constexpr uint32_t bundleMagic{0x42415753}; // "SWAB"
+constexpr uint16_t bundleVersion{1};
+} // namespace
+
+AssetBundle::AssetBundle(const FSTR::ObjectBase& data) : data(data)
+{
+	Header hdr;
+	if(data.read(0, &hdr, sizeof(hdr)) != sizeof(hdr) || hdr.magic != bundleMagic || hdr.version != bundleVersion) {
+		debug_e("[ASSET] Invalid bundle");
+		return;
+	}
+	auto entryEnd = hdr.entryOffset + hdr.count * sizeof(Asset::Entry);
+	if(hdr.seedOffset + hdr.count * sizeof(int32_t) > hdr.entryOffset || entryEnd > data.size()) {
+		debug_e("[ASSET] Bundle truncated");
+		return;
+	}
+	header = hdr;
+}
+
+uint32_t AssetBundle::hash(uint32_t seed, const char* key, size_t length)
+{
+	// FNV variant, must match assetbundle.py
+	constexpr uint32_t prime{0x01000193};
+	uint32_t h = seed ? seed : prime;
+	for(unsigned i = 0; i < length; ++i) {
+		h = (h * prime) ^ uint8_t(key[i]);
+	}
+	return h;
+}
+
+bool AssetBundle::compare(uint32_t offset, const char* str, size_t length) const
+{
+	char buf[32];
+	while(length != 0) {
+		auto n = std::min(length, sizeof(buf));
+		if(data.read(offset, buf, n) != n || memcmp(buf, str, n) != 0) {
+			return false;
+		}
+		offset += n;
+		str += n;
+		length -= n;
+	}
+	return true;
+}
+
+String AssetBundle::readString(uint32_t offset, size_t length) const
+{
+	String s;
+	if(s.setLength(length)) {
+		data.read(offset, s.begin(), length);
+	}
+	return s;
+}
+
+AssetBundle::Asset AssetBundle::find(const String& path) const
+{
+	Asset asset;
+	if(header.count == 0) {
+		return asset;
+	}
+
+	auto key = path.c_str();
+	auto keyLength = path.length();
+	unsigned bucket = hash(0, key, keyLength) % header.count;
+	int32_t seed;
+	data.read(header.seedOffset + bucket * sizeof(seed), &seed, sizeof(seed));
+	unsigned slot = (seed < 0) ? unsigned(-seed - 1) : hash(seed, key, keyLength) % header.count;
+
+	asset = (*this)[slot];
+	if(!asset || asset.entry.pathLength != keyLength || !compare(asset.entry.pathOffset, key, keyLength)) {
+		return Asset{};
+	}
+	return asset;
+}
+
+AssetBundle::Asset AssetBundle::operator[](unsigned index) const
+{
+	Asset asset;
+	if(index < header.count &&
+	   data.read(header.entryOffset + index * sizeof(asset.entry), &asset.entry, sizeof(asset.entry)) ==
+		   sizeof(asset.entry) &&
+	   asset.entry.dataOffset + asset.entry.dataLength <= data.size()) {
+		asset.bundle = this;
+	}
+	return asset;
+}
+
+String AssetBundle::Asset::getPath() const
+{
+	return bundle ? bundle->readString(entry.pathOffset, entry.pathLength) : nullptr;
+}
+
+String AssetBundle::Asset::getMimeType() const
+{
+	return bundle ? bundle->readString(entry.mimeOffset, entry.mimeLength) : nullptr;
+}
+
+String AssetBundle::Asset::getETag() const
+{
+	if(!bundle) {
+		return nullptr;
+	}
+	String tag;
+	tag += '"';
+	tag += makeHexString(entry.etag, sizeof(entry.etag));
+	tag += '"';
+	return tag;
+}
+
+IDataSourceStream* AssetBundle::Asset::createStream() const
+{
+	if(!bundle) {
+		return nullptr;
+	}
+	return new LimitedReadStream(new FlashMemoryStream(bundle->data), entry.dataOffset, entry.dataLength);
+}
+
+int AssetBundleResource::requestComplete(HttpServerConnection&, HttpRequest& request, HttpResponse& response)
+{
+	if(request.method != HTTP_GET && request.method != HTTP_HEAD) {
+		response.code = HTTP_STATUS_METHOD_NOT_ALLOWED;
+		return 0;
+	}
+
+	auto asset = bundle.find(request.uri.Path);
+	if(!asset && request.uri.Path.endsWith("/")) {
+		asset = bundle.find(request.uri.Path + indexFile);
+	}
+	if(!asset) {
+		response.code = HTTP_STATUS_NOT_FOUND;
+		return 0;
+	}
+
+	debug_d("[ASSET] %s", request.uri.Path.c_str());
+	response.headers[HTTP_HEADER_ETAG] = asset.getETag();
+	response.headers[HTTP_HEADER_ACCEPT_RANGES] = F("bytes");
+	if(asset.isCompressed()) {
+		response.headers[HTTP_HEADER_CONTENT_ENCODING] = F("gzip");
+	}
+	response.sendDataStream(asset.createStream(), asset.getMimeType());
+	return 0;
+}
@@ -0,0 +1,187 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * AssetBundle.h
+ *
+ ****/
+
+#pragma once
+
+#include "HttpResource.h"
+#include <FlashString/Object.hpp>
+
+/**
+ * @brief Read-only collection of web content stored as a single flash image
+ *
+ * The image is created at build time by `tools/assetbundle.py` and typically imported into
+ * the firmware using `IMPORT_FSTR`. It contains a perfect hash index so any path is located
+ * with a single probe, together with the MIME type, ETag and (usually gzip-compressed) content
+ * for each file.
+ *
+ * Content is read directly from flash, no filesystem is required.
+ *
+ * @ingroup http
+ */
+class AssetBundle
+{
+public:
+	/**
+	 * @brief Describes a single asset within the bundle
+	 */
+	class Asset
+	{
+	public:
+		explicit operator bool() const
+		{
+			return bundle != nullptr;
+		}
+
+		/**
+		 * @brief Request path, with leading '/'
+		 */
+		String getPath() const;
+
+		String getMimeType() const;
+
+		/**
+		 * @brief Quoted entity tag derived from original file content
+		 */
+		String getETag() const;
+
+		/**
+		 * @brief Determine if stored content is gzip-compressed
+		 */
+		bool isCompressed() const
+		{
+			return entry.flags & flagGzip;
+		}
+
+		/**
+		 * @brief Size of stored (possibly compressed) content
+		 */
+		size_t getSize() const
+		{
+			return entry.dataLength;
+		}
+
+		/**
+		 * @brief Create a stream to read the stored content
+		 * @retval IDataSourceStream* Caller is responsible for destroying
+		 */
+		IDataSourceStream* createStream() const;
+
+	private:
+		friend class AssetBundle;
+
+		const AssetBundle* bundle{nullptr};
+		struct Entry {
+			uint32_t pathOffset;
+			uint32_t dataOffset;
+			uint32_t dataLength;
+			uint32_t mimeOffset;
+			uint8_t etag[8];
+			uint16_t pathLength;
+			uint8_t mimeLength;
+			uint8_t flags;
+			uint32_t reserved;
+		} entry{};
+	};
+
+	/**
+	 * @brief Constructor
+	 * @param data Image created by `assetbundle.py`
+	 */
+	AssetBundle(const FSTR::ObjectBase& data);
+
+	/**
+	 * @brief Determine if the image header is valid
+	 */
+	bool isValid() const
+	{
+		return header.count != 0;
+	}
+
+	/**
+	 * @brief Number of assets in the bundle
+	 */
+	unsigned count() const
+	{
+		return header.count;
+	}
+
+	/**
+	 * @brief Locate an asset by path
+	 * @param path Path with leading '/', as for `Url::Path`
+	 * @retval Asset Evaluates to false if not found
+	 */
+	Asset find(const String& path) const;
+
+	/**
+	 * @brief Get asset by index, for enumeration
+	 * @note Assets are in hash order, not sorted
+	 */
+	Asset operator[](unsigned index) const;
+
+private:
+	static constexpr uint8_t flagGzip{0x01};
+
+	struct Header {
+		uint32_t magic;
+		uint16_t version;
+		uint16_t count;
+		uint32_t seedOffset;
+		uint32_t entryOffset;
+	};
+
+	static uint32_t hash(uint32_t seed, const char* key, size_t length);
+	bool compare(uint32_t offset, const char* str, size_t length) const;
+	String readString(uint32_t offset, size_t length) const;
+
+	const FSTR::ObjectBase& data;
+	Header header{};
+};
+
+/**
+ * @brief Serve content from an AssetBundle
+ *
+ * Typically registered as the default resource:
+ *
+ * ```
+ * IMPORT_FSTR_LOCAL(webAssets, ASSET_BUNDLE_BIN)
+ *
+ * server.paths.setDefault(new AssetBundleResource(webAssets));
+ * ```
+ *
+ * Requests for a directory, such as "/", are served using the index file.
+ * Compressed content is always sent with `Content-Encoding: gzip`, as for `HttpResponse::sendFile()`.
+ *
+ * @ingroup http
+ */
+class AssetBundleResource : public HttpResource
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param data Image created by `assetbundle.py`
+	 * @param indexFile Name of file to serve for directory requests
+	 */
+	AssetBundleResource(const FSTR::ObjectBase& data, const String& indexFile = F("index.html"))
+		: bundle(data), indexFile(indexFile)
+	{
+		onRequestComplete = HttpResourceDelegate(&AssetBundleResource::requestComplete, this);
+	}
+
+	const AssetBundle& getBundle() const
+	{
+		return bundle;
+	}
+
+private:
+	int requestComplete(HttpServerConnection& connection, HttpRequest& request, HttpResponse& response);
+
+	AssetBundle bundle;
+	String indexFile;
+};
@@ -12,36 +12,113 @@
 
 #include "HttpClient.h"
 #include <Data/Stream/FileStream.h>
+#include <Clock.h>
 
 HttpClient::HttpConnectionPool HttpClient::httpConnectionPool;
 SimpleTimer HttpClient::cleanUpTimer;
+HttpClient::PoolConfig HttpClient::poolConfig;
+HttpClient::PoolStats HttpClient::poolStats;
 
-bool HttpClient::send(HttpRequest* request)
+namespace
+{
+// First connection to an origin uses the plain cache key, additional ones are numbered
+String getSlotKey(const String& cacheKey, unsigned slot)
+{
+	if(slot == 0) {
+		return cacheKey;
+	}
+	String key = cacheKey;
+	key += '#';
+	key += slot;
+	return key;
+}
+
+} // namespace
+
+void HttpClient::setPoolConfig(const PoolConfig& config)
 {
-	String cacheKey = getCacheKey(request->uri);
+	poolConfig = config;
+	if(poolConfig.maxConnectionsPerOrigin == 0) {
+		poolConfig.maxConnectionsPerOrigin = 1;
+	}
+
+	for(unsigned i = 0; i < httpConnectionPool.count(); ++i) {
+		httpConnectionPool.valueAt(i)->setPipelining(poolConfig.pipelining);
+	}
+
+	if(cleanUpTimer.isStarted()) {
+		startCleanUpTimer();
+	}
+}
 
+HttpClientConnection* HttpClient::getConnection(const String& cacheKey)
+{
+	/*
+	 * Prefer an idle connection, then a new one (if permitted), otherwise queue the request
+	 * on whichever connection has the fewest outstanding requests.
+	 */
 	HttpClientConnection* connection = nullptr;
+	int freeSlot = -1;
+	bool idle = false;
+	for(unsigned slot = 0; slot < poolConfig.maxConnectionsPerOrigin; ++slot) {
+		auto conn = httpConnectionPool.find(getSlotKey(cacheKey, slot));
+		if(conn == nullptr) {
+			if(freeSlot < 0) {
+				freeSlot = slot;
+			}
+			continue;
+		}
+		if(conn->isFinished()) {
+			connection = conn;
+			idle = true;
+			break;
+		}
+		if(connection == nullptr || conn->getPendingRequestCount() < connection->getPendingRequestCount()) {
+			connection = conn;
+		}
+	}
 
-	int i = httpConnectionPool.indexOf(cacheKey);
-	if(i >= 0) {
-		// Check existing connection
-		connection = httpConnectionPool.valueAt(i);
+	if(!idle && freeSlot >= 0 && poolConfig.maxConnections != 0 &&
+	   httpConnectionPool.count() >= poolConfig.maxConnections) {
+		if(!evictIdleConnection() && connection != nullptr) {
+			// Pool is full of busy connections, so share an existing one
+			freeSlot = -1;
+		}
 	}
 
-	if(connection == nullptr) {
+	if(!idle && freeSlot >= 0) {
 		debug_d("Creating new HttpClientConnection");
 		connection = new HttpClientConnection();
 		if(connection == nullptr) {
-			debug_e("Cannot send request. Out of memory");
-			// Out of memory
-			delete request;
-			return false;
+			return nullptr;
 		}
-		httpConnectionPool[cacheKey] = connection;
+		connection->setPipelining(poolConfig.pipelining);
+		httpConnectionPool[getSlotKey(cacheKey, freeSlot)] = connection;
+		++poolStats.misses;
+		return connection;
+	}
+
+	// Re-using a connection which has been closed still requires a new TCP connection
+	if(connection->getConnectionState() == eTCS_Connecting || connection->isActive()) {
+		++poolStats.hits;
+	} else {
+		++poolStats.misses;
+	}
+	return connection;
+}
+
+bool HttpClient::send(HttpRequest* request)
+{
+	auto connection = getConnection(getCacheKey(request->uri));
+	if(connection == nullptr) {
+		debug_e("Cannot send request. Out of memory");
+		// Out of memory
+		delete request;
+		return false;
 	}
 
 	if(!cleanUpTimer.isStarted()) {
-		cleanUpTimer.initializeMs<60000>(HttpClient::cleanInactive).start(); // run every minute
+		startCleanUpTimer();
 	}
 	return connection->send(request);
 }
@@ -64,10 +141,46 @@ bool HttpClient::downloadFile(const Url& url, const String& saveFileName, Reques
 		createRequest(url)->setResponseStream(fileStream)->setMethod(HTTP_GET)->onRequestComplete(requestComplete));
 }
 
+void HttpClient::startCleanUpTimer()
+{
+	// Check at least every minute, more often for short idle timeouts
+	unsigned interval = constrain(poolConfig.idleTimeout * 1000U / 2, 1000U, 60000U);
+	cleanUpTimer.initializeMs(interval, HttpClient::cleanInactive).start();
+}
+
+bool HttpClient::evictIdleConnection()
+{
+	int lruIndex = -1;
+	uint32_t lruTime{0};
+	auto now = millis();
+	for(unsigned i = 0; i < httpConnectionPool.count(); ++i) {
+		auto connection = httpConnectionPool.valueAt(i);
+		if(!connection->isFinished()) {
+			continue;
+		}
+		auto idleTime = now - connection->getLastActivity();
+		if(lruIndex < 0 || idleTime > lruTime) {
+			lruIndex = i;
+			lruTime = idleTime;
+		}
+	}
+
+	if(lruIndex < 0) {
+		return false;
+	}
+
+	debug_d("Evicting idle connection '%s'", httpConnectionPool.keyAt(lruIndex).c_str());
+	httpConnectionPool.removeAt(lruIndex);
+	++poolStats.evictions;
+	return true;
+}
+
 void HttpClient::cleanInactive()
 {
 	debug_d("Total connections: %d", httpConnectionPool.count());
 
+	auto now = millis();
+	uint32_t idleTimeout = poolConfig.idleTimeout * 1000U;
 	size_t i = 0;
 	while(i < httpConnectionPool.count()) {
 		auto connection = httpConnectionPool.valueAt(i);
@@ -76,8 +189,22 @@ void HttpClient::cleanInactive()
 			debug_d("Removing stale connection: State: %d, Active: %d, Finished: %d", connection->getConnectionState(),
 					connection->isActive(), connection->isFinished());
 			httpConnectionPool.removeAt(i);
+		} else if(connection->isFinished() && now - connection->getLastActivity() >= idleTimeout) {
+			debug_d("Closing idle connection '%s'", httpConnectionPool.keyAt(i).c_str());
+			httpConnectionPool.removeAt(i);
+			++poolStats.evictions;
 		} else {
 			++i;
 		}
 	}
+
+	while(poolConfig.maxConnections != 0 && httpConnectionPool.count() > poolConfig.maxConnections) {
+		if(!evictIdleConnection()) {
+			break;
+		}
+	}
+
+	if(httpConnectionPool.count() == 0) {
+		cleanUpTimer.stop();
+	}
 }
@@ -28,6 +28,41 @@
 class HttpClient
 {
 public:
+	/**
+	 * @brief Connection pool settings, shared by all HttpClient instances
+	 */
+	struct PoolConfig {
+		/**
+		 * @brief Maximum number of concurrent connections to a single origin (scheme, host and port)
+		 * @note Requests are queued on the least busy connection once the limit is reached
+		 */
+		uint8_t maxConnectionsPerOrigin{1};
+		/**
+		 * @brief Maximum number of pooled connections in total, 0 for no limit
+		 * @note When the limit is reached, the least recently used idle connection is closed
+		 * to make room for a new one. If all connections are busy the limit may be exceeded.
+		 */
+		uint8_t maxConnections{0};
+		/**
+		 * @brief Seconds an idle connection is kept open for re-use, 0 to close as soon as possible
+		 */
+		uint16_t idleTimeout{60};
+		/**
+		 * @brief Send idempotent requests without waiting for the previous response
+		 * @note Only used once the server has confirmed it supports persistent connections
+		 */
+		bool pipelining{true};
+	};
+
+	/**
+	 * @brief Connection pool statistics
+	 */
+	struct PoolStats {
+		uint32_t hits;		///< Requests sent using an existing open connection
+		uint32_t misses;	///< Requests which required a new connection to be established
+		uint32_t evictions; ///< Connections closed by the pool when idle
+	};
+
 	/**
 	 * @brief HttpClient destructor
 	 * @note DON'T call cleanup.
@@ -123,22 +158,69 @@ public:
 	 */
 	static void cleanup()
 	{
+		cleanUpTimer.stop();
 		httpConnectionPool.clear();
 	}
 
+	/**
+	 * @brief Change connection pool settings
+	 * @note Existing connections are not closed, but are subject to the new limits
+	 */
+	static void setPoolConfig(const PoolConfig& config);
+
+	static const PoolConfig& getPoolConfig()
+	{
+		return poolConfig;
+	}
+
+	static const PoolStats& getPoolStats()
+	{
+		return poolStats;
+	}
+
+	static void resetPoolStats()
+	{
+		poolStats = {};
+	}
+
+	/**
+	 * @brief Get number of connections currently held in the pool
+	 */
+	static unsigned getConnectionCount()
+	{
+		return httpConnectionPool.count();
+	}
+
 protected:
 	String getCacheKey(const Url& url)
 	{
-		return url.Host + ':' + url.getPort();
+		String key = url.Scheme;
+		key += ':';
+		key += url.Host;
+		key += ':';
+		key += url.getPort();
+		return key;
 	}
 
+	/**
+	 * @brief Select a connection for a request, creating one if necessary
+	 * @param cacheKey Identifies the origin
+	 * @retval HttpClientConnection* nullptr if out of memory
+	 */
+	HttpClientConnection* getConnection(const String& cacheKey);
+
 protected:
 	using HttpConnectionPool = ObjectMap<String, HttpClientConnection>;
 	static HttpConnectionPool httpConnectionPool;
 
 private:
 	static SimpleTimer cleanUpTimer;
+	static PoolConfig poolConfig;
+	static PoolStats poolStats;
+
+	static void startCleanUpTimer();
 	static void cleanInactive();
+	static bool evictIdleConnection();
 };
 
 /** @} */
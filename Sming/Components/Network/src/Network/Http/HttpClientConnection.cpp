@@ -16,6 +16,7 @@
 #include "Data/Stream/LimitedMemoryStream.h"
 #include "Data/Stream/ChunkedStream.h"
 #include "Data/Stream/UrlencodedOutputStream.h"
+#include <Clock.h>
 
 bool HttpClientConnection::connect(const String& host, int port, bool useSsl)
 {
@@ -48,6 +49,8 @@ bool HttpClientConnection::send(HttpRequest* request)
 		return false;
 	}
 
+	lastActivity = millis();
+
 	bool useSsl = (request->uri.Scheme == URI_SCHEME_HTTP_SECURE);
 	return connect(request->uri.Host, request->uri.getPort(), useSsl);
 }
@@ -133,6 +136,7 @@ int HttpClientConnection::onMessageComplete(http_parser* parser)
 	delete incomingRequest;
 	incomingRequest = nullptr;
 
+	lastActivity = millis();
 	state = eHCS_Ready;
 
 	auto response = getResponse();
@@ -149,7 +153,7 @@ int HttpClientConnection::onMessageComplete(http_parser* parser)
 		return hasError;
 	}
 
-	allowPipe = true; // if the server supports keep-alive then it would most probably support also pipelining...
+	allowPipe = pipelining; // if the server supports keep-alive then it would most probably support also pipelining...
 
 	if(executionQueue.count() == 0) {
 		onConnected(ERR_OK);
@@ -249,14 +253,14 @@ REENTER:
 
 		// if the executionQueue is not empty then we have to check if we can pipeline that request
 		if(executionQueue.count() != 0) {
-			if(!(allowPipe && (request->method == HTTP_GET || request->method == HTTP_HEAD))) {
+			if(!(allowPipe && canPipeline(request->method))) {
 				// if the current request cannot be pipelined -> break;
 				break;
 			}
 
 			// if we have previous request
 			if(outgoingRequest != nullptr) {
-				if(!(outgoingRequest->method == HTTP_GET || outgoingRequest->method == HTTP_HEAD)) {
+				if(!canPipeline(outgoingRequest->method)) {
 					// the outgoing request does not allow pipelining
 					break;
 				}
@@ -289,7 +293,7 @@ REENTER:
 	case eHCS_StartBody:
 	case eHCS_SendingBody: {
 		if(sendRequestBody(outgoingRequest)) {
-			if(!(outgoingRequest->method == HTTP_GET || outgoingRequest->method == HTTP_HEAD)) {
+			if(!canPipeline(outgoingRequest->method)) {
 				// we should wait for the response from this request.
 				state = eHCS_WaitResponse;
 				break;
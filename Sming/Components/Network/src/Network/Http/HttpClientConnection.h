@@ -53,11 +53,60 @@ public:
 
 	void reset() override;
 
-	bool isFinished()
+	bool isFinished() const
 	{
 		return (waitingQueue.count() + executionQueue.count() == 0);
 	}
 
+	/**
+	 * @brief Get number of requests waiting or in progress
+	 */
+	unsigned getPendingRequestCount() const
+	{
+		return waitingQueue.count() + executionQueue.count();
+	}
+
+	/**
+	 * @brief Get system time (in milliseconds) of the last request or response
+	 */
+	uint32_t getLastActivity() const
+	{
+		return lastActivity;
+	}
+
+	/**
+	 * @brief Enable or disable HTTP pipelining for this connection
+	 * @note Pipelining is only used once the server has responded with a persistent connection
+	 */
+	void setPipelining(bool enable)
+	{
+		pipelining = enable;
+		if(!enable) {
+			allowPipe = false;
+		}
+	}
+
+	/**
+	 * @brief Determine if requests using a method may be pipelined
+	 *
+	 * Only idempotent methods are pipelined, since they can be safely re-sent
+	 * if the connection is closed before the response is received.
+	 * See https://tools.ietf.org/html/rfc7230#section-6.3.2
+	 */
+	static bool canPipeline(HttpMethod method)
+	{
+		switch(method) {
+		case HTTP_GET:
+		case HTTP_HEAD:
+		case HTTP_OPTIONS:
+		case HTTP_PUT:
+		case HTTP_DELETE:
+			return true;
+		default:
+			return false;
+		}
+	}
+
 protected:
 	// HTTP parser methods
 
@@ -104,7 +153,9 @@ private:
 	HttpRequest* incomingRequest = nullptr;
 	HttpRequest* outgoingRequest = nullptr;
 
-	bool allowPipe = false; /// < Flag to specify if HTTP pipelining is allowed for this connection
+	uint32_t lastActivity = 0; ///< millis() at last request or response
+	bool allowPipe = false;	///< Flag to specify if HTTP pipelining is allowed for this connection
+	bool pipelining = true;	///< Pipelining enabled by configuration
 };
 
 /** @} */
@@ -80,6 +80,37 @@ String HttpHeaderFields::toString(const String& name, const String& value)
 	return s;
 }
 
+size_t HttpHeaderFields::printTo(Print& p, HttpHeaderFieldName name, const String& value) const
+{
+	auto printLine = [&](const char* s, size_t length) -> size_t {
+		size_t n{0};
+		if(name < HTTP_HEADER_CUSTOM) {
+			n += p.print(fieldNameStrings[unsigned(name) - 1]);
+		} else {
+			n += p.print(customFieldNames[unsigned(name) - unsigned(HTTP_HEADER_CUSTOM)]);
+		}
+		n += p.print(": ");
+		n += p.write(s, length);
+		n += p.print("\r\n");
+		return n;
+	};
+
+	if(name == HTTP_HEADER_UNKNOWN) {
+		return 0;
+	}
+
+	if(!getFlags(name)[Flag::Multi]) {
+		return printLine(value.c_str(), value.length());
+	}
+
+	size_t n{0};
+	CStringArray values(value);
+	for(auto s : values) {
+		n += printLine(s, strlen(s));
+	}
+	return n;
+}
+
 HttpHeaderFieldName HttpHeaderFields::fromString(const String& name) const
 {
 	auto index = fieldNameStrings.indexOf(name);
@@ -14,6 +14,7 @@
 
 #include "Data/CStringArray.h"
 #include "WString.h"
+#include <Print.h>
 #include <Data/BitSet.h>
 
 /*
@@ -35,6 +36,7 @@
 #define HTTP_HEADER_FIELDNAME_MAP(XX)                                                                                  \
 	XX(ACCEPT, "Accept", 0, "Limit acceptable response types")                                                         \
 	XX(ACCEPT_ENCODING, "Accept-Encoding", 0, "Limit acceptable content encoding types")                               \
+	XX(ACCEPT_RANGES, "Accept-Ranges", 0, "Range units supported by the server, e.g. bytes")                           \
 	XX(ACCESS_CONTROL_ALLOW_ORIGIN, "Access-Control-Allow-Origin", 0, "")                                              \
 	XX(AUTHORIZATION, "Authorization", 0, "Basic user agent authentication")                                           \
 	XX(CC, "Cc", 0, "email field")                                                                                     \
@@ -42,6 +44,7 @@
 	XX(CONTENT_DISPOSITION, "Content-Disposition", 0, "Additional information about how to process response payload")  \
 	XX(CONTENT_ENCODING, "Content-Encoding", 0, "Applied encodings in addition to content type")                       \
 	XX(CONTENT_LENGTH, "Content-Length", 0, "Anticipated size for payload when not using transfer encoding")           \
+	XX(CONTENT_RANGE, "Content-Range", 0, "Position of partial content within the full representation")                \
 	XX(CONTENT_TYPE, "Content-Type", 0,                                                                                \
 	   "Payload media type indicating both data format and intended manner of processing by recipient")                \
 	XX(CONTENT_TRANSFER_ENCODING, "Content-Transfer-Encoding", 0, "Coding method used in a MIME message body part")    \
@@ -59,8 +62,11 @@
 	   "Precondition check using ETag to avoid accidental overwrites when servicing multiple user requests. Ensures "  \
 	   "resource entity tag matches before proceeding.")                                                               \
 	XX(IF_MODIFIED_SINCE, "If-Modified-Since", 0, "Precondition check using Date")                                     \
+	XX(IF_NONE_MATCH, "If-None-Match", 0, "Precondition check using ETag, e.g. for cache validation")                  \
+	XX(IF_RANGE, "If-Range", 0, "Only apply Range if representation is unchanged")                                     \
 	XX(LAST_MODIFIED, "Last-Modified", 0, "Server timestamp indicating date and time resource was last modified")      \
 	XX(LOCATION, "Location", 0, "Used in redirect responses, amongst other places")                                    \
+	XX(RANGE, "Range", 0, "Request only part of a representation")                                                     \
 	XX(SEC_WEBSOCKET_ACCEPT, "Sec-WebSocket-Accept", 0, "Server response to opening Websocket handshake")              \
 	XX(SEC_WEBSOCKET_VERSION, "Sec-WebSocket-Version", 0,                                                              \
 	   "Websocket opening request indicates acceptable protocol version. Can appear more than once.")                  \
@@ -76,6 +82,7 @@
 	XX(UPGRADE, "Upgrade", 0,                                                                                          \
 	   "Used to transition from HTTP to some other protocol on the same connection. e.g. Websocket")                   \
 	XX(USER_AGENT, "User-Agent", 0, "Information about the user agent originating the request")                        \
+	XX(VARY, "Vary", 0, "Request headers used to select the response, e.g. for caching")                               \
 	XX(WWW_AUTHENTICATE, "WWW-Authenticate", Flag::Multi,                                                              \
 	   "Indicates HTTP authentication scheme(s) and applicable parameters")                                            \
 	XX(PROXY_AUTHENTICATE, "Proxy-Authenticate", Flag::Multi,                                                          \
@@ -123,6 +130,15 @@ public:
 
 	String toString(HttpHeaderFieldName name, const String& value) const;
 
+	/** @brief Print header line(s) for output in the HTTP header, as for `toString()`
+	 *  @param p Output destination
+	 *  @param name
+	 *  @param value
+	 *  @retval size_t Number of characters written
+	 *  @note Avoids creating temporary Strings so may be used to serialise headers without reallocation
+	 */
+	size_t printTo(Print& p, HttpHeaderFieldName name, const String& value) const;
+
 	/** @brief Find the enumerated value for the given field name string
 	 *  @param name
 	 *  @retval HttpHeaderFieldName field name code, HTTP_HEADER_UNKNOWN if not recognised
@@ -63,6 +63,7 @@ void HttpRequest::reset()
 	responseStream = nullptr;
 
 	postParams.clear();
+	pathParams.clear();
 	files.clear();
 	headers.clear();
 }
@@ -146,6 +146,17 @@ public:
 		return static_cast<const HttpParams&>(postParams)[name];
 	}
 
+	/**
+	 * @brief Get parameter captured from the request path
+	 * @param name Name of parameter, as given in the resource pattern, e.g. `id` for `/api/device/{id}`
+	 * @retval const String& Value, will be invalid (i.e. if() == false) if parameter not present
+	 * @see See `HttpRouter` for details of path matching
+	 */
+	const String& getPathParameter(const String& name) const
+	{
+		return pathParams[name];
+	}
+
 	/**
 	 * @brief Get parameter from query fields
 	 * @param name Name of parameter
@@ -283,6 +294,7 @@ public:
 	HttpMethod method = HTTP_GET; ///< Request method
 	HttpHeaders headers;		  ///< Request headers
 	HttpParams postParams;		  ///< POST parameters
+	HttpParams pathParams;		  ///< Parameters captured from path by HttpResourceTree
 	HttpFiles files;			  ///< Attached files
 
 	int retries = 0; ///< how many times the request should be send again...
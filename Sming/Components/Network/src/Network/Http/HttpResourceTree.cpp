@@ -53,3 +53,40 @@ HttpResource* HttpResourceTree::set(String path, const HttpPathDelegate& callbac
 	set(path, res);
 	return res;
 }
+
+HttpResource* HttpResourceTree::route(const String& path, HttpParams& params)
+{
+	auto resource = find(path);
+	if(resource != nullptr) {
+		return resource;
+	}
+
+	if(!routerValid) {
+		updateRouter();
+	}
+
+	if(!router.isEmpty()) {
+		auto pattern = router.match(path, params);
+		if(pattern != nullptr) {
+			resource = find(*pattern);
+			if(resource != nullptr) {
+				return resource;
+			}
+			params.clear();
+		}
+	}
+
+	return getDefault();
+}
+
+void HttpResourceTree::updateRouter()
+{
+	router.clear();
+	for(unsigned i = 0; i < count(); ++i) {
+		auto& path = keyAt(i);
+		if(path != RESOURCE_PATH_DEFAULT && HttpRouter::isPattern(path)) {
+			router.add(path);
+		}
+	}
+	routerValid = true;
+}
@@ -13,6 +13,7 @@
 #pragma once
 
 #include "HttpResource.h"
+#include "HttpRouter.h"
 
 using HttpPathDelegate = Delegate<void(HttpRequest& request, HttpResponse& response)>;
 
@@ -22,10 +23,24 @@ using HttpPathDelegate = Delegate<void(HttpRequest& request, HttpResponse& respo
 /**
  * @brief Class to map URL paths to classes which handle them
  * @ingroup httpserver
+ *
+ * Paths may be literal, such as `/api/status`, or patterns containing named parameters or a trailing wildcard,
+ * such as `/api/device/{id}` or `/static/\*`. See `HttpRouter` for details.
+ *
+ * Literal paths are located using a hash lookup. Patterns are matched using a radix tree which is
+ * rebuilt on first use after the set of paths changes.
+ *
+ * Entries may only be changed using the methods of this class, such as `set()` and `remove()`,
+ * so that the radix tree is kept consistent with the map. Lookups return the resource directly.
  */
 class HttpResourceTree : public ObjectMap<String, HttpResource>
 {
 public:
+	HttpResourceTree()
+	{
+		enableHashing();
+	}
+
 	/** @brief Set the default resource handler
 	 *  @param resource The default resource handler
 	 */
@@ -57,7 +72,94 @@ public:
 		return find(RESOURCE_PATH_DEFAULT);
 	}
 
-	using ObjectMap::set;
+	/**
+	 * @brief Locate the resource to handle a given path
+	 * @param path The request path
+	 * @param params Receives any parameters captured from the path
+	 * @retval HttpResource* The matching resource, the default resource, or nullptr
+	 *
+	 * An exact match for the path is preferred, then the best-matching pattern,
+	 * then the default resource.
+	 */
+	HttpResource* route(const String& path, HttpParams& params);
+
+	/**
+	 * @brief Set the resource handler for a path
+	 * @param path URL path or pattern
+	 * @param resource The handler, this map takes ownership
+	 */
+	void set(const String& path, HttpResource* resource)
+	{
+		ObjectMap::set(path, resource);
+		routerValid = false;
+	}
+
+	/**
+	 * @brief Remove the resource for a path
+	 * @param path
+	 * @retval bool true if the path was found and removed
+	 */
+	bool remove(const String& path)
+	{
+		routerValid = false;
+		return ObjectMap::remove(path);
+	}
+
+	void removeAt(unsigned index)
+	{
+		routerValid = false;
+		ObjectMap::removeAt(index);
+	}
+
+	/**
+	 * @brief Remove the resource for a path without destroying it
+	 * @param path
+	 * @retval HttpResource* Caller takes ownership
+	 */
+	HttpResource* extract(const String& path)
+	{
+		routerValid = false;
+		return ObjectMap::extract(path);
+	}
+
+	HttpResource* extractAt(unsigned index)
+	{
+		routerValid = false;
+		return ObjectMap::extractAt(index);
+	}
+
+	/**
+	 * @brief Remove all resources
+	 */
+	void clear()
+	{
+		routerValid = false;
+		ObjectMap::clear();
+	}
+
+	/**
+	 * @brief Get resource for a path, if it exists
+	 * @note Entries cannot be changed this way, use `set()` or `remove()`
+	 */
+	HttpResource* operator[](const String& path) const
+	{
+		return find(path);
+	}
+
+	HttpResource* get(const String& path) const
+	{
+		return find(path);
+	}
+
+	const String& keyAt(unsigned index) const
+	{
+		return ObjectMap::keyAt(index);
+	}
+
+	HttpResource* valueAt(unsigned index) const
+	{
+		return entries[index].value.get();
+	}
 
 	template <class... Tail>
 	HttpResource* set(const String& path, HttpResource* resource, HttpResourcePlugin* plugin, Tail... plugins)
@@ -136,5 +238,9 @@ private:
 		registerPlugin(plugins...);
 	}
 
+	void updateRouter();
+
 	HttpResourcePlugin::OwnedList loadedPlugins;
+	HttpRouter router;
+	bool routerValid{false};
 };
@@ -62,6 +62,23 @@ bool HttpResponse::sendString(String&& text) noexcept
 	return true;
 }
 
+namespace
+{
+/*
+ * Add validator and range support headers for a file.
+ * The ETag is generated later from the stream id.
+ */
+void setFileHeaders(HttpHeaders& headers, FileStream& file, FileStat& stat)
+{
+	file.stat(stat);
+	if(stat.mtime != 0 && !headers.contains(HTTP_HEADER_LAST_MODIFIED)) {
+		headers[HTTP_HEADER_LAST_MODIFIED] = DateTime(stat.mtime).toHTTPDate();
+	}
+	headers[HTTP_HEADER_ACCEPT_RANGES] = F("bytes");
+}
+
+} // namespace
+
 bool HttpResponse::sendFile(const String& fileName, bool allowGzipFileCheck)
 {
 	auto fs = new FileStream;
@@ -71,6 +88,8 @@ bool HttpResponse::sendFile(const String& fileName, bool allowGzipFileCheck)
 		if(fs->open(fnCompressed)) {
 			debug_d("found %s", fnCompressed.c_str());
 			headers[HTTP_HEADER_CONTENT_ENCODING] = F("gzip");
+			FileStat stat;
+			setFileHeaders(headers, *fs, stat);
 			return sendDataStream(fs, ContentType::fromFullFileName(fileName));
 		}
 	}
@@ -78,7 +97,7 @@ bool HttpResponse::sendFile(const String& fileName, bool allowGzipFileCheck)
 	if(fs->open(fileName)) {
 		debug_d("found %s", fileName.c_str());
 		FileStat stat;
-		fs->stat(stat);
+		setFileHeaders(headers, *fs, stat);
 		if(stat.compression.type == IFS::Compression::Type::GZip) {
 			headers[HTTP_HEADER_CONTENT_ENCODING] = F("gzip");
 		} else if(stat.compression.type != IFS::Compression::Type::None) {
@@ -127,6 +146,7 @@ void HttpResponse::reset()
 	code = HTTP_STATUS_OK;
 	headers.clear();
 	freeStreams();
+	compressionWindow = 0;
 }
 
 String HttpResponse::toString() const
@@ -16,6 +16,7 @@
 #include "Data/Stream/ReadWriteStream.h"
 #include "HttpHeaders.h"
 #include "FileSystem.h"
+#include "Data/Stream/DeflateOutputStream.h"
 
 /**
  * @brief Represents either an incoming or outgoing response to a HTTP request
@@ -55,6 +56,27 @@ public:
 
 	HttpResponse* setCache(int maxAgeSeconds = 3600, bool isPublic = false);
 
+	/**
+	 * @brief Compress response content if the client supports it
+	 * @param windowSize Compression history size, 0 to disable compression
+	 *
+	 * The server checks the request `Accept-Encoding` header and, if `gzip` or `deflate` is accepted,
+	 * compresses the body on the fly. Content-Length is then unknown so chunked transfer encoding is used.
+	 *
+	 * Content which already has a `Content-Encoding`, such as a pre-compressed `.gz` file, is sent unchanged.
+	 * Larger windows generally give better compression at the expense of RAM. See `DeflateOutputStream`.
+	 */
+	HttpResponse* setCompression(uint16_t windowSize = DEFLATE_WINDOW_SIZE)
+	{
+		compressionWindow = windowSize;
+		return this;
+	}
+
+	uint16_t getCompression() const
+	{
+		return compressionWindow;
+	}
+
 	// Access-Control-Allow-Origin for AJAX from a different domain
 	HttpResponse* setAllowCrossDomainOrigin(const String& controlAllowOrigin)
 	{
@@ -150,6 +172,9 @@ public:
 	HttpHeaders headers;				 ///< Response headers
 	ReadWriteStream* buffer = nullptr;   ///< Internal stream for storing strings and receiving responses
 	IDataSourceStream* stream = nullptr; ///< The body stream
+
+private:
+	uint16_t compressionWindow = 0;
 };
 
 inline String toString(const HttpResponse& res)
@@ -0,0 +1,178 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpRouter.cpp
+ *
+ ****/
+
+#include "HttpRouter.h"
+#include <debug_progmem.h>
+
+bool HttpRouter::isPattern(const String& path)
+{
+	return path.indexOf('{') >= 0 || path.endsWith("*");
+}
+
+HttpRouter::Node* HttpRouter::addChild(Node* node, Node::Kind kind, const String& text)
+{
+	for(auto& child : node->children) {
+		if(child.kind == kind && child.text == text) {
+			return &child;
+		}
+	}
+	auto child = new Node(kind, text);
+	node->children.add(child);
+	return child;
+}
+
+HttpRouter::Node* HttpRouter::addLiteral(Node* node, const char* text, unsigned length)
+{
+	while(length != 0) {
+		Node* next{nullptr};
+		for(auto& child : node->children) {
+			if(child.kind == Node::Kind::literal && child.text[0] == text[0]) {
+				next = &child;
+				break;
+			}
+		}
+
+		if(next == nullptr) {
+			return addChild(node, Node::Kind::literal, String(text, length));
+		}
+
+		// Find length of common prefix
+		unsigned common{1};
+		while(common < length && common < next->text.length() && next->text[common] == text[common]) {
+			++common;
+		}
+
+		// Split the edge so it ends at the common prefix
+		if(common < next->text.length()) {
+			auto tail = new Node(Node::Kind::literal, next->text.substring(common));
+			while(auto child = next->children.pop()) {
+				tail->children.add(child);
+			}
+			std::swap(tail->route, next->route);
+			next->text.setLength(common);
+			next->children.add(tail);
+		}
+
+		node = next;
+		text += common;
+		length -= common;
+	}
+
+	return node;
+}
+
+bool HttpRouter::add(const String& pattern)
+{
+	auto node = &root;
+	const char* p = pattern.c_str();
+	const char* end = p + pattern.length();
+	while(p < end) {
+		if(*p == '*') {
+			if(p + 1 != end) {
+				debug_e("[ROUTER] Wildcard must be at end of '%s'", pattern.c_str());
+				return false;
+			}
+			node = addChild(node, Node::Kind::wildcard, F("*"));
+			break;
+		}
+
+		if(*p == '{') {
+			auto close = static_cast<const char*>(memchr(p, '}', end - p));
+			// Parameter must end the path segment
+			if(close == nullptr || close == p + 1 || (close + 1 != end && close[1] != '/')) {
+				debug_e("[ROUTER] Bad parameter in '%s'", pattern.c_str());
+				return false;
+			}
+			node = addChild(node, Node::Kind::param, String(p + 1, close - p - 1));
+			p = close + 1;
+			continue;
+		}
+
+		auto literalEnd = p;
+		while(literalEnd < end && *literalEnd != '{' && *literalEnd != '*') {
+			++literalEnd;
+		}
+		node = addLiteral(node, p, literalEnd - p);
+		p = literalEnd;
+	}
+
+	node->route = pattern;
+	return true;
+}
+
+const String* HttpRouter::match(const Node& node, const char* path, MatchState& state)
+{
+	if(path == state.end && node.route) {
+		return &node.route;
+	}
+
+	// Literal text takes precedence: at most one child can match
+	for(auto& child : node.children) {
+		if(child.kind != Node::Kind::literal) {
+			continue;
+		}
+		auto len = child.text.length();
+		if(path + len <= state.end && child.text[0] == *path && memcmp(child.text.c_str(), path, len) == 0) {
+			auto route = match(child, path + len, state);
+			if(route != nullptr) {
+				return route;
+			}
+			break;
+		}
+	}
+
+	// Parameter consumes up to next path separator
+	auto segEnd = path;
+	while(segEnd < state.end && *segEnd != '/') {
+		++segEnd;
+	}
+	if(segEnd != path && state.captureCount < HTTP_ROUTER_MAX_PARAMS) {
+		for(auto& child : node.children) {
+			if(child.kind != Node::Kind::param) {
+				continue;
+			}
+			state.captures[state.captureCount++] = Capture{&child.text, path, unsigned(segEnd - path)};
+			auto route = match(child, segEnd, state);
+			if(route != nullptr) {
+				return route;
+			}
+			--state.captureCount;
+		}
+	}
+
+	// Wildcard matches everything else
+	if(state.captureCount < HTTP_ROUTER_MAX_PARAMS) {
+		for(auto& child : node.children) {
+			if(child.kind == Node::Kind::wildcard && child.route) {
+				state.captures[state.captureCount++] = Capture{&child.text, path, unsigned(state.end - path)};
+				return &child.route;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+const String* HttpRouter::match(const String& path, HttpParams& params) const
+{
+	MatchState state;
+	state.end = path.c_str() + path.length();
+	state.captureCount = 0;
+	auto route = match(root, path.c_str(), state);
+	if(route == nullptr) {
+		return nullptr;
+	}
+
+	for(unsigned i = 0; i < state.captureCount; ++i) {
+		auto& capture = state.captures[i];
+		params[*capture.name] = String(capture.value, capture.length);
+	}
+	return route;
+}
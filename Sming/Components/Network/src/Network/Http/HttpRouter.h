@@ -0,0 +1,118 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * HttpRouter.h
+ *
+ ****/
+
+#pragma once
+
+#include "HttpParams.h"
+#include <Data/LinkedObjectList.h>
+
+#ifndef HTTP_ROUTER_MAX_PARAMS
+/**
+ * @brief Maximum number of parameters which may be captured from a single path
+ */
+#define HTTP_ROUTER_MAX_PARAMS 8
+#endif
+
+/**
+ * @brief Radix tree to match URL paths against route patterns
+ * @ingroup httpserver
+ *
+ * Patterns may contain:
+ *
+ * - Literal text, e.g. `/api/status`
+ * - Named parameters, e.g. `/api/device/{id}/state`. A parameter matches the remainder of a path segment,
+ *   i.e. up to the next `/`, so must be followed by `/` or appear at the end of the pattern.
+ *   The matched text must not be empty.
+ * - A trailing wildcard, e.g. `/static/\*`, which matches the remainder of the path (possibly empty).
+ *   The matched text is captured as a parameter named `*`.
+ *
+ * Where multiple patterns match a path, literal text is preferred over parameters, and parameters over wildcards.
+ * The most specific wildcard is therefore used, giving longest-prefix matching.
+ *
+ * Matching is performed in a single pass over the path, with backtracking only where a literal or
+ * parameter branch fails to match.
+ */
+class HttpRouter
+{
+public:
+	/**
+	 * @brief Determine if a path contains any parameter or wildcard fields
+	 */
+	static bool isPattern(const String& path);
+
+	/**
+	 * @brief Add a route pattern
+	 * @param pattern
+	 * @retval bool false if the pattern is invalid
+	 */
+	bool add(const String& pattern);
+
+	/**
+	 * @brief Remove all routes
+	 */
+	void clear()
+	{
+		root.children.clear();
+		root.route = nullptr;
+	}
+
+	bool isEmpty() const
+	{
+		return root.children.isEmpty() && !root.route;
+	}
+
+	/**
+	 * @brief Find the best-matching route for a path
+	 * @param path The path to match
+	 * @param params On success, contains captured parameters
+	 * @retval const String* The matching pattern, nullptr if no match found
+	 */
+	const String* match(const String& path, HttpParams& params) const;
+
+private:
+	class Node : public LinkedObjectTemplate<Node>
+	{
+	public:
+		using OwnedList = OwnedLinkedObjectListTemplate<Node>;
+
+		enum class Kind {
+			literal,
+			param,
+			wildcard,
+		};
+
+		Node(Kind kind, const String& text) : kind(kind), text(text)
+		{
+		}
+
+		Kind kind;
+		String text; ///< Literal text or parameter name
+		String route;
+		OwnedList children;
+	};
+
+	struct Capture {
+		const String* name;
+		const char* value;
+		unsigned length;
+	};
+
+	struct MatchState {
+		const char* end;
+		Capture captures[HTTP_ROUTER_MAX_PARAMS];
+		unsigned captureCount;
+	};
+
+	Node* addLiteral(Node* node, const char* text, unsigned length);
+	Node* addChild(Node* node, Node::Kind kind, const String& text);
+	static const String* match(const Node& node, const char* path, MatchState& state);
+
+	Node root{Node::Kind::literal, nullptr};
+};
@@ -16,12 +16,130 @@
 #include "Network/TcpServer.h"
 #include <Data/WebConstants.h>
 #include "Data/Stream/ChunkedStream.h"
+#include <Data/Stream/LimitedReadStream.h>
 #include <SystemClock.h>
+#include <SplitString.h>
+#include <Data/Stream/MemoryDataStream.h>
+#include <Data/StringBuilder.h>
 
 #if HTTP_SERVER_EXPOSE_VERSION == 1
 #include <SmingVersion.h>
 #endif
 
+namespace
+{
+// Initial buffer size for status line and headers, sufficient for a typical response
+constexpr size_t headerBlockSize{256};
+
+/*
+ * Check whether an entity tag appears in a list such as that provided by `If-None-Match`.
+ * Weak comparison ignores any `W/` prefix; strong comparison fails if either tag is weak.
+ */
+bool matchETag(const String& list, const String& etag, bool weak)
+{
+	bool isWeak = etag.startsWith("W/");
+	if(isWeak && !weak) {
+		return false;
+	}
+	String tag = isWeak ? etag.substring(2) : etag;
+
+	Vector<String> tags;
+	splitString(list, ',', tags);
+	for(auto& s : tags) {
+		s.trim();
+		if(s == "*") {
+			return true;
+		}
+		if(s.startsWith("W/")) {
+			if(!weak) {
+				continue;
+			}
+			s = s.substring(2);
+		}
+		if(s == tag) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Add a request header field name to the `Vary` list, preserving any existing entries.
+ */
+void addVary(HttpHeaders& headers, HttpHeaderFieldName field)
+{
+	String name = headers.toString(field);
+	String& vary = headers[HTTP_HEADER_VARY];
+	if(!vary) {
+		vary = name;
+		return;
+	}
+
+	Vector<String> fields;
+	splitString(vary, ',', fields);
+	for(auto& s : fields) {
+		s.trim();
+		if(s == "*" || s.equalsIgnoreCase(name)) {
+			return;
+		}
+	}
+	vary += ", ";
+	vary += name;
+}
+
+bool parseNumber(const String& s, unsigned& value)
+{
+	if(s.length() == 0) {
+		return false;
+	}
+	for(auto c : s) {
+		if(!isdigit(c)) {
+			return false;
+		}
+	}
+	value = strtoul(s.c_str(), nullptr, 10);
+	return true;
+}
+
+struct ByteRange {
+	unsigned first;
+	unsigned last;
+	bool suffix; ///< If set, `last` is the number of bytes at end of content
+};
+
+bool parseByteRange(const String& value, ByteRange& range)
+{
+	// Only a single range is supported
+	if(!value.startsWith(F("bytes=")) || value.indexOf(',') >= 0) {
+		return false;
+	}
+	int sep = value.indexOf('-');
+	if(sep < 0) {
+		return false;
+	}
+	String first = value.substring(6, sep);
+	String last = value.substring(sep + 1);
+	first.trim();
+	last.trim();
+
+	// "bytes=-N" requests the final N bytes
+	range.suffix = (first.length() == 0);
+	if(range.suffix) {
+		range.first = 0;
+		return parseNumber(last, range.last);
+	}
+	if(!parseNumber(first, range.first)) {
+		return false;
+	}
+	if(last.length() == 0) {
+		range.last = UINT_MAX;
+		return true;
+	}
+	return parseNumber(last, range.last) && range.last >= range.first;
+}
+
+} // namespace
+
 int HttpServerConnection::onMessageBegin(http_parser* parser)
 {
 	// Reset Response ...
@@ -49,10 +167,7 @@ int HttpServerConnection::onPath(const Url& uri)
 
 	request.setURL(uri);
 
-	resource = resourceTree->find(request.uri.Path);
-	if(resource == nullptr) {
-		resource = resourceTree->getDefault();
-	}
+	resource = resourceTree->route(request.uri.Path, request.pathParams);
 
 	return resource ? resource->handleUrl(*this, request, response) : 0;
 }
@@ -268,27 +383,24 @@ void HttpServerConnection::sendResponseHeaders(HttpResponse* response)
 		}
 	}
 
-	if(request.headers.contains(HTTP_HEADER_IF_MATCH) && response->headers.contains(HTTP_HEADER_ETAG) &&
-	   request.headers[HTTP_HEADER_IF_MATCH] == response->headers[HTTP_HEADER_ETAG]) {
-		if(request.method == HTTP_GET || request.method == HTTP_HEAD) {
-			response->code = HTTP_STATUS_NOT_MODIFIED;
-			response->headers[HTTP_HEADER_CONTENT_LENGTH] = "0";
-			delete response->stream;
-			response->stream = nullptr;
-		}
-	}
 #endif /* DISABLE_HTTPSRV_ETAG */
 
-	String statusLine = F("HTTP/1.1 ");
-	statusLine += unsigned(response->code);
-	statusLine += ' ';
-	statusLine += toString(response->code);
-	statusLine += "\r\n";
-	sendString(statusLine);
+	if(isNotModified(response)) {
+		response->code = HTTP_STATUS_NOT_MODIFIED;
+		response->freeStreams();
+		response->headers.remove(HTTP_HEADER_CONTENT_LENGTH);
+		response->headers.remove(HTTP_HEADER_TRANSFER_ENCODING);
+	} else {
+		applyRange(response);
+	}
+
+	compressResponse(response);
+
 	if(response->stream != nullptr && response->stream->available() >= 0) {
 		response->headers[HTTP_HEADER_CONTENT_LENGTH] = String(response->stream->available());
 	}
-	if(!response->headers.contains(HTTP_HEADER_CONTENT_LENGTH) && response->stream == nullptr) {
+	if(!response->headers.contains(HTTP_HEADER_CONTENT_LENGTH) && response->stream == nullptr &&
+	   response->code != HTTP_STATUS_NOT_MODIFIED) {
 		response->headers[HTTP_HEADER_CONTENT_LENGTH] = "0";
 	}
 
@@ -315,10 +427,176 @@ void HttpServerConnection::sendResponseHeaders(HttpResponse* response)
 		response->headers[HTTP_HEADER_DATE] = DateTime(SystemClock.now(eTZ_UTC)).toHTTPDate();
 	}
 
-	for(auto hdr : response->headers) {
-		sendString(hdr);
+	// Serialise status line and headers into a single block
+	StringBuilder sb(headerBlockSize);
+	sb << _F("HTTP/1.1 ") << unsigned(response->code) << ' ' << toString(response->code) << "\r\n";
+	auto& headers = response->headers;
+	for(auto hdr : headers) {
+		headers.printTo(sb, hdr.key(), hdr.value());
+	}
+	sb << "\r\n";
+	send(new MemoryDataStream(sb.moveString()));
+}
+
+bool HttpServerConnection::isNotModified(HttpResponse* response)
+{
+	if(response->code != HTTP_STATUS_OK || (request.method != HTTP_GET && request.method != HTTP_HEAD)) {
+		return false;
+	}
+
+	// If-None-Match takes precedence, If-Modified-Since is ignored when present
+	if(request.headers.contains(HTTP_HEADER_IF_NONE_MATCH)) {
+		return response->headers.contains(HTTP_HEADER_ETAG) &&
+			   matchETag(request.headers[HTTP_HEADER_IF_NONE_MATCH], response->headers[HTTP_HEADER_ETAG], true);
+	}
+
+	if(!request.headers.contains(HTTP_HEADER_IF_MODIFIED_SINCE) ||
+	   !response->headers.contains(HTTP_HEADER_LAST_MODIFIED)) {
+		return false;
+	}
+	time_t since;
+	time_t modified;
+	return DateTime::fromHttpDate(request.headers[HTTP_HEADER_IF_MODIFIED_SINCE], since) &&
+		   DateTime::fromHttpDate(response->headers[HTTP_HEADER_LAST_MODIFIED], modified) && modified <= since;
+}
+
+void HttpServerConnection::applyRange(HttpResponse* response)
+{
+	if(response->code != HTTP_STATUS_OK || request.method != HTTP_GET || response->stream == nullptr ||
+	   !request.headers.contains(HTTP_HEADER_RANGE) || !response->headers.contains(HTTP_HEADER_ACCEPT_RANGES) ||
+	   response->headers[HTTP_HEADER_ACCEPT_RANGES] != F("bytes")) {
+		return;
+	}
+
+	// If-Range requires an exact match, otherwise the full content is sent
+	if(request.headers.contains(HTTP_HEADER_IF_RANGE)) {
+		auto& condition = request.headers[HTTP_HEADER_IF_RANGE];
+		if(condition.startsWith("\"") || condition.startsWith("W/")) {
+			if(!response->headers.contains(HTTP_HEADER_ETAG) ||
+			   !matchETag(condition, response->headers[HTTP_HEADER_ETAG], false)) {
+				return;
+			}
+		} else if(!response->headers.contains(HTTP_HEADER_LAST_MODIFIED) ||
+				  condition != response->headers[HTTP_HEADER_LAST_MODIFIED]) {
+			return;
+		}
+	}
+
+	int size = response->stream->available();
+	ByteRange range;
+	if(size < 0 || !parseByteRange(request.headers[HTTP_HEADER_RANGE], range)) {
+		// Unsupported or invalid, so send full content
+		return;
+	}
+
+	String contentRange = F("bytes ");
+	if(range.suffix) {
+		range.first = (range.last < unsigned(size)) ? size - range.last : 0;
+		range.last = size - 1;
+	} else if(range.last >= unsigned(size)) {
+		range.last = size - 1;
+	}
+	if(range.first >= unsigned(size) || range.first > range.last) {
+		response->code = HTTP_STATUS_RANGE_NOT_SATISFIABLE;
+		response->freeStreams();
+		response->headers.remove(HTTP_HEADER_TRANSFER_ENCODING);
+		contentRange += "*/";
+		contentRange += size;
+		response->headers[HTTP_HEADER_CONTENT_RANGE] = contentRange;
+		return;
+	}
+
+	auto stream = new LimitedReadStream(response->stream, range.first, range.last + 1 - range.first);
+	if(response->buffer == response->stream) {
+		// Now owned by range stream
+		response->buffer = nullptr;
+	}
+	response->stream = stream;
+	if(!stream->isValid()) {
+		debug_e("[HTTP] Range seek failed");
+		response->code = HTTP_STATUS_INTERNAL_SERVER_ERROR;
+		response->freeStreams();
+		return;
+	}
+
+	response->code = HTTP_STATUS_PARTIAL_CONTENT;
+	contentRange += range.first;
+	contentRange += '-';
+	contentRange += range.last;
+	contentRange += '/';
+	contentRange += size;
+	response->headers[HTTP_HEADER_CONTENT_RANGE] = contentRange;
+}
+
+void HttpServerConnection::compressResponse(HttpResponse* response)
+{
+	auto windowSize = response->getCompression();
+	if(windowSize == 0 || response->stream == nullptr || response->code == HTTP_STATUS_PARTIAL_CONTENT ||
+	   response->headers.contains(HTTP_HEADER_CONTENT_ENCODING)) {
+		return;
+	}
+
+	addVary(response->headers, HTTP_HEADER_ACCEPT_ENCODING);
+
+	// Select gzip in preference to deflate, ignoring any which are explicitly refused (q=0)
+	bool gzip{false};
+	bool deflate{false};
+	String accept = request.headers[HTTP_HEADER_ACCEPT_ENCODING];
+	Vector<String> codings;
+	splitString(accept, ',', codings);
+	for(auto& s : codings) {
+		s.toLowerCase();
+		int i = s.indexOf(';');
+		if(i >= 0) {
+			String params = s.substring(i + 1);
+			params.replace(" ", "");
+			if(params.startsWith(F("q=0")) && !params.startsWith(F("q=0."))) {
+				continue;
+			}
+			s.setLength(i);
+		}
+		s.trim();
+		if(s == F("gzip")) {
+			gzip = true;
+		} else if(s == F("deflate")) {
+			deflate = true;
+		}
+	}
+	if(!gzip && !deflate) {
+		return;
+	}
+
+	using Format = DeflateOutputStream::Format;
+	auto format = gzip ? Format::gzip : Format::zlib;
+	auto stream = new DeflateOutputStream(response->stream, format, windowSize);
+	if(response->buffer == response->stream) {
+		// Now owned by compression stream
+		response->buffer = nullptr;
+	}
+	response->stream = stream;
+	if(!stream->isValid()) {
+		debug_e("[HTTP] Compression failed");
+		response->code = HTTP_STATUS_INTERNAL_SERVER_ERROR;
+		delete stream;
+		response->stream = nullptr;
+		return;
+	}
+
+	response->headers[HTTP_HEADER_CONTENT_ENCODING] = gzip ? F("gzip") : F("deflate");
+	response->headers.remove(HTTP_HEADER_CONTENT_LENGTH);
+	response->headers[HTTP_HEADER_TRANSFER_ENCODING] = F("chunked");
+	// Ranges would apply to the compressed output, which is not seekable
+	response->headers.remove(HTTP_HEADER_ACCEPT_RANGES);
+
+	// A strong validator must change with the content coding
+	if(response->headers.contains(HTTP_HEADER_ETAG)) {
+		String& tag = response->headers[HTTP_HEADER_ETAG];
+		if(!tag.startsWith("W/")) {
+			String weak = F("W/");
+			weak += tag;
+			tag = weak;
+		}
 	}
-	sendString("\r\n");
 }
 
 bool HttpServerConnection::sendResponseBody(HttpResponse* response)
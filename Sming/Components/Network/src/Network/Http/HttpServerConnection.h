@@ -116,6 +116,9 @@ protected:
 
 private:
 	void sendResponseHeaders(HttpResponse* response);
+	bool isNotModified(HttpResponse* response);
+	void applyRange(HttpResponse* response);
+	void compressResponse(HttpResponse* response);
 	bool sendResponseBody(HttpResponse* response);
 
 public:
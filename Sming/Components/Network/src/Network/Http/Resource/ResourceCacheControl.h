@@ -0,0 +1,53 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * ResourceCacheControl.h
+ *
+ ****/
+
+#pragma once
+
+#include "HttpResourcePlugin.h"
+
+/**
+ * @brief Apply a Cache-Control policy to successful responses for a resource
+ *
+ * Responses which already have a `Cache-Control` header are left unchanged,
+ * so request handlers can still override the policy.
+ *
+ * For example, to allow browsers to cache static content for a day:
+ *
+ * ```
+ * server.paths.set(RESOURCE_PATH_DEFAULT, onFile, new ResourceCacheControl(86400, true));
+ * ```
+ *
+ * Clients revalidate using the `ETag` and `Last-Modified` headers once content expires.
+ */
+class ResourceCacheControl : public HttpPostFilter
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param maxAgeSeconds How long the response may be cached without revalidation.
+	 * Use 0 to require revalidation on every request.
+	 * @param isPublic true to allow shared caches, false if content is specific to the user
+	 */
+	ResourceCacheControl(int maxAgeSeconds, bool isPublic = false) : maxAge(maxAgeSeconds), isPublic(isPublic)
+	{
+	}
+
+	bool requestComplete(HttpServerConnection&, HttpRequest&, HttpResponse& response) override
+	{
+		if(response.isSuccess() && !response.headers.contains(HTTP_HEADER_CACHE_CONTROL)) {
+			response.setCache(maxAge, isPublic);
+		}
+		return true;
+	}
+
+private:
+	int maxAge;
+	bool isPublic;
+};
@@ -13,7 +13,6 @@
 #include <Data/WebHelpers/base64.h>
 #include <Data/Stream/MemoryDataStream.h>
 #include <Data/Stream/XorOutputStream.h>
-#include <Data/Stream/SharedMemoryStream.h>
 
 DEFINE_FSTR(WSSTR_UPGRADE, "upgrade")
 DEFINE_FSTR(WSSTR_WEBSOCKET, "websocket")
@@ -244,36 +243,13 @@ bool WebsocketConnection::send(IDataSourceStream* source, ws_frame_type_t type,
 	debug_d("WS: Sending %d bytes, type %d", available, type);
 
 	// Construct packet
-	uint8_t packet[16]{};
-	unsigned len = 0;
-	if(isFin) {
-		packet[len] |= _BV(7); // set Fin
-	}
-	packet[len++] |= type; // set opcode
+	uint8_t packet[WebsocketFrame::maxHeaderSize];
+	uint8_t maskKey[4];
 	if(useMask) {
-		packet[len] |= _BV(7); // set mask
-	}
-	// length
-	if(available <= 125) {
-		packet[len++] |= available;
-	} else if(available <= 0xffff) {
-		packet[len++] |= 126;
-		packet[len++] = available >> 8;
-		packet[len++] = available;
-	} else {
-		packet[len++] |= 127;
-		len += 4; // All 0
-		packet[len++] = available >> 24;
-		packet[len++] = available >> 16;
-		packet[len++] = available >> 8;
-		packet[len++] = available;
+		os_get_random(maskKey, sizeof(maskKey));
 	}
+	unsigned len = WebsocketFrame::encodeHeader(packet, available, type, isFin, useMask ? maskKey : nullptr);
 	if(useMask) {
-		uint8_t maskKey[4];
-		os_get_random(maskKey, sizeof(maskKey));
-		memcpy(&packet[len], maskKey, sizeof(maskKey));
-		len += sizeof(maskKey);
-
 		auto xorStream = new XorOutputStream(source, maskKey, sizeof(maskKey));
 		if(xorStream == nullptr) {
 			return false;
@@ -295,18 +271,45 @@ bool WebsocketConnection::send(IDataSourceStream* source, ws_frame_type_t type,
 	return true;
 }
 
-void WebsocketConnection::broadcast(const char* message, size_t length, ws_frame_type_t type)
+bool WebsocketConnection::send(const WebsocketFrame& frame)
 {
-	std::shared_ptr<char[]> data(new char[length]);
-	if(!data) {
-		return;
+	if(isClientConnection) {
+		return send(frame.getPayload(), frame.getPayloadLength(), frame.getType());
+	}
+
+	if(connection == nullptr || !activated) {
+		return false;
+	}
+
+	if(!connection->send(frame.createStream())) {
+		return false;
 	}
-	memcpy(data.get(), message, length);
+	connection->commit();
+	return true;
+}
 
+unsigned WebsocketConnection::broadcast(const WebsocketFrame& frame, const String& topic, size_t maxPending)
+{
+	if(!frame) {
+		debug_e("WS: Invalid broadcast frame");
+		return 0;
+	}
+
+	unsigned count{0};
 	for(auto skt : websocketList) {
-		auto stream = new SharedMemoryStream<const char[]>(data, length);
-		skt->send(stream, type);
+		if(topic && !skt->isSubscribed(topic)) {
+			continue;
+		}
+		if(maxPending != 0 && skt->getPendingBytes() > maxPending) {
+			++skt->skippedCount;
+			continue;
+		}
+		if(skt->send(frame)) {
+			++count;
+		}
 	}
+
+	return count;
 }
 
 void WebsocketConnection::close()
@@ -12,10 +12,7 @@
 
 #include "Network/TcpServer.h"
 #include "../HttpConnection.h"
-
-extern "C" {
-#include "ws_parser/ws_parser.h"
-}
+#include "WebsocketFrame.h"
 
 /** @defgroup   websocket Websocket connection
  *  @brief      Provides websocket connection (server and client)
@@ -105,13 +102,25 @@ public:
 	 */
 	bool send(IDataSourceStream* source, ws_frame_type_t type = WS_FRAME_TEXT, bool useMask = false, bool isFin = true);
 
+	/**
+	 * @brief Sends a pre-built frame
+	 * @param frame
+	 * @retval bool true on success
+	 * @note For server connections the frame is sent by reference without copying.
+	 * Client connections require masking so the payload is copied.
+	 */
+	bool send(const WebsocketFrame& frame);
+
 	/**
 	 * @brief Broadcasts a message to all active websocket connections
 	 * @param message
 	 * @param length
 	 * @param type
 	 */
-	static void broadcast(const char* message, size_t length, ws_frame_type_t type = WS_FRAME_TEXT);
+	static void broadcast(const char* message, size_t length, ws_frame_type_t type = WS_FRAME_TEXT)
+	{
+		broadcast(WebsocketFrame(message, length, type));
+	}
 
 	/**
 	 * @brief Broadcasts a message to all active websocket connections
@@ -123,6 +132,64 @@ public:
 		broadcast(message.c_str(), message.length(), type);
 	}
 
+	/**
+	 * @brief Broadcasts a pre-built frame to active websocket connections
+	 * @param frame The frame to send. This is encoded once and shared between all connections.
+	 * @param topic If specified, only connections subscribed to this topic receive the frame
+	 * @param maxPending If non-zero, connections with more than this amount of outgoing data
+	 * pending are skipped. See `getPendingBytes()` and `getSkippedCount()`.
+	 * @retval unsigned Number of connections to which the frame was sent
+	 */
+	static unsigned broadcast(const WebsocketFrame& frame, const String& topic = nullptr, size_t maxPending = 0);
+
+	/**
+	 * @brief Subscribe this connection to a broadcast topic
+	 * @param topic
+	 */
+	void subscribe(const String& topic)
+	{
+		if(!topics.contains(topic)) {
+			topics.add(topic);
+		}
+	}
+
+	/**
+	 * @brief Unsubscribe this connection from a broadcast topic
+	 * @param topic
+	 */
+	void unsubscribe(const String& topic)
+	{
+		topics.removeElement(topic);
+	}
+
+	/**
+	 * @brief Determine if this connection is subscribed to a broadcast topic
+	 * @param topic
+	 */
+	bool isSubscribed(const String& topic) const
+	{
+		return topics.contains(topic);
+	}
+
+	/**
+	 * @brief Get amount of outgoing data not yet acknowledged by the remote end
+	 * @retval size_t Number of bytes
+	 * @note A connection where this value keeps growing has a slow or stalled client
+	 */
+	size_t getPendingBytes() const
+	{
+		return connection ? connection->getPendingBytes() : 0;
+	}
+
+	/**
+	 * @brief Get number of broadcast frames not sent to this connection due to backpressure
+	 * @note Applications may use this to identify and close slow connections.
+	 */
+	unsigned getSkippedCount() const
+	{
+		return skippedCount;
+	}
+
 	/**
 	 * @brief Sends a string websocket message
 	 * @param message
@@ -306,6 +373,8 @@ private:
 	static WebsocketList websocketList;
 
 	HttpConnection* connection = nullptr;
+	Vector<String> topics;
+	unsigned skippedCount{0};
 	bool isClientConnection;
 	bool activated = false;
 };
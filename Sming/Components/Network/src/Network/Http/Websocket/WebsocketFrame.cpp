@@ -0,0 +1,68 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * WebsocketFrame.cpp
+ *
+ ****/
+
+#include "WebsocketFrame.h"
+#include <Data/Stream/SharedMemoryStream.h>
+
+WebsocketFrame::WebsocketFrame(const char* payload, size_t length, ws_frame_type_t type)
+	: payloadLength(length), type(type)
+{
+	uint8_t header[maxHeaderSize];
+	headerLength = encodeHeader(header, length, type);
+
+	data.reset(new char[headerLength + length]);
+	if(!data) {
+		return;
+	}
+	memcpy(data.get(), header, headerLength);
+	memcpy(&data[headerLength], payload, length);
+}
+
+IDataSourceStream* WebsocketFrame::createStream() const
+{
+	if(!data) {
+		return nullptr;
+	}
+	return new SharedMemoryStream<const char[]>(data, getSize());
+}
+
+size_t WebsocketFrame::encodeHeader(uint8_t* header, size_t payloadLength, ws_frame_type_t type, bool isFin,
+									const uint8_t* maskKey)
+{
+	memset(header, 0, maxHeaderSize);
+	unsigned len = 0;
+	if(isFin) {
+		header[len] |= _BV(7); // set Fin
+	}
+	header[len++] |= type; // set opcode
+	if(maskKey != nullptr) {
+		header[len] |= _BV(7); // set mask
+	}
+	// length
+	if(payloadLength <= 125) {
+		header[len++] |= payloadLength;
+	} else if(payloadLength <= 0xffff) {
+		header[len++] |= 126;
+		header[len++] = payloadLength >> 8;
+		header[len++] = payloadLength;
+	} else {
+		header[len++] |= 127;
+		len += 4; // All 0
+		header[len++] = payloadLength >> 24;
+		header[len++] = payloadLength >> 16;
+		header[len++] = payloadLength >> 8;
+		header[len++] = payloadLength;
+	}
+	if(maskKey != nullptr) {
+		memcpy(&header[len], maskKey, 4);
+		len += 4;
+	}
+	return len;
+}
@@ -0,0 +1,108 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * WebsocketFrame.h
+ *
+ ****/
+
+#pragma once
+
+#include <Data/Stream/DataSourceStream.h>
+#include <memory>
+
+extern "C" {
+#include "ws_parser/ws_parser.h"
+}
+
+/**
+ * @brief A complete, unmasked websocket frame which may be sent to multiple connections
+ * @ingroup websocket
+ *
+ * The frame header and payload are encoded once into a single reference-counted buffer.
+ * Each connection sends the frame using a stream referencing that buffer,
+ * so there is no per-connection copying or framing.
+ *
+ * Frames are unmasked so may only be sent by servers.
+ */
+class WebsocketFrame
+{
+public:
+	/**
+	 * @brief Maximum size of a frame header
+	 */
+	static constexpr size_t maxHeaderSize{14};
+
+	/**
+	 * @brief Construct a frame
+	 * @param payload
+	 * @param length Size of payload
+	 * @param type
+	 * @note Check `isValid()` to determine if memory allocation succeeded
+	 */
+	WebsocketFrame(const char* payload, size_t length, ws_frame_type_t type = WS_FRAME_TEXT);
+
+	explicit WebsocketFrame(const String& payload, ws_frame_type_t type = WS_FRAME_TEXT)
+		: WebsocketFrame(payload.c_str(), payload.length(), type)
+	{
+	}
+
+	bool isValid() const
+	{
+		return bool(data);
+	}
+
+	explicit operator bool() const
+	{
+		return isValid();
+	}
+
+	ws_frame_type_t getType() const
+	{
+		return type;
+	}
+
+	/**
+	 * @brief Get total size of frame, including header
+	 */
+	size_t getSize() const
+	{
+		return headerLength + payloadLength;
+	}
+
+	const char* getPayload() const
+	{
+		return data ? &data[headerLength] : nullptr;
+	}
+
+	size_t getPayloadLength() const
+	{
+		return payloadLength;
+	}
+
+	/**
+	 * @brief Create a stream for sending the complete frame
+	 * @retval IDataSourceStream* Caller takes ownership. nullptr if frame is invalid.
+	 */
+	IDataSourceStream* createStream() const;
+
+	/**
+	 * @brief Encode a frame header
+	 * @param header Buffer of at least `maxHeaderSize` bytes
+	 * @param payloadLength
+	 * @param type
+	 * @param isFin true if this is the final frame
+	 * @param maskKey 4-byte masking key, nullptr for an unmasked frame
+	 * @retval size_t Number of bytes written to header
+	 */
+	static size_t encodeHeader(uint8_t* header, size_t payloadLength, ws_frame_type_t type, bool isFin = true,
+							   const uint8_t* maskKey = nullptr);
+
+private:
+	std::shared_ptr<char[]> data;
+	size_t payloadLength;
+	uint8_t headerLength{0};
+	ws_frame_type_t type;
+};
@@ -10,6 +10,7 @@
 
 #include "MqttClient.h"
 #include <Data/Stream/DataSourceStream.h>
+#include <FileSystem.h>
 
 const mqtt_parser_callbacks_t MqttClient::callbacks PROGMEM = {
 	.on_message_begin = staticOnMessageBegin,
@@ -42,7 +43,7 @@ mqtt_message_t* createMessage(mqtt_type_t messageType)
 	return message;
 }
 
-void deleteMessage(mqtt_message_t* message)
+void destroyMessage(mqtt_message_t* message)
 {
 	mqtt_message_clear(message, 0);
 	delete message;
@@ -93,14 +94,232 @@ MqttClient::~MqttClient()
 		deleteMessage(requestQueue.dequeue());
 	}
 
-	clearMessage(connectMessage);
-	if(outgoingMessage != &connectMessage) {
-		deleteMessage(outgoingMessage);
+	for(auto& entry : inFlight) {
+		deleteMessage(entry.message);
 	}
+
+	clearMessage(connectMessage);
+	deleteMessage(outgoingMessage);
 	outgoingMessage = nullptr;
 	clearMessage(incomingMessage);
 }
 
+mqtt_message_t* MqttClient::createPublishMessage(const String& topic, uint8_t flags)
+{
+	auto message = createMessage(MQTT_TYPE_PUBLISH);
+	if(message == nullptr) {
+		return nullptr;
+	}
+
+	message->common.retain = static_cast<mqtt_retain_t>((flags >> 0) & 0x01);
+	message->common.qos = static_cast<mqtt_qos_t>((flags >> 1) & 0x03);
+	message->common.dup = static_cast<mqtt_dup_t>((flags >> 3) & 0x01);
+
+	// Topic storage is shared, so must be released before message is cleared
+	auto name = topicPool.intern(topic);
+	if(name == nullptr) {
+		debug_e("Not enough memory");
+		destroyMessage(message);
+		return nullptr;
+	}
+	message->publish.topic_name.data = reinterpret_cast<uint8_t*>(const_cast<char*>(name->c_str()));
+	message->publish.topic_name.length = name->length();
+
+	return message;
+}
+
+void MqttClient::deleteMessage(mqtt_message_t* message)
+{
+	if(message == nullptr || message == &connectMessage) {
+		return;
+	}
+
+	if(message->common.type == MQTT_TYPE_PUBLISH) {
+		auto& publish = message->publish;
+		if(topicPool.release(publish.topic_name.data)) {
+			publish.topic_name.data = nullptr;
+		}
+		if(publish.content.length == MQTT_PUBLISH_STREAM) {
+			// Stream not yet sent
+			delete reinterpret_cast<IDataSourceStream*>(publish.content.data);
+			publish.content.data = nullptr;
+		}
+	}
+
+	destroyMessage(message);
+}
+
+bool MqttClient::enqueue(mqtt_message_t* message)
+{
+	if(requestQueue.enqueue(message)) {
+		return true;
+	}
+
+	deleteMessage(message);
+	return false;
+}
+
+bool MqttClient::setMessageStore(const String& fileName, IFS::FileSystem* fileSystem)
+{
+	if(!fileName) {
+		messageStore.reset();
+		return true;
+	}
+
+	if(fileSystem == nullptr) {
+		fileSystem = ::getFileSystem();
+		if(fileSystem == nullptr) {
+			debug_e("[MQTT] No filesystem for message store");
+			return false;
+		}
+	}
+
+	messageStore.reset(new MqttMessageStore(fileSystem, fileName));
+	return true;
+}
+
+void MqttClient::loadStoredMessages()
+{
+	if(!messageStore) {
+		return;
+	}
+
+	String topic;
+	String content;
+	uint8_t flags;
+	while(!requestQueue.full() && messageStore->pop(topic, content, flags)) {
+		auto message = createPublishMessage(topic, flags);
+		if(message == nullptr || (content && !copyString(message->publish.content, content))) {
+			deleteMessage(message);
+			break;
+		}
+		requestQueue.enqueue(message);
+	}
+}
+
+unsigned MqttClient::getInFlightCount() const
+{
+	unsigned count{0};
+	for(auto& entry : inFlight) {
+		if(entry.id != 0) {
+			++count;
+		}
+	}
+	return count;
+}
+
+MqttClient::InFlight* MqttClient::findInFlight(uint16_t id)
+{
+	for(auto& entry : inFlight) {
+		if(entry.id == id) {
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+void MqttClient::removeInFlight(InFlight& entry)
+{
+	deleteMessage(entry.message);
+	entry = InFlight{};
+}
+
+uint16_t MqttClient::getNextMessageId()
+{
+	// Message ID 0 is reserved
+	do {
+		++lastMessageId;
+	} while(lastMessageId == 0 || findInFlight(lastMessageId) != nullptr);
+	return lastMessageId;
+}
+
+void MqttClient::handleAcknowledgement(mqtt_message_t* message)
+{
+	switch(message->common.type) {
+	case MQTT_TYPE_CONNACK:
+		// Re-send anything not yet acknowledged
+		for(auto& entry : inFlight) {
+			if(entry.id != 0) {
+				entry.pending = true;
+			}
+		}
+		break;
+
+	case MQTT_TYPE_PUBACK: {
+		auto entry = findInFlight(message->puback.message_id);
+		if(entry != nullptr && entry->qos == MQTT_QOS_AT_LEAST_ONCE) {
+			removeInFlight(*entry);
+		}
+		break;
+	}
+
+	case MQTT_TYPE_PUBREC: {
+		auto entry = findInFlight(message->pubrec.message_id);
+		if(entry != nullptr && entry->qos == MQTT_QOS_EXACTLY_ONCE) {
+			// Message content no longer required, just need to complete the exchange
+			deleteMessage(entry->message);
+			entry->message = nullptr;
+			entry->released = true;
+			entry->pending = true;
+		}
+		break;
+	}
+
+	case MQTT_TYPE_PUBCOMP: {
+		auto entry = findInFlight(message->pubcomp.message_id);
+		if(entry != nullptr && entry->released) {
+			removeInFlight(*entry);
+		}
+		break;
+	}
+
+	default:;
+	}
+}
+
+mqtt_message_t* MqttClient::getNextMessage()
+{
+	if(connectQueued) {
+		connectQueued = false;
+		return &connectMessage;
+	}
+
+	if(bitsSet(flags, MQTT_CLIENT_CONNECTED)) {
+		// Re-send unacknowledged messages
+		auto now = millis();
+		for(auto& entry : inFlight) {
+			if(entry.id == 0) {
+				continue;
+			}
+			if(!entry.pending && (retransmitTimeout == 0 || now - entry.sentTime < retransmitTimeout * 1000U)) {
+				continue;
+			}
+			if(entry.released) {
+				auto message = createMessage(MQTT_TYPE_PUBREL);
+				if(message != nullptr) {
+					message->common.qos = MQTT_QOS_AT_LEAST_ONCE; // Fixed header flags must be 0b0010
+					message->pubrel.message_id = entry.id;
+				}
+				return message;
+			}
+			debug_d("[MQTT] Re-sending message #%u", entry.id);
+			entry.message->common.dup = MQTT_DUP_TRUE;
+			return entry.message;
+		}
+
+		loadStoredMessages();
+	}
+
+	auto message = requestQueue.peek();
+	if(message != nullptr && message->common.type == MQTT_TYPE_PUBLISH &&
+	   message->common.qos != MQTT_QOS_AT_MOST_ONCE && getInFlightCount() >= inFlightWindow) {
+		// Wait for acknowledgements
+		return nullptr;
+	}
+
+	return requestQueue.dequeue();
+}
+
 bool MqttClient::onTcpReceive(TcpClient&, char* data, int size)
 {
 	pingTimer.start();
@@ -173,6 +392,8 @@ int MqttClient::onMessageEnd(mqtt_message_t* message)
 		}
 	}
 
+	handleAcknowledgement(message);
+
 	auto& handler = static_cast<const HandlerMap&>(eventHandlers)[message->common.type];
 	if(handler) {
 		return handler(*this, message);
@@ -248,22 +469,29 @@ bool MqttClient::connect(const Url& url, const String& clientName)
 
 bool MqttClient::publish(const String& topic, const String& content, uint8_t flags)
 {
+	if(messageStore) {
+		// Preserve ordering with messages already stored
+		if(!bitsSet(this->flags, MQTT_CLIENT_CONNECTED) || requestQueue.full() || !messageStore->isEmpty()) {
+			return messageStore->push(topic, content, flags);
+		}
+	}
+
 	if(requestQueue.full()) {
 		return false;
 	}
 
-	auto message = createMessage(MQTT_TYPE_PUBLISH);
-
-	message->common.retain = static_cast<mqtt_retain_t>((flags >> 0) & 0x01);
-	message->common.qos = static_cast<mqtt_qos_t>((flags >> 1) & 0x03);
-	message->common.dup = static_cast<mqtt_dup_t>((flags >> 3) & 0x01);
+	auto message = createPublishMessage(topic, flags);
+	if(message == nullptr) {
+		return false;
+	}
 
-	if(!copyString(message->publish.topic_name, topic) || !copyString(message->publish.content, content)) {
-		delete message;
+	// Empty content is left unallocated so it isn't mistaken for a stream
+	if(content && !copyString(message->publish.content, content)) {
+		deleteMessage(message);
 		return false;
 	}
 
-	bool success = requestQueue.enqueue(message);
+	bool success = enqueue(message);
 	if(success) {
 		// Try to force-send message to decrease latency.
 		// Should work for small size messages but there is no guarantee.
@@ -280,18 +508,20 @@ bool MqttClient::publish(const String& topic, IDataSourceStream* stream, uint8_t
 		return false;
 	}
 
-	if(requestQueue.full()) {
+	if(((flags >> 1) & 0x03) != MQTT_QOS_AT_MOST_ONCE) {
+		// Stream content is consumed as it's sent so cannot be re-sent if not acknowledged
+		debug_e("[MQTT] Stream content can only be published with QoS 0");
+		delete stream;
 		return false;
 	}
 
-	auto message = createMessage(MQTT_TYPE_PUBLISH);
-
-	message->common.retain = static_cast<mqtt_retain_t>((flags >> 0) & 0x01);
-	message->common.qos = static_cast<mqtt_qos_t>((flags >> 1) & 0x03);
-	message->common.dup = static_cast<mqtt_dup_t>((flags >> 3) & 0x01);
+	if(requestQueue.full()) {
+		delete stream;
+		return false;
+	}
 
-	if(!copyString(message->publish.topic_name, topic)) {
-		delete message;
+	auto message = createPublishMessage(topic, flags);
+	if(message == nullptr) {
 		delete stream;
 		return false;
 	}
@@ -299,7 +529,7 @@ bool MqttClient::publish(const String& topic, IDataSourceStream* stream, uint8_t
 	message->publish.content.length = MQTT_PUBLISH_STREAM;
 	message->publish.content.data = (uint8_t*)stream;
 
-	bool success = requestQueue.enqueue(message);
+	bool success = enqueue(message);
 	if(success) {
 		// Try to force-send message to decrease latency.
 		// Should work for small size messages but there is no guarantee.
@@ -354,15 +584,8 @@ void MqttClient::onReadyToSendData(TcpConnectionEvent sourceEvent)
 	switch(state) {
 	REENTER:
 	case eMCS_Ready: {
-		if(outgoingMessage != &connectMessage) {
-			deleteMessage(outgoingMessage);
-		}
-		if(connectQueued) {
-			outgoingMessage = &connectMessage;
-			connectQueued = false;
-		} else {
-			outgoingMessage = requestQueue.dequeue();
-		}
+		deleteMessage(outgoingMessage);
+		outgoingMessage = getNextMessage();
 		if(!outgoingMessage) {
 			// Send PINGREQ every PingRepeatTime time, if there is no outgoing traffic
 			if(!pingTimer.expired()) {
@@ -372,7 +595,28 @@ void MqttClient::onReadyToSendData(TcpConnectionEvent sourceEvent)
 			outgoingMessage = createMessage(MQTT_TYPE_PINGREQ);
 		}
 
-		debug_d("[MQTT] Sending message type %u", outgoingMessage->common.type);
+		auto messageType = outgoingMessage->common.type;
+		auto qos = outgoingMessage->common.qos;
+		switch(messageType) {
+		case MQTT_TYPE_PUBLISH:
+			if(qos != MQTT_QOS_AT_MOST_ONCE && outgoingMessage->publish.message_id == 0) {
+				outgoingMessage->publish.message_id = getNextMessageId();
+			}
+			break;
+		case MQTT_TYPE_SUBSCRIBE:
+			if(outgoingMessage->subscribe.message_id == 0) {
+				outgoingMessage->subscribe.message_id = getNextMessageId();
+			}
+			break;
+		case MQTT_TYPE_UNSUBSCRIBE:
+			if(outgoingMessage->unsubscribe.message_id == 0) {
+				outgoingMessage->unsubscribe.message_id = getNextMessageId();
+			}
+			break;
+		default:;
+		}
+
+		debug_d("[MQTT] Sending message type %u", messageType);
 
 		IDataSourceStream* payloadStream{nullptr};
 		if(outgoingMessage->common.type == MQTT_TYPE_PUBLISH &&
@@ -386,6 +630,14 @@ void MqttClient::onReadyToSendData(TcpConnectionEvent sourceEvent)
 		size_t packetLength = mqtt_serialiser_size(&serialiser, outgoingMessage);
 		if(!packetLength) {
 			debug_e("Error: Invalid MQTT message detected!");
+			// A re-sent message is owned by the in-flight window so must not be deleted twice
+			for(auto& entry : inFlight) {
+				if(entry.id != 0 && entry.message == outgoingMessage) {
+					removeInFlight(entry);
+					outgoingMessage = nullptr;
+					break;
+				}
+			}
 			break;
 		}
 
@@ -404,6 +656,26 @@ void MqttClient::onReadyToSendData(TcpConnectionEvent sourceEvent)
 			send(payloadStream);
 		}
 
+		// Track messages requiring acknowledgement
+		if(messageType == MQTT_TYPE_PUBLISH && qos != MQTT_QOS_AT_MOST_ONCE) {
+			auto id = outgoingMessage->publish.message_id;
+			auto entry = findInFlight(id) ?: findInFlight(0);
+			if(entry != nullptr) {
+				entry->id = id;
+				entry->qos = qos;
+				entry->sentTime = millis();
+				entry->pending = false;
+				entry->message = outgoingMessage;
+				outgoingMessage = nullptr;
+			}
+		} else if(messageType == MQTT_TYPE_PUBREL) {
+			auto entry = findInFlight(outgoingMessage->pubrel.message_id);
+			if(entry != nullptr) {
+				entry->sentTime = millis();
+				entry->pending = false;
+			}
+		}
+
 		state = eMCS_SendingData;
 		[[fallthrough]];
 	}
@@ -18,6 +18,8 @@
 #include <Data/ObjectQueue.h>
 #include <Platform/Timers.h>
 #include "MqttPayloadParser.h"
+#include "MqttTopicPool.h"
+#include "MqttMessageStore.h"
 #include <mqtt-codec/src/message.h>
 #include <mqtt-codec/src/serialiser.h>
 #include <mqtt-codec/src/parser.h>
@@ -34,6 +36,20 @@ enum MqttClientState { eMCS_Ready = 0, eMCS_SendingData };
 #define MQTT_REQUEST_POOL_SIZE 10
 #endif
 
+#ifndef MQTT_INFLIGHT_WINDOW
+/**
+ * @brief Maximum number of QoS 1/2 messages awaiting acknowledgement
+ */
+#define MQTT_INFLIGHT_WINDOW 4
+#endif
+
+#ifndef MQTT_RETRANSMIT_TIMEOUT
+/**
+ * @brief Time in seconds to wait for acknowledgement before re-sending a QoS 1/2 message
+ */
+#define MQTT_RETRANSMIT_TIMEOUT 10
+#endif
+
 #define MQTT_CLIENT_CONNECTED bit(1)
 
 #define MQTT_FLAG_RETAINED 1
@@ -105,10 +121,57 @@ public:
 	 * @param topic
 	 * @param message Message content as read-only stream
 	 * @param flags Optional flags
-	 * @retval bool
+	 * @retval bool false if stream is empty, QoS is not 0 or message cannot be queued
+	 * @note Stream content cannot be re-sent so only QoS 0 is supported.
+	 * The stream is always consumed, even on failure.
 	 */
 	bool publish(const String& topic, IDataSourceStream* stream, uint8_t flags = 0);
 
+	/**
+	 * @brief Set maximum number of QoS 1/2 messages which may be awaiting acknowledgement
+	 * @param size Window size, from 1 to MQTT_INFLIGHT_WINDOW
+	 *
+	 * Messages are sent without waiting for earlier ones to be acknowledged, up to this limit.
+	 * Use a size of 1 to preserve strict ordering of retransmitted messages.
+	 */
+	void setInFlightWindow(uint8_t size)
+	{
+		inFlightWindow = std::max(uint8_t(1), std::min(size, uint8_t(MQTT_INFLIGHT_WINDOW)));
+	}
+
+	/**
+	 * @brief Get number of QoS 1/2 messages awaiting acknowledgement
+	 */
+	unsigned getInFlightCount() const;
+
+	/**
+	 * @brief Set time to wait for acknowledgement before re-sending a message
+	 * @param seconds
+	 */
+	void setRetransmitTimeout(uint16_t seconds)
+	{
+		retransmitTimeout = seconds;
+	}
+
+	/**
+	 * @brief Store outgoing messages in a file when they cannot be sent immediately
+	 * @param fileName Name of queue file. Messages already in the file are sent after connection.
+	 * @param fileSystem Where to create the file, if not specified the default filesystem is used
+	 * @retval bool
+	 *
+	 * PUBLISH messages are written to the file if the client is not connected or
+	 * the in-memory queue is full. This allows messages to be retained across reconnects and restarts.
+	 * Stream-based messages are not stored.
+	 *
+	 * @note Pass an empty filename to stop using the file
+	 */
+	bool setMessageStore(const String& fileName, IFS::FileSystem* fileSystem = nullptr);
+
+	MqttMessageStore* getMessageStore()
+	{
+		return messageStore.get();
+	}
+
 	/**
 	 * @brief Subscribe to a topic
 	 * @param topic
@@ -230,6 +293,26 @@ private:
 	static int staticOnMessageEnd(void* user_data, mqtt_message_t* message);
 	int onMessageEnd(mqtt_message_t* message);
 
+	// Message management
+	struct InFlight {
+		mqtt_message_t* message; ///< Retained for re-sending, nullptr once PUBREC received
+		uint16_t id;
+		uint8_t qos;
+		bool released; ///< QoS 2 only: PUBREC received, PUBREL to be sent
+		bool pending;  ///< Needs sending
+		uint32_t sentTime;
+	};
+
+	mqtt_message_t* createPublishMessage(const String& topic, uint8_t flags);
+	void deleteMessage(mqtt_message_t* message);
+	bool enqueue(mqtt_message_t* message);
+	uint16_t getNextMessageId();
+	InFlight* findInFlight(uint16_t id);
+	void removeInFlight(InFlight& entry);
+	mqtt_message_t* getNextMessage();
+	void handleAcknowledgement(mqtt_message_t* message);
+	void loadStoredMessages();
+
 private:
 	Url url;
 
@@ -253,6 +336,14 @@ private:
 	bool connectQueued = false; ///< True if our connect message needs to be sent
 	mqtt_message_t* outgoingMessage = nullptr;
 	mqtt_message_t incomingMessage;
+	MqttTopicPool topicPool;
+	std::unique_ptr<MqttMessageStore> messageStore;
+
+	// QoS 1/2 tracking
+	InFlight inFlight[MQTT_INFLIGHT_WINDOW]{};
+	uint8_t inFlightWindow = MQTT_INFLIGHT_WINDOW;
+	uint16_t retransmitTimeout = MQTT_RETRANSMIT_TIMEOUT;
+	uint16_t lastMessageId = 0;
 
 	// parsers and serializers
 	mqtt_serialiser_t serialiser;
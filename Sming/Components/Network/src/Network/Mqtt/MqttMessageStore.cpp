@@ -0,0 +1,115 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * MqttMessageStore.cpp
+ *
+ ****/
+
+#include "MqttMessageStore.h"
+#include <debug_progmem.h>
+
+namespace
+{
+constexpr uint32_t storeMagic{0x5154514D}; // "MQTQ"
+} // namespace
+
+MqttMessageStore::MqttMessageStore(IFS::FileSystem* fileSystem, const String& fileName)
+	: file(fileSystem), fileName(fileName)
+{
+	open();
+}
+
+bool MqttMessageStore::open()
+{
+	if(!file.open(fileName, IFS::File::Create | IFS::File::ReadWrite)) {
+		debug_e("[MQTT] Failed to open '%s': %s", fileName.c_str(), file.getLastErrorString().c_str());
+		return false;
+	}
+
+	int size = file.seek(0, SeekOrigin::End);
+	Header header{};
+	if(size >= int(sizeof(header))) {
+		file.seek(0, SeekOrigin::Start);
+		file.read(&header, sizeof(header));
+	}
+	if(header.magic == storeMagic && header.readOffset >= sizeof(header) && header.readOffset <= uint32_t(size)) {
+		readOffset = header.readOffset;
+		fileSize = size;
+		if(!isEmpty()) {
+			debug_i("[MQTT] '%s' has %u bytes of queued messages", fileName.c_str(), fileSize - readOffset);
+		}
+		return true;
+	}
+
+	clear();
+	return true;
+}
+
+bool MqttMessageStore::writeHeader()
+{
+	Header header{storeMagic, readOffset};
+	return file.seek(0, SeekOrigin::Start) == 0 && file.write(&header, sizeof(header)) == sizeof(header);
+}
+
+void MqttMessageStore::clear()
+{
+	readOffset = fileSize = sizeof(Header);
+	file.truncate(0);
+	writeHeader();
+}
+
+bool MqttMessageStore::push(const String& topic, const String& content, uint8_t flags)
+{
+	Record rec{flags, 0, uint16_t(topic.length()), uint32_t(content.length())};
+	if(file.seek(fileSize, SeekOrigin::Start) != int(fileSize) || file.write(&rec, sizeof(rec)) != sizeof(rec) ||
+	   file.write(topic.c_str(), rec.topicLength) != rec.topicLength ||
+	   file.write(content.c_str(), rec.contentLength) != int(rec.contentLength)) {
+		debug_e("[MQTT] Failed to store message: %s", file.getLastErrorString().c_str());
+		// Discard partial record
+		file.truncate(fileSize);
+		return false;
+	}
+
+	fileSize += sizeof(rec) + rec.topicLength + rec.contentLength;
+	return true;
+}
+
+bool MqttMessageStore::pop(String& topic, String& content, uint8_t& flags)
+{
+	if(isEmpty()) {
+		return false;
+	}
+
+	Record rec;
+	if(file.seek(readOffset, SeekOrigin::Start) != int(readOffset) || file.read(&rec, sizeof(rec)) != sizeof(rec)) {
+		debug_e("[MQTT] Failed to read stored message: %s", file.getLastErrorString().c_str());
+		clear();
+		return false;
+	}
+
+	auto nextOffset = readOffset + sizeof(rec) + rec.topicLength + rec.contentLength;
+	if(nextOffset > fileSize || !topic.setLength(rec.topicLength) || !content.setLength(rec.contentLength)) {
+		debug_e("[MQTT] Stored message invalid");
+		clear();
+		return false;
+	}
+
+	if(file.read(topic.begin(), rec.topicLength) != rec.topicLength ||
+	   file.read(content.begin(), rec.contentLength) != int(rec.contentLength)) {
+		debug_e("[MQTT] Failed to read stored message: %s", file.getLastErrorString().c_str());
+		clear();
+		return false;
+	}
+
+	flags = rec.flags;
+	readOffset = nextOffset;
+	if(isEmpty()) {
+		clear();
+	} else {
+		writeHeader();
+	}
+	return true;
+}
@@ -0,0 +1,85 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * MqttMessageStore.h
+ *
+ ****/
+
+#pragma once
+
+#include <IFS/File.h>
+
+/**
+ * @brief File-backed FIFO queue of outgoing PUBLISH messages
+ *
+ * Used by MqttClient to hold messages which cannot be sent immediately, either because the
+ * client is not connected or because the in-memory queue is full.
+ * As the content is stored in a file it also survives a restart.
+ *
+ * The file starts with a header containing the offset of the next unread record.
+ * Each record contains flags, topic and message content.
+ * The file is truncated once all records have been read.
+ *
+ * @ingroup mqttclient
+ */
+class MqttMessageStore
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param fileSystem Where to store the queue
+	 * @param fileName Name of queue file. If it exists, any unread messages are retained.
+	 */
+	MqttMessageStore(IFS::FileSystem* fileSystem, const String& fileName);
+
+	/**
+	 * @brief Append a message to the end of the queue
+	 * @retval bool false on file error
+	 */
+	bool push(const String& topic, const String& content, uint8_t flags);
+
+	/**
+	 * @brief Read and remove the message at the head of the queue
+	 * @retval bool false if queue is empty or on file error
+	 */
+	bool pop(String& topic, String& content, uint8_t& flags);
+
+	/**
+	 * @brief Discard all stored messages
+	 */
+	void clear();
+
+	bool isEmpty() const
+	{
+		return readOffset >= fileSize;
+	}
+
+	const String& getFileName() const
+	{
+		return fileName;
+	}
+
+private:
+	struct Header {
+		uint32_t magic;
+		uint32_t readOffset;
+	};
+
+	struct Record {
+		uint8_t flags;
+		uint8_t reserved;
+		uint16_t topicLength;
+		uint32_t contentLength;
+	};
+
+	bool open();
+	bool writeHeader();
+
+	IFS::File file;
+	String fileName;
+	uint32_t readOffset{0};
+	uint32_t fileSize{0};
+};
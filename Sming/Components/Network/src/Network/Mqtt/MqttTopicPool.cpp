@@ -0,0 +1,74 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * MqttTopicPool.cpp
+ *
+ ****/
+
+#include "MqttTopicPool.h"
+
+const String* MqttTopicPool::intern(const String& topic)
+{
+	for(auto& entry : entries) {
+		if(entry.name == topic) {
+			// Keep most recently used entries at the front
+			entries.LinkedObjectList::remove(&entry);
+			entries.insert(&entry);
+			++entry.refCount;
+			return &entry.name;
+		}
+	}
+
+	auto entry = new Entry(topic);
+	if(entry == nullptr || entry->name.length() != topic.length()) {
+		delete entry;
+		return nullptr;
+	}
+	entries.insert(entry);
+	++entry->refCount;
+	trim();
+	return &entry->name;
+}
+
+bool MqttTopicPool::release(const void* data)
+{
+	for(auto& entry : entries) {
+		if(entry.name.c_str() == data) {
+			if(entry.refCount != 0) {
+				--entry.refCount;
+			}
+			trim();
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned MqttTopicPool::getRefCount(const String& topic) const
+{
+	for(auto& entry : entries) {
+		if(entry.name == topic) {
+			return entry.refCount;
+		}
+	}
+	return 0;
+}
+
+void MqttTopicPool::trim()
+{
+	// Discard least recently used entries which are no longer referenced
+	unsigned unused{0};
+	Entry* last{nullptr};
+	for(auto& entry : entries) {
+		if(entry.refCount == 0) {
+			++unused;
+			last = &entry;
+		}
+	}
+	if(unused > MQTT_TOPIC_POOL_SIZE) {
+		entries.remove(last);
+	}
+}
@@ -0,0 +1,81 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * MqttTopicPool.h
+ *
+ ****/
+
+#pragma once
+
+#include <WString.h>
+#include <Data/LinkedObjectList.h>
+
+#ifndef MQTT_TOPIC_POOL_SIZE
+/**
+ * @brief Number of unused topic names to retain for re-use
+ */
+#define MQTT_TOPIC_POOL_SIZE 8
+#endif
+
+/**
+ * @brief Stores topic names shared by outgoing messages
+ *
+ * Applications typically publish to a small set of topics. Rather than allocating a copy
+ * of the topic name for every message, messages reference a single pooled copy.
+ * Unused entries are retained (up to MQTT_TOPIC_POOL_SIZE) so that bursts of messages
+ * to the same topic do not require any allocation.
+ *
+ * @ingroup mqttclient
+ */
+class MqttTopicPool
+{
+public:
+	/**
+	 * @brief Obtain a reference to a pooled topic name
+	 * @param topic
+	 * @retval const String* Storage remains valid until the matching call to `release()`
+	 */
+	const String* intern(const String& topic);
+
+	/**
+	 * @brief Release a reference obtained from `intern()`
+	 * @param data Pointer to the topic name content
+	 * @retval bool false if data does not belong to the pool
+	 */
+	bool release(const void* data);
+
+	/**
+	 * @brief Get number of topic names in the pool
+	 */
+	size_t count() const
+	{
+		return entries.count();
+	}
+
+	/**
+	 * @brief Get number of references to a topic
+	 */
+	unsigned getRefCount(const String& topic) const;
+
+	void clear()
+	{
+		entries.clear();
+	}
+
+private:
+	struct Entry : public LinkedObjectTemplate<Entry> {
+		Entry(const String& name) : name(name)
+		{
+		}
+
+		String name;
+		uint16_t refCount{0};
+	};
+
+	void trim();
+
+	OwnedLinkedObjectListTemplate<Entry> entries;
+};
@@ -16,6 +16,7 @@ void TcpClient::freeStreams()
 {
 	delete stream;
 	stream = nullptr;
+	queuedBytes = 0;
 }
 
 bool TcpClient::connect(const String& server, int port, bool useSsl)
@@ -61,6 +62,12 @@ bool TcpClient::send(const char* data, uint16_t len, bool forceCloseAfterSent)
 
 	memoryStream->write(data, len);
 
+	if(!newStream) {
+		// Appended to existing stream, so account for the new data here
+		totalSentBytes += len;
+		queuedBytes += len;
+	}
+
 	(void)newStream.release();
 	return send(memoryStream, forceCloseAfterSent);
 }
@@ -80,6 +87,7 @@ bool TcpClient::send(IDataSourceStream* source, bool forceCloseAfterSent)
 		return false;
 	}
 
+	bool appended = (stream == source);
 	if(stream == nullptr) {
 		stream = source;
 	} else if(stream != source) {
@@ -114,8 +122,9 @@ bool TcpClient::send(IDataSourceStream* source, bool forceCloseAfterSent)
 	(void)sourceRef.release();
 
 	int length = source->available();
-	if(length > 0) {
+	if(length > 0 && !appended) {
 		totalSentBytes += length;
+		queuedBytes += length;
 	}
 
 	debug_d("Sending stream. Bytes to send: %d", length);
@@ -201,7 +210,10 @@ void TcpClient::pushAsyncPart()
 		return;
 	}
 
-	write(stream);
+	int written = write(stream);
+	if(written > 0) {
+		queuedBytes -= std::min(size_t(written), queuedBytes);
+	}
 
 	if(stream->isFinished()) {
 		debug_d("TcpClient stream finished");
@@ -128,6 +128,16 @@ public:
 		return state;
 	}
 
+	/**
+	 * @brief Get amount of outgoing data which has not yet been acknowledged by the remote end
+	 * @retval size_t Number of bytes queued for sending plus those in flight
+	 * @note Use this to detect slow receivers. Streams of unknown length are not included.
+	 */
+	size_t getPendingBytes() const
+	{
+		return queuedBytes + getUnackedBytes();
+	}
+
 	/**
 	 * Schedules the connection to get closed after the data is sent
 	 * @param ignoreIncomingData when that flag is set the connection will start ignoring incoming data.
@@ -173,6 +183,7 @@ private:
 	TcpClientCloseAfterSentState closeAfterSent = eTCCASS_None;
 	uint16_t totalSentConfirmedBytes = 0;
 	uint16_t totalSentBytes = 0;
+	size_t queuedBytes = 0; ///< Data queued in stream but not yet passed to TCP stack
 };
 
 /** @} */
@@ -26,12 +26,144 @@
 #define debug_tcp_ext(fmt, ...) debug_none(fmt, ##__VA_ARGS__)
 #endif
 
+/*
+ * Holds references to stream content passed to lwIP without copying.
+ *
+ * Each entry keeps its content alive until the remote end has acknowledged the sequence number
+ * at which it ends. Consecutive writes from the same buffer share an entry.
+ *
+ * If the connection is closed whilst data is still unacknowledged, the references are handed
+ * over to the pcb which is kept open until the data is acknowledged, the connection fails,
+ * or a timeout expires.
+ */
+class TcpConnection::SendRefs
+{
+public:
+	static constexpr unsigned maxRefs{8};
+	static constexpr unsigned lingerTimeout{20}; ///< Poll intervals of 1 second
+
+	bool isEmpty() const
+	{
+		return count == 0;
+	}
+
+	bool canAdd(const std::shared_ptr<const void>& owner) const
+	{
+		return count < maxRefs || refs[count - 1].owner == owner;
+	}
+
+	/**
+	 * @brief Record a reference
+	 * @param owner
+	 * @param endSeq Sequence number following the last byte written
+	 */
+	void add(const std::shared_ptr<const void>& owner, uint32_t endSeq)
+	{
+		if(count != 0 && refs[count - 1].owner == owner) {
+			refs[count - 1].endSeq = endSeq;
+			return;
+		}
+		assert(count < maxRefs);
+		refs[count++] = Ref{owner, endSeq};
+	}
+
+	/**
+	 * @brief Drop references to acknowledged content
+	 * @param ackSeq The next sequence number expected by the remote end
+	 */
+	void release(uint32_t ackSeq)
+	{
+		unsigned n{0};
+		while(n < count && int32_t(ackSeq - refs[n].endSeq) >= 0) {
+			++n;
+		}
+		if(n == 0) {
+			return;
+		}
+		for(unsigned i = n; i < count; ++i) {
+			refs[i - n] = std::move(refs[i]);
+		}
+		for(unsigned i = count - n; i < count; ++i) {
+			refs[i].owner.reset();
+		}
+		count -= n;
+	}
+
+	static void linger(tcp_pcb* pcb, SendRefs* refs);
+
+private:
+	struct Ref {
+		std::shared_ptr<const void> owner;
+		uint32_t endSeq;
+	};
+
+	static void finish(tcp_pcb* pcb, SendRefs* refs)
+	{
+		tcp_arg(pcb, nullptr);
+		delete refs;
+		closeTcpConnection(pcb);
+	}
+
+	Ref refs[maxRefs];
+	unsigned count{0};
+	unsigned lingerPolls{0};
+};
+
+void TcpConnection::SendRefs::linger(tcp_pcb* pcb, SendRefs* refs)
+{
+	debug_d("TCP %p waiting for ack before close", pcb);
+
+	tcp_arg(pcb, refs);
+
+	tcp_sent(pcb, [](void* arg, tcp_pcb* pcb, uint16_t) -> err_t {
+		auto refs = static_cast<SendRefs*>(arg);
+		refs->release(pcb->lastack);
+		if(refs->isEmpty()) {
+			finish(pcb, refs);
+		}
+		return ERR_OK;
+	});
+
+	tcp_recv(pcb, [](void*, tcp_pcb* pcb, pbuf* p, err_t) -> err_t {
+		// Discard any incoming data
+		if(p != nullptr) {
+			tcp_recved(pcb, p->tot_len);
+			pbuf_free(p);
+		}
+		return ERR_OK;
+	});
+
+	// lwIP has already released the pcb and any queued data
+	tcp_err(pcb, [](void* arg, err_t) { delete static_cast<SendRefs*>(arg); });
+
+	tcp_poll(
+		pcb,
+		[](void* arg, tcp_pcb* pcb) -> err_t {
+			auto refs = static_cast<SendRefs*>(arg);
+			refs->release(pcb->lastack);
+			if(refs->isEmpty()) {
+				finish(pcb, refs);
+				return ERR_OK;
+			}
+			if(++refs->lingerPolls < lingerTimeout) {
+				tcp_output(pcb);
+				return ERR_OK;
+			}
+			debug_w("TCP %p timeout waiting for ack, aborting", pcb);
+			// Error callback frees refs
+			tcp_abort(pcb);
+			return ERR_ABRT;
+		},
+		2);
+}
+
 TcpConnection::~TcpConnection()
 {
 	autoSelfDestruct = false;
 	close();
 
 	delete ssl;
+	delete sendRefs;
 
 	debug_tcp_d("~connection");
 
@@ -238,21 +370,45 @@ int TcpConnection::write(IDataSourceStream* stream)
 	// Send data from DataStream
 	size_t total = 0;
 	unsigned pushCount = 0;
-	while((tcp_sndqueuelen(tcp) < TCP_SND_QUEUELEN) && !stream->isFinished() && (pushCount < 25)) {
+	while((tcp_sndqueuelen(tcp) < TCP_SND_QUEUELEN) && !stream->isFinished()) {
 		size_t available = getAvailableWriteSize();
 		if(available == 0) {
 			break;
 		}
 
-		char buffer[NETWORK_SEND_BUFFER_SIZE];
-		auto bytesRead = stream->readMemoryBlock(buffer, std::min(sizeof(buffer), available));
-		if(bytesRead == 0) {
-			break;
+		// Content may be passed to lwIP by reference, provided it can be retained until acknowledged
+		StreamRegion region;
+		bool direct = (ssl == nullptr) && stream->getReadRegion(region) && region.length != 0;
+		if(direct && region.owner) {
+			if(sendRefs == nullptr) {
+				sendRefs = new SendRefs;
+			}
+			direct = (sendRefs != nullptr) && sendRefs->canAdd(region.owner);
 		}
 
-		++pushCount;
+		int bytesWritten;
+		if(direct) {
+			++pushCount;
+
+			auto len = std::min(region.length, available);
+			bytesWritten = tcp_write(tcp, region.data, len, TCP_WRITE_FLAG_MORE);
+			if(bytesWritten == ERR_OK) {
+				bytesWritten = len;
+				if(region.owner) {
+					sendRefs->add(region.owner, tcp->snd_lbb);
+				}
+			}
+		} else {
+			char buffer[NETWORK_SEND_BUFFER_SIZE];
+			auto bytesRead = stream->readMemoryBlock(buffer, std::min(sizeof(buffer), available));
+			if(bytesRead == 0) {
+				break;
+			}
+
+			++pushCount;
 
-		int bytesWritten = write(buffer, bytesRead, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+			bytesWritten = write(buffer, bytesRead, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE);
+		}
 		debug_tcp_d("Written: %d, Available: %u, isFinished: %d, PushCount: %u", bytesWritten, available,
 					stream->isFinished(), pushCount);
 
@@ -288,8 +444,10 @@ void TcpConnection::close()
 	}
 	debug_tcp_d("connection closing");
 
-	tcp_poll(tcp, staticOnPoll, 1);
-	tcp_arg(tcp, nullptr); // reset pointer to close connection on next callback
+	if(!lingerSendRefs(tcp)) {
+		tcp_poll(tcp, staticOnPoll, 1);
+		tcp_arg(tcp, nullptr); // reset pointer to close connection on next callback
+	}
 	tcp = nullptr;
 
 	onClosed();
@@ -297,6 +455,17 @@ void TcpConnection::close()
 	checkSelfFree();
 }
 
+void TcpConnection::resumeReceive()
+{
+	receivePaused = false;
+	while(tcp != nullptr && withheldWindow != 0) {
+		auto len = std::min(withheldWindow, size_t(0xffff));
+		tcp_recved(tcp, len);
+		withheldWindow -= len;
+	}
+	withheldWindow = 0;
+}
+
 void TcpConnection::initialize(tcp_pcb* pcb)
 {
 	assert(pcb != nullptr);
@@ -304,6 +473,8 @@ void TcpConnection::initialize(tcp_pcb* pcb)
 	tcp = pcb;
 	sleep = 0;
 	canSend = true;
+	receivePaused = false;
+	withheldWindow = 0;
 
 	tcp_nagle_disable(tcp);
 	tcp_arg(tcp, this);
@@ -354,6 +525,11 @@ void TcpConnection::closeTcpConnection(tcp_pcb* tpcb)
 
 	auto connection = reinterpret_cast<TcpConnection*>(tpcb->callback_arg);
 
+	if(connection != nullptr && connection->lingerSendRefs(tpcb)) {
+		connection->onClosed();
+		return;
+	}
+
 	tcp_arg(tpcb, nullptr);
 	tcp_sent(tpcb, nullptr);
 	tcp_recv(tpcb, nullptr);
@@ -374,6 +550,25 @@ void TcpConnection::closeTcpConnection(tcp_pcb* tpcb)
 	}
 }
 
+bool TcpConnection::lingerSendRefs(tcp_pcb* pcb)
+{
+	if(sendRefs == nullptr) {
+		return false;
+	}
+
+	sendRefs->release(pcb->lastack);
+	if(sendRefs->isEmpty()) {
+		delete sendRefs;
+		sendRefs = nullptr;
+		return false;
+	}
+
+	// lwIP still references unacknowledged data, so the pcb takes ownership of the references
+	SendRefs::linger(pcb, sendRefs);
+	sendRefs = nullptr;
+	return true;
+}
+
 void TcpConnection::flush()
 {
 	if(tcp && tcp->state == ESTABLISHED) {
@@ -468,7 +663,11 @@ err_t TcpConnection::internalOnReceive(pbuf* p, err_t err)
 	//if (tcp != nullptr && tcp->state == ESTABLISHED) // If active
 	/* We have taken the data. */
 	if(p != nullptr) {
-		tcp_recved(tcp, p->tot_len);
+		if(receivePaused) {
+			withheldWindow += p->tot_len;
+		} else {
+			tcp_recved(tcp, p->tot_len);
+		}
 	} else {
 		debug_tcp_d("receive: pbuf is NULL");
 	}
@@ -521,6 +720,9 @@ err_t TcpConnection::internalOnReceive(pbuf* p, err_t err)
 err_t TcpConnection::internalOnSent(uint16_t len)
 {
 	sleep = 0;
+	if(sendRefs != nullptr && tcp != nullptr) {
+		sendRefs->release(tcp->lastack);
+	}
 	err_t res = onSent(len);
 	checkSelfFree();
 	debug_tcp_ext("<sent");
@@ -553,6 +755,9 @@ err_t TcpConnection::internalOnPoll()
 void TcpConnection::internalOnError(err_t err)
 {
 	tcp = nullptr; // IMPORTANT. No available connection after error!
+	// lwIP has freed any queued data
+	delete sendRefs;
+	sendRefs = nullptr;
 	onError(err);
 	checkSelfFree();
 	debug_tcp_ext("<error");
@@ -89,8 +89,10 @@ public:
 
 	/** @brief Writes stream data directly to the TCP buffer
 	 *  @param stream
-	 *  @param apiflags TCP_WRITE_FLAG_COPY, TCP_WRITE_FLAG_MORE
 	 *  @retval int negative on error, 0 when retry is needed or positive on success
+	 *  @note Where the stream provides direct access to its content via `getReadRegion()`
+	 *  and SSL is not in use, data is passed to the TCP stack without copying.
+	 *  A reference to the content is retained until the remote end acknowledges it.
 	 */
 	int write(IDataSourceStream* stream);
 
@@ -99,8 +101,38 @@ public:
 		return (canSend && tcp) ? tcp_sndbuf(tcp) : 0;
 	}
 
+	/**
+	 * @brief Get number of bytes passed to the TCP stack which have not yet been acknowledged
+	 */
+	size_t getUnackedBytes() const
+	{
+		return (tcp == nullptr) ? 0 : size_t(tcp->snd_lbb - tcp->lastack);
+	}
+
 	void flush();
 
+	/**
+	 * @brief Stop re-opening the receive window as data is consumed
+	 *
+	 * Used for flow control when received data cannot be processed as fast as it arrives,
+	 * for example whilst waiting for flash writes to complete.
+	 * Data already in flight is still delivered, but the remote end stops sending once the window is exhausted.
+	 */
+	void pauseReceive()
+	{
+		receivePaused = true;
+	}
+
+	/**
+	 * @brief Re-open the receive window, allowing the remote end to continue sending
+	 */
+	void resumeReceive();
+
+	bool isReceivePaused() const
+	{
+		return receivePaused;
+	}
+
 	void setTimeOut(uint16_t waitTimeOut);
 
 	IpAddress getRemoteIp() const
@@ -215,8 +247,11 @@ protected:
 	void internalOnDnsResponse(const char* name, LWIP_IP_ADDR_T* ipaddr, int port);
 
 private:
+	class SendRefs;
+
 	static err_t staticOnPoll(void* arg, tcp_pcb* tcp);
 	static void closeTcpConnection(tcp_pcb* tpcb);
+	bool lingerSendRefs(tcp_pcb* pcb);
 
 	void checkSelfFree()
 	{
@@ -237,6 +272,10 @@ protected:
 
 private:
 	TcpConnectionDestroyedDelegate destroyedDelegate = nullptr;
+	SendRefs* sendRefs = nullptr; ///< Content passed to lwIP without copying
+	// Flow control: received bytes not yet released to lwIP whilst paused
+	size_t withheldWindow = 0;
+	bool receivePaused = false;
 };
 
 /** @} */
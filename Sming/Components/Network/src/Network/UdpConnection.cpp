@@ -74,9 +74,9 @@ bool UdpConnection::send(const char* data, int length)
 		return false;
 	} else {
 		memcpy(p->payload, data, length);
-		err_t res = udp_send(udp, p);
+		bool res = send(p);
 		pbuf_free(p);
-		return res == ERR_OK;
+		return res;
 	}
 }
 
@@ -87,12 +87,120 @@ bool UdpConnection::sendTo(IpAddress remoteIP, uint16_t remotePort, const char*
 		return false;
 	} else {
 		memcpy(p->payload, data, length);
-		err_t res = udp_sendto(udp, p, remoteIP, remotePort);
+		bool res = sendTo(remoteIP, remotePort, p);
 		pbuf_free(p);
-		return res == ERR_OK;
+		return res;
 	}
 }
 
+bool UdpConnection::send(pbuf* p)
+{
+	if(udp == nullptr || p == nullptr) {
+		return false;
+	}
+	err_t res = udp_send(udp, p);
+	return res == ERR_OK;
+}
+
+bool UdpConnection::sendTo(IpAddress remoteIP, uint16_t remotePort, pbuf* p)
+{
+	if(udp == nullptr || p == nullptr) {
+		return false;
+	}
+	err_t res = udp_sendto(udp, p, remoteIP, remotePort);
+	return res == ERR_OK;
+}
+
+bool UdpConnection::send(const Segment* segments, unsigned count, bool persistent)
+{
+	pbuf* p = createPbuf(segments, count, persistent);
+	if(p == nullptr) {
+		return false;
+	}
+	bool res = send(p);
+	pbuf_free(p);
+	return res;
+}
+
+bool UdpConnection::sendTo(IpAddress remoteIP, uint16_t remotePort, const Segment* segments, unsigned count,
+						   bool persistent)
+{
+	pbuf* p = createPbuf(segments, count, persistent);
+	if(p == nullptr) {
+		return false;
+	}
+	bool res = sendTo(remoteIP, remotePort, p);
+	pbuf_free(p);
+	return res;
+}
+
+unsigned UdpConnection::sendToMany(const Endpoint* destinations, unsigned count, const void* data, size_t length,
+								   bool persistent)
+{
+	/*
+	 * A referenced buffer has no header space, so the stack chains a separate header pbuf
+	 * for each destination and leaves the payload untouched.
+	 */
+	Segment segment{data, length};
+	pbuf* p = createPbuf(&segment, 1, persistent);
+	if(p == nullptr) {
+		return 0;
+	}
+
+	unsigned sent{0};
+	for(unsigned i = 0; i < count; ++i) {
+		auto& dest = destinations[i];
+		if(sendTo(dest.ip, dest.port, p)) {
+			++sent;
+		} else {
+			debug_w("UDP send to %s:%u failed", dest.ip.toString().c_str(), dest.port);
+		}
+	}
+
+	pbuf_free(p);
+	return sent;
+}
+
+pbuf* UdpConnection::createPbuf(const Segment* segments, unsigned count, bool persistent)
+{
+	size_t totalLength{0};
+	for(unsigned i = 0; i < count; ++i) {
+		totalLength += segments[i].length;
+	}
+	if(totalLength > 0xffff) {
+		debug_e("UDP datagram too large: %u", totalLength);
+		return nullptr;
+	}
+
+	pbuf* head = nullptr;
+	for(unsigned i = 0; i < count; ++i) {
+		auto& segment = segments[i];
+		if(segment.length == 0) {
+			continue;
+		}
+		pbuf* p = pbuf_alloc(PBUF_RAW, segment.length, persistent ? PBUF_ROM : PBUF_REF);
+		if(p == nullptr) {
+			if(head != nullptr) {
+				pbuf_free(head);
+			}
+			return nullptr;
+		}
+		p->payload = const_cast<void*>(segment.data);
+		if(head == nullptr) {
+			head = p;
+		} else {
+			pbuf_cat(head, p);
+		}
+	}
+
+	if(head == nullptr) {
+		// Empty datagram
+		head = pbuf_alloc(PBUF_TRANSPORT, 0, PBUF_RAM);
+	}
+
+	return head;
+}
+
 void UdpConnection::onReceive(pbuf* buf, IpAddress remoteIP, uint16_t remotePort)
 {
 	debug_d("UDP received: %d bytes", buf->tot_len);
@@ -27,6 +27,22 @@ using UdpConnectionDataDelegate =
 class UdpConnection : public IpConnection
 {
 public:
+	/**
+	 * @brief Describes a block of caller-owned data to be sent without copying
+	 */
+	struct Segment {
+		const void* data;
+		size_t length;
+	};
+
+	/**
+	 * @brief Identifies a destination for batched sends
+	 */
+	struct Endpoint {
+		IpAddress ip;
+		uint16_t port;
+	};
+
 	UdpConnection()
 	{
 		initialize();
@@ -71,6 +87,72 @@ public:
 		return sendTo(remoteIP, remotePort, data.c_str(), data.length());
 	}
 
+	/**
+	 * @name Zero-copy send methods
+	 *
+	 * These methods avoid allocating and copying the payload for each datagram.
+	 * Caller-owned data is referenced directly by the network stack via `PBUF_REF` buffers.
+	 * The data only needs to remain valid until the method returns: if the stack must queue the packet
+	 * (for example, whilst resolving the destination MAC address) it takes a copy.
+	 *
+	 * Set `persistent` if the data will remain unchanged for the lifetime of the application,
+	 * such as a constant table in RAM. `PBUF_ROM` buffers are then used, which are never copied.
+	 *
+	 * @{
+	 */
+
+	/**
+	 * @brief Send a pre-built pbuf chain to the connected remote
+	 * @param p The buffer is not freed, and remains owned by the caller
+	 * @note The stack may insert protocol headers into the first pbuf if it has space.
+	 * To send the same data more than once, use PBUF_REF or PBUF_ROM buffers or `sendToMany()`.
+	 */
+	bool send(pbuf* p);
+
+	/**
+	 * @brief Send a pre-built pbuf chain to a specific remote
+	 * @see See `send(pbuf*)`
+	 */
+	bool sendTo(IpAddress remoteIP, uint16_t remotePort, pbuf* p);
+
+	/**
+	 * @brief Gather a list of segments into a single datagram and send to the connected remote
+	 * @param segments For example, a protocol header followed by payload
+	 * @param count Number of segments
+	 * @param persistent true if the data is never modified or freed
+	 */
+	bool send(const Segment* segments, unsigned count, bool persistent = false);
+
+	/**
+	 * @brief Gather a list of segments into a single datagram and send to a specific remote
+	 * @see See `send(const Segment*, unsigned, bool)`
+	 */
+	bool sendTo(IpAddress remoteIP, uint16_t remotePort, const Segment* segments, unsigned count,
+				bool persistent = false);
+
+	/**
+	 * @brief Send the same datagram to multiple destinations
+	 * @param destinations List of destinations
+	 * @param count Number of destinations
+	 * @param data Datagram content, referenced without copying
+	 * @param length
+	 * @param persistent true if the data is never modified or freed
+	 * @retval unsigned Number of destinations the datagram was successfully sent to
+	 */
+	unsigned sendToMany(const Endpoint* destinations, unsigned count, const void* data, size_t length,
+						bool persistent = false);
+
+	/**
+	 * @brief Build a pbuf chain referencing caller-owned segments
+	 * @param segments
+	 * @param count
+	 * @param persistent true to use PBUF_ROM, false for PBUF_REF
+	 * @retval pbuf* Must be released with `pbuf_free()`. nullptr if out of memory or data too large.
+	 */
+	static pbuf* createPbuf(const Segment* segments, unsigned count, bool persistent = false);
+
+	/** @} */
+
 	/**
 	 * @brief Sets the UDP multicast IP.
 	 * @param ip
@@ -0,0 +1,203 @@
+#!/usr/bin/env python
+#
+# Pack a directory of web content into a single image for use with AssetBundle
+#
+# Image layout (all values little-endian, sections 4-byte aligned):
+#
+#   Header      magic "SWAB", version, asset count, offsets of seed and entry tables
+#   Seeds       int32[count] perfect hash displacement values
+#   Entries     Entry[count], indexed by perfect hash of path
+#   Strings     paths and MIME types
+#   Content     file bodies, gzip-compressed where this saves space
+#
+# Lookup uses the 'hash, displace' scheme: bucket = hash(0, path) % count.
+# A negative seed value gives the slot directly (-seed - 1), otherwise slot = hash(seed, path) % count.
+#
+
+import argparse
+import gzip
+import hashlib
+import mimetypes
+import os
+import struct
+import sys
+
+MAGIC = b'SWAB'
+VERSION = 1
+FLAG_GZIP = 0x01
+
+HEADER_FORMAT = '<4sHHII'
+# pathOffset, dataOffset, dataLength, mimeOffset, etag[8], pathLength, mimeLength, flags, reserved
+ENTRY_FORMAT = '<IIII8sHBBI'
+
+# Ensure consistent results regardless of host configuration
+MIME_TYPES = {
+    '.css': 'text/css',
+    '.gif': 'image/gif',
+    '.htm': 'text/html',
+    '.html': 'text/html',
+    '.ico': 'image/x-icon',
+    '.jpeg': 'image/jpeg',
+    '.jpg': 'image/jpeg',
+    '.js': 'text/javascript',
+    '.json': 'application/json',
+    '.map': 'application/json',
+    '.png': 'image/png',
+    '.svg': 'image/svg+xml',
+    '.txt': 'text/plain',
+    '.wasm': 'application/wasm',
+    '.woff': 'font/woff',
+    '.woff2': 'font/woff2',
+    '.xml': 'text/xml',
+}
+
+
+def fnv_hash(seed, key):
+    """Must match AssetBundle::hash()"""
+    h = seed or 0x01000193
+    for c in key:
+        h = ((h * 0x01000193) ^ c) & 0xffffffff
+    return h
+
+
+def build_perfect_hash(keys):
+    """Return (seeds, slots) where slots[i] is index of key stored in slot i"""
+    size = len(keys)
+    buckets = [[] for _ in range(size)]
+    for i, key in enumerate(keys):
+        buckets[fnv_hash(0, key) % size].append(i)
+
+    seeds = [0] * size
+    slots = [None] * size
+    order = sorted(range(size), key=lambda b: len(buckets[b]), reverse=True)
+
+    # Find a seed which places all keys in each multi-key bucket into free slots
+    for b in order:
+        bucket = buckets[b]
+        if len(bucket) <= 1:
+            break
+        seed = 1
+        while True:
+            used = [fnv_hash(seed, keys[i]) % size for i in bucket]
+            if len(set(used)) == len(used) and all(slots[s] is None for s in used):
+                break
+            seed += 1
+        seeds[b] = seed
+        for i, s in zip(bucket, used):
+            slots[s] = i
+
+    # Single-key buckets go directly into remaining slots
+    free = [s for s in range(size) if slots[s] is None]
+    for b in order:
+        bucket = buckets[b]
+        if len(bucket) != 1:
+            continue
+        s = free.pop()
+        seeds[b] = -s - 1
+        slots[s] = bucket[0]
+
+    return seeds, slots
+
+
+def align(data, alignment=4):
+    pad = (alignment - len(data) % alignment) % alignment
+    data.extend(b'\0' * pad)
+
+
+def get_mime_type(path):
+    ext = os.path.splitext(path)[1].lower()
+    mime = MIME_TYPES.get(ext) or mimetypes.guess_type(path)[0]
+    return mime or 'application/octet-stream'
+
+
+def scan_files(source_dirs):
+    assets = {}
+    for source in source_dirs:
+        for root, dirs, files in os.walk(source):
+            dirs.sort()
+            for name in sorted(files):
+                filename = os.path.join(root, name)
+                path = '/' + os.path.relpath(filename, source).replace(os.sep, '/')
+                assets[path] = filename
+    return assets
+
+
+def create_image(assets, compress):
+    paths = sorted(assets.keys())
+    keys = [p.encode() for p in paths]
+    count = len(keys)
+    if count == 0:
+        raise RuntimeError('No files found')
+    if count > 0xffff:
+        raise RuntimeError('Too many files')
+
+    seeds, slots = build_perfect_hash(keys)
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    entry_size = struct.calcsize(ENTRY_FORMAT)
+    seed_offset = header_size
+    entry_offset = seed_offset + 4 * count
+
+    strings = bytearray()
+    string_offset = entry_offset + entry_size * count
+    mime_offsets = {}
+    content = bytearray()
+    records = []
+    for key, path in zip(keys, paths):
+        with open(assets[path], 'rb') as f:
+            data = f.read()
+        etag = hashlib.sha1(data).digest()[:8]
+        flags = 0
+        if compress:
+            packed = gzip.compress(data, compresslevel=9, mtime=0)
+            if len(packed) < len(data) * 0.9:
+                data = packed
+                flags |= FLAG_GZIP
+        mime = get_mime_type(path).encode()
+        if mime not in mime_offsets:
+            mime_offsets[mime] = string_offset + len(strings)
+            strings.extend(mime)
+        path_offset = string_offset + len(strings)
+        strings.extend(key)
+        records.append((path_offset, len(key), mime_offsets[mime], len(mime), etag, flags, data))
+
+    align(strings)
+    content_offset = string_offset + len(strings)
+
+    image = bytearray(struct.pack(HEADER_FORMAT, MAGIC, VERSION, count, seed_offset, entry_offset))
+    image.extend(struct.pack('<%di' % count, *seeds))
+    entries = [None] * count
+    for slot, index in enumerate(slots):
+        path_offset, path_length, mime_offset, mime_length, etag, flags, data = records[index]
+        data_offset = content_offset + len(content)
+        content.extend(data)
+        align(content)
+        entries[slot] = struct.pack(ENTRY_FORMAT, path_offset, data_offset, len(data), mime_offset, etag,
+                                    path_length, mime_length, flags, 0)
+    for e in entries:
+        image.extend(e)
+    image.extend(strings)
+    image.extend(content)
+    return image
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Sming web asset bundle builder')
+    parser.add_argument('source', nargs='+', help='Directories containing files to pack')
+    parser.add_argument('output', help='Image file to create')
+    parser.add_argument('--no-compress', action='store_true', help='Store all content uncompressed')
+    args = parser.parse_args()
+
+    assets = scan_files(args.source)
+    image = create_image(assets, not args.no_compress)
+    with open(args.output, 'wb') as f:
+        f.write(image)
+    print("Packed %u files into '%s', %u bytes" % (len(assets), args.output, len(image)))
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except Exception as e:
+        print('** ERROR! %s' % e, file=sys.stderr)
+        sys.exit(1)
@@ -0,0 +1,202 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * CachedDevice.cpp
+ *
+ ****/
+
+#include "include/Storage/CachedDevice.h"
+#include <debug_progmem.h>
+#include <algorithm>
+#include <cstring>
+
+namespace Storage
+{
+CachedDevice::CachedDevice(Device& device, uint16_t pageSize, uint8_t pageCount, uint16_t writeBufferSize)
+	: mDevice(device), mWriteBufferSize(writeBufferSize), mPageSize(pageSize), mPageCount(pageCount)
+{
+	assert(pageSize != 0 && (pageSize & (pageSize - 1)) == 0);
+	assert((writeBufferSize & (writeBufferSize - 1)) == 0);
+
+	mPages.reset(new Page[pageCount]{});
+	mPageData.reset(new uint8_t[size_t(pageSize) * pageCount]);
+	if(writeBufferSize != 0) {
+		mWriteBuffer.reset(new uint8_t[writeBufferSize]);
+	}
+
+	for(auto part : device.partitions()) {
+		mPartitions.add(part.name(), part.fullType(), part.address(), part.size(), part.flags());
+	}
+}
+
+CachedDevice::~CachedDevice()
+{
+	flush();
+}
+
+int CachedDevice::findPage(storage_size_t address) const
+{
+	for(unsigned i = 0; i < mPageCount; ++i) {
+		auto& page = mPages[i];
+		if(page.valid && page.address == address) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int CachedDevice::loadPage(storage_size_t address)
+{
+	// Use an empty page if available, otherwise the least recently used one
+	unsigned index{0};
+	for(unsigned i = 0; i < mPageCount; ++i) {
+		auto& page = mPages[i];
+		if(!page.valid) {
+			index = i;
+			break;
+		}
+		if(page.lastUse < mPages[index].lastUse) {
+			index = i;
+		}
+	}
+
+	auto& page = mPages[index];
+	if(page.valid) {
+		++mStats.evictions;
+		page.valid = false;
+	}
+
+	// Last page may extend beyond end of device
+	size_t len = std::min(storage_size_t(mPageSize), mDevice.getSize() - address);
+	if(!mDevice.read(address, pageData(index), len)) {
+		return -1;
+	}
+	page.address = address;
+	page.valid = true;
+	++mStats.misses;
+	return index;
+}
+
+bool CachedDevice::read(storage_size_t address, void* dst, size_t size)
+{
+	if(overlapsBuffer(address, size) && !flush()) {
+		return false;
+	}
+
+	if(size > size_t(mPageSize) * mPageCount) {
+		++mStats.bypassed;
+		return mDevice.read(address, dst, size);
+	}
+
+	auto out = static_cast<uint8_t*>(dst);
+	while(size != 0) {
+		auto pageAddress = address & ~storage_size_t(mPageSize - 1);
+		int index = findPage(pageAddress);
+		if(index >= 0) {
+			++mStats.hits;
+		} else {
+			index = loadPage(pageAddress);
+			if(index < 0) {
+				return false;
+			}
+		}
+		mPages[index].lastUse = ++mUseCounter;
+
+		auto offset = address - pageAddress;
+		auto len = std::min(size, size_t(mPageSize - offset));
+		memcpy(out, pageData(index) + offset, len);
+		out += len;
+		address += len;
+		size -= len;
+	}
+
+	return true;
+}
+
+bool CachedDevice::write(storage_size_t address, const void* src, size_t size)
+{
+	++mStats.writes;
+
+	if(mWriteLength != 0) {
+		// Append if contiguous and within the same buffer-aligned block
+		auto blockEnd = (mWriteAddress | (mWriteBufferSize - 1)) + 1;
+		if(address == mWriteAddress + mWriteLength && address + size <= blockEnd) {
+			memcpy(&mWriteBuffer[mWriteLength], src, size);
+			mWriteLength += size;
+			++mStats.combined;
+			return (address + size == blockEnd) ? flush() : true;
+		}
+		if(!flush()) {
+			return false;
+		}
+	}
+
+	// Start a new buffer if the data doesn't cross a block boundary
+	if(mWriteBufferSize != 0 && size < mWriteBufferSize) {
+		auto offset = address & (mWriteBufferSize - 1);
+		if(offset + size < mWriteBufferSize) {
+			memcpy(&mWriteBuffer[0], src, size);
+			mWriteAddress = address;
+			mWriteLength = size;
+			return true;
+		}
+	}
+
+	invalidate(address, size);
+	++mStats.flushes;
+	return mDevice.write(address, src, size);
+}
+
+bool CachedDevice::flush()
+{
+	if(mWriteLength == 0) {
+		return true;
+	}
+
+	invalidate(mWriteAddress, mWriteLength);
+	++mStats.flushes;
+	bool res = mDevice.write(mWriteAddress, &mWriteBuffer[0], mWriteLength);
+	if(!res) {
+		debug_e("[CachedDevice] Write 0x%08llx, %u failed", uint64_t(mWriteAddress), mWriteLength);
+	}
+	mWriteLength = 0;
+	return res;
+}
+
+bool CachedDevice::erase_range(storage_size_t address, storage_size_t size)
+{
+	if(overlapsBuffer(address, size) && !flush()) {
+		return false;
+	}
+
+	invalidate(address, size);
+	return mDevice.erase_range(address, size);
+}
+
+bool CachedDevice::sync()
+{
+	bool res = flush();
+	return mDevice.sync() && res;
+}
+
+void CachedDevice::invalidate()
+{
+	for(unsigned i = 0; i < mPageCount; ++i) {
+		mPages[i].valid = false;
+	}
+}
+
+void CachedDevice::invalidate(storage_size_t address, storage_size_t size)
+{
+	for(unsigned i = 0; i < mPageCount; ++i) {
+		auto& page = mPages[i];
+		if(page.valid && address < page.address + mPageSize && page.address < address + size) {
+			page.valid = false;
+		}
+	}
+}
+
+} // namespace Storage
@@ -0,0 +1,166 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * CachedDevice.h - Read cache and write combining for storage devices
+ *
+ ****/
+#pragma once
+
+#include "Device.h"
+#include <memory>
+
+namespace Storage
+{
+/**
+ * @brief Storage device wrapper providing a read cache and write combining
+ *
+ * Reads are serviced from an LRU cache of fixed-size pages, so repeated small reads
+ * of the same region (typical of filesystem metadata access) do not go to the medium.
+ * Requests larger than the entire cache bypass it to avoid evicting useful pages.
+ *
+ * Small sequential writes are collected in a buffer and passed to the device as a single write.
+ * The buffer is flushed when:
+ *
+ * - A write is not contiguous with the buffered data
+ * - A write would cross a buffer boundary (addresses aligned to the buffer size)
+ * - A read or erase overlaps the buffered data
+ * - `sync()` is called, or the device is destroyed
+ *
+ * Cached pages are invalidated when written or erased. They are reloaded from the device
+ * on next access, so flash semantics (bits can only be cleared by writes) are preserved.
+ *
+ * Partition entries are copied from the wrapped device on construction, so partitions obtained
+ * from this device (and any filesystem mounted on them) access storage via the cache.
+ * Do not write to the wrapped device directly whilst the cache is in use.
+ */
+class CachedDevice : public Device
+{
+public:
+	struct Stats {
+		uint32_t hits;		///< Page reads satisfied from cache
+		uint32_t misses;	///< Pages loaded from device
+		uint32_t bypassed;  ///< Large reads passed directly to device
+		uint32_t writes;	///< Write requests
+		uint32_t combined;  ///< Write requests merged into an existing buffer
+		uint32_t flushes;   ///< Writes issued to device
+		uint32_t evictions; ///< Valid pages discarded to make room for new ones
+	};
+
+	/**
+	 * @brief Construct a caching wrapper
+	 * @param device The device to cache
+	 * @param pageSize Size of a cache page in bytes, must be a power of 2
+	 * @param pageCount Number of pages in the read cache
+	 * @param writeBufferSize Size of write-combining buffer, a power of 2 or 0 to disable
+	 */
+	CachedDevice(Device& device, uint16_t pageSize = 512, uint8_t pageCount = 8, uint16_t writeBufferSize = 256);
+
+	~CachedDevice();
+
+	String getName() const override
+	{
+		return F("cached-") + mDevice.getName();
+	}
+
+	uint32_t getId() const override
+	{
+		return mDevice.getId();
+	}
+
+	size_t getBlockSize() const override
+	{
+		return mDevice.getBlockSize();
+	}
+
+	storage_size_t getSize() const override
+	{
+		return mDevice.getSize();
+	}
+
+	Type getType() const override
+	{
+		return mDevice.getType();
+	}
+
+	uint16_t getSectorSize() const override
+	{
+		return mDevice.getSectorSize();
+	}
+
+	storage_size_t getSectorCount() const override
+	{
+		return mDevice.getSectorCount();
+	}
+
+	bool read(storage_size_t address, void* dst, size_t size) override;
+	bool write(storage_size_t address, const void* src, size_t size) override;
+	bool erase_range(storage_size_t address, storage_size_t size) override;
+	bool sync() override;
+
+	/**
+	 * @brief Write out any buffered data without syncing the wrapped device
+	 */
+	bool flush();
+
+	/**
+	 * @brief Discard all cached pages
+	 * @note Buffered writes are not affected
+	 */
+	void invalidate();
+
+	/**
+	 * @brief Get the wrapped device
+	 */
+	Device& device() const
+	{
+		return mDevice;
+	}
+
+	const Stats& getStats() const
+	{
+		return mStats;
+	}
+
+	void resetStats()
+	{
+		mStats = {};
+	}
+
+private:
+	struct Page {
+		storage_size_t address;
+		uint32_t lastUse;
+		bool valid;
+	};
+
+	uint8_t* pageData(unsigned index)
+	{
+		return &mPageData[index * mPageSize];
+	}
+
+	int findPage(storage_size_t address) const;
+	int loadPage(storage_size_t address);
+	void invalidate(storage_size_t address, storage_size_t size);
+
+	bool overlapsBuffer(storage_size_t address, storage_size_t size) const
+	{
+		return mWriteLength != 0 && address < mWriteAddress + mWriteLength && mWriteAddress < address + size;
+	}
+
+	Device& mDevice;
+	std::unique_ptr<Page[]> mPages;
+	std::unique_ptr<uint8_t[]> mPageData;
+	std::unique_ptr<uint8_t[]> mWriteBuffer;
+	storage_size_t mWriteAddress{0};
+	uint16_t mWriteLength{0};
+	uint16_t mWriteBufferSize;
+	uint16_t mPageSize;
+	uint8_t mPageCount;
+	uint32_t mUseCounter{0};
+	Stats mStats{};
+};
+
+} // namespace Storage
@@ -11,6 +11,8 @@
  ****/
 
 #include "include/driver/SerialBuffer.h"
+#include <algorithm>
+#include <cstring>
 
 #ifdef ARCH_ESP32
 #include <esp_heap_caps.h>
@@ -43,6 +45,14 @@ int SerialBuffer::find(uint8_t c)
 	return -1;
 }
 
+void SerialBuffer::peekData(void* dest, size_t length)
+{
+	auto dst = static_cast<char*>(dest);
+	size_t n = std::min(length, size - readPos);
+	memcpy(dst, buffer + readPos, n);
+	memcpy(dst + n, buffer, length - n);
+}
+
 // Must be called with interrupts disabled
 size_t SerialBuffer::resize(size_t newSize)
 {
@@ -134,6 +134,13 @@ public:
 		return (wp < readPos) ? size - readPos : wp - readPos;
 	}
 
+	/** @brief Copy data from the buffer without removing it
+	 *  @param dest
+	 *  @param length MUST be <= available()
+	 *  @note Used where data wraps around the end of the buffer; otherwise use getReadData()
+	 */
+	void peekData(void* dest, size_t length);
+
 	/** @brief Skip a number of chars starting at the given read position
 	 *  @param length MUST be <= value returned from peek()
 	 *  @note Provided for efficient buffer access
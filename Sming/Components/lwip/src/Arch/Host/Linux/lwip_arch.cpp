@@ -192,6 +192,16 @@ bool lwip_arch_service()
 	return res > 0;
 }
 
+int lwip_arch_get_fd()
+{
+	/*
+	 * tapif keeps its state private, but it's just a structure whose first member is the device fd.
+	 * See contrib/ports/unix/port/netif/tapif.c.
+	 */
+	auto state = static_cast<const int*>(net_if.state);
+	return (state == nullptr) ? -1 : *state;
+}
+
 void lwip_arch_shutdown()
 {
 }
@@ -198,6 +198,11 @@ bool lwip_arch_service()
 	return true;
 }
 
+int lwip_arch_get_fd()
+{
+	return -1;
+}
+
 void lwip_arch_shutdown()
 {
 	/* release the pcap library... */
@@ -19,17 +19,35 @@
 
 #include "lwip_arch.h"
 #include "lwip/netif.h"
+#include <lwip/timeouts.h>
+#include <hostlib/threads.h>
+#include <hostlib/reactor.h>
 #include <SimpleTimer.h>
+#include <algorithm>
 
 namespace
 {
 SimpleTimer lwipServiceTimer;
 host_lwip_init_callback_t init_callback;
 
+int watchFd{-1};
+
 // Service stack more frequently when busy to ensure decent throughput
 constexpr unsigned activeInterval{2};
 constexpr unsigned inactiveInterval{100};
 
+/*
+ * Incoming packets are handled via the main thread reactor,
+ * so the timer is only required to run lwIP timeouts when they're due.
+ */
+void serviceTimeouts()
+{
+	sys_check_timeouts();
+	auto ms = sys_timeouts_sleeptime();
+	lwipServiceTimer.setIntervalMs(std::max(1U, std::min(unsigned(ms), inactiveInterval)));
+	lwipServiceTimer.startOnce();
+}
+
 } // namespace
 
 bool host_lwip_init(const struct lwip_param& param)
@@ -80,11 +98,18 @@ bool host_lwip_init(const struct lwip_param& param)
 		init_callback();
 	}
 
-	lwipServiceTimer.initializeMs(activeInterval, []() {
-		bool active = lwip_arch_service();
-		lwipServiceTimer.setIntervalMs(active ? activeInterval : inactiveInterval);
-		lwipServiceTimer.startOnce();
-	});
+	int fd = lwip_arch_get_fd();
+	if(fd >= 0 && host_thread_watch(
+					  fd, REACTOR_READ, [](void*, unsigned) { lwip_arch_service(); }, nullptr)) {
+		watchFd = fd;
+		lwipServiceTimer.initializeMs(activeInterval, serviceTimeouts);
+	} else {
+		lwipServiceTimer.initializeMs(activeInterval, []() {
+			bool active = lwip_arch_service();
+			lwipServiceTimer.setIntervalMs(active ? activeInterval : inactiveInterval);
+			lwipServiceTimer.startOnce();
+		});
+	}
 	lwipServiceTimer.startOnce();
 
 	return true;
@@ -93,6 +118,10 @@ bool host_lwip_init(const struct lwip_param& param)
 void host_lwip_shutdown()
 {
 	lwipServiceTimer.stop();
+	if(watchFd >= 0) {
+		host_thread_unwatch(watchFd);
+		watchFd = -1;
+	}
 	lwip_arch_shutdown();
 }
 
@@ -45,6 +45,12 @@ void lwip_arch_shutdown();
  */
 bool lwip_arch_service();
 
+/*
+ * Get file descriptor which becomes readable when packets arrive.
+ * Return -1 if not available, in which case the interface must be polled.
+ */
+int lwip_arch_get_fd();
+
 #ifdef __cplusplus
 }
 #endif
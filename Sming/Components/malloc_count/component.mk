@@ -12,6 +12,17 @@ ifeq ($(ENABLE_MALLOC_COUNT),1)
 
 COMPONENT_CXXFLAGS += -DENABLE_MALLOC_COUNT=1
 
+# Allocation profiler records caller, size and lifetime for every allocation
+COMPONENT_VARS += ENABLE_MALLOC_PROFILE
+ENABLE_MALLOC_PROFILE ?= 0
+ifeq ($(ENABLE_MALLOC_PROFILE),1)
+COMPONENT_VARS += MALLOC_PROFILE_SITES
+MALLOC_PROFILE_SITES ?= 256
+COMPONENT_CXXFLAGS += \
+	-DENABLE_MALLOC_PROFILE=1 \
+	-DMALLOC_PROFILE_SITES=$(MALLOC_PROFILE_SITES)
+endif
+
 # Hook all the memory allocation functions we need to monitor heap activity
 MC_WRAP_FUNCS := \
 	malloc \
@@ -30,8 +30,11 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <functional>
 
+class Print;
+
 namespace MallocCount
 {
 /**
@@ -93,4 +96,73 @@ void enableLogging(bool enable);
  */
 void setLogThreshold(size_t threshold);
 
+/**
+ * @name Allocation profiler
+ *
+ * Available when built with ENABLE_MALLOC_PROFILE=1.
+ * Each allocation records the return address of its caller and a timestamp,
+ * so activity can be attributed to the code responsible.
+ *
+ * @{
+ */
+
+/**
+ * @brief Statistics for all allocations made from one code location
+ * @note Lifetimes are in milliseconds, for blocks which have been freed
+ */
+struct SiteInfo {
+	const void* caller;		///< Return address of allocating call, nullptr for overflow entry
+	uint32_t allocCount;	///< Number of allocations
+	uint32_t freeCount;		///< Number of blocks freed
+	size_t totalBytes;		///< Cumulative bytes allocated
+	size_t currentBytes;	///< Bytes currently allocated
+	size_t peakBytes;		///< Maximum value of currentBytes
+	uint32_t totalLifetime; ///< Sum of lifetimes
+	uint32_t maxLifetime;	///< Longest lifetime
+};
+
+/**
+ * @brief Number of entries in size histogram
+ *
+ * Bucket 0 counts allocations of up to 8 bytes, bucket 1 up to 16 bytes, and so on.
+ * The last bucket counts everything larger.
+ */
+constexpr unsigned sizeHistogramBuckets{16};
+
+/**
+ * @brief Determine if the profiler is available
+ */
+bool isProfileEnabled();
+
+/**
+ * @brief Take a copy of profile statistics
+ * @param sites Buffer to receive entries
+ * @param maxSites Number of entries available in buffer
+ * @retval unsigned Number of entries copied, in order of caller address
+ * @note If there are more active sites than `maxSites` then those with the most allocations are returned.
+ */
+unsigned getProfile(SiteInfo* sites, unsigned maxSites);
+
+/**
+ * @brief Take a copy of the allocation size histogram
+ */
+void getSizeHistogram(uint32_t (&histogram)[sizeHistogramBuckets]);
+
+/**
+ * @brief Clear all profile statistics
+ * @note Blocks allocated before the reset are ignored when subsequently freed
+ */
+void resetProfile();
+
+/**
+ * @brief Print a snapshot of profile statistics
+ * @param p Where to print output
+ *
+ * Output is sorted by caller address so that two snapshots can be compared using `diff`.
+ * Use `addr2line` or the debugger to translate caller addresses into source locations.
+ */
+void printProfile(Print& p);
+
+/** @} */
+
 }; // namespace MallocCount
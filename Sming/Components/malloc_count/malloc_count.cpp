@@ -40,6 +40,11 @@
 #include "include/malloc_count.h"
 #include <debug_progmem.h>
 #include <esp_attr.h>
+#include <Print.h>
+#ifdef ENABLE_MALLOC_PROFILE
+#include <esp_systemapi.h>
+#include <algorithm>
+#endif
 
 // Names for the actual implementations
 #ifdef ARCH_ESP8266
@@ -77,9 +82,19 @@ size_t logThreshold{256};
 
 #ifdef ENABLE_MALLOC_COUNT
 
-/* to each allocation additional data is added for bookkeeping. due to
- * alignment requirements, we can optionally add more than just one integer. */
-constexpr size_t alignment{16}; /* bytes (>= 2*sizeof(size_t)) */
+/* bookkeeping data stored at the start of each allocation */
+struct BlockHeader {
+	size_t size;
+#ifdef ENABLE_MALLOC_PROFILE
+	uint32_t timestamp;	///< system_get_time() when allocated
+	uint16_t site;		 ///< Index into profile table
+	uint16_t generation; ///< Profile generation when allocated
+#endif
+};
+
+/* to each allocation additional data is added for bookkeeping: the header plus a sentinel.
+ * Round up to maintain alignment requirements. */
+constexpr size_t alignment{(sizeof(BlockHeader) + sizeof(size_t) + 15) & ~size_t(15)};
 
 /* a sentinel value prefixed to each allocation */
 constexpr size_t sentinel{0xDEADC0DE};
@@ -123,6 +138,77 @@ size_t allocationLimit{0};
 
 MallocCount::Callback userCallback;
 
+#ifdef ENABLE_MALLOC_PROFILE
+
+/*
+ * Callsite table uses open addressing, indexed by hash of caller address.
+ * The extra entry at the end collects allocations which don't fit.
+ */
+constexpr unsigned profileSiteCount{MALLOC_PROFILE_SITES};
+MallocCount::SiteInfo profileSites[profileSiteCount + 1];
+uint32_t sizeHistogram[MallocCount::sizeHistogramBuckets];
+uint16_t profileGeneration;
+
+uint16_t findSite(const void* caller)
+{
+	auto hash = uint32_t(uintptr_t(caller) >> 2) * 2654435761U;
+	for(unsigned i = 0; i < profileSiteCount; ++i) {
+		unsigned index = (hash + i) % profileSiteCount;
+		auto& site = profileSites[index];
+		if(site.caller == caller) {
+			return index;
+		}
+		if(site.caller == nullptr) {
+			site.caller = caller;
+			return index;
+		}
+	}
+	return profileSiteCount;
+}
+
+unsigned getSizeBucket(size_t size)
+{
+	unsigned bucket{0};
+	for(size_t limit = 8; size > limit && bucket < MallocCount::sizeHistogramBuckets - 1; limit <<= 1) {
+		++bucket;
+	}
+	return bucket;
+}
+
+void profileAlloc(BlockHeader& hdr, const void* caller)
+{
+	hdr.timestamp = system_get_time();
+	hdr.site = findSite(caller);
+	hdr.generation = profileGeneration;
+
+	auto& site = profileSites[hdr.site];
+	++site.allocCount;
+	site.totalBytes += hdr.size;
+	site.currentBytes += hdr.size;
+	if(site.currentBytes > site.peakBytes) {
+		site.peakBytes = site.currentBytes;
+	}
+	++sizeHistogram[getSizeBucket(hdr.size)];
+}
+
+void profileFree(const BlockHeader& hdr)
+{
+	if(hdr.generation != profileGeneration) {
+		return;
+	}
+
+	auto& site = profileSites[hdr.site];
+	++site.freeCount;
+	site.currentBytes -= hdr.size;
+	uint32_t lifetime = (system_get_time() - hdr.timestamp) / 1000;
+	site.totalLifetime += lifetime;
+	if(lifetime > site.maxLifetime) {
+		site.maxLifetime = lifetime;
+	}
+}
+
+#endif // ENABLE_MALLOC_PROFILE
+
 #ifdef ENABLE_MALLOC_COUNT
 
 /* add allocation to statistics */
@@ -211,13 +297,121 @@ void setCallback(Callback callback)
 	userCallback = std::move(callback);
 }
 
+#ifdef ENABLE_MALLOC_PROFILE
+
+bool isProfileEnabled()
+{
+	return true;
+}
+
+unsigned getProfile(SiteInfo* sites, unsigned maxSites)
+{
+	if(maxSites == 0) {
+		return 0;
+	}
+
+	// Heap with least active site at front, so busiest sites are kept if buffer is too small
+	auto lessActive = [](const SiteInfo& a, const SiteInfo& b) { return a.allocCount > b.allocCount; };
+	unsigned count{0};
+	for(auto& site : profileSites) {
+		if(site.allocCount == 0) {
+			continue;
+		}
+		if(count < maxSites) {
+			sites[count++] = site;
+			std::push_heap(sites, sites + count, lessActive);
+		} else if(site.allocCount > sites[0].allocCount) {
+			std::pop_heap(sites, sites + count, lessActive);
+			sites[count - 1] = site;
+			std::push_heap(sites, sites + count, lessActive);
+		}
+	}
+	std::sort(sites, sites + count, [](const SiteInfo& a, const SiteInfo& b) { return a.caller < b.caller; });
+	return count;
+}
+
+void getSizeHistogram(uint32_t (&histogram)[sizeHistogramBuckets])
+{
+	memcpy(histogram, sizeHistogram, sizeof(histogram));
+}
+
+void resetProfile()
+{
+	memset(profileSites, 0, sizeof(profileSites));
+	memset(sizeHistogram, 0, sizeof(sizeHistogram));
+	++profileGeneration;
+}
+
+void printProfile(Print& p)
+{
+	// Take a copy using real allocator so output doesn't disturb statistics
+	auto sites = static_cast<SiteInfo*>(REAL(F_MALLOC)(sizeof(profileSites)));
+	if(sites == nullptr) {
+		return;
+	}
+	unsigned count = getProfile(sites, profileSiteCount + 1);
+	uint32_t histogram[sizeHistogramBuckets];
+	getSizeHistogram(histogram);
+
+	p.printf("MC## profile: %u sites, current %u, peak %u, total %u, count %u\r\n", count, stats.current, stats.peak,
+			 stats.total, stats.count);
+	p.println(_F("caller,allocs,frees,current,peak,total,avg_life_ms,max_life_ms"));
+	for(unsigned i = 0; i < count; ++i) {
+		auto& site = sites[i];
+		auto avgLifetime = (site.freeCount == 0) ? 0 : site.totalLifetime / site.freeCount;
+		p.printf("%p,%u,%u,%u,%u,%u,%u,%u\r\n", site.caller, site.allocCount, site.freeCount, site.currentBytes,
+				 site.peakBytes, site.totalBytes, avgLifetime, site.maxLifetime);
+	}
+	REAL(F_FREE)(sites);
+
+	p.println(_F("size,count"));
+	for(unsigned i = 0; i < sizeHistogramBuckets; ++i) {
+		if(i + 1 < sizeHistogramBuckets) {
+			p.printf("<=%u,%u\r\n", 8U << i, histogram[i]);
+		} else {
+			p.printf(">%u,%u\r\n", 8U << (i - 1), histogram[i]);
+		}
+	}
+}
+
+#else
+
+bool isProfileEnabled()
+{
+	return false;
+}
+
+unsigned getProfile(SiteInfo*, unsigned)
+{
+	return 0;
+}
+
+void getSizeHistogram(uint32_t (&histogram)[sizeHistogramBuckets])
+{
+	memset(histogram, 0, sizeof(histogram));
+}
+
+void resetProfile()
+{
+}
+
+void printProfile(Print& p)
+{
+	p.println(_F("MC## profile not enabled"));
+}
+
+#endif // ENABLE_MALLOC_PROFILE
+
 #ifdef ENABLE_MALLOC_COUNT
 
 /****************************************************/
 /* malloc_count function implementations             */
 /****************************************************/
 
-extern "C" void* mc_malloc(size_t size)
+/*
+ * Callers pass their own return address so allocations are attributed to the calling code.
+ */
+static void* allocate(size_t size, [[maybe_unused]] const void* caller)
 {
 	if(size == 0) {
 		return nullptr;
@@ -237,7 +431,11 @@ extern "C" void* mc_malloc(size_t size)
 	}
 
 	/* prepend allocation size and check sentinel */
-	*static_cast<size_t*>(ret) = size;
+	auto hdr = static_cast<BlockHeader*>(ret);
+	hdr->size = size;
+#ifdef ENABLE_MALLOC_PROFILE
+	profileAlloc(*hdr, caller);
+#endif
 	ret = offsetPointer(ret, alignment);
 	*getSentinel(ret) = sentinel;
 
@@ -249,15 +447,25 @@ extern "C" void* mc_malloc(size_t size)
 	return ret;
 }
 
-extern "C" void* mc_zalloc(size_t size)
+static void* zallocate(size_t size, const void* caller)
 {
-	auto ptr = mc_malloc(size);
+	auto ptr = allocate(size, caller);
 	if(ptr != nullptr) {
 		memset(ptr, 0, size);
 	}
 	return ptr;
 }
 
+extern "C" void* mc_malloc(size_t size)
+{
+	return allocate(size, __builtin_return_address(0));
+}
+
+extern "C" void* mc_zalloc(size_t size)
+{
+	return zallocate(size, __builtin_return_address(0));
+}
+
 extern "C" void mc_free(void* ptr)
 {
 	// free(nullptr) is no operation
@@ -273,8 +481,12 @@ extern "C" void mc_free(void* ptr)
 		*p_sentinel = 0; // Clear sentinel to avoid false-positives
 		ptr = offsetPointer(ptr, -alignment);
 
-		size_t size = *static_cast<size_t*>(ptr);
+		auto hdr = static_cast<const BlockHeader*>(ptr);
+		size_t size = hdr->size;
 		dec_count(size);
+#ifdef ENABLE_MALLOC_PROFILE
+		profileFree(*hdr);
+#endif
 
 		if(size >= logThreshold) {
 			log("free(%p) -> %u (cur %u)", offsetPointer(ptr, alignment), size, stats.current);
@@ -286,11 +498,13 @@ extern "C" void mc_free(void* ptr)
 
 extern "C" void* mc_calloc(size_t nmemb, size_t size)
 {
-	return mc_zalloc(nmemb * size);
+	return zallocate(nmemb * size, __builtin_return_address(0));
 }
 
 extern "C" void* mc_realloc(void* ptr, size_t size)
 {
+	auto caller = __builtin_return_address(0);
+
 	// special case size == 0 -> free()
 	if(size == 0) {
 		mc_free(ptr);
@@ -299,7 +513,7 @@ extern "C" void* mc_realloc(void* ptr, size_t size)
 
 	// special case ptr == 0 -> malloc()
 	if(ptr == nullptr) {
-		return mc_malloc(size);
+		return allocate(size, caller);
 	}
 
 	if(*getSentinel(ptr) != sentinel) {
@@ -316,7 +530,8 @@ extern "C" void* mc_realloc(void* ptr, size_t size)
 
 	ptr = offsetPointer(ptr, -alignment);
 
-	size_t oldsize = *static_cast<size_t*>(ptr);
+	auto oldhdr = *static_cast<const BlockHeader*>(ptr);
+	size_t oldsize = oldhdr.size;
 
 	void* newptr = REAL(F_REALLOC)(ptr, alignment + size);
 
@@ -337,7 +552,15 @@ extern "C" void* mc_realloc(void* ptr, size_t size)
 		}
 	}
 
-	*static_cast<size_t*>(newptr) = size;
+	auto hdr = static_cast<BlockHeader*>(newptr);
+	hdr->size = size;
+#ifdef ENABLE_MALLOC_PROFILE
+	// Treat as a new allocation made by the caller
+	profileFree(oldhdr);
+	profileAlloc(*hdr, caller);
+#else
+	(void)caller;
+#endif
 
 	return offsetPointer(newptr, alignment);
 }
@@ -382,22 +605,22 @@ extern "C" void WRAP(vPortFree)(void*) __attribute__((alias("mc_free")));
 
 void* operator new(size_t size)
 {
-	return mc_malloc(size);
+	return allocate(size, __builtin_return_address(0));
 }
 
 void* operator new(size_t size, const std::nothrow_t&) noexcept
 {
-	return mc_malloc(size);
+	return allocate(size, __builtin_return_address(0));
 }
 
 void* operator new[](size_t size)
 {
-	return mc_malloc(size);
+	return allocate(size, __builtin_return_address(0));
 }
 
 void* operator new[](size_t size, const std::nothrow_t&) noexcept
 {
-	return mc_malloc(size);
+	return allocate(size, __builtin_return_address(0));
 }
 
 void operator delete(void* ptr)
@@ -429,7 +652,7 @@ void operator delete[](void* ptr, size_t)
 extern "C" char* WRAP(strdup)(const char* s)
 {
 	auto len = strlen(s) + 1;
-	auto dup = static_cast<char*>(mc_malloc(len));
+	auto dup = static_cast<char*>(allocate(len, __builtin_return_address(0)));
 	memcpy(dup, s, len);
 	return dup;
 }
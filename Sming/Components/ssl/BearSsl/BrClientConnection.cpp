@@ -55,7 +55,15 @@ int BrClientConnection::init()
 
 	br_ssl_client_set_default_rsapub(&clientContext);
 	br_ssl_engine_set_x509(getEngine(), x509);
-	if(!br_ssl_client_reset(&clientContext, context.session.hostName.c_str(), 0)) {
+	// Restore parameters from session cache to attempt abbreviated handshake
+	auto& params = context.session.getSessionParameters();
+	bool resume = (params.length() == sizeof(br_ssl_session_parameters));
+	if(resume) {
+		br_ssl_engine_set_session_parameters(getEngine(),
+											 reinterpret_cast<const br_ssl_session_parameters*>(params.c_str()));
+	}
+
+	if(!br_ssl_client_reset(&clientContext, context.session.hostName.c_str(), resume)) {
 		debug_e("br_ssl_client_reset failed");
 		return getLastError();
 	}
@@ -49,6 +49,16 @@ public:
 		return id;
 	}
 
+	String getSessionParameters() const override
+	{
+		String params;
+		if(handshakeDone && params.setLength(sizeof(br_ssl_session_parameters))) {
+			br_ssl_engine_get_session_parameters(getEngine(),
+												 reinterpret_cast<br_ssl_session_parameters*>(params.begin()));
+		}
+		return params;
+	}
+
 	bool isHandshakeDone() const override
 	{
 		return handshakeDone;
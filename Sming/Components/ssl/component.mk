@@ -32,6 +32,13 @@ ifeq ($(SSL_DEBUG),1)
 	COMPONENT_CXXFLAGS	+= -DSSL_DEBUG=1
 endif
 
+COMPONENT_VARS			+= SSL_SESSION_CACHE_SIZE SSL_SESSION_CACHE_TTL
+SSL_SESSION_CACHE_SIZE	?= 4
+SSL_SESSION_CACHE_TTL	?= 3600
+COMPONENT_CXXFLAGS		+= \
+	-DSSL_SESSION_CACHE_SIZE=$(SSL_SESSION_CACHE_SIZE) \
+	-DSSL_SESSION_CACHE_TTL=$(SSL_SESSION_CACHE_TTL)
+
 # Prints SSL status when App gets built
 CUSTOM_TARGETS			+= check-ssl
 .PHONY:check-ssl
@@ -83,6 +83,16 @@ public:
 	 */
 	virtual SessionId getSessionId() const = 0;
 
+	/**
+	 * @brief Gets any additional data required to resume the current session.
+	 *        Should be called after handshake.
+	 * @retval String Opaque adapter-specific data, stored with the session ID in the session cache
+	 */
+	virtual String getSessionParameters() const
+	{
+		return nullptr;
+	}
+
 	/**
 	 * @brief Gets the certificate object.
 	 *        That object MUST be owned by the Connection implementation
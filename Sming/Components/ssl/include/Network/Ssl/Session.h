@@ -13,6 +13,7 @@
 #include "Context.h"
 #include "KeyCertPair.h"
 #include "ValidatorList.h"
+#include "SessionCache.h"
 #include <Platform/System.h>
 #include <memory>
 
@@ -133,6 +134,24 @@ public:
 		return sessionId.get();
 	}
 
+	/**
+	 * @brief Get adapter-specific parameters for resuming a cached client session
+	 * @retval String Empty if there is no cached session to resume
+	 * @note Used by SSL adapters when creating a client connection
+	 */
+	const String& getSessionParameters() const
+	{
+		return sessionParameters;
+	}
+
+	/**
+	 * @brief Determine if the handshake resumed a previous session
+	 */
+	bool isResumed() const
+	{
+		return resumed;
+	}
+
 	/**
 	 * @brief Called when a client connection is made via server TCP socket
 	 * @param client The client TCP socket
@@ -226,7 +245,10 @@ private:
 	std::unique_ptr<Context> context;
 	std::unique_ptr<Connection> connection;
 	std::unique_ptr<SessionId> sessionId;
+	String sessionParameters;
+	String cacheKey; ///< Identifies client session in sessionCache
 	CpuFrequency curFreq = CpuFrequency(0);
+	bool resumed{false};
 };
 
 }; // namespace Ssl
@@ -0,0 +1,169 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * SessionCache.h
+ *
+ ****/
+
+#pragma once
+
+#include "SessionId.h"
+#include <Printable.h>
+#include <memory>
+
+struct tcp_pcb;
+
+#ifndef SSL_SESSION_CACHE_SIZE
+/**
+ * @brief Default number of client sessions to cache for resumption
+ */
+#define SSL_SESSION_CACHE_SIZE 4
+#endif
+
+#ifndef SSL_SESSION_CACHE_TTL
+/**
+ * @brief Default time in seconds for which a cached client session is offered for resumption
+ */
+#define SSL_SESSION_CACHE_TTL 3600
+#endif
+
+namespace Ssl
+{
+/**
+ * @brief Process-wide cache of client sessions, used to abbreviate subsequent handshakes
+ *
+ * When a client handshake completes the session ID and any adapter-specific parameters
+ * (such as the master secret) are stored, keyed by remote address and SNI host name.
+ * The next client connection to the same server offers the cached session, and if the
+ * server agrees the certificate exchange and key agreement are skipped.
+ *
+ * Entries expire after a configurable time, and the least recently used entry is discarded
+ * when the cache is full.
+ * Only sessions which completed a successful handshake (including certificate validation) are cached,
+ * and only where the adapter provides the parameters needed to restore them in a new context.
+ */
+class SessionCache : public Printable
+{
+public:
+	struct Entry {
+		String key;
+		SessionId id;
+		String parameters; ///< Adapter-specific data required to resume the session
+		uint32_t created;  ///< millis() when stored
+		uint32_t lastUse;  ///< Use counter value when last stored or offered
+	};
+
+	struct Stats {
+		uint32_t lookups;   ///< Client handshakes started (calls to find)
+		uint32_t offered;   ///< Handshakes where a cached session was offered to the server
+		uint32_t resumed;   ///< Handshakes where the server accepted the cached session
+		uint32_t evictions; ///< Valid entries discarded to make room for new ones
+	};
+
+	/**
+	 * @brief Construct a session cache
+	 * @param maxEntries Maximum number of sessions to store, 0 to disable caching
+	 * @param ttl Lifetime of an entry in seconds
+	 */
+	SessionCache(uint8_t maxEntries, uint32_t ttl) : maxEntries(maxEntries), ttl(ttl)
+	{
+	}
+
+	/**
+	 * @brief Change cache limits
+	 * @note Existing entries are discarded
+	 */
+	void setLimits(uint8_t maxEntries, uint32_t ttl);
+
+	bool isEnabled() const
+	{
+		return maxEntries != 0;
+	}
+
+	/**
+	 * @brief Build the key used to identify a server
+	 * @param tcp Client connection
+	 * @param hostName Name sent to server for SNI
+	 */
+	static String getKey(const tcp_pcb* tcp, const String& hostName);
+
+	/**
+	 * @brief Look up a session for resumption
+	 * @param key
+	 * @retval const Entry* nullptr if no valid entry exists
+	 * @note Expired entries are removed. Each call counts as a lookup in the statistics.
+	 */
+	const Entry* find(const String& key);
+
+	/**
+	 * @brief Store a session following successful handshake
+	 */
+	void store(const String& key, const SessionId& id, const String& parameters);
+
+	/**
+	 * @brief Discard a session, for example after a failed handshake
+	 */
+	void remove(const String& key);
+
+	/**
+	 * @brief Discard all sessions
+	 */
+	void clear();
+
+	/**
+	 * @brief Get number of sessions currently cached
+	 */
+	unsigned count() const;
+
+	/**
+	 * @brief Called by Session when the server has accepted a cached session
+	 */
+	void recordResumed()
+	{
+		++stats.resumed;
+	}
+
+	const Stats& getStats() const
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = {};
+	}
+
+	/**
+	 * @brief Get proportion of client handshakes which were resumed, as a percentage
+	 */
+	unsigned getHitRate() const
+	{
+		return stats.lookups ? (stats.resumed * 100U / stats.lookups) : 0;
+	}
+
+	size_t printTo(Print& p) const override;
+
+private:
+	Entry* findEntry(const String& key);
+
+	bool isExpired(const Entry& entry, uint32_t now) const
+	{
+		return now - entry.created >= ttl * 1000U;
+	}
+
+	std::unique_ptr<Entry[]> entries;
+	uint8_t maxEntries;
+	uint32_t ttl;
+	uint32_t useCounter{0};
+	Stats stats{};
+};
+
+/**
+ * @brief Client session cache consulted by all SSL adapters
+ */
+extern SessionCache sessionCache;
+
+} // namespace Ssl
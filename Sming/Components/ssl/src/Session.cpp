@@ -90,6 +90,26 @@ bool Session::onConnect(tcp_pcb* tcp)
 		return false;
 	}
 
+	// Offer a cached session from any previous connection to this server
+	resumed = false;
+	sessionParameters = nullptr;
+	cacheKey = nullptr;
+	if(!options.sessionResume) {
+		sessionId.reset();
+	}
+	if(sessionCache.isEnabled()) {
+		cacheKey = SessionCache::getKey(tcp, hostName);
+		auto entry = sessionCache.find(cacheKey);
+		// Session ID alone is no use to a new context as it has no master secret
+		if(entry != nullptr && entry->parameters.length() != 0) {
+			if(!sessionId) {
+				sessionId = std::make_unique<SessionId>();
+			}
+			*sessionId = entry->id;
+			sessionParameters = entry->parameters;
+		}
+	}
+
 	if(sessionId && sessionId->isValid()) {
 		debug_d("-----BEGIN SSL SESSION PARAMETERS-----");
 		debug_d("SessionId: %s", toString(*sessionId).c_str());
@@ -197,17 +217,41 @@ void Session::handshakeComplete(bool success)
 	endHandshake();
 
 	if(success) {
+		auto id = connection->getSessionId();
+
+		// Server echoes the offered session ID if it agrees to resume
+		if(sessionId && sessionId->isValid() && id.getLength() == sessionId->getLength() &&
+		   memcmp(id.getValue(), sessionId->getValue(), id.getLength()) == 0) {
+			debug_d("SSL: Session resumed");
+			resumed = true;
+			if(cacheKey) {
+				sessionCache.recordResumed();
+			}
+		}
+
+		// Only cache sessions which the adapter is able to restore
+		auto parameters = connection->getSessionParameters();
+		if(cacheKey && parameters.length() != 0) {
+			sessionCache.store(cacheKey, id, parameters);
+		}
+
 		// If requested, take a copy of the session ID for later re-use
 		if(options.sessionResume) {
 			if(!sessionId) {
 				sessionId = std::make_unique<SessionId>();
 			}
-			*sessionId = connection->getSessionId();
+			*sessionId = id;
 		}
 	} else {
 		debug_w("SSL Handshake failed");
+		// Don't offer the same session again in case it caused the failure
+		if(cacheKey) {
+			sessionCache.remove(cacheKey);
+		}
 	}
 
+	sessionParameters = nullptr;
+
 	if(options.freeKeyCertAfterHandshake && connection) {
 		connection->freeCertificate();
 	}
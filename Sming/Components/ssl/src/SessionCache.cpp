@@ -0,0 +1,168 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * SessionCache.cpp
+ *
+ ****/
+
+#include <SslDebug.h>
+#include <Network/Ssl/SessionCache.h>
+#include <IpAddress.h>
+#include <Clock.h>
+#include <Print.h>
+#include <lwip/tcp.h>
+
+namespace Ssl
+{
+SessionCache sessionCache(SSL_SESSION_CACHE_SIZE, SSL_SESSION_CACHE_TTL);
+
+void SessionCache::setLimits(uint8_t maxEntries, uint32_t ttl)
+{
+	entries.reset();
+	this->maxEntries = maxEntries;
+	this->ttl = ttl;
+}
+
+String SessionCache::getKey(const tcp_pcb* tcp, const String& hostName)
+{
+	String key = IpAddress(tcp->remote_ip).toString();
+	key += ':';
+	key += tcp->remote_port;
+	key += '/';
+	key += hostName;
+	return key;
+}
+
+SessionCache::Entry* SessionCache::findEntry(const String& key)
+{
+	if(!entries) {
+		return nullptr;
+	}
+	for(unsigned i = 0; i < maxEntries; ++i) {
+		auto& entry = entries[i];
+		if(entry.key == key) {
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+const SessionCache::Entry* SessionCache::find(const String& key)
+{
+	++stats.lookups;
+
+	auto entry = findEntry(key);
+	if(entry == nullptr) {
+		return nullptr;
+	}
+
+	auto now = millis();
+	if(isExpired(*entry, now)) {
+		debug_d("[SSL] Cached session for '%s' expired", key.c_str());
+		*entry = Entry{};
+		return nullptr;
+	}
+
+	entry->lastUse = ++useCounter;
+	++stats.offered;
+	return entry;
+}
+
+void SessionCache::store(const String& key, const SessionId& id, const String& parameters)
+{
+	if(maxEntries == 0 || !key || !id.isValid()) {
+		return;
+	}
+
+	if(!entries) {
+		entries.reset(new Entry[maxEntries]);
+		if(!entries) {
+			return;
+		}
+	}
+
+	// Replace existing entry, or use an empty slot, or evict least recently used
+	auto now = millis();
+	auto entry = findEntry(key);
+	if(entry == nullptr) {
+		entry = &entries[0];
+		for(unsigned i = 0; i < maxEntries; ++i) {
+			auto& e = entries[i];
+			if(!e.key || isExpired(e, now)) {
+				entry = &e;
+				break;
+			}
+			if(e.lastUse < entry->lastUse) {
+				entry = &e;
+			}
+		}
+		if(entry->key && !isExpired(*entry, now)) {
+			debug_d("[SSL] Evicting cached session for '%s'", entry->key.c_str());
+			++stats.evictions;
+		}
+	}
+
+	entry->key = key;
+	entry->id = id;
+	entry->parameters = parameters;
+	entry->created = now;
+	entry->lastUse = ++useCounter;
+}
+
+void SessionCache::remove(const String& key)
+{
+	auto entry = findEntry(key);
+	if(entry != nullptr) {
+		*entry = Entry{};
+	}
+}
+
+void SessionCache::clear()
+{
+	entries.reset();
+}
+
+unsigned SessionCache::count() const
+{
+	if(!entries) {
+		return 0;
+	}
+	unsigned n{0};
+	auto now = millis();
+	for(unsigned i = 0; i < maxEntries; ++i) {
+		auto& entry = entries[i];
+		if(entry.key && !isExpired(entry, now)) {
+			++n;
+		}
+	}
+	return n;
+}
+
+size_t SessionCache::printTo(Print& p) const
+{
+	size_t n = 0;
+
+	n += p.println(_F("SSL Session Cache:"));
+	n += p.print(_F("  Entries: "));
+	n += p.print(count());
+	n += p.print('/');
+	n += p.println(maxEntries);
+	n += p.print(_F("  Lookups: "));
+	n += p.println(stats.lookups);
+	n += p.print(_F("  Offered: "));
+	n += p.println(stats.offered);
+	n += p.print(_F("  Resumed: "));
+	n += p.println(stats.resumed);
+	n += p.print(_F("  Evictions: "));
+	n += p.println(stats.evictions);
+	n += p.print(_F("  Hit rate: "));
+	n += p.print(getHitRate());
+	n += p.println('%');
+
+	return n;
+}
+
+} // namespace Ssl
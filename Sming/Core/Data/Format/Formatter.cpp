@@ -50,6 +50,35 @@ char escapeChar(char c, Options options)
 	}
 }
 
+unsigned escapeControl(char c, Options options, char* buffer)
+{
+	auto out = buffer;
+	auto esc = escapeChar(c, options);
+	if(esc) {
+		*out++ = '\\';
+		c = esc;
+	} else if(options[Option::unicode]) {
+		if(uint8_t(c) < 0x20) {
+			*out++ = '\\';
+			*out++ = 'u';
+			*out++ = '0';
+			*out++ = '0';
+			*out++ = hexchar(uint8_t(c) >> 4);
+			c = hexchar(uint8_t(c) & 0x0f);
+		}
+	} else if(uint8_t(c) < 0x20) {
+		*out++ = '\\';
+		*out++ = 'x';
+		*out++ = hexchar(uint8_t(c) >> 4);
+		c = hexchar(uint8_t(c) & 0x0f);
+	} else if((c & 0x80) && options[Option::utf8]) {
+		*out++ = 0xc0 | (uint8_t(c) >> 6);
+		c = 0x80 | (c & 0x3f);
+	}
+	*out++ = c;
+	return out - buffer;
+}
+
 unsigned escapeControls(String& value, Options options)
 {
 	// Count number of extra characters we'll need to insert
@@ -80,30 +109,7 @@ unsigned escapeControls(String& value, Options options)
 	memmove(out + extra, in, len);
 	in += extra;
 	while(len--) {
-		uint8_t c = *in++;
-		auto esc = escapeChar(c, options);
-		if(esc) {
-			*out++ = '\\';
-			c = esc;
-		} else if(options[Option::unicode]) {
-			if(uint8_t(c) < 0x20) {
-				*out++ = '\\';
-				*out++ = 'u';
-				*out++ = '0';
-				*out++ = '0';
-				*out++ = hexchar(uint8_t(c) >> 4);
-				c = hexchar(uint8_t(c) & 0x0f);
-			}
-		} else if(uint8_t(c) < 0x20) {
-			*out++ = '\\';
-			*out++ = 'x';
-			*out++ = hexchar(uint8_t(c) >> 4);
-			c = hexchar(uint8_t(c) & 0x0f);
-		} else if((c & 0x80) && options[Option::utf8]) {
-			*out++ = 0xc0 | (c >> 6);
-			c = 0x80 | (c & 0x3f);
-		}
-		*out++ = c;
+		out += escapeControl(*in++, options, out);
 	}
 	return extra;
 }
@@ -35,6 +35,20 @@ using Options = BitSet<uint8_t, Option, 5>;
  */
 unsigned escapeControls(String& value, Options options);
 
+/**
+ * @brief Maximum number of characters produced by `escapeControl()`
+ */
+constexpr unsigned maxEscapeLength{6};
+
+/**
+ * @brief Escape a single character as for `escapeControls()`
+ * @param c Character to escape
+ * @param options
+ * @param buffer Output, must have space for at least `maxEscapeLength` characters
+ * @retval unsigned Number of characters written (1 if no escaping was required)
+ */
+unsigned escapeControl(char c, Options options, char* buffer);
+
 /**
  * @brief Virtual class to perform format-specific String adjustments
  */
@@ -30,6 +30,24 @@ void Json::escape(String& value) const
 	escapeControls(value, Option::unicode | Option::doublequote | Option::backslash);
 }
 
+size_t Json::escape(const char* src, size_t srcLength, char* dst, size_t dstSize, size_t& consumed) const
+{
+	const Options options = Option::unicode | Option::doublequote | Option::backslash;
+	char buf[maxEscapeLength];
+	size_t written{0};
+	consumed = 0;
+	while(consumed < srcLength) {
+		auto len = escapeControl(src[consumed], options, buf);
+		if(written + len > dstSize) {
+			break;
+		}
+		memcpy(&dst[written], buf, len);
+		written += len;
+		++consumed;
+	}
+	return written;
+}
+
 void Json::quote(String& value) const
 {
 	escape(value);
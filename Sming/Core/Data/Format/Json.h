@@ -22,6 +22,19 @@ public:
 	void escape(String& value) const override;
 	void quote(String& value) const override;
 
+	/**
+	 * @brief Escape text incrementally, without requiring the whole value in memory
+	 * @param src Text to escape
+	 * @param srcLength Number of characters in src
+	 * @param dst Output buffer
+	 * @param dstSize Space available in dst
+	 * @param consumed On return, number of characters from src which were processed
+	 * @retval size_t Number of characters written to dst
+	 * @note An escape sequence is never split: if there's insufficient space then
+	 * the character is left for the next call.
+	 */
+	size_t escape(const char* src, size_t srcLength, char* dst, size_t dstSize, size_t& consumed) const;
+
 	MimeType mimeType() const override
 	{
 		return MIME_JSON;
@@ -13,6 +13,7 @@
 #pragma once
 
 #include "WVector.h"
+#include "KeyHash.h"
 #include <memory>
 
 /**
@@ -44,10 +45,17 @@
  *	}
  * 	```
  *
+ * For larger maps, call `enableHashing()` so keys are located via a hash index instead of a linear search.
  */
 template <typename K, typename V> class ObjectMap
 {
 public:
+	/**
+	 * @brief Compute hash for a key
+	 * @see See `KeyHash` for default implementations
+	 */
+	using Hasher = uint32_t (*)(const K&);
+
 	ObjectMap() = default;
 
 	~ObjectMap()
@@ -206,11 +214,23 @@ public:
 	 */
 	void set(const K& key, V* value)
 	{
-		int i = entries.indexOf(key);
+		uint32_t hash{0};
+		int i;
+		if(hasher) {
+			hash = hasher(key);
+			i = findIndex(key, hash);
+		} else {
+			i = entries.indexOf(key);
+		}
 		if(i >= 0) {
 			entries[i].value.reset(value);
-		} else {
-			entries.addElement(new Entry(key, value));
+			return;
+		}
+		if(!entries.addElement(new Entry(key, value))) {
+			return;
+		}
+		if(hasher && !hashIndex.add(hash, entries.count() - 1)) {
+			disableHashing();
 		}
 	}
 
@@ -222,7 +242,7 @@ public:
 	 */
 	V* find(const K& key) const
 	{
-		int index = entries.indexOf(key);
+		int index = indexOf(key);
 		return (index < 0) ? nullptr : entries[index].value.get();
 	}
 
@@ -233,7 +253,7 @@ public:
 	 */
 	int indexOf(const K& key) const
 	{
-		return entries.indexOf(key);
+		return hasher ? findIndex(key, hasher(key)) : entries.indexOf(key);
 	}
 
 	/**
@@ -243,7 +263,7 @@ public:
 	 */
 	bool contains(const K& key) const
 	{
-		return entries.contains(key);
+		return indexOf(key) >= 0;
 	}
 
 	/**
@@ -252,6 +272,7 @@ public:
 	 */
 	void removeAt(unsigned index)
 	{
+		unindex(index);
 		entries.remove(index);
 	}
 
@@ -293,6 +314,7 @@ public:
 		std::unique_ptr<V> value;
 		if(index < entries.count()) {
 			entries[index].value.swap(value);
+			unindex(index);
 			entries.remove(index);
 		}
 		return value.release();
@@ -304,6 +326,40 @@ public:
 	void clear()
 	{
 		entries.clear();
+		hashIndex.clear();
+	}
+
+	/**
+	 * @brief Enable hashed key lookups
+	 * @param hasher Function to compute key hash
+	 * @retval bool false on memory allocation failure, in which case the map reverts to linear searching
+	 * @see `HashMap::enableHashing()`
+	 */
+	bool enableHashing(Hasher hasher = KeyHash<K>::hash)
+	{
+		this->hasher = hasher;
+		hashIndex.clear();
+		for(unsigned i = 0; i < entries.count(); ++i) {
+			if(!hashIndex.add(hasher(entries[i].key), i)) {
+				disableHashing();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Revert to linear key searching and release the hash index
+	 */
+	void disableHashing()
+	{
+		hasher = nullptr;
+		hashIndex.clear();
+	}
+
+	bool isHashed() const
+	{
+		return hasher != nullptr;
 	}
 
 protected:
@@ -326,8 +382,22 @@ protected:
 	};
 
 	Vector<Entry> entries;
+	Hasher hasher{nullptr};
+	wiring_private::HashIndex hashIndex;
 
 private:
+	int findIndex(const K& key, uint32_t hash) const
+	{
+		return hashIndex.find(hash, [&](unsigned index) { return entries[index].key == key; });
+	}
+
+	void unindex(unsigned index)
+	{
+		if(hasher && index < entries.count()) {
+			hashIndex.remove(hasher(entries[index].key), index);
+		}
+	}
+
 	// Copy constructor unsafe, so prevent access
 	ObjectMap(ObjectMap<K, V>& that);
 };
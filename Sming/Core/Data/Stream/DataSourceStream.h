@@ -14,6 +14,7 @@
 #include <WString.h>
 #include "SeekOrigin.h"
 #include "../WebConstants.h"
+#include <memory>
 
 /** @defgroup   stream Stream functions
  *  @brief      Data stream classes
@@ -38,6 +39,23 @@ enum StreamType {
 	eSST_Unknown		 ///< Unknown data stream type
 };
 
+/**
+ * @brief Describes a block of stream content which may be accessed directly
+ * @ingroup stream
+ */
+struct StreamRegion {
+	const char* data{nullptr}; ///< Start of readable content
+	size_t length{0};		   ///< Number of bytes available at `data`
+	/**
+	 * @brief Keeps memory valid whilst a reference is held
+	 *
+	 * Empty if the content is permanent, such as constant data in memory-mapped flash.
+	 * Otherwise, content remains valid for as long as a copy of this pointer is retained,
+	 * even if the stream itself is destroyed.
+	 */
+	std::shared_ptr<const void> owner;
+};
+
 /**
  * @brief Base class for read-only stream
  * @ingroup stream
@@ -110,6 +128,23 @@ public:
 		return seekFrom(len, SeekOrigin::Current) >= 0;
 	}
 
+	/**
+	 * @brief Get direct access to content at the current read position
+	 * @param region On success, describes the content
+	 * @retval bool true on success, false if the stream does not support direct access
+	 *
+	 * This allows stream content to be passed to consumers, such as the TCP stack, without copying.
+	 * The read position is not changed; call `seek()` to consume data.
+	 *
+	 * Region content must not change whilst `region.owner` is held.
+	 * Streams which cannot guarantee this must not override this method.
+	 */
+	virtual bool getReadRegion(StreamRegion& region)
+	{
+		(void)region;
+		return false;
+	}
+
 	/** @brief  Check if all data has been read
      *  @retval bool True on success.
      */
@@ -18,4 +18,35 @@
  * @brief Provides a read-only stream buffer on flash storage
  * @ingroup stream
  */
-using FlashMemoryStream = FSTR::Stream;
+class FlashMemoryStream : public FSTR::Stream
+{
+public:
+	FlashMemoryStream(const FSTR::ObjectBase& object) : FSTR::Stream(object), object(object)
+	{
+	}
+
+	/**
+	 * @note Only supported where flash is memory-mapped with byte access, and may be read by network drivers.
+	 * Esp8266 requires aligned access and Esp32 wifi cannot transmit directly from flash.
+	 */
+	bool getReadRegion(StreamRegion& region) override
+	{
+#if defined(ARCH_HOST) || defined(ARCH_RP2040)
+		auto pos = seekFrom(0, SeekOrigin::Current);
+		auto size = object.size();
+		if(pos < 0 || size_t(pos) > size) {
+			return false;
+		}
+		region.data = reinterpret_cast<const char*>(object.data()) + pos;
+		region.length = size - pos;
+		region.owner.reset();
+		return true;
+#else
+		(void)region;
+		return false;
+#endif
+	}
+
+private:
+	const FSTR::ObjectBase& object;
+};
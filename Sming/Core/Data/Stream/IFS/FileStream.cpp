@@ -9,6 +9,7 @@
  ****/
 
 #include "FileStream.h"
+#include <Data/HexString.h>
 
 namespace IFS
 {
@@ -164,6 +165,12 @@ String FileStream::id() const
 		return 0;
 	}
 
+	uint8_t hash[16];
+	int len = fs->fgetxattr(handle, contentHashTag, hash, sizeof(hash));
+	if(len > 0) {
+		return makeHexString(hash, std::min(len, int(sizeof(hash))));
+	}
+
 	Stat stat;
 	int res = fs->fstat(handle, stat);
 	if(res < 0) {
@@ -13,6 +13,13 @@
 #include "../ReadWriteStream.h"
 #include <IFS/FsBase.h>
 
+#ifndef FILESTREAM_HASH_ATTRIBUTE
+/**
+ * @brief Index of user attribute which may contain a hash of the file content
+ */
+#define FILESTREAM_HASH_ATTRIBUTE 0xF0
+#endif
+
 namespace IFS
 {
 /**
@@ -24,6 +31,16 @@ class FileStream : public FsBase, public ReadWriteStream
 public:
 	using FsBase::FsBase;
 
+	/**
+	 * @brief Attribute tag for optional content hash
+	 *
+	 * Applications (or build tools) may store a hash of the file content in this attribute,
+	 * for example using `File::setAttribute()`. Any size may be used, but only the first
+	 * 16 bytes are significant. Keep it short for filesystems with limited metadata space, such as SPIFFS.
+	 */
+	static constexpr AttributeTag contentHashTag{
+		AttributeTag(unsigned(AttributeTag::User) + FILESTREAM_HASH_ATTRIBUTE)};
+
 	~FileStream()
 	{
 		close();
@@ -123,6 +140,12 @@ public:
 		return size - pos;
 	}
 
+	/**
+	 * @brief Get a unique identifier for the file content, suitable for use as an HTTP ETag
+	 *
+	 * If the file has a `contentHashTag` attribute then this is used.
+	 * Otherwise the identifier is derived from file ID, size and modification time.
+	 */
 	String id() const override;
 
 	/** @brief Reduce the file size
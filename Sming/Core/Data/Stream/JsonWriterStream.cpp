@@ -0,0 +1,254 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * JsonWriterStream.cpp
+ *
+ ****/
+
+#include "JsonWriterStream.h"
+#include <Data/Format/Json.h>
+#include <debug_progmem.h>
+#include <algorithm>
+
+namespace
+{
+// Amount of value stream content to read and escape in one go
+constexpr size_t streamChunkSize{64};
+} // namespace
+
+void JsonWriterStream::write(const char* data, size_t length)
+{
+	if(valueStream) {
+		debug_e("[JSON] Cannot write whilst value stream is pending");
+		return;
+	}
+	if(!buffer.concat(data, length)) {
+		debug_e("[JSON] Out of memory");
+		return;
+	}
+	peakBufferLength = std::max(peakBufferLength, buffer.length() - readPos);
+}
+
+void JsonWriterStream::writeEscaped(const char* text, size_t length)
+{
+	char buf[streamChunkSize];
+	while(length != 0) {
+		size_t consumed;
+		auto len = Format::json.escape(text, length, buf, sizeof(buf), consumed);
+		write(buf, len);
+		text += consumed;
+		length -= consumed;
+	}
+}
+
+bool JsonWriterStream::beginValue()
+{
+	if(afterKey) {
+		afterKey = false;
+		return true;
+	}
+
+	if(depth == 0) {
+		return true;
+	}
+
+	auto mask = 1U << (depth - 1);
+	if(objectBits & mask) {
+		debug_e("[JSON] Object value requires key");
+		return false;
+	}
+	if(itemBits & mask) {
+		write(',');
+	}
+	itemBits |= mask;
+	return true;
+}
+
+JsonWriterStream& JsonWriterStream::beginContainer(char c, bool isObject)
+{
+	if(depth >= maxDepth) {
+		debug_e("[JSON] Nesting too deep");
+		return *this;
+	}
+	if(!beginValue()) {
+		return *this;
+	}
+	write(c);
+	auto mask = 1U << depth;
+	if(isObject) {
+		objectBits |= mask;
+	} else {
+		objectBits &= ~mask;
+	}
+	itemBits &= ~mask;
+	++depth;
+	return *this;
+}
+
+JsonWriterStream& JsonWriterStream::endContainer(char c)
+{
+	if(depth == 0) {
+		debug_e("[JSON] Unbalanced '%c'", c);
+		return *this;
+	}
+	bool isObject = objectBits & (1U << (depth - 1));
+	if(isObject != (c == '}')) {
+		debug_e("[JSON] Mismatched '%c'", c);
+		return *this;
+	}
+	if(afterKey) {
+		// Keep document valid
+		debug_e("[JSON] Key has no value");
+		null();
+	}
+	--depth;
+	write(c);
+	return *this;
+}
+
+JsonWriterStream& JsonWriterStream::key(const String& name)
+{
+	auto mask = (depth == 0) ? 0 : 1U << (depth - 1);
+	if(!(objectBits & mask) || afterKey) {
+		debug_e("[JSON] Key '%s' not valid here", name.c_str());
+		return *this;
+	}
+	if(itemBits & mask) {
+		write(',');
+	}
+	itemBits |= mask;
+	write('"');
+	writeEscaped(name.c_str(), name.length());
+	write("\":", 2);
+	afterKey = true;
+	return *this;
+}
+
+JsonWriterStream& JsonWriterStream::value(const char* text, size_t length)
+{
+	if(beginValue()) {
+		write('"');
+		writeEscaped(text, length);
+		write('"');
+	}
+	return *this;
+}
+
+JsonWriterStream& JsonWriterStream::value(IDataSourceStream* stream)
+{
+	if(stream == nullptr) {
+		return null();
+	}
+	if(beginValue()) {
+		write('"');
+		valueStream.reset(stream);
+	} else {
+		delete stream;
+	}
+	return *this;
+}
+
+JsonWriterStream& JsonWriterStream::rawValue(const String& json)
+{
+	if(beginValue()) {
+		write(json.c_str(), json.length());
+	}
+	return *this;
+}
+
+void JsonWriterStream::pumpValueStream(size_t size)
+{
+	while(buffer.length() - readPos < size) {
+		char chunk[streamChunkSize];
+		auto len = valueStream->readMemoryBlock(chunk, sizeof(chunk));
+		if(len == 0) {
+			if(valueStream->isFinished()) {
+				valueStream.reset();
+				write('"');
+			}
+			break;
+		}
+
+		// Escaping may produce up to `maxEscapeLength` output characters per input character
+		auto offset = buffer.length();
+		if(!buffer.setLength(offset + len * Format::maxEscapeLength)) {
+			debug_e("[JSON] Out of memory");
+			buffer.setLength(offset);
+			break;
+		}
+		size_t consumed;
+		auto written =
+			Format::json.escape(chunk, len, buffer.begin() + offset, len * Format::maxEscapeLength, consumed);
+		buffer.setLength(offset + written);
+		peakBufferLength = std::max(peakBufferLength, buffer.length() - readPos);
+		valueStream->seek(consumed);
+	}
+}
+
+void JsonWriterStream::fill(size_t size)
+{
+	// Discard content already read
+	if(readPos == buffer.length()) {
+		buffer.setLength(0);
+		readPos = 0;
+	} else if(readPos != 0 && buffer.length() - readPos < size) {
+		buffer.remove(0, readPos);
+		readPos = 0;
+	}
+
+	while(buffer.length() - readPos < size) {
+		if(valueStream) {
+			auto len = buffer.length();
+			pumpValueStream(size);
+			if(valueStream && buffer.length() == len) {
+				// Nothing available from stream at present
+				return;
+			}
+			continue;
+		}
+
+		if(done || !producer) {
+			done = true;
+			break;
+		}
+
+		auto len = buffer.length();
+		if(!producer(*this)) {
+			done = true;
+			if(depth != 0) {
+				debug_w("[JSON] Document incomplete, depth %u", depth);
+			}
+			break;
+		}
+		if(buffer.length() == len && !valueStream) {
+			// Nothing produced, try again later
+			break;
+		}
+	}
+}
+
+uint16_t JsonWriterStream::readMemoryBlock(char* data, int bufSize)
+{
+	if(bufSize <= 0) {
+		return 0;
+	}
+
+	fill(bufSize);
+
+	size_t len = std::min(size_t(bufSize), buffer.length() - readPos);
+	memcpy(data, buffer.c_str() + readPos, len);
+	return len;
+}
+
+bool JsonWriterStream::seek(int len)
+{
+	if(len < 0 || readPos + len > buffer.length()) {
+		return false;
+	}
+
+	readPos += len;
+	return true;
+}
@@ -0,0 +1,226 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * JsonWriterStream.h
+ *
+ ****/
+
+#pragma once
+
+#include "DataSourceStream.h"
+#include <Delegate.h>
+#include <memory>
+#include <type_traits>
+#include <cmath>
+
+/**
+ * @brief Generates JSON output on demand from an application callback
+ *
+ * Unlike building a document in memory (e.g. with ArduinoJson) and then serialising it,
+ * content is requested from the application only when the consumer (typically a TCP connection)
+ * needs more data. Memory usage therefore depends on the size of the largest item written
+ * in a single callback, not on the size of the document.
+ *
+ * Example, generating an array of readings::
+ *
+ * 		unsigned index{0};
+ * 		auto stream = new JsonWriterStream([index](JsonWriterStream& json) mutable -> bool {
+ * 			if(index == 0) {
+ * 				json.beginArray();
+ * 			}
+ * 			if(index < readingCount) {
+ * 				json.beginObject().add("id", index).add("value", readings[index]).endObject();
+ * 				++index;
+ * 				return true;
+ * 			}
+ * 			json.endArray();
+ * 			return false;
+ * 		});
+ * 		response.sendDataStream(stream, MIME_JSON);
+ *
+ * Commas between items are inserted automatically. String values are escaped using `Format::Json`.
+ * Calls which would produce invalid JSON, such as a value without a key in an object or closing
+ * an array with `endObject()`, are reported as errors and ignored. A key without a value is given `null`.
+ *
+ * Large string values may be provided as a stream, which is read and escaped incrementally.
+ *
+ * @ingroup stream
+ */
+class JsonWriterStream : public IDataSourceStream
+{
+public:
+	/**
+	 * @brief Application callback to produce content
+	 * @param writer Use the writer methods to add one or more items to the document
+	 * @retval bool Return true if there is more to come, false when the document is complete
+	 * @note Keep the amount of content produced per call small to minimise buffer size.
+	 * If no content is produced then reading stops until the consumer next polls the stream.
+	 */
+	using Producer = Delegate<bool(JsonWriterStream& writer)>;
+
+	/**
+	 * @brief Maximum nesting level of objects and arrays
+	 */
+	static constexpr unsigned maxDepth{32};
+
+	JsonWriterStream(Producer producer) : producer(producer)
+	{
+	}
+
+	StreamType getStreamType() const override
+	{
+		return eSST_JsonObject;
+	}
+
+	MimeType getMimeType() const override
+	{
+		return MIME_JSON;
+	}
+
+	uint16_t readMemoryBlock(char* data, int bufSize) override;
+
+	bool seek(int len) override;
+
+	bool isFinished() override
+	{
+		return done && !valueStream && readPos == buffer.length();
+	}
+
+	/**
+	 * @name Writer methods, called from the producer callback
+	 * @{
+	 */
+
+	JsonWriterStream& beginObject()
+	{
+		return beginContainer('{', true);
+	}
+
+	JsonWriterStream& endObject()
+	{
+		return endContainer('}');
+	}
+
+	JsonWriterStream& beginArray()
+	{
+		return beginContainer('[', false);
+	}
+
+	JsonWriterStream& endArray()
+	{
+		return endContainer(']');
+	}
+
+	/**
+	 * @brief Write name for the next value in an object
+	 */
+	JsonWriterStream& key(const String& name);
+
+	JsonWriterStream& value(const char* text)
+	{
+		return text ? value(text, strlen(text)) : null();
+	}
+
+	JsonWriterStream& value(const String& text)
+	{
+		return text ? value(text.c_str(), text.length()) : null();
+	}
+
+	JsonWriterStream& value(const char* text, size_t length);
+
+	JsonWriterStream& value(bool b)
+	{
+		return rawValue(b ? F("true") : F("false"));
+	}
+
+	/**
+	 * @brief Write an integer value
+	 */
+	template <typename T>
+	typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, JsonWriterStream&>::type
+	value(T number)
+	{
+		return rawValue(String(number));
+	}
+
+	/**
+	 * @brief Write a floating-point value
+	 * @param number
+	 * @param decimalPlaces Number of digits after decimal point
+	 * @note Non-finite values (infinity, NaN) are written as `null`
+	 */
+	JsonWriterStream& value(double number, unsigned char decimalPlaces = 6)
+	{
+		return std::isfinite(number) ? rawValue(String(number, decimalPlaces)) : null();
+	}
+
+	/**
+	 * @brief Write a string value from a stream
+	 * @param stream The content is read and escaped on demand. Stream is owned by this object.
+	 * @note This must be the last item written by the producer call.
+	 */
+	JsonWriterStream& value(IDataSourceStream* stream);
+
+	JsonWriterStream& null()
+	{
+		return rawValue(F("null"));
+	}
+
+	/**
+	 * @brief Write a value which is already formatted as JSON
+	 */
+	JsonWriterStream& rawValue(const String& json);
+
+	/**
+	 * @brief Write a name/value pair to an object
+	 */
+	template <typename T> JsonWriterStream& add(const String& name, const T& v)
+	{
+		return key(name).value(v);
+	}
+
+	/** @} */
+
+	/**
+	 * @brief Get current nesting level
+	 */
+	unsigned getDepth() const
+	{
+		return depth;
+	}
+
+	/**
+	 * @brief Get the largest amount of output buffered at any time
+	 */
+	size_t getPeakBufferLength() const
+	{
+		return peakBufferLength;
+	}
+
+private:
+	JsonWriterStream& beginContainer(char c, bool isObject);
+	JsonWriterStream& endContainer(char c);
+	bool beginValue();
+	void write(const char* data, size_t length);
+	void write(char c)
+	{
+		write(&c, 1);
+	}
+	void writeEscaped(const char* text, size_t length);
+	void fill(size_t size);
+	void pumpValueStream(size_t size);
+
+	Producer producer;
+	String buffer;
+	size_t readPos{0};
+	size_t peakBufferLength{0};
+	std::unique_ptr<IDataSourceStream> valueStream;
+	uint32_t objectBits{0}; ///< Set if container at corresponding depth is an object
+	uint32_t itemBits{0};	///< Set if container at corresponding depth has at least one item
+	uint8_t depth{0};
+	bool afterKey{false};
+	bool done{false};
+};
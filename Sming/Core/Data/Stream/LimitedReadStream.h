@@ -0,0 +1,126 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * LimitedReadStream.h
+ *
+ ****/
+
+#pragma once
+
+#include "DataSourceStream.h"
+#include <memory>
+
+/**
+ * @brief Read-only stream presenting a section of a seekable source stream
+ *
+ * Used, for example, to serve HTTP range requests.
+ * @ingroup stream
+ */
+class LimitedReadStream : public IDataSourceStream
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param source Stream to read from, owned by this object
+	 * @param offset Position of first byte to read
+	 * @param length Maximum number of bytes to read
+	 * @note If the source cannot seek to the requested offset the stream is invalid
+	 */
+	LimitedReadStream(IDataSourceStream* source, size_t offset, size_t length)
+		: source(source), start(offset), length(length)
+	{
+		if(source == nullptr || source->seekFrom(offset, SeekOrigin::Start) != int(offset)) {
+			this->source.reset();
+		}
+	}
+
+	StreamType getStreamType() const override
+	{
+		return eSST_Wrapper;
+	}
+
+	bool isValid() const override
+	{
+		return source && source->isValid();
+	}
+
+	int available() override
+	{
+		return length - pos;
+	}
+
+	uint16_t readMemoryBlock(char* data, int bufSize) override
+	{
+		if(!source) {
+			return 0;
+		}
+		return source->readMemoryBlock(data, std::min(size_t(bufSize), length - pos));
+	}
+
+	bool getReadRegion(StreamRegion& region) override
+	{
+		if(!source || !source->getReadRegion(region)) {
+			return false;
+		}
+		region.length = std::min(region.length, length - pos);
+		return true;
+	}
+
+	/**
+	 * @brief Change position within the section
+	 * @note Seeking from the start requires the source stream to support this
+	 * @retval int New position within section, < 0 on error
+	 */
+	int seekFrom(int offset, SeekOrigin origin) override
+	{
+		if(!source) {
+			return -1;
+		}
+		switch(origin) {
+		case SeekOrigin::Current:
+			if(offset < 0 || size_t(offset) > length - pos || source->seekFrom(offset, SeekOrigin::Current) < 0) {
+				return -1;
+			}
+			pos += offset;
+			return pos;
+		case SeekOrigin::Start:
+			if(offset < 0 || size_t(offset) > length ||
+			   source->seekFrom(start + offset, SeekOrigin::Start) != int(start + offset)) {
+				return -1;
+			}
+			pos = offset;
+			return pos;
+		default:
+			return -1;
+		}
+	}
+
+	bool isFinished() override
+	{
+		return pos >= length || !source || source->isFinished();
+	}
+
+	String id() const override
+	{
+		return source ? source->id() : nullptr;
+	}
+
+	String getName() const override
+	{
+		return source ? source->getName() : nullptr;
+	}
+
+	MimeType getMimeType() const override
+	{
+		return source ? source->getMimeType() : MIME_UNKNOWN;
+	}
+
+private:
+	std::unique_ptr<IDataSourceStream> source;
+	size_t start;
+	size_t length;
+	size_t pos{0};
+};
@@ -12,7 +12,7 @@
 
 #include "MultiStream.h"
 
-uint16_t MultiStream::readMemoryBlock(char* data, int bufSize)
+bool MultiStream::updateStream()
 {
 	if(stream && stream->isFinished()) {
 		stream.reset();
@@ -22,11 +22,21 @@ uint16_t MultiStream::readMemoryBlock(char* data, int bufSize)
 		stream.reset(getNextStream());
 		if(!stream) {
 			finished = true;
-			return 0;
+			return false;
 		}
 	}
 
-	return stream->readMemoryBlock(data, bufSize);
+	return true;
+}
+
+uint16_t MultiStream::readMemoryBlock(char* data, int bufSize)
+{
+	return updateStream() ? stream->readMemoryBlock(data, bufSize) : 0;
+}
+
+bool MultiStream::getReadRegion(StreamRegion& region)
+{
+	return updateStream() && stream->getReadRegion(region);
 }
 
 bool MultiStream::seek(int len)
@@ -27,6 +27,8 @@ public:
 
 	bool seek(int len) override;
 
+	bool getReadRegion(StreamRegion& region) override;
+
 	bool isFinished() override
 	{
 		return finished;
@@ -41,6 +43,8 @@ protected:
 	virtual IDataSourceStream* getNextStream() = 0;
 
 private:
+	bool updateStream();
+
 	std::unique_ptr<IDataSourceStream> stream;
 	bool finished{false};
 };
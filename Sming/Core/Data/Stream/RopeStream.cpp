@@ -0,0 +1,199 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * RopeStream.cpp
+ *
+ ****/
+
+#include "RopeStream.h"
+#include <algorithm>
+
+size_t RopeStream::Segment::read(size_t offset, char* buffer, size_t count) const
+{
+	count = std::min(count, length - offset);
+	switch(type) {
+	case Type::Owned:
+		memcpy(buffer, string.c_str() + offset, count);
+		break;
+	case Type::Borrowed:
+		memcpy(buffer, static_cast<const char*>(ref) + offset, count);
+		break;
+	case Type::Flash:
+		count = static_cast<const FlashString*>(ref)->read(offset, buffer, count);
+		break;
+	}
+	return count;
+}
+
+RopeStream::Segment* RopeStream::addSegment(Segment::Type type, size_t length)
+{
+	// Everything read, so start again
+	if(readIndex == count) {
+		readIndex = count = 0;
+		readOffset = 0;
+	}
+
+	if(count == capacity) {
+		auto newCapacity = capacity ? capacity * 2 : 4;
+		std::unique_ptr<Segment[]> newSegments(new Segment[newCapacity]);
+		if(!newSegments) {
+			return nullptr;
+		}
+		for(unsigned i = readIndex; i < count; ++i) {
+			newSegments[i - readIndex] = std::move(segments[i]);
+		}
+		count -= readIndex;
+		readIndex = 0;
+		segments = std::move(newSegments);
+		capacity = newCapacity;
+	}
+
+	auto& seg = segments[count++];
+	seg = Segment{};
+	seg.type = type;
+	seg.length = length;
+	totalLength += length;
+	return &seg;
+}
+
+bool RopeStream::append(String&& str)
+{
+	auto length = str.length();
+	if(length == 0) {
+		return true;
+	}
+	auto seg = addSegment(Segment::Type::Owned, length);
+	if(seg == nullptr) {
+		return false;
+	}
+	seg->string = std::move(str);
+	seg->capacity = length;
+	return true;
+}
+
+bool RopeStream::append(const char* data, size_t length)
+{
+	if(length == 0) {
+		return true;
+	}
+
+	// Add to last segment if we own it and it hasn't been released
+	Segment* seg{nullptr};
+	if(readIndex < count && segments[count - 1].type == Segment::Type::Owned) {
+		seg = &segments[count - 1];
+		auto required = seg->length + length;
+		if(required > seg->capacity) {
+			auto newCapacity = std::max(required, seg->capacity * 2);
+			if(!seg->string.reserve(newCapacity)) {
+				return false;
+			}
+			seg->capacity = newCapacity;
+		}
+		seg->length = required;
+		totalLength += length;
+	} else {
+		seg = addSegment(Segment::Type::Owned, length);
+		if(seg == nullptr) {
+			return false;
+		}
+		if(!seg->string.reserve(length)) {
+			--count;
+			totalLength -= length;
+			return false;
+		}
+		seg->capacity = length;
+	}
+
+	seg->string.concat(data, length);
+	return true;
+}
+
+bool RopeStream::append(const FlashString& str)
+{
+	if(str.length() == 0) {
+		return true;
+	}
+	auto seg = addSegment(Segment::Type::Flash, str.length());
+	if(seg == nullptr) {
+		return false;
+	}
+	seg->ref = &str;
+	return true;
+}
+
+bool RopeStream::appendRef(const void* data, size_t length)
+{
+	if(length == 0) {
+		return true;
+	}
+	auto seg = addSegment(Segment::Type::Borrowed, length);
+	if(seg == nullptr) {
+		return false;
+	}
+	seg->ref = data;
+	return true;
+}
+
+uint16_t RopeStream::readMemoryBlock(char* data, int bufSize)
+{
+	if(data == nullptr || bufSize <= 0) {
+		return 0;
+	}
+
+	size_t total{0};
+	size_t offset = readOffset;
+	for(unsigned i = readIndex; i < count && total < size_t(bufSize); ++i) {
+		auto& seg = segments[i];
+		auto n = seg.read(offset, data + total, bufSize - total);
+		total += n;
+		if(offset + n < seg.length) {
+			// Short read from flash
+			break;
+		}
+		offset = 0;
+	}
+
+	return total;
+}
+
+int RopeStream::seekFrom(int offset, SeekOrigin origin)
+{
+	size_t newPos;
+	switch(origin) {
+	case SeekOrigin::Start:
+		newPos = offset;
+		break;
+	case SeekOrigin::Current:
+		newPos = readPos + offset;
+		break;
+	case SeekOrigin::End:
+		newPos = totalLength + offset;
+		break;
+	default:
+		return -1;
+	}
+
+	if(newPos < readPos || newPos > totalLength) {
+		return -1;
+	}
+
+	auto len = newPos - readPos;
+	while(len != 0) {
+		auto& seg = segments[readIndex];
+		auto n = std::min(len, seg.length - readOffset);
+		readOffset += n;
+		readPos += n;
+		len -= n;
+		if(readOffset == seg.length) {
+			// Release content as soon as it's been consumed
+			seg.string = nullptr;
+			++readIndex;
+			readOffset = 0;
+		}
+	}
+
+	return readPos;
+}
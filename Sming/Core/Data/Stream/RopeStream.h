@@ -0,0 +1,126 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * RopeStream.h
+ *
+ ****/
+
+#pragma once
+
+#include "DataSourceStream.h"
+#include <WString.h>
+#include <memory>
+
+/**
+ * @brief Read-only stream built from a list of content segments
+ *
+ * Content is never flattened into a single buffer. Each segment is one of:
+ *
+ * - A String whose content is taken over using move semantics
+ * - Copied data, coalesced into a single owned segment with geometric growth
+ * - A FlashString, read directly from flash
+ * - A reference to RAM which the application guarantees outlives the stream
+ *
+ * This allows a response to be assembled from existing strings and constant data
+ * without reallocating or copying it all. Owned segments are released as soon as they have been read.
+ *
+ * @ingroup stream
+ */
+class RopeStream : public IDataSourceStream
+{
+public:
+	/**
+	 * @brief Append a String, taking ownership of its content
+	 */
+	bool append(String&& str);
+
+	/**
+	 * @brief Append a copy of String content
+	 */
+	bool append(const String& str)
+	{
+		return append(str.c_str(), str.length());
+	}
+
+	/**
+	 * @brief Append a copy of data
+	 * @param data
+	 * @param length
+	 * @retval bool false on allocation failure
+	 *
+	 * Successive copies are merged into one segment.
+	 */
+	bool append(const char* data, size_t length);
+
+	/**
+	 * @brief Append a reference to flash content, which is not copied
+	 */
+	bool append(const FlashString& str);
+
+	/**
+	 * @brief Append a reference to RAM content, which is not copied
+	 * @note Data must remain valid and unchanged until read or the stream is destroyed
+	 */
+	bool appendRef(const void* data, size_t length);
+
+	/**
+	 * @brief Get number of segments appended, for diagnostic purposes
+	 */
+	unsigned getSegmentCount() const
+	{
+		return count;
+	}
+
+	StreamType getStreamType() const override
+	{
+		return eSST_Memory;
+	}
+
+	int available() override
+	{
+		return totalLength - readPos;
+	}
+
+	uint16_t readMemoryBlock(char* data, int bufSize) override;
+
+	/**
+	 * @brief Change position in stream
+	 * @note Only forward seeking is supported as content is released after it has been read
+	 */
+	int seekFrom(int offset, SeekOrigin origin) override;
+
+	bool isFinished() override
+	{
+		return readPos >= totalLength;
+	}
+
+private:
+	struct Segment {
+		enum class Type : uint8_t {
+			Owned,
+			Borrowed,
+			Flash,
+		};
+
+		String string;
+		const void* ref{nullptr};
+		size_t length{0};
+		size_t capacity{0};
+		Type type{};
+
+		size_t read(size_t offset, char* buffer, size_t count) const;
+	};
+
+	Segment* addSegment(Segment::Type type, size_t length);
+
+	std::unique_ptr<Segment[]> segments;
+	unsigned count{0};
+	unsigned capacity{0};
+	unsigned readIndex{0};
+	size_t readOffset{0};
+	size_t readPos{0};
+	size_t totalLength{0};
+};
@@ -197,6 +197,11 @@ public:
 	String getValue(const char* name) override;
 
 protected:
+	int programSection() const override
+	{
+		return sectionIndex();
+	}
+
 	/**
 	 * @brief Move to next record
 	 * @retval bool true to emit section, false to skip
@@ -66,6 +66,14 @@ public:
 		return true;
 	}
 
+	bool getReadRegion(StreamRegion& region) override
+	{
+		region.data = reinterpret_cast<const char*>(buffer.get()) + readPos;
+		region.length = capacity - readPos;
+		region.owner = buffer;
+		return true;
+	}
+
 	bool isFinished() override
 	{
 		return available() <= 0;
@@ -0,0 +1,205 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * TemplateProgram.cpp
+ *
+ ****/
+
+#include "TemplateProgram.h"
+#include <debug_progmem.h>
+#include <algorithm>
+
+namespace
+{
+/*
+ * Provides random access to source data via a small buffer
+ */
+class SourceReader
+{
+public:
+	SourceReader(IDataSourceStream& source, uint32_t length) : source(source), length(length)
+	{
+	}
+
+	/**
+	 * @brief Get character at given position
+	 * @retval int -1 if position is out of range or read failed
+	 */
+	int read(uint32_t offset)
+	{
+		if(offset >= length) {
+			return -1;
+		}
+		if(offset < bufStart || offset >= bufStart + bufLength) {
+			if(source.seekFrom(offset, SeekOrigin::Start) != int(offset)) {
+				return -1;
+			}
+			bufStart = offset;
+			bufLength = source.readMemoryBlock(buffer, std::min(length - offset, uint32_t(sizeof(buffer))));
+			if(bufLength == 0) {
+				return -1;
+			}
+		}
+		return uint8_t(buffer[offset - bufStart]);
+	}
+
+private:
+	IDataSourceStream& source;
+	uint32_t length;
+	uint32_t bufStart{0};
+	uint16_t bufLength{0};
+	char buffer[128];
+};
+
+/*
+ * Get length of tag starting at given position, 0 if it isn't valid
+ *
+ * Expressions may contain nested tags and quoted strings, as used by SectionTemplate.
+ */
+size_t getTagLength(SourceReader& reader, uint32_t offset, bool doubleBraces)
+{
+	int c = reader.read(offset + 1);
+	if(doubleBraces) {
+		if(c != '{') {
+			return 0;
+		}
+	} else if(c <= ' ' || c == '"') {
+		return 0;
+	}
+
+	unsigned depth{0};
+	bool quoted{false};
+	for(size_t i = 1 + doubleBraces; i < TemplateProgram::maxTagLength; ++i) {
+		c = reader.read(offset + i);
+		if(c < 0) {
+			return 0;
+		}
+		if(c == '"') {
+			quoted = !quoted;
+		} else if(quoted) {
+			continue;
+		} else if(c == '{') {
+			++depth;
+		} else if(c == '}') {
+			if(depth != 0) {
+				--depth;
+				continue;
+			}
+			++i;
+			// Double end brace isn't necessary, but if present it's part of the tag
+			if(doubleBraces && reader.read(offset + i) == '}') {
+				++i;
+			}
+			return (i <= TemplateProgram::maxTagLength) ? i : 0;
+		}
+	}
+
+	return 0;
+}
+
+} // namespace
+
+bool TemplateProgram::compile(uint8_t section, IDataSourceStream& source, bool doubleBraces)
+{
+	if(section >= sectionCount) {
+		return false;
+	}
+
+	auto& sect = sections[section];
+	sect.compiled = false;
+	sect.tagCount = 0;
+
+	int startPos = source.seekFrom(0, SeekOrigin::Current);
+	if(startPos < 0) {
+		return false;
+	}
+	int length = source.seekFrom(0, SeekOrigin::End);
+	if(length < 0) {
+		source.seekFrom(startPos, SeekOrigin::Start);
+		return false;
+	}
+
+	SourceReader reader(source, length);
+	uint32_t offset{0};
+	bool success{true};
+	while(offset < uint32_t(length)) {
+		int c = reader.read(offset);
+		if(c < 0) {
+			success = false;
+			break;
+		}
+		if(c != '{') {
+			++offset;
+			continue;
+		}
+		auto tagLength = getTagLength(reader, offset, doubleBraces);
+		if(tagLength == 0) {
+			// Not a tag, treat as text
+			++offset;
+			continue;
+		}
+		if(!addTag(sect, offset, tagLength)) {
+			success = false;
+			break;
+		}
+		offset += tagLength;
+	}
+
+	source.seekFrom(startPos, SeekOrigin::Start);
+
+	if(success) {
+		sect.length = length;
+		sect.compiled = true;
+		debug_d("[TMPL] Section #%u compiled, %u tags in %u bytes", section, sect.tagCount, sect.length);
+	}
+
+	return success;
+}
+
+const TemplateProgram::Tag* TemplateProgram::findTag(uint8_t section, uint32_t offset, unsigned& index) const
+{
+	if(!isCompiled(section)) {
+		return nullptr;
+	}
+
+	auto& sect = sections[section];
+	auto isFirstAfter = [&](unsigned i) {
+		return i < sect.tagCount && sect.tags[i].offset >= offset && (i == 0 || sect.tags[i - 1].offset < offset);
+	};
+
+	if(!isFirstAfter(index) && !isFirstAfter(++index)) {
+		auto it = std::lower_bound(sect.tags, sect.tags + sect.tagCount, offset,
+								   [](const Tag& tag, uint32_t value) { return tag.offset < value; });
+		index = it - sect.tags;
+	}
+
+	return (index < sect.tagCount) ? &sect.tags[index] : nullptr;
+}
+
+void TemplateProgram::clear()
+{
+	for(unsigned i = 0; i < sectionCount; ++i) {
+		auto& sect = sections[i];
+		free(sect.tags);
+		sect = Section{};
+	}
+}
+
+bool TemplateProgram::addTag(Section& section, uint32_t offset, uint8_t length)
+{
+	if(section.tagCount == section.capacity) {
+		auto newCapacity = section.capacity ? section.capacity * 2 : 16;
+		auto p = static_cast<Tag*>(realloc(section.tags, newCapacity * sizeof(Tag)));
+		if(p == nullptr) {
+			return false;
+		}
+		section.tags = p;
+		section.capacity = newCapacity;
+	}
+
+	section.tags[section.tagCount++] = Tag{offset, length};
+	return true;
+}
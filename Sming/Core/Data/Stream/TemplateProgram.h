@@ -0,0 +1,132 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * TemplateProgram.h
+ *
+ ****/
+
+#pragma once
+
+#include "DataSourceStream.h"
+#include <memory>
+
+/**
+ * @brief Compiled form of a template, used by TemplateStream to avoid re-scanning source data
+ *
+ * Compiling locates every tag in the template source and records its position and length.
+ * The text between tags is then passed through directly from the source stream without
+ * being searched, and tag text only needs to be read when it's evaluated.
+ *
+ * A program is compiled on first use and can be shared by all streams rendering the same template,
+ * so the cost is paid once rather than for every request. For example:
+ *
+ * ```
+ * TemplateProgram program(2);
+ *
+ * void onDashboard(HttpRequest& request, HttpResponse& response)
+ * {
+ *     auto tmpl = new SectionTemplate(new FlashMemoryStream(dashboard), 2);
+ *     tmpl->setProgram(&program);
+ *     ...
+ * }
+ * ```
+ *
+ * Templates using SectionTemplate are compiled one section at a time.
+ *
+ * @note All users of a program must have the same template source and brace setting.
+ */
+class TemplateProgram
+{
+public:
+	/**
+	 * @brief Location of a tag within source data, including braces
+	 */
+	struct Tag {
+		uint32_t offset;
+		uint8_t length;
+	};
+
+	/**
+	 * @brief Longer tags are treated as plain text
+	 */
+	static constexpr size_t maxTagLength{255};
+
+	/**
+	 * @brief Constructor
+	 * @param sectionCount Number of sections to support, must be at least that of the SectionTemplate used
+	 */
+	TemplateProgram(uint8_t sectionCount = 1) : sections(new Section[sectionCount]), sectionCount(sectionCount)
+	{
+	}
+
+	/**
+	 * @brief Determine if a section is available to use
+	 */
+	bool isCompiled(uint8_t section) const
+	{
+		return section < sectionCount && sections[section].compiled;
+	}
+
+	/**
+	 * @brief Locate all tags within source data
+	 * @param section Index of section to compile
+	 * @param source Stream positioned within the source data. Position is restored on return.
+	 * @param doubleBraces Tags are marked using `{{` instead of `{`
+	 * @retval bool false if source stream isn't seekable or there is insufficient memory
+	 */
+	bool compile(uint8_t section, IDataSourceStream& source, bool doubleBraces);
+
+	/**
+	 * @brief Find the first tag at or after a given position
+	 * @param section
+	 * @param offset Position in source data
+	 * @param index IN: Index of tag to check first, OUT: Index of tag found
+	 * @retval Tag* nullptr if there are no more tags in section
+	 *
+	 * Tags are usually visited in order so passing the previous result avoids a search.
+	 */
+	const Tag* findTag(uint8_t section, uint32_t offset, unsigned& index) const;
+
+	/**
+	 * @brief Get size of source data for a section
+	 */
+	uint32_t getLength(uint8_t section) const
+	{
+		return isCompiled(section) ? sections[section].length : 0;
+	}
+
+	/**
+	 * @brief Get number of tags in a section
+	 */
+	unsigned getTagCount(uint8_t section) const
+	{
+		return isCompiled(section) ? sections[section].tagCount : 0;
+	}
+
+	/**
+	 * @brief Discard compiled data so it's rebuilt on next use
+	 */
+	void clear();
+
+private:
+	struct Section {
+		~Section()
+		{
+			free(tags);
+		}
+
+		Tag* tags{nullptr};
+		unsigned tagCount{0};
+		unsigned capacity{0};
+		uint32_t length{0};
+		bool compiled{false};
+	};
+
+	bool addTag(Section& section, uint32_t offset, uint8_t length);
+
+	std::unique_ptr<Section[]> sections;
+	uint8_t sectionCount;
+};
@@ -36,22 +36,108 @@ String TemplateStream::getValue(const char* name)
 	return s;
 }
 
+uint16_t TemplateStream::sendValue(char* data, size_t bufSize)
+{
+	assert(value.length() != 0);
+	auto len = std::min(bufSize, value.length() - valuePos);
+	memcpy(data, value.c_str() + valuePos, len);
+	sendingValue = true;
+	return len;
+}
+
+/*
+ * Tag locations are known so text is read directly from the source stream into the caller's buffer.
+ * Returns -1 if the program cannot be used, in which case the source is scanned as normal.
+ */
+int TemplateStream::readCompiled(char* data, size_t bufSize)
+{
+	for(;;) {
+		if(sendingValue) {
+			return sendValue(data, bufSize);
+		}
+
+		int section = programSection();
+		int pos = stream->seekFrom(0, SeekOrigin::Current);
+		if(section >= 0 && pos >= 0 && !program->isCompiled(section)) {
+			if(!program->compile(section, *stream, doubleBraces)) {
+				return -1;
+			}
+		}
+
+		if(section < 0 || pos < 0 || uint32_t(pos) >= program->getLength(section)) {
+			// Give source a chance to move to next section or record
+			if(stream->isFinished()) {
+				return 0;
+			}
+			stream->readMemoryBlock(data, 0);
+			if(programSection() == section && stream->seekFrom(0, SeekOrigin::Current) == pos) {
+				return 0;
+			}
+			rawTag = -1;
+			continue;
+		}
+
+		auto tag = program->findTag(section, pos, tagIndex);
+		if(tag != nullptr && tag->offset == uint32_t(pos) && pos != rawTag) {
+			char buf[TemplateProgram::maxTagLength + 1];
+			size_t len = stream->readMemoryBlock(buf, tag->length);
+			buf[len] = '\0';
+			char* expr = buf + 1 + doubleBraces;
+			bool enabled = outputEnabled;
+			value = (len == tag->length) ? evaluate(expr) : nullptr;
+			if(!value) {
+				// Not handled, emit unchanged
+				rawTag = pos;
+				continue;
+			}
+			rawTag = -1;
+			stream->seek(len);
+			outputEnabled = enableNextState;
+			if(enabled && value.length() != 0) {
+				valuePos = 0;
+				return sendValue(data, bufSize);
+			}
+			value = nullptr;
+			continue;
+		}
+
+		uint32_t end;
+		if(tag == nullptr) {
+			end = program->getLength(section);
+		} else if(tag->offset == uint32_t(pos)) {
+			end = pos + tag->length;
+		} else {
+			end = tag->offset;
+		}
+		size_t len = std::min(size_t(end - pos), bufSize);
+		if(!outputEnabled) {
+			if(!stream->seek(len)) {
+				return -1;
+			}
+			continue;
+		}
+		return stream->readMemoryBlock(data, len);
+	}
+}
+
 uint16_t TemplateStream::readMemoryBlock(char* data, int bufSize)
 {
 	if(data == nullptr || bufSize <= 0) {
 		return 0;
 	}
 
-	auto sendValue = [&]() {
-		assert(value.length() != 0);
-		auto len = std::min(size_t(bufSize), value.length() - valuePos);
-		memcpy(data, value.c_str() + valuePos, len);
-		sendingValue = true;
-		return len;
-	};
-
 	if(sendingValue) {
-		return sendValue();
+		return sendValue(data, bufSize);
+	}
+
+	if(program != nullptr && valueWaitSize == 0) {
+		int res = readCompiled(data, bufSize);
+		if(res >= 0) {
+			return res;
+		}
+		// Don't try again for this stream
+		debug_w("[TMPL] Program unusable, scanning source");
+		program = nullptr;
 	}
 
 	if(valueWaitSize != 0) {
@@ -131,7 +217,7 @@ uint16_t TemplateStream::readMemoryBlock(char* data, int bufSize)
 
 			if(outputEnabled && valueWaitSize == 0 && value.length() != 0) {
 				valuePos = 0;
-				return sendValue();
+				return sendValue(data, bufSize);
 			}
 
 			outputEnabled = enableNextState;
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "DataSourceStream.h"
+#include "TemplateProgram.h"
 #include "WHashMap.h"
 #include "WString.h"
 
@@ -36,6 +37,8 @@
  * 
  * Invalid tags, such as `{"abc"}` will be ignored, so JSON templates do not require special treatment.
  *
+ * For better throughput, use `setProgram()` so the template is only scanned for tags once.
+ *
  * @ingroup stream
  */
 class TemplateStream : public IDataSourceStream
@@ -151,6 +154,21 @@ public:
 		doubleBraces = enable;
 	}
 
+	/**
+	 * @brief Use a compiled program to locate tags
+	 * @param program Compiled on first use, may be shared between streams using the same template.
+	 * Caller retains ownership and must ensure it remains valid for the lifetime of this stream.
+	 *
+	 * Text between tags is passed straight through from the source stream,
+	 * so the source must support seeking (e.g. flash, memory or file streams).
+	 * If compilation fails the stream falls back to scanning the source as it's read,
+	 * and the program is not used again by this stream.
+	 */
+	void setProgram(TemplateProgram* program)
+	{
+		this->program = program;
+	}
+
 	/**
 	 * @brief Evaluate a template expression
 	 * @param expr IN: First character after the opening brace(s)
@@ -183,7 +201,20 @@ public:
 	 */
 	virtual String getValue(const char* name);
 
+protected:
+	/**
+	 * @brief Get index of compiled program section for current position in source stream
+	 * @retval int -1 if source stream isn't positioned within a section
+	 */
+	virtual int programSection() const
+	{
+		return 0;
+	}
+
 private:
+	uint16_t sendValue(char* data, size_t bufSize);
+	int readCompiled(char* data, size_t bufSize);
+
 	void reset()
 	{
 		value = nullptr;
@@ -194,13 +225,17 @@ private:
 		sendingValue = false;
 		outputEnabled = true;
 		enableNextState = true;
+		rawTag = -1;
 	}
 
 	IDataSourceStream* stream;
+	TemplateProgram* program{nullptr};
 	Variables templateData;
 	GetValueDelegate getValueCallback;
 	String value;
 	uint32_t streamPos;		///< Position in output stream
+	int rawTag;				///< Position of compiled tag to be emitted unchanged
+	unsigned tagIndex{0};	///< Last compiled tag located
 	uint16_t valuePos;		///< How much of variable value has been sent
 	uint16_t valueWaitSize; ///< Chars to send before variable value
 	uint8_t tagLength;
@@ -30,35 +30,41 @@ uint16_t StreamTransformer::readMemoryBlock(char* data, int bufSize)
 	return tempStream->readMemoryBlock(data, bufSize);
 }
 
+bool StreamTransformer::flushResult()
+{
+	if(resultPos < resultLength) {
+		resultPos += tempStream->write(&result[resultPos], resultLength - resultPos);
+	}
+	return resultPos == resultLength;
+}
+
 void StreamTransformer::fillTempStream(char* buffer, size_t bufSize)
 {
-	size_t room;
+	// Output from a previous transformation may not have fitted
+	if(!flushResult()) {
+		return;
+	}
+
 	auto maxChunkSize = std::min(bufSize, blockSize);
-	while((room = tempStream->room()) >= maxChunkSize) {
+	while(tempStream->room() >= maxChunkSize) {
 		auto chunkSize = sourceStream->readMemoryBlock(buffer, maxChunkSize);
 		if(chunkSize == 0) {
 			break;
 		}
 
-		saveState();
-		size_t outLength = transform(reinterpret_cast<const uint8_t*>(buffer), chunkSize, result.get(), resultSize);
-		if(outLength > room) {
-			restoreState();
+		resultLength = transform(reinterpret_cast<const uint8_t*>(buffer), chunkSize, result.get(), resultSize);
+		resultPos = 0;
+		sourceStream->seek(chunkSize);
+		if(!flushResult()) {
 			return;
 		}
-
-		auto written = tempStream->write(result.get(), outLength);
-		(void)written;
-		assert(written == outLength);
-
-		sourceStream->seek(chunkSize);
 	}
 
-	if(sourceStream->isFinished()) {
-		auto outLength = transform(nullptr, 0, result.get(), resultSize);
-		auto written = tempStream->write(result.get(), outLength);
-		(void)written;
-		assert(written == outLength);
+	if(!endOfInput && sourceStream->isFinished()) {
+		resultLength = transform(nullptr, 0, result.get(), resultSize);
+		resultPos = 0;
+		endOfInput = true;
+		flushResult();
 	}
 }
 
@@ -69,5 +75,6 @@ bool StreamTransformer::seek(int len)
 
 bool StreamTransformer::isFinished()
 {
-	return (sourceStream->isFinished() && (tempStream == nullptr || tempStream->isFinished()));
+	// End of input is only processed after source stream has finished
+	return endOfInput && resultPos == resultLength && tempStream->isFinished();
 }
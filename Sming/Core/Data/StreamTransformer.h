@@ -59,17 +59,6 @@ public:
 		return sourceStream ? sourceStream->getName() : String::nullstr;
 	}
 
-	/**
-	 * @brief A method that backs up the current state
-	 *
-	 */
-	virtual void saveState(){};
-
-	/**
-	 * @brief A method that restores the last backed up state
-	 */
-	virtual void restoreState(){};
-
 protected:
 	/**
 	 * @brief Inherited class implements this method to transform a block of data
@@ -78,16 +67,20 @@ protected:
 	 * @param out output buffer
 	 * @param outLength size of output buffer
 	 * @retval size_t number of output bytes written
-	 * @note Called with `in = nullptr` and `inLength = 0` at end of input stream
+	 * @note Called once with `in = nullptr` and `inLength = 0` at end of input stream
 	 */
 	virtual size_t transform(const uint8_t* in, size_t inLength, uint8_t* out, size_t outLength) = 0;
 
 private:
 	void fillTempStream(char* buffer, size_t bufSize);
+	bool flushResult();
 
 	std::unique_ptr<IDataSourceStream> sourceStream;
 	std::unique_ptr<CircularBuffer> tempStream;
 	std::unique_ptr<uint8_t[]> result;
 	size_t resultSize;
 	size_t blockSize;
+	size_t resultPos{0};	///< Start of result data not yet written to tempStream
+	size_t resultLength{0}; ///< Amount of data in result buffer
+	bool endOfInput{false}; ///< Set once transform() has been called for end of input
 };
@@ -0,0 +1,96 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * StringBuilder.cpp
+ *
+ ****/
+
+#include "StringBuilder.h"
+#include <algorithm>
+
+size_t StringBuilder::write(const uint8_t* data, size_t size)
+{
+	if(size == 0) {
+		return 0;
+	}
+	if(!grow(len + size)) {
+		setWriteError();
+		return 0;
+	}
+	memcpy(buffer + len, data, size);
+	len += size;
+	buffer[len] = '\0';
+	return size;
+}
+
+bool StringBuilder::reserve(size_t size)
+{
+	if(size <= capacity) {
+		return true;
+	}
+
+	// Moving out of the arena, or an explicit request for more heap space
+	bool inArena = (buffer != nullptr && buffer == arena);
+	if(!inArena && buffer != nullptr) {
+		// String only preserves content up to its current length when reallocating
+		string.setLength(len);
+	}
+	if(!string.reserve(size)) {
+		return false;
+	}
+	auto newBuffer = string.begin();
+	if(inArena) {
+		memcpy(newBuffer, arena, len + 1);
+	}
+	buffer = newBuffer;
+	capacity = size;
+	return true;
+}
+
+bool StringBuilder::grow(size_t required)
+{
+	if(required <= capacity) {
+		return true;
+	}
+
+	// Geometric growth keeps the number of reallocations proportional to log(length)
+	auto newCapacity = std::max({required, capacity * 2, initialCapacity});
+	return reserve(newCapacity) || reserve(required);
+}
+
+void StringBuilder::clear()
+{
+	len = 0;
+	if(buffer != nullptr) {
+		buffer[0] = '\0';
+	}
+}
+
+String StringBuilder::moveString()
+{
+	String s;
+	if(arena != nullptr && buffer == arena) {
+		s.setString(arena, len);
+	} else {
+		string.setLength(len);
+		s = std::move(string);
+	}
+	reset();
+	return s;
+}
+
+void StringBuilder::reset()
+{
+	len = 0;
+	if(arena == nullptr) {
+		buffer = nullptr;
+		capacity = 0;
+	} else {
+		buffer = arena;
+		capacity = arenaSize - 1;
+		arena[0] = '\0';
+	}
+}
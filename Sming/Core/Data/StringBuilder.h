@@ -0,0 +1,145 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * StringBuilder.h
+ *
+ ****/
+
+#pragma once
+
+#include <Print.h>
+#include <WString.h>
+
+/**
+ * @brief Builds text content with fewer reallocations than String concatenation
+ *
+ * String grows to exactly the size required, so building content in many small pieces
+ * can reallocate for every append. StringBuilder doubles its capacity when more space
+ * is required, so the number of reallocations is logarithmic in the final size.
+ *
+ * Content is written using the regular Print methods and streaming operators:
+ *
+ * ```
+ * StringBuilder sb(256);
+ * sb << "HTTP/1.1 " << code << ' ' << toString(code) << "\r\n";
+ * String s = sb.moveString();
+ * ```
+ *
+ * See StackStringBuilder to avoid heap allocation entirely for short content.
+ */
+class StringBuilder : public Print
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param initialCapacity Size of first allocation, typically the expected content length
+	 */
+	StringBuilder(size_t initialCapacity = 0) : StringBuilder(nullptr, 0, initialCapacity)
+	{
+	}
+
+	// Buffer may refer to internal storage, so copying isn't meaningful
+	StringBuilder(const StringBuilder&) = delete;
+	StringBuilder& operator=(const StringBuilder&) = delete;
+
+	using Print::write;
+
+	size_t write(uint8_t c) override
+	{
+		return write(&c, 1);
+	}
+
+	size_t write(const uint8_t* data, size_t size) override;
+
+	/**
+	 * @brief Get number of characters written
+	 */
+	size_t length() const
+	{
+		return len;
+	}
+
+	/**
+	 * @brief Ensure there is space for the given content length without further allocation
+	 * @retval bool false on allocation failure
+	 */
+	bool reserve(size_t size);
+
+	/**
+	 * @brief Discard content, retaining any allocated memory
+	 */
+	void clear();
+
+	/**
+	 * @brief Get the content as a NUL-terminated string
+	 * @note The pointer is invalidated by any subsequent write
+	 */
+	const char* c_str() const
+	{
+		return (buffer == nullptr) ? "" : buffer;
+	}
+
+	/**
+	 * @brief Obtain content as a String
+	 * @retval String
+	 *
+	 * Heap content is moved without copying. If content is still in the stack arena
+	 * it is copied into a new String.
+	 *
+	 * The builder is left empty and may be re-used.
+	 */
+	String moveString();
+
+	size_t printTo(Print& p) const
+	{
+		return p.write(buffer, len);
+	}
+
+protected:
+	/**
+	 * @brief Constructor for derived classes providing a fixed first block
+	 * @param arena Buffer to use before any heap allocation
+	 * @param arenaSize Size of arena, including space for the terminating NUL
+	 * @param initialCapacity Size of first heap allocation
+	 */
+	StringBuilder(char* arena, size_t arenaSize, size_t initialCapacity)
+		: arena(arena), arenaSize(arenaSize), initialCapacity(initialCapacity)
+	{
+		reset();
+	}
+
+private:
+	void reset();
+	bool grow(size_t required);
+
+	String string;
+	char* arena;
+	char* buffer{nullptr};
+	size_t arenaSize;
+	size_t initialCapacity;
+	size_t capacity{0};
+	size_t len{0};
+};
+
+/**
+ * @brief StringBuilder which uses a fixed-size buffer until content outgrows it
+ * @tparam size Buffer size, including the terminating NUL
+ *
+ * Typically declared as a local variable so short content requires no heap allocation.
+ * Beware of stack usage with larger sizes.
+ */
+template <size_t size> class StackStringBuilder : public StringBuilder
+{
+public:
+	static_assert(size > 1, "Arena too small");
+
+	StackStringBuilder(size_t initialCapacity = 0) : StringBuilder(stackBuffer, size, initialCapacity)
+	{
+	}
+
+private:
+	char stackBuffer[size];
+};
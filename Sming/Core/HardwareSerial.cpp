@@ -11,7 +11,9 @@
  ****/
 
 #include "HardwareSerial.h"
+#include <driver/SerialBuffer.h>
 #include <cstdarg>
+#include <algorithm>
 #include "Platform/System.h"
 #include "m_printf.h"
 
@@ -108,6 +110,10 @@ void HardwareSerial::invokeCallbacks()
 
 	// RX FIFO Full or RX FIFO Timeout or RX Overflow ?
 	if(status & (UART_STATUS_RXFIFO_FULL | UART_STATUS_RXFIFO_TOUT | UART_STATUS_RXFIFO_OVF)) {
+		updateErrorCounts();
+		if(frameDelegate) {
+			processFrames();
+		}
 		auto receivedChar = smg_uart_peek_last_char(uart);
 		if(HWSDelegate) {
 			HWSDelegate(*this, receivedChar, smg_uart_rx_available(uart));
@@ -115,10 +121,101 @@ void HardwareSerial::invokeCallbacks()
 	}
 }
 
+void HardwareSerial::processFrames()
+{
+	auto buffer = uart->rx_buffer;
+	if(buffer == nullptr) {
+		return;
+	}
+
+	while(frameDelegate) {
+		size_t length;
+		if(frameLength != 0) {
+			length = (buffer->available() >= frameLength) ? frameLength : 0;
+		} else {
+			length = buffer->find(frameDelimiter) + 1;
+		}
+
+		if(length == 0) {
+			if(buffer->isFull()) {
+				// Frame cannot complete so drop it
+				++errorCounts.oversizeFrames;
+				frameDiscard = (frameLength == 0);
+				consumeFrame(*buffer, buffer->available());
+			}
+			break;
+		}
+
+		if(frameDiscard) {
+			// Remainder of an oversize frame
+			frameDiscard = false;
+			consumeFrame(*buffer, length);
+			continue;
+		}
+
+		void* data;
+		if(buffer->getReadData(data) < length) {
+			// Frame wraps around end of buffer
+			if(frameBufferSize < length) {
+				frameBuffer.reset(new char[length]);
+				frameBufferSize = frameBuffer ? length : 0;
+			}
+			if(!frameBuffer) {
+				consumeFrame(*buffer, length);
+				continue;
+			}
+			buffer->peekData(frameBuffer.get(), length);
+			data = frameBuffer.get();
+		}
+
+		frameDelegate(*this, static_cast<const char*>(data), length);
+		consumeFrame(*buffer, length);
+	}
+}
+
+void HardwareSerial::consumeFrame(SerialBuffer& buffer, size_t length)
+{
+	while(length > 1) {
+		void* data;
+		auto n = std::min(buffer.getReadData(data), length - 1);
+		buffer.skipRead(n);
+		length -= n;
+	}
+
+	/*
+	 * Read final character via driver: if the receive buffer filled up then
+	 * this re-enables receive interrupts so any data waiting in the FIFO is collected.
+	 */
+	if(length != 0) {
+		char c;
+		smg_uart_read(uart, &c, 1);
+	}
+}
+
+void HardwareSerial::updateErrorCounts()
+{
+	auto ustat = smg_uart_get_status(uart);
+	if(ustat & UART_STATUS_RXFIFO_OVF) {
+		++errorCounts.overruns;
+	}
+	if(ustat & UART_STATUS_FRM_ERR) {
+		++errorCounts.framingErrors;
+	}
+	if(ustat & UART_STATUS_PARITY_ERR) {
+		++errorCounts.parityErrors;
+	}
+	if(ustat & UART_STATUS_BRK_DET) {
+		++errorCounts.breaks;
+	}
+	uartStatus |= ustat;
+}
+
 unsigned HardwareSerial::getStatus()
 {
+	updateErrorCounts();
 	unsigned status = 0;
-	unsigned ustat = smg_uart_get_status(uart);
+	unsigned ustat = uartStatus;
+	uartStatus = 0;
 	if(ustat & UART_STATUS_BRK_DET) {
 		bitSet(status, eSERS_BreakDetected);
 	}
@@ -171,7 +268,7 @@ void HardwareSerial::staticCallbackHandler(smg_uart_t* uart, uint32_t status)
 bool HardwareSerial::updateUartCallback()
 {
 	uint16_t mask = 0;
-	if(HWSDelegate) {
+	if(HWSDelegate || frameDelegate) {
 		mask |= UART_STATUS_RXFIFO_FULL | UART_STATUS_RXFIFO_TOUT | UART_STATUS_RXFIFO_OVF;
 	}
 
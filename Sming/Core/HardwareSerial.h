@@ -20,6 +20,7 @@
 #include <Data/Stream/ReadWriteStream.h>
 #include <BitManipulations.h>
 #include <driver/uart.h>
+#include <memory>
 
 #define UART_ID_0 0 ///< ID of UART 0
 #define UART_ID_1 1 ///< ID of UART 1
@@ -50,6 +51,16 @@ using StreamDataReceivedDelegate = Delegate<void(Stream& source, char arrivedCha
  */
 using TransmitCompleteDelegate = Delegate<void(HardwareSerial& serial)>;
 
+/** @brief Delegate callback type for framed data reception
+ *  @param serial Reference to serial port
+ *  @param frame Received data
+ *  @param length Number of bytes in frame, including any delimiter
+ *  @note Frames are passed directly from the receive buffer, and are only copied if they wrap
+ *  around the end of it. Data is only valid for the duration of the callback, and the
+ *  serial port must not be read from within it.
+ */
+using FrameReceivedDelegate = Delegate<void(HardwareSerial& serial, const char* frame, size_t length)>;
+
 // clang-format off
 #define SERIAL_CONFIG_MAP(XX) \
 	XX(5N1) XX(6N1) XX(7N1) XX(8N1) XX(5N2) XX(6N2) XX(7N2) XX(8N2) XX(5E1) XX(6E1) XX(7E1) XX(8E1) \
@@ -102,6 +113,18 @@ enum class SerialStatus {
 SERIAL_STATUS_MAP(XX)
 #undef XX
 
+/**
+ * @brief Receive error counters
+ * @see HardwareSerial::getErrorCounts()
+ */
+struct SerialErrorCounts {
+	uint32_t overruns;		 ///< Receive buffer full and hardware FIFO overflowed, so data was lost
+	uint32_t framingErrors;	 ///< Stop bit not found where expected
+	uint32_t parityErrors;	 ///< Parity check failed
+	uint32_t breaks;		 ///< Break condition detected
+	uint32_t oversizeFrames; ///< Frames discarded because they couldn't fit in the receive buffer
+};
+
 /// Hardware serial class
 class HardwareSerial : public ReadWriteStream
 {
@@ -353,6 +376,34 @@ public:
 		return updateUartCallback();
 	}
 
+	/** @brief  Set handler to receive data one line at a time
+	 *  @param  delegate Function to handle each line, nullptr to disable
+	 *  @param  delimiter Character which terminates a line
+	 *  @retval bool Returns true if the callback was set correctly
+	 *  @note Lines which don't fit in the receive buffer are discarded, see setRxBufferSize().
+	 */
+	bool onLineReceived(FrameReceivedDelegate delegate, char delimiter = '\n')
+	{
+		frameDelegate = delegate;
+		frameDelimiter = delimiter;
+		frameLength = 0;
+		frameDiscard = false;
+		return updateUartCallback();
+	}
+
+	/** @brief  Set handler to receive data in fixed-size frames
+	 *  @param  delegate Function to handle each frame, nullptr to disable
+	 *  @param  length Size of each frame, must be less than the receive buffer size
+	 *  @retval bool Returns true if the callback was set correctly
+	 */
+	bool onFrameReceived(FrameReceivedDelegate delegate, uint16_t length)
+	{
+		frameDelegate = length ? delegate : nullptr;
+		frameLength = length;
+		frameDiscard = false;
+		return updateUartCallback();
+	}
+
 	/** @brief  Set handler for received data
 	 *  @param  transmitCompleteDelegate Function to handle received data
 	 *  @retval bool Returns true if the callback was set correctly
@@ -445,6 +496,30 @@ public:
 	 */
 	unsigned getStatus();
 
+	/**
+	 * @brief Get receive error counts
+	 *
+	 * Counters are updated when received data is processed for a callback, and when this method or
+	 * getStatus() are called. Each count therefore indicates the number of occasions an error was seen,
+	 * which may cover more than one event.
+	 *
+	 * A non-zero count of overruns or oversize frames indicates that a larger receive buffer is required.
+	 */
+	const SerialErrorCounts& getErrorCounts()
+	{
+		updateErrorCounts();
+		return errorCounts;
+	}
+
+	/**
+	 * @brief Set all error counts to zero
+	 */
+	void resetErrorCounts()
+	{
+		updateErrorCounts();
+		errorCounts = {};
+	}
+
 private:
 	int uartNr = UART_NO;
 	TransmitCompleteDelegate transmitComplete = nullptr; ///< Callback for transmit completion
@@ -457,6 +532,18 @@ private:
 	volatile uint16_t callbackStatus = 0; ///< Persistent uart status flags for callback
 	volatile bool callbackQueued = false;
 
+	// Framed receive
+	FrameReceivedDelegate frameDelegate = nullptr;
+	std::unique_ptr<char[]> frameBuffer; // Holds frames which wrap around end of receive buffer
+	size_t frameBufferSize = 0;
+	uint16_t frameLength = 0; // Fixed frame size, 0 for delimited frames
+	char frameDelimiter = '\n';
+	bool frameDiscard = false; // Oversize frame being dropped, discard up to next delimiter
+
+	SerialErrorCounts errorCounts = {};
+	// Status bits fetched from uart which have not yet been returned by getStatus()
+	uint8_t uartStatus = 0;
+
 	/**
 	 * @brief Serial interrupt handler, called by serial driver
 	 * @param uart pointer to UART object
@@ -465,6 +552,9 @@ private:
 	static void IRAM_ATTR staticCallbackHandler(smg_uart_t* uart, uint32_t status);
 	static void staticOnStatusChange(void* param);
 	void invokeCallbacks();
+	void processFrames();
+	void consumeFrame(SerialBuffer& buffer, size_t length);
+	void updateErrorCounts();
 
 	/**
 	 * @brief Called whenever one of the user callbacks change
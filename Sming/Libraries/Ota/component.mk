@@ -13,6 +13,8 @@ COMPONENT_INCDIRS := \
         src/include \
         src/Arch/$(COMPONENT_ARCH)/include
 
+COMPONENT_DEPENDS := crypto
+
 ifeq ($(COMPONENT_ARCH),Esp8266)
 	COMPONENT_DEPENDS += rboot
 endif
@@ -20,3 +22,16 @@ endif
 COMPONENT_DOXYGEN_INPUT := src
 
 COMPONENT_RELINK_VARS += RBOOT_RTC_ENABLED
+
+# Buffering for PipelinedOutputStream
+COMPONENT_VARS += \
+	OTA_PIPELINE_BUFFER_SIZE \
+	OTA_PIPELINE_ERASE_AHEAD
+OTA_PIPELINE_BUFFER_SIZE ?= 4096
+OTA_PIPELINE_ERASE_AHEAD ?= 2
+GLOBAL_CFLAGS += \
+	-DOTA_PIPELINE_BUFFER_SIZE=$(OTA_PIPELINE_BUFFER_SIZE) \
+	-DOTA_PIPELINE_ERASE_AHEAD=$(OTA_PIPELINE_ERASE_AHEAD)
+
+# Binary patch generator for DeltaOutputStream
+OTA_DELTA_TOOL := $(PYTHON) $(COMPONENT_PATH)/tools/otadelta.py
@@ -0,0 +1,204 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * DeltaOutputStream.cpp
+ *
+ *
+ */
+
+#include "include/Ota/DeltaOutputStream.h"
+#include <Platform/WDT.h>
+#include <debug_progmem.h>
+
+namespace Ota
+{
+void DeltaOutputStream::setError(const char* message)
+{
+	debug_e("[OTA] Delta: %s", message);
+	state = State::Error;
+}
+
+void DeltaOutputStream::processHeader()
+{
+	if(header.magic != headerMagic || header.version != headerVersion) {
+		setError("Invalid patch header");
+		return;
+	}
+	if(header.sourceSize > source.size()) {
+		setError("Source image too large for partition");
+		return;
+	}
+
+	debug_i("[OTA] Delta: %u -> %u bytes", header.sourceSize, header.targetSize);
+	hash.reset();
+	state = State::Opcode;
+}
+
+void DeltaOutputStream::processOpcode(uint8_t code)
+{
+	opcode = Opcode(code);
+	switch(opcode) {
+	case Opcode::End:
+		finish();
+		break;
+	case Opcode::Copy:
+	case Opcode::Insert:
+		state = State::Length;
+		value = 0;
+		valueShift = 0;
+		break;
+	default:
+		setError("Invalid opcode");
+	}
+}
+
+bool DeltaOutputStream::readValue(const uint8_t*& data, size_t& size)
+{
+	while(size != 0) {
+		uint8_t c = *data++;
+		--size;
+		if(valueShift > 28) {
+			setError("Bad value encoding");
+			return false;
+		}
+		value |= uint32_t(c & 0x7f) << valueShift;
+		valueShift += 7;
+		if((c & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void DeltaOutputStream::copy(int32_t offset)
+{
+	int64_t pos = int64_t(sourcePos) + offset;
+	if(pos < 0 || pos + length > header.sourceSize) {
+		setError("Copy outside source image");
+		return;
+	}
+	sourcePos = pos;
+
+	uint8_t buffer[256];
+	while(length != 0) {
+		auto n = std::min(size_t(length), sizeof(buffer));
+		if(!source.read(sourcePos, buffer, n)) {
+			setError("Source read failed");
+			return;
+		}
+		if(!writeOutput(buffer, n)) {
+			return;
+		}
+		sourcePos += n;
+		length -= n;
+		// Large copies may take some time
+		WDT.alive();
+	}
+
+	state = State::Opcode;
+}
+
+bool DeltaOutputStream::writeOutput(const void* data, size_t size)
+{
+	if(written + size > header.targetSize) {
+		setError("Output exceeds target size");
+		return false;
+	}
+	hash.update(data, size);
+	if(output->write(static_cast<const uint8_t*>(data), size) != size) {
+		setError("Output write failed");
+		return false;
+	}
+	written += size;
+	return true;
+}
+
+void DeltaOutputStream::finish()
+{
+	auto result = hash.getHash();
+	if(written != header.targetSize || memcmp(result.data(), header.targetMd5, result.size()) != 0) {
+		setError("Result does not match target");
+		return;
+	}
+
+	debug_i("[OTA] Delta: Patch applied");
+	state = State::Complete;
+}
+
+size_t DeltaOutputStream::write(const uint8_t* data, size_t size)
+{
+	if(!output) {
+		return 0;
+	}
+
+	const size_t origSize = size;
+	while(size != 0) {
+		switch(state) {
+		case State::Header: {
+			auto n = std::min(size, sizeof(header) - headerLength);
+			memcpy(reinterpret_cast<uint8_t*>(&header) + headerLength, data, n);
+			headerLength += n;
+			data += n;
+			size -= n;
+			if(headerLength == sizeof(header)) {
+				processHeader();
+			}
+			break;
+		}
+
+		case State::Opcode:
+			--size;
+			processOpcode(*data++);
+			break;
+
+		case State::Length:
+			if(!readValue(data, size)) {
+				break;
+			}
+			length = value;
+			if(opcode == Opcode::Copy) {
+				state = State::Offset;
+				value = 0;
+				valueShift = 0;
+			} else {
+				state = length ? State::Insert : State::Opcode;
+			}
+			break;
+
+		case State::Offset:
+			if(readValue(data, size)) {
+				// Decode zigzag value
+				copy(int32_t(value >> 1) ^ -int32_t(value & 1));
+			}
+			break;
+
+		case State::Insert: {
+			auto n = std::min(size, size_t(length));
+			if(!writeOutput(data, n)) {
+				break;
+			}
+			data += n;
+			size -= n;
+			length -= n;
+			if(length == 0) {
+				state = State::Opcode;
+			}
+			break;
+		}
+
+		case State::Complete:
+			setError("Unexpected data after end of patch");
+			break;
+
+		case State::Error:
+			return 0;
+		}
+	}
+
+	return (state == State::Error) ? 0 : origSize;
+}
+
+} // namespace Ota
@@ -0,0 +1,218 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * PipelinedOutputStream.cpp
+ *
+ *
+ */
+
+#include "include/Ota/PipelinedOutputStream.h"
+#include <Clock.h>
+#include <debug_progmem.h>
+
+namespace Ota
+{
+bool PipelinedOutputStream::init()
+{
+	for(auto& buf : buffers) {
+		buf.reset(new uint8_t[OTA_PIPELINE_BUFFER_SIZE]);
+		if(!buf) {
+			debug_e("[OTA] Out of memory");
+			return false;
+		}
+	}
+
+	stats = {};
+	startTime = millis();
+	writeOffset = 0;
+	erasedTo = 0;
+	fillLength = 0;
+	pendingLength = 0;
+	fillIndex = 0;
+	paused = false;
+	failed = false;
+	initialized = true;
+
+	// Start erasing straight away
+	timer.initializeMs<1>(staticService, this);
+	schedule();
+
+	return true;
+}
+
+size_t PipelinedOutputStream::write(const uint8_t* data, size_t size)
+{
+	if(failed) {
+		return 0;
+	}
+
+	if(!initialized && size > 0 && !init()) {
+		return 0;
+	}
+
+	if(written + size > maxLength) {
+		debug_e("The ROM size is bigger than the maximum allowed");
+		return 0;
+	}
+
+	auto src = data;
+	auto remaining = size;
+	while(remaining != 0) {
+		auto n = std::min(remaining, size_t(OTA_PIPELINE_BUFFER_SIZE) - fillLength);
+		memcpy(&buffers[fillIndex][fillLength], src, n);
+		fillLength += n;
+		src += n;
+		remaining -= n;
+		if(fillLength == OTA_PIPELINE_BUFFER_SIZE && !submit()) {
+			return 0;
+		}
+	}
+
+	written += size;
+	return size;
+}
+
+bool PipelinedOutputStream::submit()
+{
+	if(pendingLength != 0) {
+		// Background task hasn't caught up, have to wait for it
+		++stats.stallCount;
+		auto start = micros();
+		bool ok = flush();
+		stats.stallTime += micros() - start;
+		if(!ok) {
+			return false;
+		}
+	}
+
+	pendingLength = fillLength;
+	fillIndex ^= 1;
+	fillLength = 0;
+
+	// Sender may only fill the remaining buffer until this one has been written
+	pause(true);
+	schedule();
+	return true;
+}
+
+bool PipelinedOutputStream::flush()
+{
+	if(failed) {
+		return false;
+	}
+	if(pendingLength == 0) {
+		return true;
+	}
+
+	if(!eraseTo(writeOffset + pendingLength)) {
+		return false;
+	}
+
+	auto start = micros();
+	bool ok = partition.write(writeOffset, buffers[fillIndex ^ 1].get(), pendingLength);
+	stats.writeTime += micros() - start;
+	if(!ok) {
+		debug_e("[OTA] Write failed @ 0x%08x", uint32_t(writeOffset));
+		failed = true;
+		return false;
+	}
+
+	writeOffset += pendingLength;
+	pendingLength = 0;
+	pause(false);
+	return true;
+}
+
+bool PipelinedOutputStream::eraseTo(storage_size_t offset)
+{
+	auto blockSize = partition.getBlockSize();
+	while(erasedTo < offset) {
+		auto start = micros();
+		bool ok = partition.erase_range(erasedTo, blockSize);
+		stats.eraseTime += micros() - start;
+		if(!ok) {
+			debug_e("[OTA] Erase failed @ 0x%08x", uint32_t(erasedTo));
+			failed = true;
+			return false;
+		}
+		erasedTo += blockSize;
+	}
+	return true;
+}
+
+void PipelinedOutputStream::service()
+{
+	if(failed) {
+		return;
+	}
+
+	if(pendingLength != 0) {
+		flush();
+		schedule();
+		return;
+	}
+
+	// Idle, so erase one sector ahead of where the next buffer will go
+	auto blockSize = partition.getBlockSize();
+	storage_size_t limit = writeOffset + OTA_PIPELINE_BUFFER_SIZE + OTA_PIPELINE_ERASE_AHEAD * blockSize;
+	limit = std::min(limit, storage_size_t(maxLength));
+	if(erasedTo < limit && eraseTo(erasedTo + 1)) {
+		schedule();
+	}
+}
+
+void PipelinedOutputStream::schedule()
+{
+	if(!timer.isStarted()) {
+		timer.startOnce();
+	}
+}
+
+void PipelinedOutputStream::pause(bool state)
+{
+	if(!flowControl || state == paused) {
+		return;
+	}
+	paused = state;
+	if(state) {
+		++stats.pauseCount;
+	}
+	flowControl(state);
+}
+
+bool PipelinedOutputStream::close()
+{
+	if(!initialized) {
+		return true;
+	}
+
+	timer.stop();
+
+	bool success = flush();
+	if(success && fillLength != 0) {
+		pendingLength = fillLength;
+		fillIndex ^= 1;
+		fillLength = 0;
+		success = flush();
+	}
+
+	pause(false);
+	flowControl = nullptr;
+	for(auto& buf : buffers) {
+		buf.reset();
+	}
+	initialized = false;
+
+	stats.bytes = written;
+	stats.elapsed = millis() - startTime;
+	debug_i("[OTA] %u bytes in %u ms, %u bytes/s", stats.bytes, stats.elapsed, stats.getThroughput());
+	debug_i("[OTA] stalled %u times for %u us, paused %u times, erase %u us, write %u us", stats.stallCount,
+			stats.stallTime, stats.pauseCount, stats.eraseTime, stats.writeTime);
+
+	return success;
+}
+
+} // namespace Ota
@@ -52,6 +52,7 @@ size_t UpgradeOutputStream::write(const uint8_t* data, size_t size)
 bool UpgradeOutputStream::close()
 {
 	if(initialized) {
+		initialized = false;
 		return ota.end();
 	}
 
@@ -0,0 +1,164 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * DeltaOutputStream.h
+ *
+ * Important: Patch format definitions must be kept in sync with tools/otadelta.py
+ *
+*/
+
+#pragma once
+
+#include <Storage/Partition.h>
+#include <Data/Stream/ReadWriteStream.h>
+#include <Crypto/Md5.h>
+#include <memory>
+
+namespace Ota
+{
+/**
+ * @brief Write-only stream which applies a binary patch to reconstruct a firmware image
+ *
+ * Patches are created using `tools/otadelta.py` from the image currently installed on the device
+ * (the source) and the new firmware (the target). They consist of a header followed by a sequence of
+ * commands which either copy a range from the source partition or insert literal data.
+ *
+ * Patch data is processed as it arrives, using a small fixed amount of RAM, and the reconstructed
+ * image is written to the output stream. This is typically an `UpgradeOutputStream` for the partition to
+ * be upgraded:
+ *
+ * ```
+ * auto target = OtaManager.getNextBootPartition();
+ * auto stream = new Ota::DeltaOutputStream(OtaManager.getRunningPartition(), new Ota::UpgradeOutputStream(target));
+ * ```
+ *
+ * The patch header contains the MD5 hash of the target image, which is checked once the patch is complete.
+ * A mismatch, for example if the patch was created against a different source image, causes `write()` to fail.
+ */
+class DeltaOutputStream : public ReadWriteStream
+{
+public:
+	using Partition = Storage::Partition;
+
+	/**
+	 * @brief Patch file header
+	 */
+	struct Header {
+		uint32_t magic;
+		uint16_t version;
+		uint16_t reserved;
+		/// Size of source image the patch was created from
+		uint32_t sourceSize;
+		/// Size of reconstructed image
+		uint32_t targetSize;
+		/// Hash of reconstructed image
+		uint8_t targetMd5[16];
+	};
+
+	static constexpr uint32_t headerMagic{0x544c4453}; // "SDLT"
+	static constexpr uint16_t headerVersion{1};
+
+	/**
+	 * @brief Patch commands
+	 *
+	 * Each command is a single opcode byte followed by its parameters.
+	 * Lengths and offsets are unsigned LEB128-encoded values.
+	 */
+	enum class Opcode : uint8_t {
+		/// Patch complete
+		End = 0x00,
+		/// Length, offset: Copy from source. Offset is zigzag-encoded, relative to end of previous copy.
+		Copy = 0x01,
+		/// Length, data: Insert literal data
+		Insert = 0x02,
+	};
+
+	/**
+	 * @brief Constructor
+	 * @param source Partition containing the image the patch was created from
+	 * @param output Stream to write reconstructed image to, owned by this object
+	 */
+	DeltaOutputStream(Partition source, ReadWriteStream* output) : source(source), output(output)
+	{
+	}
+
+	size_t write(const uint8_t* data, size_t size) override;
+
+	StreamType getStreamType() const override
+	{
+		return eSST_Wrapper;
+	}
+
+	uint16_t readMemoryBlock(char*, int) override
+	{
+		return 0;
+	}
+
+	bool seek(int) override
+	{
+		return false;
+	}
+
+	/**
+	 * @brief Get number of bytes written to the output stream
+	 */
+	int available() override
+	{
+		return written;
+	}
+
+	bool isFinished() override
+	{
+		return true;
+	}
+
+	/**
+	 * @brief Determine if the complete patch has been applied and verified
+	 */
+	bool isComplete() const
+	{
+		return state == State::Complete;
+	}
+
+	bool hasError() const
+	{
+		return state == State::Error;
+	}
+
+private:
+	enum class State {
+		Header,
+		Opcode,
+		Length,
+		Offset,
+		Insert,
+		Complete,
+		Error,
+	};
+
+	void setError(const char* message);
+	void processHeader();
+	void processOpcode(uint8_t value);
+	bool readValue(const uint8_t*& data, size_t& size);
+	void copy(int32_t offset);
+	bool writeOutput(const void* data, size_t size);
+	void finish();
+
+	Partition source;
+	std::unique_ptr<ReadWriteStream> output;
+	Crypto::Md5 hash;
+	Header header{};
+	State state{State::Header};
+	Opcode opcode{};
+	uint32_t headerLength{0};
+	uint32_t value{0};
+	uint8_t valueShift{0};
+	uint32_t length{0};
+	uint32_t sourcePos{0};
+	uint32_t written{0};
+};
+
+} // namespace Ota
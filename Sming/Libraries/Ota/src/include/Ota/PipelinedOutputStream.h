@@ -0,0 +1,147 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * PipelinedOutputStream.h
+ *
+ *
+*/
+
+#pragma once
+
+#include "UpgradeOutputStream.h"
+#include <SimpleTimer.h>
+#include <Delegate.h>
+#include <memory>
+
+/**
+ * @brief Size of each of the two buffers used by PipelinedOutputStream
+ */
+#ifndef OTA_PIPELINE_BUFFER_SIZE
+#define OTA_PIPELINE_BUFFER_SIZE 4096
+#endif
+
+/**
+ * @brief Number of flash sectors PipelinedOutputStream keeps erased ahead of the write position
+ */
+#ifndef OTA_PIPELINE_ERASE_AHEAD
+#define OTA_PIPELINE_ERASE_AHEAD 2
+#endif
+
+namespace Ota
+{
+/**
+ * @brief Upgrade stream which overlaps flash erase and write with network reception
+ *
+ * Incoming data is collected into one of two buffers. When a buffer fills it is handed to a
+ * background task which erases the required sectors and writes it to flash, whilst the second
+ * buffer continues to receive data. When idle, the task erases sectors ahead of the write position
+ * so they are ready before the data arrives.
+ *
+ * If the sender gets ahead of the flash the stream asks the data source to stop sending using
+ * the flow control callback. For an HTTP download this withholds the TCP receive window.
+ * Where no flow control is available, `write()` blocks until the pending buffer has been flushed
+ * and the time spent is recorded as a stall.
+ *
+ * Data is written directly to the partition, bypassing the architecture upgrader, so no
+ * partition-wide erase takes place at the start of the upgrade.
+ */
+class PipelinedOutputStream : public UpgradeOutputStream
+{
+public:
+	/**
+	 * @brief Callback to control the data source
+	 * @param pause true to stop receiving, false to resume
+	 */
+	using FlowControl = Delegate<void(bool pause)>;
+
+	/**
+	 * @brief Performance statistics for an upgrade
+	 */
+	struct Stats {
+		/// Total bytes written
+		size_t bytes;
+		/// Milliseconds from first write until close
+		uint32_t elapsed;
+		/// Microseconds `write()` spent waiting for flash
+		uint32_t stallTime;
+		/// Microseconds spent erasing sectors
+		uint32_t eraseTime;
+		/// Microseconds spent writing to flash
+		uint32_t writeTime;
+		/// Number of times `write()` had to wait for flash
+		uint16_t stallCount;
+		/// Number of times the data source was paused
+		uint16_t pauseCount;
+
+		/**
+		 * @brief Get average throughput
+		 * @retval uint32_t Bytes per second
+		 */
+		uint32_t getThroughput() const
+		{
+			return elapsed ? uint64_t(bytes) * 1000 / elapsed : 0;
+		}
+	};
+
+	using UpgradeOutputStream::UpgradeOutputStream;
+
+	~PipelinedOutputStream()
+	{
+		close();
+	}
+
+	size_t write(const uint8_t* data, size_t size) override;
+
+	bool close() override;
+
+	/**
+	 * @brief Set callback used to pause and resume the data source
+	 */
+	void setFlowControl(FlowControl callback)
+	{
+		flowControl = callback;
+	}
+
+	const Stats& getStats() const
+	{
+		return stats;
+	}
+
+protected:
+	bool init() override;
+
+private:
+	static void staticService(void* param)
+	{
+		static_cast<PipelinedOutputStream*>(param)->service();
+	}
+
+	void service();
+	bool submit();
+	bool flush();
+	bool eraseTo(storage_size_t offset);
+	void schedule();
+	void pause(bool state);
+
+	std::unique_ptr<uint8_t[]> buffers[2];
+	SimpleTimer timer;
+	FlowControl flowControl;
+	Stats stats{};
+	uint32_t startTime{0};
+	// Partition offset for pending buffer
+	storage_size_t writeOffset{0};
+	// Partition offset of first sector not yet erased
+	storage_size_t erasedTo{0};
+	// Bytes in fill buffer
+	size_t fillLength{0};
+	// Bytes in pending buffer, 0 if none
+	size_t pendingLength{0};
+	uint8_t fillIndex{0};
+	bool paused{false};
+	bool failed{false};
+};
+
+} // namespace Ota
@@ -0,0 +1,135 @@
+#!/usr/bin/env python
+#
+# Create a binary patch for use with Ota::DeltaOutputStream
+#
+# Patch layout (all values little-endian):
+#
+#   Header      magic "SDLT", version, reserved, source size, target size, MD5 of target
+#   Commands    opcode byte followed by LEB128-encoded parameters:
+#                 0x00              End of patch
+#                 0x01 len offset   Copy from source, offset zigzag-encoded relative to end of previous copy
+#                 0x02 len data     Insert literal data
+#
+# Definitions must be kept in sync with DeltaOutputStream.h
+#
+
+import argparse
+import hashlib
+import struct
+import sys
+
+MAGIC = b'SDLT'
+VERSION = 1
+HEADER_FORMAT = '<4sHHII16s'
+
+OP_END = 0x00
+OP_COPY = 0x01
+OP_INSERT = 0x02
+
+# Shorter matches cost more to encode than inserting the data
+MIN_MATCH = 12
+
+
+def encode_value(value):
+    out = bytearray()
+    while True:
+        c = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(c | 0x80)
+        else:
+            out.append(c)
+            return out
+
+
+def zigzag(value):
+    return ((value << 1) ^ (value >> 31)) & 0xffffffff
+
+
+def match_length(source, src_pos, target, tgt_pos):
+    """Length of common run, compared in growing blocks"""
+    limit = min(len(source) - src_pos, len(target) - tgt_pos)
+    length = 0
+    step = 64
+    while length < limit:
+        n = min(step, limit - length)
+        if source[src_pos + length:src_pos + length + n] == target[tgt_pos + length:tgt_pos + length + n]:
+            length += n
+            step = min(step * 2, 4096)
+        elif n == 1:
+            break
+        else:
+            step = n // 2
+    return length
+
+
+def make_patch(source, target):
+    index = {}
+    for i in range(len(source) - MIN_MATCH + 1):
+        index.setdefault(source[i:i + MIN_MATCH], i)
+
+    commands = bytearray()
+    literal = bytearray()
+    copy_count = 0
+
+    def flush_literal():
+        if literal:
+            commands.append(OP_INSERT)
+            commands.extend(encode_value(len(literal)))
+            commands.extend(literal)
+            literal.clear()
+
+    source_pos = 0
+    pos = 0
+    while pos < len(target):
+        # Data following the previous copy is the most likely match
+        best_len, best_offset = 0, 0
+        for offset in (source_pos, index.get(target[pos:pos + MIN_MATCH])):
+            if offset is None or offset >= len(source):
+                continue
+            n = match_length(source, offset, target, pos)
+            if n > best_len:
+                best_len, best_offset = n, offset
+        if best_len < MIN_MATCH:
+            literal.append(target[pos])
+            pos += 1
+            continue
+        flush_literal()
+        commands.append(OP_COPY)
+        commands.extend(encode_value(best_len))
+        commands.extend(encode_value(zigzag(best_offset - source_pos)))
+        source_pos = best_offset + best_len
+        pos += best_len
+        copy_count += 1
+
+    flush_literal()
+    commands.append(OP_END)
+
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, 0, len(source), len(target), hashlib.md5(target).digest())
+    return header + commands, copy_count
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Sming OTA delta patch generator')
+    parser.add_argument('source', help='Firmware image currently installed on device')
+    parser.add_argument('target', help='New firmware image')
+    parser.add_argument('output', help='Patch file to create')
+    args = parser.parse_args()
+
+    with open(args.source, 'rb') as f:
+        source = f.read()
+    with open(args.target, 'rb') as f:
+        target = f.read()
+    patch, copy_count = make_patch(source, target)
+    with open(args.output, 'wb') as f:
+        f.write(patch)
+    print("Created patch '%s', %u bytes (%u%% of target), %u copies" %
+          (args.output, len(patch), 100 * len(patch) // max(len(target), 1), copy_count))
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except Exception as e:
+        print('** ERROR! %s' % e, file=sys.stderr)
+        sys.exit(1)
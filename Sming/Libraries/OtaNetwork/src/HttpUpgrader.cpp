@@ -41,6 +41,9 @@ void HttpUpgrader::fetchNextItem()
 
 	request->setMethod(HTTP_GET);
 	request->setResponseStream(it.getStream());
+	if(it.pipeline != nullptr) {
+		request->onHeadersComplete(RequestHeadersCompletedDelegate(&HttpUpgrader::itemHeadersComplete, this));
+	}
 
 	request->onRequestComplete(RequestCompletedDelegate(&HttpUpgrader::itemComplete, this));
 
@@ -51,10 +54,28 @@ void HttpUpgrader::fetchNextItem()
 	}
 }
 
+int HttpUpgrader::itemHeadersComplete(HttpConnection& client, HttpResponse&)
+{
+	// Hold off the sender whilst flash writes are outstanding
+	items[currentItem].pipeline->setFlowControl([&client](bool pause) {
+		if(pause) {
+			client.pauseReceive();
+		} else {
+			client.resumeReceive();
+		}
+	});
+	return 0;
+}
+
 int HttpUpgrader::itemComplete(HttpConnection&, bool success)
 {
 	auto& it = items[currentItem];
 
+	// Write out any buffered data now so errors are reported
+	if(success && it.pipeline != nullptr) {
+		success = it.pipeline->close();
+	}
+
 	if(!success) {
 		it.stream.release();
 		downloadFailed();
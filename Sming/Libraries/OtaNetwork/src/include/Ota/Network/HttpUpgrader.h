@@ -16,7 +16,7 @@
 #pragma once
 
 #include <Network/HttpClient.h>
-#include <Ota/UpgradeOutputStream.h>
+#include <Ota/PipelinedOutputStream.h>
 
 namespace Ota
 {
@@ -38,11 +38,18 @@ public:
 		Partition partition;					 // << partition to write the data to
 		size_t size{0};							 // << actual size of written bytes
 		std::unique_ptr<ReadWriteStream> stream; // (optional) output stream to use.
+		// Set if stream is pipelined
+		PipelinedOutputStream* pipeline{nullptr};
 
 		Item(String url, Partition partition, ReadWriteStream* stream) : url(url), partition(partition), stream(stream)
 		{
 		}
 
+		Item(String url, Partition partition, PipelinedOutputStream* stream)
+			: url(url), partition(partition), stream(stream), pipeline(stream)
+		{
+		}
+
 		ReadWriteStream* getStream()
 		{
 			if(!stream) {
@@ -78,6 +85,28 @@ public:
 		return items.addNew(new Item{firmwareFileUrl, partition, stream});
 	}
 
+	/**
+	 * @brief Add an item to update using a PipelinedOutputStream
+	 * @param firmwareFileUrl
+	 * @param partition Target partition to write
+	 * @param stream Pipelined stream to use, or nullptr to create one for the partition
+	 *
+	 * @retval bool
+	 *
+	 * Flash writes are overlapped with reception and the connection is paused whilst
+	 * the flash catches up.
+	 *
+	 * @note The stream writes the partition directly and does not go through the architecture
+	 * upgrader, so any image verification it would perform (e.g. `esp_ota_end` on Esp32) is skipped.
+	 */
+	bool addPipelinedItem(const String& firmwareFileUrl, Partition partition, PipelinedOutputStream* stream = nullptr)
+	{
+		if(stream == nullptr) {
+			stream = new PipelinedOutputStream(partition);
+		}
+		return items.addNew(new Item{firmwareFileUrl, partition, stream});
+	}
+
 	void start();
 
 	/**
@@ -108,6 +137,8 @@ public:
 	 * 		- default SSL client certificates
 	 *
 	 * @param request
+	 * @note Pipelined items replace any `onHeadersComplete` callback,
+	 * which is used to connect flow control to the connection.
 	 */
 	void setBaseRequest(HttpRequest* request)
 	{
@@ -128,6 +159,7 @@ protected:
 	void downloadComplete();
 	void fetchNextItem();
 
+	int itemHeadersComplete(HttpConnection& client, HttpResponse& response);
 	int itemComplete(HttpConnection& client, bool success);
 
 protected:
@@ -80,7 +80,12 @@ void BasicStream::processRomHeader()
 		if(romHeader.size <= slot.partition.size()) {
 			debug_i("Update slot %s [0x%08X..0x%08X)", slot.partition.name().c_str(), slot.partition.address(),
 					slot.partition.address() + romHeader.size);
-			ota.begin(slot.partition);
+			if(isDelta) {
+				patchOutput = new Ota::UpgradeOutputStream(slot.partition);
+				patch.reset(new Ota::DeltaOutputStream(OtaManager.getRunningPartition(), patchOutput));
+			} else {
+				ota.begin(slot.partition);
+			}
 			setupChunk(State::WriteRom, romHeader.size);
 		} else {
 			setError(Error::RomTooLarge);
@@ -92,6 +97,24 @@ void BasicStream::processRomHeader()
 	setupChunk(State::SkipRom, romHeader.size);
 }
 
+bool BasicStream::finishPatch()
+{
+	bool complete = patch->isComplete();
+	bool closed = patchOutput->close();
+	patch.reset();
+	patchOutput = nullptr;
+
+	if(!complete) {
+		setError(Error::PatchFailed);
+		return false;
+	}
+	if(!closed) {
+		setError(Error::FlashWriteFailed);
+		return false;
+	}
+	return true;
+}
+
 void BasicStream::verifyRoms()
 {
 	state = State::RomsComplete;
@@ -133,7 +156,8 @@ size_t BasicStream::write(const uint8_t* data, size_t size)
 		switch(state) {
 		case State::Header:
 			if(consume(data, size)) {
-				if(fileHeader.magic == expectedHeaderMagic) {
+				isDelta = (fileHeader.magic == (expectedHeaderMagic | OTA_HEADER_MAGIC_DELTA));
+				if(fileHeader.magic == expectedHeaderMagic || isDelta) {
 #ifndef ENABLE_OTA_DOWNGRADE
 					const auto buildTimestampFirmware = FSTR::readValue(&BuildTimestamp);
 					debug_i("Build timestamp of current firmware: %ull", buildTimestampFirmware);
@@ -145,7 +169,8 @@ size_t BasicStream::write(const uint8_t* data, size_t size)
 						break;
 					}
 #endif
-					debug_i("Starting firmware upgrade, receive %u image(s)", fileHeader.romCount);
+					debug_i("Starting firmware upgrade, receive %u %simage(s)", fileHeader.romCount,
+							isDelta ? "delta " : "");
 					nextRom();
 				} else {
 					setError(Error::InvalidFormat);
@@ -160,15 +185,25 @@ size_t BasicStream::write(const uint8_t* data, size_t size)
 			break;
 
 		case State::WriteRom: {
-			bool ok = ota.write(data, std::min(remainingBytes, size));
-			if(ok) {
-				if(consume(data, size)) {
-					ok = slot.updated = ota.end();
-					nextRom();
+			const size_t chunkSize = std::min(remainingBytes, size);
+			if(patch) {
+				if(patch->write(data, chunkSize) != chunkSize) {
+					setError(Error::PatchFailed);
+					break;
 				}
-			}
-			if(!ok) {
+			} else if(!ota.write(data, chunkSize)) {
 				setError(Error::FlashWriteFailed);
+				break;
+			}
+			if(consume(data, size)) {
+				if(patch) {
+					slot.updated = finishPatch();
+				} else if(!(slot.updated = ota.end())) {
+					setError(Error::FlashWriteFailed);
+				}
+				if(slot.updated) {
+					nextRom();
+				}
 			}
 		} break;
 
@@ -227,6 +262,8 @@ String toString(OtaUpgrade::BasicStream::Error code)
 		return F("Could not activate updated ROM");
 	case Error::OutOfMemory:
 		return F("Out of memory. Allocation failed.");
+	case Error::PatchFailed:
+		return F("Delta patch does not match running firmware");
 	case Error::Internal:
 		return F("Internal error");
 	default:
@@ -13,6 +13,8 @@
 #include <Data/Stream/ReadWriteStream.h>
 #include <Storage/Partition.h>
 #include <Ota/Manager.h>
+#include <Ota/DeltaOutputStream.h>
+#include <Ota/UpgradeOutputStream.h>
 #include "FileFormat.h"
 #ifdef ENABLE_OTA_SIGNING
 #include "SignatureVerifier.h"
@@ -61,6 +63,7 @@ public:
 		FlashWriteFailed,	///< Error while writing to Flash memory.
 		RomActivationFailed, ///< Error while activating updated ROM slot.
 		OutOfMemory,		 ///< Dynamic memory allocation failed
+		PatchFailed,		 ///< Delta patch could not be applied to the running ROM
 		Internal,			 ///< An unexpected error occurred.
 	};
 
@@ -116,6 +119,11 @@ private:
 	// Instead of RbootOutputStream, the rboot write API is used directly because in a future extension the OTA file may contain data for multiple FLASH regions.
 	OtaUpgrader ota;
 
+	// Delta images are reconstructed from the running ROM and written via an UpgradeOutputStream
+	std::unique_ptr<Ota::DeltaOutputStream> patch;
+	Ota::UpgradeOutputStream* patchOutput{nullptr};
+	bool isDelta{false};
+
 	enum class State {
 		Error,
 		Header,
@@ -177,6 +185,10 @@ private:
 	 * If successful, the upgraded slot is set as active ROM using the rBoot API.
 	 */
 	void verifyRoms();
+	/** Called after the last byte of a delta ROM image has been written.
+	 * Checks the reconstructed image and finalises the flash writes.
+	 */
+	bool finishPatch();
 };
 
 } // namespace OtaUpgrade
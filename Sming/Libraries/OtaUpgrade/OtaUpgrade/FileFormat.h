@@ -40,6 +40,8 @@ struct OtaRomHeader {
 #define OTA_HEADER_MAGIC_SIGNED 0xf01af02a
 /** Expected value for OTA_FileHeader::magic when signing is disabled. */
 #define OTA_HEADER_MAGIC_NOT_SIGNED 0xf01af020
+/** Added to OTA_FileHeader::magic if ROM images are delta patches against the running ROM. */
+#define OTA_HEADER_MAGIC_DELTA 0x00000100
 
 #ifdef __cplusplus
 }
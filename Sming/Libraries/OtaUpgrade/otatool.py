@@ -22,6 +22,7 @@ def import_nacl():
 
 MAGIC_UNSIGNED = 0xf01af020
 MAGIC_SIGNED = 0xf01af02a
+MAGIC_DELTA = 0x00000100
 
 def load_keys(keyfilepath):
     try:
@@ -92,6 +93,8 @@ def make_ota_file(args):
     assert len(args.roms) < 256
 
     magic = MAGIC_SIGNED if args.signed else MAGIC_UNSIGNED
+    if args.delta:
+        magic |= MAGIC_DELTA
     timestamp = int((datetime.now() - datetime(1900, 1, 1)).total_seconds() * 1000)
     ota = struct.pack('<IQBxxx', magic, timestamp, len(args.roms))
 
@@ -207,6 +210,8 @@ def make_parser():
         help='Input file containing private key for signing and/or encryption of the generated OTA file.')
     mkota_parser.add_argument('-s', '--signed', action='store_true', default=False, help='Sign upgrade image')
     mkota_parser.add_argument('-e', '--encrypted', action='store_true', default=False, help='Encrypt upgrade file')
+    mkota_parser.add_argument('-d', '--delta', action='store_true', default=False,
+        help='ROM images are patches created by otadelta.py against the ROM running on the device')
 
     def get_address(string):
         try:
@@ -16,6 +16,7 @@
 
 #include "SPI.h"
 #include <esp_systemapi.h>
+#include <Platform/System.h>
 #include "espinc/eagle_soc.h"
 #include "espinc/spi_register.h"
 #include "espinc/spi_struct.h"
@@ -31,6 +32,11 @@
 	}                                                                                                                  \
 	SpiDevice dev;
 
+// Interrupt status register shared by SPI0, SPI1 and I2S
+#define SPI_IRQ_STATUS_REG 0x3ff00020
+#define SPI0_IRQ BIT(4)
+#define SPI1_IRQ BIT(7)
+
 SPIClass SPI;
 
 namespace
@@ -157,6 +163,98 @@ struct SpiDevice {
 	}
 };
 
+/*
+ * Asynchronous request in progress. Data is transferred one FIFO-full at a time
+ * from the SPI interrupt, which queues the completion task when finished.
+ */
+struct RequestState {
+	SPIRequest* request;
+	size_t pos;
+	size_t chunkSize;
+	bool restoreByteOrder;
+	TaskCallback onComplete;
+	void* param;
+};
+
+RequestState requestState;
+bool interruptAttached;
+
+void IRAM_ATTR startRequestChunk()
+{
+	auto hw = &SPI1;
+	auto& req = *requestState.request;
+	auto n = std::min(req.length - requestState.pos, SPI_FIFO_SIZE);
+	requestState.chunkSize = n;
+
+	if(n == 0) {
+		// Command and/or address only
+		hw->user.usr_mosi = false;
+		hw->cmd.usr = true;
+		return;
+	}
+
+	uint32_t words[SPI_FIFO_SIZE / 4];
+	if(req.out == nullptr) {
+		memset(words, 0xff, n);
+	} else {
+		memcpy(words, static_cast<const uint8_t*>(req.out) + requestState.pos, n);
+	}
+	for(unsigned i = 0; i < ALIGNUP4(n) / 4; ++i) {
+		hw->data_buf[i] = words[i];
+	}
+
+	hw->user.usr_mosi = true;
+	hw->user1.usr_mosi_bitlen = n * 8 - 1;
+	hw->cmd.usr = true;
+}
+
+void IRAM_ATTR spiInterruptHandler(void*)
+{
+	uint32_t status = READ_PERI_REG(SPI_IRQ_STATUS_REG);
+	if(status & SPI0_IRQ) {
+		// Not ours, but must be cleared
+		SPI0.slave.val &= ~0x3ff;
+	}
+	if(!(status & SPI1_IRQ)) {
+		return;
+	}
+
+	auto hw = &SPI1;
+	hw->slave.trans_done = false;
+	if(requestState.request == nullptr) {
+		return;
+	}
+
+	auto& req = *requestState.request;
+	auto n = requestState.chunkSize;
+	if(req.in != nullptr && n != 0) {
+		uint32_t words[SPI_FIFO_SIZE / 4];
+		for(unsigned i = 0; i < ALIGNUP4(n) / 4; ++i) {
+			words[i] = hw->data_buf[i];
+		}
+		memcpy(static_cast<uint8_t*>(req.in) + requestState.pos, words, n);
+	}
+	requestState.pos += n;
+
+	// Command and address are only sent at the start
+	hw->user.usr_command = false;
+	hw->user.usr_addr = false;
+
+	if(requestState.pos < req.length) {
+		startRequestChunk();
+		return;
+	}
+
+	hw->slave.trans_inten = false;
+	hw->user.usr_mosi = true;
+	if(requestState.restoreByteOrder) {
+		hw->user.rd_byte_order = true;
+		hw->user.wr_byte_order = true;
+	}
+	requestState.request = nullptr;
+	System.queueCallback(requestState.onComplete, requestState.param);
+}
+
 /**
  * @brief Calculate the closest prescale value for a given frequency and clock-divider
  * @param  freq target SPI bus frequency, in Hz
@@ -370,6 +468,57 @@ void SPIClass::prepare(SPISettings& settings)
 #endif
 }
 
+void SPIClass::startRequest(SPIRequest& request)
+{
+	GET_DEVICE();
+
+	if(!interruptAttached) {
+		ETS_SPI_INTR_ATTACH(spiInterruptHandler, nullptr);
+		ETS_SPI_INTR_ENABLE();
+		interruptAttached = true;
+	}
+
+	auto onComplete = [](void* param) { static_cast<SPIClass*>(param)->requestComplete(); };
+	requestState = RequestState{&request, 0, 0, !lsbFirst, onComplete, this};
+
+	// As for transfer(), always send LS byte first to match system byte order
+	if(!lsbFirst) {
+		dev.set_byte_order(LSBFIRST);
+	}
+
+	auto hw = dev.hw;
+	if(request.cmdBits != 0) {
+		/*
+		 * Command is output bits 7-0 then 15-8, so for MSB first
+		 * left-align the value and swap bytes.
+		 */
+		uint16_t cmd = request.cmd;
+		if(!lsbFirst) {
+			cmd <<= 16 - request.cmdBits;
+			cmd = (cmd >> 8) | (cmd << 8);
+		}
+		hw->user2.usr_command_value = cmd;
+		hw->user2.usr_command_bitlen = request.cmdBits - 1;
+		hw->user.usr_command = true;
+	}
+	if(request.addrBits != 0) {
+		// Address is output MS byte first, so LSB first requires whole bytes
+		uint32_t addr = request.addr;
+		if(lsbFirst) {
+			addr = __builtin_bswap32(addr);
+		} else {
+			addr <<= 32 - request.addrBits;
+		}
+		hw->addr = addr;
+		hw->user1.usr_addr_bitlen = request.addrBits - 1;
+		hw->user.usr_addr = true;
+	}
+
+	hw->slave.trans_done = false;
+	hw->slave.trans_inten = true;
+	startRequestChunk();
+}
+
 bool SPIClass::loopback(bool enable)
 {
 	(void)enable;
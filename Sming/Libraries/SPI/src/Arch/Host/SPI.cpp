@@ -3,6 +3,7 @@
 #include <debug_progmem.h>
 #include <stringconversion.h>
 #include <Data/BitSet.h>
+#include <SimpleTimer.h>
 
 #define SPI_FIFO_DEPTH 8
 
@@ -77,6 +78,9 @@ public:
 	}
 
 	SPIClass::IoCallback ioCallback;
+	// Simulates time taken by asynchronous requests
+	SimpleTimer requestTimer;
+	uint32_t frequency{SPI_SPEED_DEFAULT};
 
 private:
 	FIFO<uint16_t, SPI_FIFO_DEPTH> fifo;
@@ -257,10 +261,25 @@ void SPIClass::prepare(SPISettings& settings)
 	GET_DEVICE();
 
 	cr0val = dev.configure(8, settings.dataMode, 0);
+	dev.frequency = std::max(settings.speed.frequency, 1U);
 
 	lsbFirst = (settings.bitOrder == LSBFIRST);
 }
 
+void SPIClass::startRequest(SPIRequest& request)
+{
+	GET_DEVICE();
+
+	// Data is transferred immediately but completion is delayed according to bus speed
+	transferRequest(request);
+
+	uint64_t bitCount = request.cmdBits + request.addrBits + request.length * 8;
+	auto duration = std::max(bitCount * 1000000U / dev.frequency, uint64_t(1));
+	auto callback = [](void* param) { static_cast<SPIClass*>(param)->requestComplete(); };
+	dev.requestTimer.initializeUs(duration, callback, this);
+	dev.requestTimer.startOnce();
+}
+
 bool SPIClass::loopback(bool enable)
 {
 	(void)enable;
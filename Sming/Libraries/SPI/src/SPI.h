@@ -77,6 +77,9 @@ public:
 
 protected:
 	void prepare(SPISettings& settings) override;
+#if defined(ARCH_ESP8266) || defined(ARCH_HOST)
+	void startRequest(SPIRequest& request) override;
+#endif
 
 private:
 #ifndef ARCH_ESP8266
@@ -0,0 +1,133 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * SPIBase.cpp
+ *
+ ****/
+
+#include "SPIBase.h"
+#include <Platform/System.h>
+#include <debug_progmem.h>
+#include <algorithm>
+#include <cstring>
+
+bool SPIBase::execute(SPIRequest& request)
+{
+	if(request.busy) {
+		debug_e("[SPI] Request already queued");
+		return false;
+	}
+
+	if(request.cmdBits > 16 || request.addrBits > 32 || request.cmdBits + request.addrBits + request.length == 0) {
+		debug_e("[SPI] Invalid request");
+		return false;
+	}
+
+	request.busy = true;
+	request.next = nullptr;
+	if(queueTail != nullptr) {
+		queueTail->next = &request;
+		queueTail = &request;
+		if(retryStart) {
+			// Head request could not be started previously
+			retryStart = false;
+			startRequest(*queueHead);
+		}
+		return true;
+	}
+
+	queueHead = queueTail = &request;
+	startNextRequest();
+	return true;
+}
+
+void SPIBase::startNextRequest()
+{
+	auto& request = *queueHead;
+	if(request.settings != nullptr) {
+		prepare(*request.settings);
+	}
+	if(request.csPin != SPI_PIN_NONE) {
+		digitalWrite(request.csPin, LOW);
+	}
+	startRequest(request);
+}
+
+void SPIBase::startRequest(SPIRequest&)
+{
+	auto callback = [](void* param) {
+		auto spi = static_cast<SPIBase*>(param);
+		if(spi->queueHead != nullptr) {
+			spi->transferRequest(*spi->queueHead);
+			spi->requestComplete();
+		}
+	};
+
+	if(!System.queueCallback(callback, this)) {
+		debug_e("[SPI] Task queue full, request deferred");
+		retryStart = true;
+	}
+}
+
+void SPIBase::transferRequest(SPIRequest& request)
+{
+	if(request.cmdBits != 0) {
+		transfer32(request.cmd, request.cmdBits);
+	}
+	if(request.addrBits != 0) {
+		transfer32(request.addr, request.addrBits);
+	}
+
+	auto out = static_cast<const uint8_t*>(request.out);
+	auto in = static_cast<uint8_t*>(request.in);
+	if(out != nullptr && out == in) {
+		transfer(in, request.length);
+		return;
+	}
+
+	// Separate (or absent) buffers so go via a temporary one
+	uint8_t buffer[64];
+	for(size_t pos = 0; pos < request.length; pos += sizeof(buffer)) {
+		auto n = std::min(request.length - pos, sizeof(buffer));
+		if(out == nullptr) {
+			memset(buffer, 0xff, n);
+		} else {
+			memcpy(buffer, &out[pos], n);
+		}
+		transfer(buffer, n);
+		if(in != nullptr) {
+			memcpy(&in[pos], buffer, n);
+		}
+	}
+}
+
+void SPIBase::requestComplete()
+{
+	auto request = queueHead;
+	if(request == nullptr) {
+		return;
+	}
+
+	if(request->csPin != SPI_PIN_NONE) {
+		digitalWrite(request->csPin, HIGH);
+	}
+
+	queueHead = request->next;
+	if(queueHead == nullptr) {
+		queueTail = nullptr;
+	}
+	request->next = nullptr;
+	request->busy = false;
+
+	// Keep the bus occupied whilst the application deals with this one
+	if(queueHead != nullptr) {
+		startNextRequest();
+	}
+
+	if(request->callback) {
+		request->callback(*request);
+	}
+}
@@ -14,6 +14,7 @@
 #pragma once
 
 #include "SPISettings.h"
+#include "SPIRequest.h"
 #include <cstddef>
 
 // for compatibility when porting from Arduino
@@ -179,6 +180,37 @@ public:
 
 	/** @} */
 
+	/**
+	 * @name Asynchronous requests
+	 * @{
+	 *
+	 * Requests are queued and executed in order, allowing the application to continue
+	 * with other work whilst data is transferred. Implementations use hardware support where
+	 * available, otherwise requests are performed using blocking transfers from task context.
+	 *
+	 * Blocking transfers must not be used whilst requests are pending.
+	 */
+
+	/**
+	 * @brief Queue a request for execution
+	 * @param request Must remain valid until its callback has been invoked
+	 * @retval bool false if request is already queued or invalid
+	 *
+	 * If the request at the head of the queue could not be started because the task queue was full,
+	 * then another attempt is made here.
+	 */
+	bool execute(SPIRequest& request);
+
+	/**
+	 * @brief Determine if any requests are queued or in progress
+	 */
+	bool isBusy() const
+	{
+		return queueHead != nullptr;
+	}
+
+	/** @} */
+
 	/**
 	 * @brief For testing, tie MISO <-> MOSI internally
 	 *
@@ -203,6 +235,31 @@ protected:
 	 */
 	virtual void prepare(SPISettings& settings) = 0;
 
+	/**
+	 * @brief Begin execution of a request
+	 * @param request The request at the head of the queue
+	 *
+	 * Bus settings have been applied and chip select asserted.
+	 * Implementations must call requestComplete() from task context when the request has finished,
+	 * but not from within this method.
+	 *
+	 * The default implementation calls transferRequest() from a queued task callback.
+	 * If that callback cannot be queued then the request is started again on the next call to execute().
+	 */
+	virtual void startRequest(SPIRequest& request);
+
+	/**
+	 * @brief Perform all phases of a request using blocking transfers
+	 */
+	void transferRequest(SPIRequest& request);
+
+	/**
+	 * @brief Called by implementation when the current request has finished
+	 *
+	 * Releases chip select, starts the next queued request (if any) then invokes the callback.
+	 */
+	void requestComplete();
+
 	/**
 	 * @brief Assign any default pins
 	 */
@@ -220,6 +277,13 @@ protected:
 	}
 
 	SpiPins mPins;
+
+private:
+	void startNextRequest();
+
+	SPIRequest* queueHead{nullptr};
+	SPIRequest* queueTail{nullptr};
+	bool retryStart{false}; ///< Set if startRequest() could not queue its task callback
 };
 
 /** @} */
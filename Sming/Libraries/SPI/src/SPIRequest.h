@@ -0,0 +1,118 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * SPIRequest.h
+ *
+ ****/
+
+#pragma once
+
+#include "SPISettings.h"
+#include <Delegate.h>
+
+/** @ingroup base_spi
+ *  @{
+ */
+
+/**
+ * @brief Use when no pin is required
+ */
+static constexpr uint8_t SPI_PIN_NONE{0xfe};
+
+/**
+ * @brief Defines an SPI transaction for asynchronous execution
+ *
+ * A request consists of up to three phases, each of which is optional:
+ *
+ * - Command: up to 16 bits, output only
+ * - Address: up to 32 bits, output only
+ * - Data: any number of bytes, output and/or input
+ *
+ * Command and address values are sent in the same bit order as the data, as for transfer32().
+ * Data is sent from `out` and received into `in`. These may point to the same buffer for an
+ * in-place transfer, as with SPIBase::transfer(). If `out` is nullptr then 0xFF bytes are sent,
+ * and if `in` is nullptr the received data is discarded.
+ *
+ * Requests are queued using SPIBase::execute() and must remain valid until the callback is invoked.
+ * Buffers must not be accessed by the application whilst the request is busy.
+ */
+struct SPIRequest {
+	/**
+	 * @brief Invoked in task context when a request has completed
+	 * @param request The completed request, which may be queued again from within the callback
+	 */
+	using Callback = Delegate<void(SPIRequest& request)>;
+
+	SPIRequest* next{nullptr}; ///< Used internally for queueing
+	/**
+	 * @brief Bus settings to use for this request
+	 *
+	 * If nullptr then the bus remains as configured by the previous transaction.
+	 */
+	SPISettings* settings{nullptr};
+	uint16_t cmd{0};
+	uint8_t cmdBits{0};
+	uint8_t addrBits{0};
+	uint32_t addr{0};
+	const void* out{nullptr};
+	void* in{nullptr};
+	size_t length{0}; ///< Size of data phase in bytes
+	/**
+	 * @brief Chip select, driven LOW for the duration of the request
+	 *
+	 * Pin must already be configured as an output.
+	 */
+	uint8_t csPin{SPI_PIN_NONE};
+	/**
+	 * @brief Set when request is queued, cleared on completion
+	 */
+	volatile bool busy{false};
+	Callback callback;
+
+	void setCommand(uint16_t command, uint8_t bits)
+	{
+		cmd = command;
+		cmdBits = bits;
+	}
+
+	void setAddress(uint32_t address, uint8_t bits)
+	{
+		addr = address;
+		addrBits = bits;
+	}
+
+	/**
+	 * @brief Data phase sends from a buffer, input is discarded
+	 */
+	void setOutput(const void* data, size_t size)
+	{
+		out = data;
+		in = nullptr;
+		length = size;
+	}
+
+	/**
+	 * @brief Data phase receives into a buffer, sending 0xFF
+	 */
+	void setInput(void* buffer, size_t size)
+	{
+		out = nullptr;
+		in = buffer;
+		length = size;
+	}
+
+	/**
+	 * @brief Data phase sends buffer content and replaces it with received data
+	 */
+	void setDuplex(void* buffer, size_t size)
+	{
+		out = buffer;
+		in = buffer;
+		length = size;
+	}
+};
+
+/** @} */
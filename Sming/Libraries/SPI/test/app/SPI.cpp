@@ -31,6 +31,24 @@ void ioCallback(uint16_t c, uint8_t bits, bool read)
 }
 #endif
 
+#if defined(ARCH_HOST) && !SPISOFT_ENABLE
+#define CHECK_ASYNC_IO
+// Captures start of asynchronous request output
+struct IoRecord {
+	uint16_t value;
+	uint8_t bits;
+};
+IoRecord ioRecords[4];
+unsigned ioRecordCount;
+
+void recordIo(uint16_t c, uint8_t bits, bool read)
+{
+	if(!read && ioRecordCount < ARRAY_SIZE(ioRecords)) {
+		ioRecords[ioRecordCount++] = {c, bits};
+	}
+}
+#endif
+
 #if SPISOFT_ENABLE
 SPISoft spi(0);
 #else
@@ -65,6 +83,7 @@ public:
 #ifdef ARCH_HOST
 		setDigitalHooks(nullptr);
 		loopbackTests();
+		asyncTests();
 #else
 		settings.speed = 150e3;
 		spi.beginTransaction(settings);
@@ -283,6 +302,95 @@ public:
 		}
 	}
 
+	void asyncTests()
+	{
+		TEST_CASE("Asynchronous requests")
+		{
+			settings.speed = 1000000;
+			settings.bitOrder = MSBFIRST;
+
+			for(unsigned i = 0; i < sizeof(txData); ++i) {
+				txData[i] = i;
+			}
+			memset(rxData, 0, sizeof(rxData));
+			memcpy(duplexData, txData, sizeof(duplexData));
+
+			// Command, address and data from separate buffers
+			requests[0].settings = &settings;
+			requests[0].setCommand(0x9f, 8);
+			requests[0].setAddress(0x123456, 24);
+			requests[0].out = txData;
+			requests[0].in = rxData;
+			requests[0].length = sizeof(txData);
+			// Input only
+			requests[1].setInput(inputData, sizeof(inputData));
+			// In-place transfer
+			requests[2].setDuplex(duplexData, sizeof(duplexData));
+
+			completionCount = 0;
+#ifdef CHECK_ASYNC_IO
+			ioRecordCount = 0;
+			SPI.setDebugIoCallback(recordIo);
+#endif
+			// First request starts immediately
+			asyncStartTime = micros();
+			for(auto& req : requests) {
+				req.callback = [this](SPIRequest& req) { requestComplete(req); };
+				REQUIRE(spi.execute(req));
+			}
+			REQUIRE(spi.isBusy());
+			REQUIRE(requests[2].busy);
+			// Cannot queue twice
+			REQUIRE(!spi.execute(requests[2]));
+
+			return pending();
+		}
+	}
+
+	void requestComplete(SPIRequest& req)
+	{
+		unsigned index = &req - requests;
+		debug_i("Request #%u complete", index);
+		REQUIRE_EQ(index, completionCount);
+		REQUIRE(!req.busy);
+		++completionCount;
+		if(completionCount < ARRAY_SIZE(requests)) {
+			return;
+		}
+
+		REQUIRE(!spi.isBusy());
+
+		uint32_t elapsed = micros() - asyncStartTime;
+		unsigned bitCount = 8 + 24 + 8 * (sizeof(txData) + sizeof(inputData) + sizeof(duplexData));
+		debug_i("Asynchronous requests took %u us, %u bits", elapsed, bitCount);
+#if !SPISOFT_ENABLE
+		// Host hardware completion time is simulated according to bus speed
+		REQUIRE(elapsed >= uint64_t(bitCount) * 1000000 / settings.speed.frequency);
+#endif
+
+		REQUIRE(memcmp(txData, rxData, sizeof(txData)) == 0);
+		for(auto c : inputData) {
+			REQUIRE_EQ(c, 0xff);
+		}
+		REQUIRE(memcmp(txData, duplexData, sizeof(duplexData)) == 0);
+
+#ifdef CHECK_ASYNC_IO
+		SPI.setDebugIoCallback(nullptr);
+		// MSB first: 8-bit command, then 24-bit address sent as 16 + 8 bits as for transfer32(), then data
+		REQUIRE_EQ(ioRecordCount, ARRAY_SIZE(ioRecords));
+		REQUIRE_EQ(ioRecords[0].value, 0x9f);
+		REQUIRE_EQ(ioRecords[0].bits, 8);
+		REQUIRE_EQ(ioRecords[1].value, 0x1234);
+		REQUIRE_EQ(ioRecords[1].bits, 16);
+		REQUIRE_EQ(ioRecords[2].value, 0x56);
+		REQUIRE_EQ(ioRecords[2].bits, 8);
+		REQUIRE_EQ(ioRecords[3].value, txData[0]);
+		REQUIRE_EQ(ioRecords[3].bits, 8);
+#endif
+
+		complete();
+	}
+
 	void send(uint32_t outValue, uint8_t bits)
 	{
 		outValue &= BIT(bits) - 1;
@@ -370,6 +478,13 @@ private:
 
 	Timer timer;
 	MinMaxTimes<CycleTimer> cycleTimes;
+	SPIRequest requests[3];
+	uint8_t txData[200];
+	uint8_t rxData[200];
+	uint8_t inputData[10];
+	uint8_t duplexData[100];
+	unsigned completionCount{0};
+	uint32_t asyncStartTime{0};
 	size_t totalBitCount{0};
 	SPISettings settings;
 	unsigned loopCount{0};
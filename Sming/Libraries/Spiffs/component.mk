@@ -24,6 +24,10 @@ COMPONENT_CXXFLAGS		+= -DSPIFF_FILEDESC_COUNT=$(SPIFF_FILEDESC_COUNT)
 
 COMPONENT_CFLAGS		+= -Wno-tautological-compare
 
+COMPONENT_VARS			+= SPIFFS_NAME_INDEX
+SPIFFS_NAME_INDEX		?= 0
+COMPONENT_CXXFLAGS		+= -DSPIFFS_NAME_INDEX=$(SPIFFS_NAME_INDEX)
+
 COMPONENT_RELINK_VARS	+= SPIFFS_OBJ_META_LEN
 SPIFFS_OBJ_META_LEN		?= 16
 COMPONENT_CFLAGS		+= -DSPIFFS_OBJ_META_LEN=$(SPIFFS_OBJ_META_LEN)
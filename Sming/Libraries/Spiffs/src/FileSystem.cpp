@@ -40,6 +40,10 @@ struct FileDir {
 	unsigned pathlen;
 	String directories; // Names of discovered directories
 	spiffs_DIR d;
+	// Position when listing using name index
+	NameIndex::Index dir;
+	NameIndex::Index nextDir;
+	NameIndex::Index nextFile;
 };
 
 constexpr uint32_t logicalBlockSize{4096 * 2};
@@ -87,6 +91,34 @@ void fillStat(Stat& stat, const SpiffsMetaBuffer& smb)
 	stat.compression = smb.meta.compression;
 }
 
+/*
+ * Check page contents is the current index header for an object
+ */
+bool isIndexHeader(const spiffs_page_object_ix_header& hdr, spiffs_obj_id id)
+{
+	// Flags are active low
+	constexpr uint8_t mask{SPIFFS_PH_FLAG_USED | SPIFFS_PH_FLAG_FINAL | SPIFFS_PH_FLAG_INDEX | SPIFFS_PH_FLAG_IXDELE |
+						   SPIFFS_PH_FLAG_DELET};
+	constexpr uint8_t value{SPIFFS_PH_FLAG_IXDELE | SPIFFS_PH_FLAG_DELET};
+	return (hdr.p_hdr.obj_id & ~SPIFFS_OBJ_ID_IX_FLAG) == id && hdr.p_hdr.span_ix == 0 &&
+		   (hdr.p_hdr.flags & mask) == value;
+}
+
+/*
+ * Equivalent of SPIFFS_stat() using an index header we've already read
+ */
+void fillSpiffsStat(spiffs_stat& ss, const spiffs_page_object_ix_header& hdr, spiffs_page_ix pix)
+{
+	ss.obj_id = hdr.p_hdr.obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
+	ss.size = (hdr.size == SPIFFS_UNDEFINED_LEN) ? 0 : hdr.size;
+	ss.type = hdr.type;
+	ss.pix = pix;
+	memcpy(ss.name, hdr.name, sizeof(ss.name));
+#ifdef SPIFFS_STORE_META
+	memcpy(ss.meta, hdr.meta, sizeof(ss.meta));
+#endif
+}
+
 } // namespace
 
 s32_t FileSystem::f_read(struct spiffs_t* spiffs, u32_t addr, u32_t size, u8_t* dst)
@@ -185,11 +217,171 @@ int FileSystem::tryMount(spiffs_config& cfg)
 			err = translateSpiffsError(err);
 		}
 		debug_ifserr(err, "SPIFFS_mount()");
+		return err;
 	}
 
+#if SPIFFS_NAME_INDEX
+	buildIndex();
+#endif
+
 	return err;
 }
 
+/*
+ * Scan the volume once to record the location of every file.
+ * If there isn't enough RAM then we carry on without an index.
+ */
+int FileSystem::buildIndex()
+{
+	if(!index) {
+		index.reset(new NameIndex);
+		if(!index) {
+			return Error::NoMem;
+		}
+	}
+	index->clear();
+
+	spiffs_DIR d;
+	if(SPIFFS_opendir(handle(), nullptr, &d) == nullptr) {
+		index.reset();
+		return translateSpiffsError(SPIFFS_errno(handle()));
+	}
+
+	int err = FS_OK;
+	spiffs_dirent e;
+	while(SPIFFS_readdir(&d, &e) != nullptr) {
+		auto id = e.obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
+		if(!index->add(reinterpret_cast<const char*>(e.name), id, e.pix)) {
+			err = Error::NoMem;
+			break;
+		}
+	}
+	SPIFFS_closedir(&d);
+
+	if(err < 0) {
+		debug_w("[SPIFFS] Insufficient RAM for name index");
+		index.reset();
+		return err;
+	}
+
+	debug_d("[SPIFFS] Indexed %u files", index->getFileCount());
+	return FS_OK;
+}
+
+/*
+ * Read index header for an entry, locating it by object ID if it has moved
+ */
+int FileSystem::readIndexHeader(NameIndex::File& entry, spiffs_page_object_ix_header& hdr)
+{
+	auto fs = handle();
+
+	auto read = [&](spiffs_page_ix pix) -> bool {
+		if(pix >= SPIFFS_MAX_PAGES(fs) || SPIFFS_IS_LOOKUP_PAGE(fs, pix)) {
+			return false;
+		}
+		int err = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_READ, 0, SPIFFS_PAGE_TO_PADDR(fs, pix), sizeof(hdr),
+							 reinterpret_cast<u8_t*>(&hdr));
+		return err == SPIFFS_OK && isIndexHeader(hdr, entry.id);
+	};
+
+	if(read(entry.pix)) {
+		return SPIFFS_OK;
+	}
+
+	spiffs_page_ix pix;
+	int err = spiffs_obj_lu_find_id_and_span(fs, entry.id | SPIFFS_OBJ_ID_IX_FLAG, 0, 0, &pix);
+	if(err < 0) {
+		return err;
+	}
+	if(!read(pix)) {
+		return SPIFFS_ERR_NOT_FOUND;
+	}
+	entry.pix = pix;
+	return SPIFFS_OK;
+}
+
+/*
+ * Locate a file using the name index
+ * Returns the index entry, or a SPIFFS error code
+ */
+int FileSystem::findIndexed(const char* path, spiffs_page_object_ix_header& hdr)
+{
+	for(auto i = index->find(path); i != NameIndex::none; i = index->find(path, i)) {
+		if(readIndexHeader(index->getFile(i), hdr) < 0) {
+			continue;
+		}
+		if(strcmp(reinterpret_cast<const char*>(hdr.name), path) == 0) {
+			return i;
+		}
+	}
+
+	return SPIFFS_ERR_NOT_FOUND;
+}
+
+/*
+ * Existing files are opened directly from their index header page.
+ * SPIFFS only needs to search by name when creating a file.
+ */
+spiffs_file FileSystem::openIndexed(const char* path, spiffs_flags sflags)
+{
+	spiffs_page_object_ix_header hdr;
+	int i = findIndexed(path, hdr);
+	if(i >= 0) {
+		return SPIFFS_open_by_page(handle(), index->getFile(i).pix, sflags & ~SPIFFS_O_CREAT, 0);
+	}
+	if(i != SPIFFS_ERR_NOT_FOUND || (sflags & SPIFFS_O_CREAT) == 0) {
+		return i;
+	}
+
+	auto file = SPIFFS_open(handle(), path, sflags, 0);
+	if(file >= 0) {
+		auto fd = getDescriptor(file);
+		if(fd == nullptr || !index->add(path, fd->obj_id & ~SPIFFS_OBJ_ID_IX_FLAG, fd->objix_hdr_pix)) {
+			debug_w("[SPIFFS] Name index discarded");
+			index.reset();
+		}
+	}
+	return file;
+}
+
+/*
+ * Index header is re-written when file is flushed, so record new location
+ */
+void FileSystem::updateIndex(FileHandle file)
+{
+	auto fd = getDescriptor(file);
+	if(fd == nullptr) {
+		return;
+	}
+	auto i = index->findId(fd->obj_id & ~SPIFFS_OBJ_ID_IX_FLAG);
+	if(i != NameIndex::none) {
+		index->getFile(i).pix = fd->objix_hdr_pix;
+	}
+}
+
+int FileSystem::statPath(const char* path, spiffs_stat& ss)
+{
+	if(!index) {
+		return SPIFFS_stat(handle(), path, &ss);
+	}
+
+	spiffs_page_object_ix_header hdr;
+	int i = findIndexed(path, hdr);
+	if(i < 0) {
+		return i;
+	}
+	fillSpiffsStat(ss, hdr, index->getFile(i).pix);
+	return SPIFFS_OK;
+}
+
+spiffs_fd* FileSystem::getDescriptor(FileHandle file)
+{
+	auto fs = handle();
+	spiffs_fd* fd;
+	int res = spiffs_fd_get(fs, SPIFFS_FH_UNOFFS(fs, file), &fd);
+	return (res < 0) ? nullptr : fd;
+}
+
 /*
  * Format the file system and leave it mounted in an accessible state.
  */
@@ -219,6 +411,10 @@ int FileSystem::check()
 	};
 
 	int err = SPIFFS_check(handle());
+	// Files may have been repaired or removed
+	if(index) {
+		buildIndex();
+	}
 	return translateSpiffsError(err);
 }
 
@@ -281,7 +477,7 @@ FileHandle FileSystem::open(const char* path, OpenFlags flags)
 		return FileHandle(Error::NotSupported);
 	}
 
-	auto file = SPIFFS_open(handle(), path, sflags, 0);
+	auto file = index ? openIndexed(path, sflags) : SPIFFS_open(handle(), path, sflags, 0);
 	if(file < 0) {
 		int err = translateSpiffsError(file);
 		debug_ifserr(err, "open('%s')", path);
@@ -321,6 +517,10 @@ int FileSystem::close(FileHandle file)
 	}
 
 	int res = flushMeta(file);
+	if(index) {
+		SPIFFS_fflush(handle(), file);
+		updateIndex(file);
+	}
 	int err = SPIFFS_close(handle(), file);
 	if(err < 0) {
 		res = translateSpiffsError(err);
@@ -355,6 +555,8 @@ int FileSystem::flush(FileHandle file)
 	int err = SPIFFS_fflush(handle(), file);
 	if(err < 0) {
 		res = translateSpiffsError(err);
+	} else if(index) {
+		updateIndex(file);
 	}
 	partition.sync();
 	return res;
@@ -466,7 +668,7 @@ int FileSystem::stat(const char* path, Stat* stat)
 	}
 
 	spiffs_stat ss;
-	int err = SPIFFS_stat(handle(), path ?: "", &ss);
+	int err = statPath(path ?: "", ss);
 	CHECK_RES(err)
 
 	if(stat != nullptr) {
@@ -624,7 +826,7 @@ int FileSystem::setxattr(const char* path, AttributeTag tag, const void* data, s
 #ifdef SPIFFS_STORE_META
 	FS_CHECK_PATH(path)
 	spiffs_stat ss;
-	int err = SPIFFS_stat(handle(), path ?: "", &ss);
+	int err = statPath(path ?: "", ss);
 	CHECK_RES(err)
 	SpiffsMetaBuffer smb;
 	smb.assign(ss.meta);
@@ -648,7 +850,7 @@ int FileSystem::getxattr(const char* path, AttributeTag tag, void* buffer, size_
 #ifdef SPIFFS_STORE_META
 	FS_CHECK_PATH(path)
 	spiffs_stat ss;
-	int err = SPIFFS_stat(handle(), path, &ss);
+	int err = statPath(path, ss);
 	CHECK_RES(err)
 	SpiffsMetaBuffer smb;
 	smb.assign(ss.meta);
@@ -689,11 +891,27 @@ int FileSystem::opendir(const char* path, DirHandle& dir)
 	}
 	d->path[pathlen] = '\0';
 	d->pathlen = pathlen;
+	startIndexedDir(d);
 
 	dir = DirHandle(d);
 	return FS_OK;
 }
 
+void FileSystem::startIndexedDir(FileDir* d)
+{
+	if(!index) {
+		return;
+	}
+	d->dir = index->findDir(d->path, d->pathlen);
+	if(d->dir == NameIndex::none) {
+		d->nextDir = d->nextFile = NameIndex::none;
+	} else {
+		auto& dir = index->getDir(d->dir);
+		d->nextDir = dir.firstDir;
+		d->nextFile = dir.firstFile;
+	}
+}
+
 int FileSystem::rewinddir(DirHandle dir)
 {
 	GET_FILEDIR()
@@ -704,14 +922,73 @@ int FileSystem::rewinddir(DirHandle dir)
 		int err = SPIFFS_errno(handle());
 		return translateSpiffsError(err);
 	}
+	startIndexedDir(d);
 
 	return FS_OK;
 }
 
+/*
+ * Directories are returned first, then files.
+ * Entries are checked against the directory being listed in case they've been removed.
+ */
+int FileSystem::readdirIndexed(FileDir* d, Stat& stat)
+{
+	if(d->nextDir != NameIndex::none) {
+		auto& dir = index->getDir(d->nextDir);
+		if(dir.parent == d->dir) {
+			d->nextDir = dir.nextSibling;
+			stat = Stat{};
+			stat.fs = this;
+			stat.name.copy(dir.name);
+			stat.attr |= FileAttribute::Directory;
+			return FS_OK;
+		}
+		d->nextDir = NameIndex::none;
+	}
+
+	while(d->nextFile != NameIndex::none) {
+		auto& entry = index->getFile(d->nextFile);
+		if(entry.dir != d->dir) {
+			break;
+		}
+		d->nextFile = entry.nextSibling;
+
+		spiffs_page_object_ix_header hdr;
+		if(readIndexHeader(entry, hdr) < 0) {
+			continue;
+		}
+
+		auto name = reinterpret_cast<const char*>(hdr.name);
+		if(d->pathlen != 0) {
+			name += d->pathlen + 1;
+		}
+		stat = Stat{};
+		stat.fs = this;
+		stat.name.copy(name);
+		stat.size = (hdr.size == SPIFFS_UNDEFINED_LEN) ? 0 : hdr.size;
+		stat.id = entry.id;
+		SpiffsMetaBuffer smb;
+#ifdef SPIFFS_STORE_META
+		smb.assign(hdr.meta);
+#else
+		smb.init();
+#endif
+		fillStat(stat, smb);
+		return FS_OK;
+	}
+
+	d->nextFile = NameIndex::none;
+	return Error::NoMoreFiles;
+}
+
 int FileSystem::readdir(DirHandle dir, Stat& stat)
 {
 	GET_FILEDIR()
 
+	if(index) {
+		return readdirIndexed(d, stat);
+	}
+
 	SPIFFS_clearerr(handle());
 	spiffs_dirent e;
 	for(;;) {
@@ -817,8 +1094,21 @@ int FileSystem::rename(const char* oldpath, const char* newpath)
 		return Error::BadParam;
 	}
 
+	int entry{-1};
+	if(index) {
+		spiffs_page_object_ix_header hdr;
+		entry = findIndexed(oldpath, hdr);
+		if(entry < 0) {
+			return translateSpiffsError(entry);
+		}
+	}
+
 	int err = SPIFFS_rename(handle(), oldpath, newpath);
 	partition.sync();
+	if(err >= 0 && index && !index->rename(entry, newpath)) {
+		debug_w("[SPIFFS] Name index discarded");
+		index.reset();
+	}
 	return translateSpiffsError(err);
 }
 
@@ -829,11 +1119,16 @@ int FileSystem::remove(const char* path)
 	}
 
 	// Check file is not marked read-only
+	spiffs_obj_id id{SPIFFS_OBJ_ID_FREE};
 	int f = open(path, OpenFlag::Read);
 	if(f >= 0) {
 		auto smb = getMetaBuffer(f);
 		assert(smb != nullptr);
 		auto attr = smb->meta.attr;
+		auto fd = getDescriptor(f);
+		if(fd != nullptr) {
+			id = fd->obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
+		}
 		close(f);
 		if(attr[FileAttribute::ReadOnly]) {
 			return Error::ReadOnly;
@@ -841,6 +1136,9 @@ int FileSystem::remove(const char* path)
 	}
 
 	int err = SPIFFS_remove(handle(), path);
+	if(err >= 0 && index) {
+		index->remove(index->findId(id));
+	}
 	err = translateSpiffsError(err);
 	debug_ifserr(err, "remove('%s')", path);
 	partition.sync();
@@ -860,7 +1158,13 @@ int FileSystem::fremove(FileHandle file)
 		return Error::ReadOnly;
 	}
 
+	auto fd = getDescriptor(file);
+	auto id = (fd == nullptr) ? SPIFFS_OBJ_ID_FREE : fd->obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
+
 	int err = SPIFFS_fremove(handle(), file);
+	if(err >= 0 && index) {
+		index->remove(index->findId(id));
+	}
 	return translateSpiffsError(err);
 }
 
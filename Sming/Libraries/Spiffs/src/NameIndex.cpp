@@ -0,0 +1,324 @@
+/**
+ * NameIndex.cpp
+ *
+ * Copyright 2019 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the SPIFFS IFS Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/IFS/SPIFFS/NameIndex.h"
+#include <algorithm>
+
+namespace IFS::SPIFFS
+{
+namespace
+{
+/*
+ * Entries are plain structures so arrays can be resized in place
+ */
+template <typename T> bool grow(T*& array, NameIndex::Index& capacity)
+{
+	unsigned newCapacity = std::min(capacity ? capacity * 2U : 8U, unsigned(NameIndex::none));
+	if(newCapacity <= capacity) {
+		return false;
+	}
+	auto p = static_cast<T*>(realloc(array, newCapacity * sizeof(T)));
+	if(p == nullptr) {
+		return false;
+	}
+	array = p;
+	capacity = newCapacity;
+	return true;
+}
+
+} // namespace
+
+uint32_t NameIndex::getHash(const char* path, size_t len)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261U;
+	while(len-- != 0) {
+		hash ^= uint8_t(*path++);
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+void NameIndex::freeDirNames()
+{
+	for(unsigned i = 0; i < dirCount; ++i) {
+		free(dirs[i].name);
+	}
+}
+
+void NameIndex::clear()
+{
+	freeDirNames();
+	dirCount = 0;
+	fileCount = 0;
+	fileUsed = 0;
+	freeFile = none;
+	std::fill_n(buckets, bucketCount, none);
+}
+
+bool NameIndex::add(const char* path, spiffs_obj_id id, spiffs_page_ix pix)
+{
+	if(dirCount == 0) {
+		if(dirCapacity == 0 && !grow(dirs, dirCapacity)) {
+			return false;
+		}
+		dirs[root] = Dir{nullptr, none, none, none, none};
+		dirCount = 1;
+	}
+
+	if(fileCount >= bucketCount && !growBuckets()) {
+		return false;
+	}
+
+	// Locate parent directory, creating it if required
+	Index dir = root;
+	auto name = path;
+	const char* sep;
+	while((sep = strchr(name, '/')) != nullptr) {
+		auto len = sep - name;
+		auto child = findChildDir(dir, name, len);
+		if(child == none) {
+			child = addChildDir(dir, name, len);
+			if(child == none) {
+				pruneDir(dir);
+				return false;
+			}
+		}
+		dir = child;
+		name = sep + 1;
+	}
+
+	auto i = allocFile();
+	if(i == none) {
+		pruneDir(dir);
+		return false;
+	}
+
+	auto& file = files[i];
+	file = File{getHash(path), id, pix, dir, none, none};
+	auto& bucket = buckets[file.hash & (bucketCount - 1)];
+	file.nextHash = bucket;
+	bucket = i;
+	file.nextSibling = dirs[dir].firstFile;
+	dirs[dir].firstFile = i;
+	++fileCount;
+	return true;
+}
+
+void NameIndex::remove(Index file)
+{
+	if(file == none || files[file].dir == none) {
+		return;
+	}
+	auto& f = files[file];
+
+	unlinkHash(file);
+	unlinkSibling(file);
+	auto dir = f.dir;
+	f.dir = none;
+	f.nextHash = freeFile;
+	freeFile = file;
+	--fileCount;
+	pruneDir(dir);
+}
+
+bool NameIndex::rename(Index file, const char* newpath)
+{
+	auto f = files[file];
+	remove(file);
+	return add(newpath, f.id, f.pix);
+}
+
+NameIndex::Index NameIndex::find(const char* path, Index prev) const
+{
+	if(bucketCount == 0) {
+		return none;
+	}
+
+	auto hash = getHash(path);
+	auto i = (prev == none) ? buckets[hash & (bucketCount - 1)] : files[prev].nextHash;
+	while(i != none && files[i].hash != hash) {
+		i = files[i].nextHash;
+	}
+	return i;
+}
+
+NameIndex::Index NameIndex::findId(spiffs_obj_id id) const
+{
+	for(Index i = 0; i < fileUsed; ++i) {
+		if(files[i].dir != none && files[i].id == id) {
+			return i;
+		}
+	}
+	return none;
+}
+
+NameIndex::Index NameIndex::findDir(const char* path, size_t len) const
+{
+	if(dirCount == 0) {
+		return none;
+	}
+
+	Index dir = root;
+	while(len != 0 && dir != none) {
+		auto sep = static_cast<const char*>(memchr(path, '/', len));
+		size_t n = sep ? sep - path : len;
+		dir = findChildDir(dir, path, n);
+		if(sep == nullptr) {
+			break;
+		}
+		path = sep + 1;
+		len -= n + 1;
+	}
+	return dir;
+}
+
+NameIndex::Index NameIndex::allocFile()
+{
+	if(freeFile != none) {
+		auto i = freeFile;
+		freeFile = files[i].nextHash;
+		return i;
+	}
+	if(fileUsed == fileCapacity && !grow(files, fileCapacity)) {
+		return none;
+	}
+	return fileUsed++;
+}
+
+NameIndex::Index NameIndex::findChildDir(Index parent, const char* name, size_t len) const
+{
+	for(auto i = dirs[parent].firstDir; i != none; i = dirs[i].nextSibling) {
+		auto& d = dirs[i];
+		if(strncmp(d.name, name, len) == 0 && d.name[len] == '\0') {
+			return i;
+		}
+	}
+	return none;
+}
+
+NameIndex::Index NameIndex::addChildDir(Index parent, const char* name, size_t len)
+{
+	auto s = static_cast<char*>(malloc(len + 1));
+	if(s == nullptr) {
+		return none;
+	}
+	memcpy(s, name, len);
+	s[len] = '\0';
+
+	// Re-use a free entry if there is one
+	Index i = 1;
+	while(i < dirCount && dirs[i].parent != none) {
+		++i;
+	}
+	if(i == dirCount) {
+		if(dirCount == dirCapacity && !grow(dirs, dirCapacity)) {
+			free(s);
+			return none;
+		}
+		++dirCount;
+	}
+
+	dirs[i] = Dir{s, parent, none, none, dirs[parent].firstDir};
+	dirs[parent].firstDir = i;
+	return i;
+}
+
+void NameIndex::unlinkHash(Index file)
+{
+	auto p = &buckets[files[file].hash & (bucketCount - 1)];
+	while(*p != none) {
+		if(*p == file) {
+			*p = files[file].nextHash;
+			break;
+		}
+		p = &files[*p].nextHash;
+	}
+}
+
+void NameIndex::unlinkSibling(Index file)
+{
+	auto p = &dirs[files[file].dir].firstFile;
+	while(*p != none) {
+		if(*p == file) {
+			*p = files[file].nextSibling;
+			break;
+		}
+		p = &files[*p].nextSibling;
+	}
+}
+
+/*
+ * Directories only exist whilst they contain files
+ */
+void NameIndex::pruneDir(Index dir)
+{
+	while(dir != root) {
+		auto& d = dirs[dir];
+		if(d.firstFile != none || d.firstDir != none) {
+			break;
+		}
+
+		auto p = &dirs[d.parent].firstDir;
+		while(*p != none) {
+			if(*p == dir) {
+				*p = d.nextSibling;
+				break;
+			}
+			p = &dirs[*p].nextSibling;
+		}
+
+		auto parent = d.parent;
+		free(d.name);
+		d = Dir{nullptr, none, none, none, none};
+		dir = parent;
+	}
+}
+
+bool NameIndex::growBuckets()
+{
+	// Indices are 16-bit so limit table size
+	if(bucketCount >= 0x8000) {
+		return true;
+	}
+
+	unsigned newCount = bucketCount ? bucketCount * 2U : 16U;
+	auto p = static_cast<Index*>(realloc(buckets, newCount * sizeof(Index)));
+	if(p == nullptr) {
+		// Chains just get longer
+		return bucketCount != 0;
+	}
+
+	buckets = p;
+	bucketCount = newCount;
+	std::fill_n(buckets, bucketCount, none);
+	for(Index i = 0; i < fileUsed; ++i) {
+		auto& file = files[i];
+		if(file.dir == none) {
+			continue;
+		}
+		auto& bucket = buckets[file.hash & (bucketCount - 1)];
+		file.nextHash = bucket;
+		bucket = i;
+	}
+
+	return true;
+}
+
+} // namespace IFS::SPIFFS
@@ -37,12 +37,20 @@
  *  	Standard IFS truncate() method allows file size to be reduced.
  *  	This was added to Sming in version 4.
  *
+ *	Name index
+ *
+ *		If SPIFFS_NAME_INDEX is enabled then an index of file names is built at mount time
+ *		so that open(), stat() and readdir() don't need to scan the volume.
+ *		See NameIndex.h.
+ *
  */
 
 #pragma once
 
 #include <IFS/IFileSystem.h>
 #include "FileMeta.h"
+#include "NameIndex.h"
+#include <memory>
 #include "../../../../spiffs/src/spiffs.h"
 extern "C" {
 #include "../../../../spiffs/src/spiffs_nucleus.h"
@@ -50,6 +58,8 @@ extern "C" {
 
 namespace IFS::SPIFFS
 {
+struct FileDir;
+
 /*
  * Wraps SPIFFS
  */
@@ -109,6 +119,16 @@ private:
 
 	int tryMount(spiffs_config& cfg);
 
+	int buildIndex();
+	int readIndexHeader(NameIndex::File& entry, spiffs_page_object_ix_header& hdr);
+	int findIndexed(const char* path, spiffs_page_object_ix_header& hdr);
+	spiffs_file openIndexed(const char* path, spiffs_flags sflags);
+	void startIndexedDir(FileDir* d);
+	int readdirIndexed(FileDir* d, Stat& stat);
+	void updateIndex(FileHandle file);
+	int statPath(const char* path, spiffs_stat& ss);
+	spiffs_fd* getDescriptor(FileHandle file);
+
 	SpiffsMetaBuffer* initMetaBuffer(FileHandle file);
 	SpiffsMetaBuffer* getMetaBuffer(FileHandle file);
 	int flushMeta(FileHandle file);
@@ -139,6 +159,7 @@ private:
 	uint8_t workBuffer[LOG_PAGE_SIZE * 2];
 	spiffs_fd fileDescriptors[SPIFF_FILEDESC_COUNT];
 	uint8_t cache[CACHE_SIZE];
+	std::unique_ptr<NameIndex> index;
 };
 
 } // namespace IFS::SPIFFS
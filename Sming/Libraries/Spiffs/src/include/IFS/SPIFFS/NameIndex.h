@@ -0,0 +1,180 @@
+/**
+ * NameIndex.h
+ * In-RAM index of SPIFFS file names and emulated directories.
+ *
+ * Copyright 2019 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the SPIFFS IFS Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ *
+ * SPIFFS locates a file by name by reading the index header of every object on the volume,
+ * and directory emulation requires a scan of the entire volume for every listing.
+ *
+ * This index is built once at mount time. Each file is recorded by a hash of its path together
+ * with its object ID and the page holding its index header. Directories are derived from
+ * path separators and kept as a tree, so a listing only visits entries in that directory.
+ *
+ * File names are not stored: the hash identifies candidates which are confirmed by reading the
+ * index header. Page numbers are hints only since SPIFFS relocates index headers when they're
+ * updated and during garbage collection, so the filesystem validates them before use.
+ *
+ ****/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include "../../../../spiffs/src/spiffs.h"
+
+namespace IFS::SPIFFS
+{
+class NameIndex
+{
+public:
+	using Index = uint16_t;
+
+	static constexpr Index none{0xffff};
+	static constexpr Index root{0};
+
+	struct File {
+		uint32_t hash;
+		spiffs_obj_id id;
+		// Last known location of object index header
+		spiffs_page_ix pix;
+		// Parent directory, none if entry is free
+		Index dir;
+		Index nextHash;
+		Index nextSibling;
+	};
+
+	struct Dir {
+		// Final path component, nullptr if entry is free (except root)
+		char* name;
+		Index parent;
+		Index firstDir;
+		Index firstFile;
+		Index nextSibling;
+	};
+
+	NameIndex()
+	{
+		clear();
+	}
+
+	~NameIndex()
+	{
+		freeDirNames();
+		free(files);
+		free(dirs);
+		free(buckets);
+	}
+
+	NameIndex(const NameIndex&) = delete;
+	NameIndex& operator=(const NameIndex&) = delete;
+
+	/**
+	 * @brief Remove all entries
+	 */
+	void clear();
+
+	/**
+	 * @brief Add a new file entry, creating parent directories as required
+	 * @param path Full path of file
+	 * @param id SPIFFS object ID, without index flag
+	 * @param pix Page containing object index header
+	 * @retval bool false if out of memory, in which case index is incomplete and should be discarded
+	 */
+	bool add(const char* path, spiffs_obj_id id, spiffs_page_ix pix);
+
+	/**
+	 * @brief Remove a file entry, and any parent directories which become empty
+	 * @param file Entry to remove, ignored if none
+	 */
+	void remove(Index file);
+
+	/**
+	 * @brief Move a file entry to a new path
+	 * @retval bool false if out of memory
+	 */
+	bool rename(Index file, const char* newpath);
+
+	/**
+	 * @brief Find candidate entries for a path
+	 * @param path
+	 * @param prev none to start search, otherwise previous value returned
+	 * @retval Index Next entry whose hash matches, none if there are no more
+	 * @note Different paths may share a hash value so the caller must confirm the name
+	 */
+	Index find(const char* path, Index prev = none) const;
+
+	/**
+	 * @brief Find entry for an object ID
+	 * @note This is a linear search but does not require any flash access
+	 */
+	Index findId(spiffs_obj_id id) const;
+
+	/**
+	 * @brief Find an emulated directory
+	 * @param path Directory path, without trailing separator
+	 * @param len Length of path, 0 for root
+	 * @retval Index none if directory does not exist
+	 */
+	Index findDir(const char* path, size_t len) const;
+
+	File& getFile(Index i)
+	{
+		return files[i];
+	}
+
+	const Dir& getDir(Index i) const
+	{
+		return dirs[i];
+	}
+
+	unsigned getFileCount() const
+	{
+		return fileCount;
+	}
+
+	static uint32_t getHash(const char* path, size_t len);
+
+	static uint32_t getHash(const char* path)
+	{
+		return getHash(path, strlen(path));
+	}
+
+private:
+	void freeDirNames();
+	Index allocFile();
+	Index findChildDir(Index parent, const char* name, size_t len) const;
+	Index addChildDir(Index parent, const char* name, size_t len);
+	void unlinkHash(Index file);
+	void unlinkSibling(Index file);
+	void pruneDir(Index dir);
+	bool growBuckets();
+
+	File* files{nullptr};
+	Dir* dirs{nullptr};
+	Index* buckets{nullptr};
+	Index fileCapacity{0};
+	Index dirCapacity{0};
+	Index dirCount{0};
+	Index bucketCount{0};
+	Index fileCount{0};
+	Index fileUsed{0};
+	Index freeFile{none};
+};
+
+} // namespace IFS::SPIFFS
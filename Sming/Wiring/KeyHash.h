@@ -0,0 +1,80 @@
+/****
+ * Sming Framework Project - Open Source framework for high efficiency native ESP8266 development.
+ * Created 2015 by Skurydin Alexey
+ * http://github.com/SmingHub/Sming
+ * All files of the Sming Core are provided under the LGPL v3 license.
+ *
+ * KeyHash.h - Hash functions for map keys
+ *
+ ****/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include "WString.h"
+
+/**
+ * @brief Fold an integer value into a well-distributed 32-bit hash
+ * @note Uses the MurmurHash3 finaliser
+ */
+inline uint32_t hashMix(uint32_t value)
+{
+	value ^= value >> 16;
+	value *= 0x85ebca6b;
+	value ^= value >> 13;
+	value *= 0xc2b2ae35;
+	value ^= value >> 16;
+	return value;
+}
+
+/**
+ * @brief Compute FNV-1a hash over a block of data
+ */
+inline uint32_t hashBytes(const void* data, size_t length)
+{
+	auto p = static_cast<const uint8_t*>(data);
+	uint32_t hash{2166136261U};
+	while(length-- != 0) {
+		hash ^= *p++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/**
+ * @brief Class template providing hash function for map keys
+ * @ingroup wiring
+ *
+ * Specialisations are provided for `String`, integral and enumerated types.
+ * Provide a specialisation with a static `hash()` method to support other key types, e.g:
+ *
+ * ```
+ * template <> struct KeyHash<MyKey> {
+ *     static uint32_t hash(const MyKey& key)
+ *     {
+ *         return hashBytes(&key, sizeof(key));
+ *     }
+ * };
+ * ```
+ *
+ * The hash must be consistent with key comparison: equal keys must produce equal hashes.
+ */
+template <typename K, typename Enable = void> struct KeyHash;
+
+template <typename K>
+struct KeyHash<K, typename std::enable_if<std::is_integral<K>::value || std::is_enum<K>::value>::type> {
+	static uint32_t hash(const K& key)
+	{
+		auto value = uint64_t(key);
+		return hashMix(uint32_t(value) ^ uint32_t(value >> 32));
+	}
+};
+
+template <> struct KeyHash<String> {
+	static uint32_t hash(const String& key)
+	{
+		return hashBytes(key.c_str(), key.length());
+	}
+};
@@ -31,7 +31,10 @@
 #include <cstdint>
 #include <iterator>
 #include <cstdlib>
+#include <memory>
+#include <new>
 #include "WiringList.h"
+#include "KeyHash.h"
 #include "Print.h"
 
 /**
@@ -180,6 +183,12 @@ public:
 	 */
 	using SortCompare = bool (*)(const ElementConst& e1, const ElementConst& e2);
 
+	/**
+	 * @brief Compute hash for a key
+	 * @see See `KeyHash` for default implementations
+	 */
+	using Hasher = uint32_t (*)(const K&);
+
 	/*
     || @constructor
     || | Default constructor
@@ -227,6 +236,9 @@ public:
 		return keys[idx];
 	}
 
+	/*
+	 * @note If hashing is enabled, do not modify the key value
+	 */
 	K& keyAt(unsigned int idx)
 	{
 		if(idx >= count()) {
@@ -301,6 +313,40 @@ public:
 		return keys.allocate(newSize) && values.allocate(newSize);
 	}
 
+	/**
+	 * @brief Enable hashed key lookups
+	 * @param hasher Function to compute key hash. Must be consistent with any custom comparator.
+	 * @retval bool false on memory allocation failure, in which case the map reverts to linear searching
+	 *
+	 * By default, keys are located by linear search which is efficient for small maps.
+	 * With hashing enabled an index is maintained alongside the key/value lists, so lookups
+	 * and insertions are performed in constant time at a cost of 4 bytes per slot.
+	 * Iteration order and index-based access are unchanged.
+	 * Removal remains O(n) because following list entries move down and their indices must be updated.
+	 *
+	 * Hashing may be enabled at any time: existing entries are added to the index.
+	 * Maps containing more than 49152 entries cannot be hashed.
+	 */
+	bool enableHashing(Hasher hasher = KeyHash<K>::hash)
+	{
+		this->hasher = hasher;
+		return rebuildIndex();
+	}
+
+	/**
+	 * @brief Revert to linear key searching and release the hash index
+	 */
+	void disableHashing()
+	{
+		hasher = nullptr;
+		hashIndex.clear();
+	}
+
+	bool isHashed() const
+	{
+		return hasher != nullptr;
+	}
+
 	/**
 	 * @brief Sort map entries
 	 */
@@ -317,12 +363,11 @@ public:
     */
 	int indexOf(const K& key) const
 	{
+		if(hasher) {
+			return findIndex(key, hasher(key));
+		}
 		for(unsigned i = 0; i < currentIndex; i++) {
-			if(cb_comparator) {
-				if(cb_comparator(key, keys[i])) {
-					return i;
-				}
-			} else if(key == keys[i]) {
+			if(keyEquals(key, i)) {
 				return i;
 			}
 		}
@@ -356,6 +401,10 @@ public:
 			return;
 		}
 
+		if(hasher) {
+			hashIndex.remove(hasher(keys[index]), index);
+		}
+
 		keys.remove(index);
 		values.remove(index);
 
@@ -381,6 +430,7 @@ public:
 	{
 		keys.clear();
 		values.clear();
+		hashIndex.clear();
 		currentIndex = 0;
 	}
 
@@ -423,17 +473,38 @@ protected:
 	KeyList keys;
 	ValueList values;
 	Comparator cb_comparator{nullptr};
+	Hasher hasher{nullptr};
+	wiring_private::HashIndex hashIndex;
 	unsigned currentIndex{0};
 	V nil{};
 
 private:
+	bool keyEquals(const K& key, unsigned index) const
+	{
+		return cb_comparator ? cb_comparator(key, keys[index]) : (key == keys[index]);
+	}
+
+	int findIndex(const K& key, uint32_t hash) const
+	{
+		return hashIndex.find(hash, [&](unsigned index) { return keyEquals(key, index); });
+	}
+
+	bool rebuildIndex();
+
 	HashMap(const HashMap<K, V>& that);
 	HashMap& operator=(const HashMap& that);
 };
 
 template <typename K, typename V> V& HashMap<K, V>::operator[](const K& key)
 {
-	int i = indexOf(key);
+	uint32_t hash{0};
+	int i;
+	if(hasher) {
+		hash = hasher(key);
+		i = findIndex(key, hash);
+	} else {
+		i = indexOf(key);
+	}
 	if(i >= 0) {
 		return values[i];
 	}
@@ -442,6 +513,9 @@ template <typename K, typename V> V& HashMap<K, V>::operator[](const K& key)
 	}
 	keys[currentIndex] = key;
 	values[currentIndex] = nil;
+	if(hasher && !hashIndex.add(hash, currentIndex)) {
+		disableHashing();
+	}
 	currentIndex++;
 	return values[currentIndex - 1];
 }
@@ -449,14 +523,58 @@ template <typename K, typename V> V& HashMap<K, V>::operator[](const K& key)
 template <typename K, typename V> void HashMap<K, V>::sort(SortCompare compare)
 {
 	auto n = count();
-	for(unsigned i = 0; i < n - 1; ++i) {
-		for(unsigned j = 0; j < n - i - 1; ++j) {
-			HashMap::ElementConst e1{keys[j + 1], values[j + 1]};
-			HashMap::ElementConst e2{keys[j], values[j]};
-			if(compare(e1, e2)) {
-				std::swap(keys[j], keys[j + 1]);
-				std::swap(values[j], values[j + 1]);
+	if(n < 2) {
+		return;
+	}
+
+	// Sort a list of entry positions, then re-order the key/value lists to match
+	std::unique_ptr<unsigned[]> order(new(std::nothrow) unsigned[n]);
+	if(order) {
+		for(unsigned i = 0; i < n; ++i) {
+			order[i] = i;
+		}
+		std::stable_sort(&order[0], &order[n], [&](unsigned i1, unsigned i2) {
+			return compare(ElementConst{keys[i1], values[i1]}, ElementConst{keys[i2], values[i2]});
+		});
+		for(unsigned i = 0; i < n; ++i) {
+			unsigned j = i;
+			while(order[j] != i) {
+				unsigned k = order[j];
+				std::swap(keys.values[j], keys.values[k]);
+				std::swap(values.values[j], values.values[k]);
+				order[j] = j;
+				j = k;
+			}
+			order[j] = j;
+		}
+	} else {
+		// Not enough memory, fall back to in-place bubble sort
+		for(unsigned i = 0; i < n - 1; ++i) {
+			for(unsigned j = 0; j < n - i - 1; ++j) {
+				HashMap::ElementConst e1{keys[j + 1], values[j + 1]};
+				HashMap::ElementConst e2{keys[j], values[j]};
+				if(compare(e1, e2)) {
+					std::swap(keys.values[j], keys.values[j + 1]);
+					std::swap(values.values[j], values.values[j + 1]);
+				}
 			}
 		}
 	}
+
+	rebuildIndex();
+}
+
+template <typename K, typename V> bool HashMap<K, V>::rebuildIndex()
+{
+	hashIndex.clear();
+	if(!hasher) {
+		return true;
+	}
+	for(unsigned i = 0; i < currentIndex; ++i) {
+		if(!hashIndex.add(hasher(keys[i]), i)) {
+			disableHashing();
+			return false;
+		}
+	}
+	return true;
 }
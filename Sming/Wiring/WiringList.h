@@ -11,6 +11,9 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 namespace wiring_private
 {
@@ -196,4 +199,172 @@ template <typename T> bool ObjectList<T>::allocate(size_t newSize)
 template <typename T>
 using List = typename std::conditional<std::is_scalar<T>::value, ScalarList<T>, ObjectList<T>>::type;
 
+/**
+ * @brief Open-addressing hash table mapping key hashes to list positions
+ *
+ * Used by HashMap and ObjectMap to provide fast lookups whilst retaining the list layout,
+ * so iteration order and index-based access are unaffected.
+ *
+ * Each slot contains the list index (offset by 1, so 0 indicates an empty slot) plus a 16-bit tag
+ * derived from the key hash. The slot position is derived from the tag, so the table can be resized
+ * without re-hashing keys. Linear probing is used, with backward-shift deletion so no tombstones are required.
+ */
+class HashIndex
+{
+public:
+	/**
+	 * @brief Largest list index which may be stored
+	 */
+	static constexpr unsigned maxIndex{0xfffe};
+
+	HashIndex() = default;
+
+	HashIndex(const HashIndex&) = delete;
+	HashIndex& operator=(const HashIndex&) = delete;
+
+	~HashIndex()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		free(slots);
+		slots = nullptr;
+		capacity = 0;
+		used = 0;
+	}
+
+	/**
+	 * @brief Locate a list entry
+	 * @param hash Hash of key to find
+	 * @param match Callback `bool(unsigned index)` to compare candidate list entries with the key
+	 * @retval int Index of the matching entry, or -1 if not found
+	 */
+	template <typename Match> int find(uint32_t hash, Match match) const
+	{
+		if(capacity == 0) {
+			return -1;
+		}
+		auto tag = getTag(hash);
+		auto mask = capacity - 1;
+		for(unsigned pos = tag & mask;; pos = (pos + 1) & mask) {
+			auto& slot = slots[pos];
+			if(slot.index == 0) {
+				return -1;
+			}
+			if(slot.tag == tag && match(slot.index - 1)) {
+				return slot.index - 1;
+			}
+		}
+	}
+
+	/**
+	 * @brief Add a new list entry to the index
+	 * @param hash Hash of the entry's key
+	 * @param index Position of the entry in the list
+	 * @retval bool false if the index is full or memory allocation failed
+	 */
+	bool add(uint32_t hash, unsigned index)
+	{
+		if(index > maxIndex) {
+			return false;
+		}
+		if((used + 1) * 4 > capacity * 3 && !resize(capacity ? capacity * 2 : 8)) {
+			return false;
+		}
+		insert(Slot{uint16_t(index + 1), getTag(hash)});
+		++used;
+		return true;
+	}
+
+	/**
+	 * @brief Remove an entry from the index
+	 * @param hash Hash of the entry's key
+	 * @param index Position of the entry in the list
+	 * @note Indices of all following entries are adjusted to account for removal from the list.
+	 * This requires a scan of the whole table so removal is O(n), as is removal from the list itself.
+	 */
+	void remove(uint32_t hash, unsigned index)
+	{
+		if(capacity == 0) {
+			return;
+		}
+		auto mask = capacity - 1;
+		uint16_t slotIndex = index + 1;
+		unsigned hole = getTag(hash) & mask;
+		while(slots[hole].index != slotIndex) {
+			if(slots[hole].index == 0) {
+				return;
+			}
+			hole = (hole + 1) & mask;
+		}
+
+		// Shift back any following entries which would no longer be reachable
+		for(unsigned pos = (hole + 1) & mask; slots[pos].index != 0; pos = (pos + 1) & mask) {
+			unsigned home = slots[pos].tag & mask;
+			if(((pos - home) & mask) >= ((pos - hole) & mask)) {
+				slots[hole] = slots[pos];
+				hole = pos;
+			}
+		}
+		slots[hole] = Slot{};
+		--used;
+
+		// Following list entries have moved down by one
+		for(unsigned i = 0; i < capacity; ++i) {
+			if(slots[i].index > slotIndex) {
+				--slots[i].index;
+			}
+		}
+	}
+
+private:
+	struct Slot {
+		uint16_t index;
+		uint16_t tag;
+	};
+
+	static uint16_t getTag(uint32_t hash)
+	{
+		return hash ^ (hash >> 16);
+	}
+
+	void insert(Slot slot)
+	{
+		auto mask = capacity - 1;
+		unsigned pos = slot.tag & mask;
+		while(slots[pos].index != 0) {
+			pos = (pos + 1) & mask;
+		}
+		slots[pos] = slot;
+	}
+
+	bool resize(unsigned newCapacity)
+	{
+		if(newCapacity > 0x10000) {
+			return false;
+		}
+		auto newSlots = static_cast<Slot*>(calloc(newCapacity, sizeof(Slot)));
+		if(newSlots == nullptr) {
+			return false;
+		}
+		auto oldSlots = slots;
+		auto oldCapacity = capacity;
+		slots = newSlots;
+		capacity = newCapacity;
+		for(unsigned i = 0; i < oldCapacity; ++i) {
+			if(oldSlots[i].index != 0) {
+				insert(oldSlots[i]);
+			}
+		}
+		free(oldSlots);
+		return true;
+	}
+
+	Slot* slots{nullptr};
+	unsigned capacity{0}; ///< Always a power of 2
+	unsigned used{0};
+};
+
 } // namespace wiring_private
@@ -21,6 +21,7 @@ ARDUINO_LIBRARIES := \
 
 ifeq ($(SMING_ARCH),Host)
 	ARDUINO_LIBRARIES += Hosted
+	ENABLE_MALLOC_PROFILE := 1
 endif
 
 COMPONENT_DEPENDS := \
@@ -33,6 +34,19 @@ COMPONENT_SRCDIRS += \
 COMPONENT_DEPENDS += \
 	axtls-8266 \
 	bearssl-esp8266
+ASSET_BUNDLE_FILES := resource/web
+endif
+
+# Delta OTA patch test, using a pair of existing resource files
+ifneq (,$(filter esp% host,$(SMING_SOC)))
+ARDUINO_LIBRARIES += Ota
+COMPONENT_SRCDIRS += modules/Ota
+OTA_DELTA_PATCH := $(PROJECT_DIR)/$(OUT_BASE)/delta.patch
+APP_CFLAGS += -DOTA_DELTA_PATCH=\"$(OTA_DELTA_PATCH)\"
+CUSTOM_TARGETS += $(OTA_DELTA_PATCH)
+$(OTA_DELTA_PATCH): resource/unit_testing.rst resource/ut_template1.in.rst
+	$(Q) mkdir -p $(@D)
+	$(Q) $(OTA_DELTA_TOOL) $^ $@
 endif
 
 ifeq ($(UNAME),Windows)
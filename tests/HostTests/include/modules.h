@@ -6,12 +6,21 @@
 #define XX_NET(test) XX(test)
 #endif
 
+#ifdef OTA_DELTA_PATCH
+#define XX_OTA(test) XX(test)
+#else
+#define XX_OTA(test)
+#endif
+
 // Architecture-specific test modules
 #ifdef ARCH_HOST
 #define ARCH_TEST_MAP(XX)                                                                                              \
 	XX_NET(Hosted)                                                                                                     \
 	XX_NET(HttpRequest)                                                                                                \
-	XX_NET(TcpClient)
+	XX_NET(MqttClient)                                                                                                 \
+	XX_NET(TcpClient)                                                                                                  \
+	XX_NET(UdpConnection)                                                                                              \
+	XX_NET(Websocket)
 #else
 #define ARCH_TEST_MAP(XX)
 #endif
@@ -37,6 +46,8 @@
 	XX(Uuid)                                                                                                           \
 	XX_NET(Http)                                                                                                       \
 	XX_NET(Url)                                                                                                        \
+	XX_NET(Ssl)                                                                                                        \
+	XX_NET(Mqtt)                                                                                                       \
 	XX(ArduinoJson5)                                                                                                   \
 	XX(ArduinoJson6)                                                                                                   \
 	XX(Storage)                                                                                                        \
@@ -45,4 +56,5 @@
 	XX(Rational)                                                                                                       \
 	XX(Clocks)                                                                                                         \
 	XX(Timers)                                                                                                         \
+	XX_OTA(Ota)                                                                                                        \
 	ARCH_TEST_MAP(XX)
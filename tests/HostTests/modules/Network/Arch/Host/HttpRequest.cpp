@@ -4,6 +4,9 @@
 #include "Network/HttpClient.h"
 #include <Platform/Station.h>
 #include <IFS/Helpers.h>
+#include <Data/Stream/MemoryDataStream.h>
+#include <DateTime.h>
+#include <uzlib.h>
 
 namespace
 {
@@ -44,6 +47,9 @@ public:
 
 		REQUIRE(fwfs_mount(Storage::findPartition("fwfs_httprequest")));
 
+		HttpClient::cleanup();
+		HttpClient::resetPoolStats();
+
 		server->listen(80);
 		server->paths.setDefault([](HttpRequest& request, HttpResponse& response) {
 			auto path = request.uri.getRelativePath();
@@ -51,6 +57,12 @@ public:
 			(void)ok;
 			debug_i("Request from '%s' for '%s': %s", request.uri.Host.c_str(), path.c_str(), ok ? "OK" : "FAIL");
 		});
+		server->paths.set(compressedPath, [](HttpRequest&, HttpResponse& response) {
+			// Application-specified Vary must be retained
+			response.headers[HTTP_HEADER_VARY] = F("Origin");
+			response.setCompression();
+			response.sendFile(conditionalFile);
+		});
 
 		requestNextFile();
 		pending();
@@ -59,17 +71,18 @@ public:
 	void requestNextFile()
 	{
 		if(fileIndex >= ARRAY_SIZE(testFiles)) {
-			shutdown();
+			// Server keeps connection alive so only the first request should need to connect
+			auto& stats = HttpClient::getPoolStats();
+			debug_i("Pool hits %u, misses %u, evictions %u", stats.hits, stats.misses, stats.evictions);
+			REQUIRE_EQ(stats.misses, 1U);
+			REQUIRE_EQ(stats.hits, ARRAY_SIZE(testFiles) - 1);
+			REQUIRE_EQ(HttpClient::getConnectionCount(), 1U);
+			requestNextCondition();
 			return;
 		}
 
 		auto& file = testFiles[fileIndex++];
-		Url url;
-		url.Host = WifiStation.getIP().toString();
-		url.Port = 80;
-		url.Path = String('/') + file.name;
-
-		auto req = new HttpRequest(url);
+		auto req = new HttpRequest(getUrl(file.name));
 		req->onRequestComplete([this, file](HttpConnection& connection, bool) -> int {
 			auto response = connection.getResponse();
 			debug_i("Client received '%s'", connection.getRequest()->uri.toString().c_str());
@@ -89,6 +102,249 @@ public:
 		debug_i("Requested '%s': %s", file.name, ok ? "OK" : "FAIL");
 	}
 
+	/*
+	 * Conditional and range requests, using validators from the first response
+	 */
+	void requestNextCondition()
+	{
+		auto req = new HttpRequest(getUrl(conditionalFile));
+		auto& headers = req->headers;
+		auto size = content.length();
+		expect = Expect{HTTP_STATUS_OK};
+
+		switch(conditionIndex++) {
+		case 0:
+			content = fileGetContent(conditionalFile);
+			REQUIRE(content.length() > 20);
+			break;
+		case 1:
+			headers[HTTP_HEADER_IF_NONE_MATCH] = etag;
+			expect = Expect{HTTP_STATUS_NOT_MODIFIED};
+			break;
+		case 2:
+			// Weak comparison
+			headers[HTTP_HEADER_IF_NONE_MATCH] = F("W/") + etag;
+			expect = Expect{HTTP_STATUS_NOT_MODIFIED};
+			break;
+		case 3:
+			headers[HTTP_HEADER_IF_NONE_MATCH] = F("\"other\", ") + etag;
+			expect = Expect{HTTP_STATUS_NOT_MODIFIED};
+			break;
+		case 4:
+			headers[HTTP_HEADER_IF_NONE_MATCH] = F("\"other\"");
+			break;
+		case 5:
+			headers[HTTP_HEADER_IF_MODIFIED_SINCE] = lastModified;
+			expect = Expect{HTTP_STATUS_NOT_MODIFIED};
+			break;
+		case 6: {
+			time_t modified;
+			REQUIRE(DateTime::fromHttpDate(lastModified, modified));
+			headers[HTTP_HEADER_IF_MODIFIED_SINCE] = DateTime(modified - 3600).toHTTPDate();
+			break;
+		}
+		case 7:
+			// If-None-Match takes precedence
+			headers[HTTP_HEADER_IF_NONE_MATCH] = F("\"other\"");
+			headers[HTTP_HEADER_IF_MODIFIED_SINCE] = lastModified;
+			break;
+		case 8:
+			headers[HTTP_HEADER_RANGE] = F("bytes=10-19");
+			expect = Expect{HTTP_STATUS_PARTIAL_CONTENT, 10, 10};
+			break;
+		case 9:
+			headers[HTTP_HEADER_RANGE] = F("bytes=-10");
+			expect = Expect{HTTP_STATUS_PARTIAL_CONTENT, size - 10, 10};
+			break;
+		case 10:
+			headers[HTTP_HEADER_RANGE] = F("bytes=10-");
+			expect = Expect{HTTP_STATUS_PARTIAL_CONTENT, 10, size - 10};
+			break;
+		case 11:
+			headers[HTTP_HEADER_RANGE] = F("bytes=") + String(size) + '-';
+			expect = Expect{HTTP_STATUS_RANGE_NOT_SATISFIABLE};
+			break;
+		case 12:
+			// Multiple ranges not supported so full content is sent
+			headers[HTTP_HEADER_RANGE] = F("bytes=0-9,20-29");
+			break;
+		case 13:
+			headers[HTTP_HEADER_RANGE] = F("bytes=10-19");
+			headers[HTTP_HEADER_IF_RANGE] = etag;
+			expect = Expect{HTTP_STATUS_PARTIAL_CONTENT, 10, 10};
+			break;
+		case 14:
+			headers[HTTP_HEADER_RANGE] = F("bytes=10-19");
+			headers[HTTP_HEADER_IF_RANGE] = F("\"other\"");
+			break;
+		case 15:
+			// If-Range requires strong comparison
+			headers[HTTP_HEADER_RANGE] = F("bytes=10-19");
+			headers[HTTP_HEADER_IF_RANGE] = F("W/") + etag;
+			break;
+		case 16:
+			headers[HTTP_HEADER_RANGE] = F("bytes=10-19");
+			headers[HTTP_HEADER_IF_RANGE] = lastModified;
+			expect = Expect{HTTP_STATUS_PARTIAL_CONTENT, 10, 10};
+			break;
+		default:
+			delete req;
+			requestNextCompression();
+			return;
+		}
+
+		req->setResponseStream(new MemoryDataStream);
+		req->onRequestComplete([this](HttpConnection& connection, bool) -> int {
+			checkConditionalResponse(*connection.getResponse());
+			requestNextCondition();
+			return 0;
+		});
+		client.send(req);
+	}
+
+	void checkConditionalResponse(HttpResponse& response)
+	{
+		auto& headers = response.headers;
+		auto body = response.getBody();
+		debug_i("Condition #%u: %u %s", conditionIndex - 1, response.code, toString(response.code).c_str());
+		REQUIRE_EQ(response.code, expect.code);
+
+		switch(expect.code) {
+		case HTTP_STATUS_OK:
+			REQUIRE_EQ(headers[HTTP_HEADER_ACCEPT_RANGES], "bytes");
+			REQUIRE(!headers.contains(HTTP_HEADER_CONTENT_RANGE));
+			REQUIRE(body == content);
+			if(etag.length() == 0) {
+				etag = headers[HTTP_HEADER_ETAG];
+				lastModified = headers[HTTP_HEADER_LAST_MODIFIED];
+				REQUIRE(etag.startsWith("\""));
+				REQUIRE(lastModified.length() != 0);
+			}
+			break;
+
+		case HTTP_STATUS_PARTIAL_CONTENT: {
+			String range;
+			range += F("bytes ");
+			range += expect.first;
+			range += '-';
+			range += expect.first + expect.length - 1;
+			range += '/';
+			range += content.length();
+			REQUIRE_EQ(headers[HTTP_HEADER_CONTENT_RANGE], range);
+			REQUIRE_EQ(headers[HTTP_HEADER_CONTENT_LENGTH], String(expect.length));
+			REQUIRE(body == content.substring(expect.first, expect.first + expect.length));
+			break;
+		}
+
+		case HTTP_STATUS_RANGE_NOT_SATISFIABLE:
+			REQUIRE_EQ(headers[HTTP_HEADER_CONTENT_RANGE], F("bytes */") + String(content.length()));
+			REQUIRE(body.length() == 0);
+			break;
+
+		case HTTP_STATUS_NOT_MODIFIED:
+			REQUIRE_EQ(headers[HTTP_HEADER_ETAG], etag);
+			REQUIRE(body.length() == 0);
+			break;
+
+		default:
+			TEST_ASSERT(false);
+		}
+	}
+
+	/*
+	 * Accept-Encoding negotiation for a compressed resource
+	 */
+	void requestNextCompression()
+	{
+		auto req = new HttpRequest(getUrl(compressedPath + 1));
+		auto& headers = req->headers;
+
+		switch(compressionIndex++) {
+		case 0:
+			headers[HTTP_HEADER_ACCEPT_ENCODING] = F("deflate, gzip");
+			expectEncoding = "gzip";
+			break;
+		case 1:
+			headers[HTTP_HEADER_ACCEPT_ENCODING] = F("deflate");
+			expectEncoding = "deflate";
+			break;
+		case 2:
+			headers[HTTP_HEADER_ACCEPT_ENCODING] = F("gzip;q=0, deflate");
+			expectEncoding = "deflate";
+			break;
+		case 3:
+			headers[HTTP_HEADER_ACCEPT_ENCODING] = F("gzip; q=0, deflate;q=0, br");
+			expectEncoding = "";
+			break;
+		case 4:
+			// No Accept-Encoding
+			expectEncoding = "";
+			break;
+		default:
+			delete req;
+			shutdown();
+			return;
+		}
+
+		req->setResponseStream(new MemoryDataStream);
+		req->onRequestComplete([this](HttpConnection& connection, bool) -> int {
+			checkCompressedResponse(*connection.getResponse());
+			requestNextCompression();
+			return 0;
+		});
+		client.send(req);
+	}
+
+	void checkCompressedResponse(HttpResponse& response)
+	{
+		auto& headers = response.headers;
+		auto body = response.getBody();
+		debug_i("Compression #%u: %u %s, encoding '%s'", compressionIndex - 1, response.code,
+				toString(response.code).c_str(), headers[HTTP_HEADER_CONTENT_ENCODING].c_str());
+		REQUIRE_EQ(response.code, HTTP_STATUS_OK);
+		REQUIRE_EQ(headers[HTTP_HEADER_VARY], "Origin, Accept-Encoding");
+		REQUIRE(headers[HTTP_HEADER_CONTENT_ENCODING] == expectEncoding);
+
+		if(*expectEncoding == '\0') {
+			REQUIRE_EQ(headers[HTTP_HEADER_CONTENT_LENGTH], String(content.length()));
+			REQUIRE_EQ(headers[HTTP_HEADER_ETAG], etag);
+			REQUIRE(body == content);
+			return;
+		}
+
+		REQUIRE(!headers.contains(HTTP_HEADER_CONTENT_LENGTH));
+		REQUIRE(!headers.contains(HTTP_HEADER_ACCEPT_RANGES));
+		REQUIRE_EQ(headers[HTTP_HEADER_ETAG], F("W/") + etag);
+		REQUIRE(body.length() < content.length());
+
+		uzlib_init();
+		uzlib_uncomp state{};
+		uzlib_uncompress_init(&state, nullptr, 0);
+		state.source = reinterpret_cast<const uint8_t*>(body.c_str());
+		state.source_limit = state.source + body.length();
+		bool gzip = (strcmp(expectEncoding, "gzip") == 0);
+		int res = gzip ? uzlib_gzip_parse_header(&state) : uzlib_zlib_parse_header(&state);
+		REQUIRE(res >= 0);
+
+		String output;
+		REQUIRE(output.setLength(content.length() + 16));
+		state.dest_start = state.dest = reinterpret_cast<uint8_t*>(output.begin());
+		state.dest_limit = state.dest + output.length();
+		res = uzlib_uncompress_chksum(&state);
+		REQUIRE_EQ(res, TINF_DONE);
+		output.setLength(state.dest - state.dest_start);
+		REQUIRE(output == content);
+	}
+
+	Url getUrl(const String& fileName)
+	{
+		Url url;
+		url.Host = WifiStation.getIP().toString();
+		url.Port = 80;
+		url.Path = String('/') + fileName;
+		return url;
+	}
+
 	void shutdown()
 	{
 		server->shutdown();
@@ -98,8 +354,23 @@ public:
 	}
 
 private:
+	struct Expect {
+		HttpStatus code;
+		size_t first{0};
+		size_t length{0};
+	};
+
+	static constexpr const char* conditionalFile{"index.html"};
+	static constexpr const char* compressedPath{"/compressed"};
 	HttpServer* server{nullptr};
 	unsigned fileIndex{0};
+	unsigned conditionIndex{0};
+	unsigned compressionIndex{0};
+	const char* expectEncoding{""};
+	Expect expect{};
+	String content;
+	String etag;
+	String lastModified;
 	HttpClient client;
 	Timer timer;
 };
@@ -0,0 +1,238 @@
+#include <HostTests.h>
+
+#include <Network/MqttClient.h>
+#include <Network/TcpServer.h>
+#include <Data/Stream/MemoryDataStream.h>
+#include <Data/StringBuilder.h>
+#include <Platform/Station.h>
+
+/*
+ * Checks QoS 1/2 handling against a minimal broker which acknowledges messages selectively.
+ *
+ * Window size is 2, so of the three messages published only two are sent initially:
+ *
+ *  - 'a' is never acknowledged on the first connection, so is re-sent with DUP set after the timeout.
+ *    The broker then drops the connection and acknowledges 'a' when it is re-sent after re-connection.
+ *  - 'b' is acknowledged immediately with PUBACK, which allows 'c' to be sent
+ *  - 'c' is QoS 2 so goes through PUBREC, PUBREL, PUBCOMP
+ */
+class MqttClientTest : public TestGroup
+{
+public:
+	MqttClientTest() : TestGroup(_F("MqttClient"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Publish stream with QoS 1")
+		{
+			auto stream = new MemoryDataStream;
+			stream->print(_F("Stream content"));
+			REQUIRE(!client.publish(F("stream"), stream, MqttClient::getFlags(MQTT_QOS_AT_LEAST_ONCE)));
+		}
+
+		if(!WifiStation.isConnected()) {
+			Serial.println("No network, skipping tests");
+			return;
+		}
+
+		constexpr int port = 9877;
+
+		server = new TcpServer(TcpClientConnectDelegate(&MqttClientTest::onBrokerConnect, this),
+							   TcpClientDataDelegate(&MqttClientTest::onBrokerReceive, this), nullptr);
+		server->listen(port);
+		server->setTimeOut(USHRT_MAX);
+		server->setKeepAlive(USHRT_MAX);
+
+		client.setConnectedHandler([this](MqttClient& mqtt, mqtt_message_t*) -> int {
+			if(connectCount == 1) {
+				auto qos1 = MqttClient::getFlags(MQTT_QOS_AT_LEAST_ONCE);
+				auto qos2 = MqttClient::getFlags(MQTT_QOS_EXACTLY_ONCE);
+				REQUIRE(mqtt.publish(F("test/a"), F("a"), qos1));
+				REQUIRE(mqtt.publish(F("test/b"), F("b"), qos1));
+				REQUIRE(mqtt.publish(F("test/c"), F("c"), qos2));
+			}
+			return 0;
+		});
+
+		client.setPublishedHandler([this](MqttClient& mqtt, mqtt_message_t* message) -> int {
+			if(connectCount == 2 && message->common.type == MQTT_TYPE_PUBACK) {
+				REQUIRE_EQ(mqtt.getInFlightCount(), 0U);
+				checkLog();
+			}
+			return 0;
+		});
+
+		client.setDisconnectHandler([this](TcpClient&, bool) {
+			if(connectCount == 1 && !reconnecting) {
+				reconnecting = true;
+				// Re-connect outside of callback
+				System.queueCallback([this]() { connectClient(); });
+			}
+		});
+
+		client.setInFlightWindow(2);
+		client.setRetransmitTimeout(1);
+
+		url = Url(URI_SCHEME_MQTT, nullptr, nullptr, WifiStation.getIP().toString(), port);
+		connectClient();
+
+		pending();
+	}
+
+	void connectClient()
+	{
+		REQUIRE(client.connect(url, F("HostTests")));
+	}
+
+	void onBrokerConnect(TcpClient*)
+	{
+		++connectCount;
+		rxBuffer = nullptr;
+	}
+
+	bool onBrokerReceive(TcpClient& connection, char* data, int size)
+	{
+		rxBuffer.concat(data, size);
+
+		// Process all complete packets
+		for(;;) {
+			auto buf = reinterpret_cast<const uint8_t*>(rxBuffer.c_str());
+			size_t len = rxBuffer.length();
+			if(len < 2) {
+				break;
+			}
+			size_t remaining{0};
+			unsigned pos{1};
+			for(unsigned shift = 0; pos < len; shift += 7) {
+				auto c = buf[pos++];
+				remaining |= size_t(c & 0x7f) << shift;
+				if((c & 0x80) == 0) {
+					break;
+				}
+			}
+			if(pos + remaining > len) {
+				break;
+			}
+			if(!processPacket(connection, buf[0], buf + pos, remaining)) {
+				// Drop connection
+				return false;
+			}
+			rxBuffer.remove(0, pos + remaining);
+		}
+
+		return true;
+	}
+
+	bool processPacket(TcpClient& connection, uint8_t header, const uint8_t* data, size_t length)
+	{
+		auto getId = [&](unsigned offset) -> uint16_t { return (data[offset] << 8) | data[offset + 1]; };
+		auto reply = [&](uint8_t type, uint16_t id) {
+			const char packet[]{char(type << 4), 2, char(id >> 8), char(id)};
+			connection.send(packet, sizeof(packet));
+		};
+		auto inFlightCount = client.getInFlightCount();
+
+		switch(header >> 4) {
+		case MQTT_TYPE_CONNECT: {
+			brokerLog << "CONNECT" << '\n';
+			const char connack[]{char(MQTT_TYPE_CONNACK << 4), 2, 0, 0};
+			connection.send(connack, sizeof(connack));
+			break;
+		}
+
+		case MQTT_TYPE_PUBLISH: {
+			unsigned qos = (header >> 1) & 0x03;
+			unsigned dup = (header >> 3) & 0x01;
+			unsigned offset = 2 + getId(0);
+			uint16_t id{0};
+			if(qos != MQTT_QOS_AT_MOST_ONCE) {
+				id = getId(offset);
+				offset += 2;
+			}
+			String content(reinterpret_cast<const char*>(data) + offset, length - offset);
+			brokerLog << "PUBLISH #" << id << " qos " << qos << " dup " << dup << " '" << content << "' in-flight "
+				<< inFlightCount << '\n';
+			if(content == "a") {
+				if(dup == 0) {
+					// Let this one time out
+					break;
+				}
+				if(connectCount == 1) {
+					return false;
+				}
+				reply(MQTT_TYPE_PUBACK, id);
+			} else if(content == "b") {
+				reply(MQTT_TYPE_PUBACK, id);
+			} else if(content == "c") {
+				reply(MQTT_TYPE_PUBREC, id);
+			}
+			break;
+		}
+
+		case MQTT_TYPE_PUBREL: {
+			auto id = getId(0);
+			brokerLog << "PUBREL #" << id << " in-flight " << inFlightCount << '\n';
+			reply(MQTT_TYPE_PUBCOMP, id);
+			break;
+		}
+
+		case MQTT_TYPE_PINGREQ: {
+			const char pingresp[]{char(MQTT_TYPE_PINGRESP << 4), 0};
+			connection.send(pingresp, sizeof(pingresp));
+			break;
+		}
+
+		default:
+			brokerLog << "Type " << (header >> 4) << '\n';
+		}
+
+		return true;
+	}
+
+	void checkLog()
+	{
+		DEFINE_FSTR_LOCAL(expected, "CONNECT\n"
+									"PUBLISH #1 qos 1 dup 0 'a' in-flight 2\n"
+									"PUBLISH #2 qos 1 dup 0 'b' in-flight 2\n"
+									"PUBLISH #3 qos 2 dup 0 'c' in-flight 2\n"
+									"PUBREL #3 in-flight 2\n"
+									"PUBLISH #1 qos 1 dup 1 'a' in-flight 1\n"
+									"CONNECT\n"
+									"PUBLISH #1 qos 1 dup 1 'a' in-flight 1\n")
+
+		String s = brokerLog.moveString();
+		Serial << s;
+
+		TEST_CASE("In-flight window and acknowledgements")
+		{
+			REQUIRE_EQ(s, String(expected));
+		}
+
+		client.setConnectedHandler(nullptr);
+		client.setPublishedHandler(nullptr);
+		client.setDisconnectHandler(nullptr);
+
+		// Defer shutdown until we're out of callbacks
+		System.queueCallback([this]() {
+			server->shutdown();
+			server = nullptr;
+			complete();
+		});
+	}
+
+private:
+	MqttClient client;
+	TcpServer* server{nullptr};
+	Url url;
+	String rxBuffer;
+	StringBuilder brokerLog;
+	unsigned connectCount{0};
+	bool reconnecting{false};
+};
+
+void REGISTER_TEST(MqttClient)
+{
+	registerGroup<MqttClientTest>();
+}
@@ -0,0 +1,88 @@
+#include <HostTests.h>
+
+#include <Network/UdpConnection.h>
+#include <Platform/Station.h>
+
+class UdpConnectionTest : public TestGroup
+{
+public:
+	UdpConnectionTest() : TestGroup(_F("UdpConnection"))
+	{
+	}
+
+	void execute() override
+	{
+		if(!WifiStation.isConnected()) {
+			Serial.println("No network, skipping tests");
+			return;
+		}
+
+		auto onReceive = [this](UdpConnection&, char* data, int size, IpAddress, uint16_t) {
+			received += String(data, size);
+			received += ';';
+		};
+		for(unsigned i = 0; i < ARRAY_SIZE(listeners); ++i) {
+			listeners[i] = new UdpConnection(onReceive);
+			REQUIRE(listeners[i]->listen(basePort + i));
+		}
+
+		auto ip = WifiStation.getIP();
+
+		TEST_CASE("Gather send")
+		{
+			static const char header[]{"hdr:"};
+			String payload = F("payload");
+			UdpConnection::Segment segments[]{
+				{header, strlen(header)},
+				{payload.c_str(), payload.length()},
+			};
+			REQUIRE(sender.sendTo(ip, basePort, segments, ARRAY_SIZE(segments)));
+		}
+
+		TEST_CASE("Send to many")
+		{
+			UdpConnection::Endpoint destinations[]{
+				{ip, basePort},
+				{ip, basePort + 1},
+			};
+			const char data[]{"batch"};
+			REQUIRE_EQ(sender.sendToMany(destinations, ARRAY_SIZE(destinations), data, strlen(data)), 2U);
+		}
+
+		TEST_CASE("Send pbuf")
+		{
+			auto p = pbuf_alloc(PBUF_TRANSPORT, 4, PBUF_RAM);
+			REQUIRE(p != nullptr);
+			memcpy(p->payload, "pbuf", 4);
+			REQUIRE(sender.sendTo(ip, basePort + 1, p));
+			pbuf_free(p);
+		}
+
+		timer.initializeMs<500>([this]() {
+			debug_i("Received '%s'", received.c_str());
+			for(auto s : {"hdr:payload;", "batch;", "pbuf;"}) {
+				REQUIRE(received.indexOf(s) >= 0);
+			}
+			REQUIRE_EQ(received.length(), 29U);
+			for(auto& listener : listeners) {
+				delete listener;
+				listener = nullptr;
+			}
+			complete();
+		});
+		timer.startOnce();
+		pending();
+	}
+
+private:
+	static constexpr uint16_t basePort{9877};
+	UdpConnection* listeners[2]{};
+	UdpConnection sender;
+	String received;
+	Timer timer;
+};
+
+void REGISTER_TEST(UdpConnection)
+{
+	registerGroup<UdpConnectionTest>();
+}
@@ -0,0 +1,168 @@
+#include <HostTests.h>
+
+#include <Network/HttpServer.h>
+#include <Network/WebsocketClient.h>
+#include <Network/Http/Websocket/WebsocketResource.h>
+#include <Platform/Station.h>
+
+namespace
+{
+constexpr int port = 8082;
+constexpr size_t largeFrameSize = 8192;
+
+/*
+ * Commands sent by each client on connection. The server echoes each one back once applied.
+ */
+const char* clientCommands[][2]{
+	{"+news", nullptr},
+	{"+news", "+weather"},
+	{"+news", "-news"},
+};
+
+constexpr unsigned clientCount = ARRAY_SIZE(clientCommands);
+
+} // namespace
+
+class WebsocketTest : public TestGroup
+{
+public:
+	WebsocketTest() : TestGroup(_F("Websocket"))
+	{
+	}
+
+	void execute() override
+	{
+		if(!WifiStation.isConnected()) {
+			Serial.println("No network, skipping tests");
+			return;
+		}
+
+		server = new HttpServer;
+		server->listen(port);
+		auto resource = new WebsocketResource();
+		resource->setMessageHandler([this](WebsocketConnection& socket, const String& message) {
+			String topic = message.substring(1);
+			if(message[0] == '+') {
+				socket.subscribe(topic);
+				REQUIRE(socket.isSubscribed(topic));
+			} else {
+				socket.unsubscribe(topic);
+				REQUIRE(!socket.isSubscribed(topic));
+			}
+			socket.sendString(message);
+		});
+		server->paths.set(F("/ws"), resource);
+
+		for(auto& cmds : clientCommands) {
+			for(auto cmd : cmds) {
+				if(cmd != nullptr) {
+					++commandCount;
+				}
+			}
+		}
+
+		Url url(URI_SCHEME_WEBSOCKET, nullptr, nullptr, WifiStation.getIP().toString(), port, F("/ws"));
+		for(auto& client : clients) {
+			client.setConnectionHandler([this](WebsocketConnection& socket) {
+				auto index = getClientIndex(socket);
+				for(auto cmd : clientCommands[index]) {
+					if(cmd != nullptr) {
+						socket.sendString(cmd);
+					}
+				}
+			});
+			client.setMessageHandler([this](WebsocketConnection& socket, const String& message) {
+				auto index = getClientIndex(socket);
+				received[index] += message;
+				received[index] += ';';
+				if(++ackCount == commandCount) {
+					System.queueCallback([this]() { broadcast(); });
+				}
+			});
+			client.setBinaryHandler([this](WebsocketConnection& socket, uint8_t*, size_t size) {
+				binaryLength[getClientIndex(socket)] += size;
+			});
+			REQUIRE(client.connect(url));
+		}
+
+		pending();
+	}
+
+	unsigned getClientIndex(WebsocketConnection& socket)
+	{
+		auto client = static_cast<WebsocketClient*>(socket.getUserData());
+		return client - clients;
+	}
+
+	void broadcast()
+	{
+		auto& sockets = WebsocketConnection::getActiveWebsockets();
+		REQUIRE_EQ(sockets.count(), clientCount);
+
+		TEST_CASE("Broadcast to topics")
+		{
+			REQUIRE_EQ(WebsocketConnection::broadcast(WebsocketFrame(F("all"))), 3U);
+			REQUIRE_EQ(WebsocketConnection::broadcast(WebsocketFrame(F("news")), F("news")), 2U);
+			REQUIRE_EQ(WebsocketConnection::broadcast(WebsocketFrame(F("weather")), F("weather")), 1U);
+			REQUIRE_EQ(WebsocketConnection::broadcast(WebsocketFrame(F("sport")), F("sport")), 0U);
+		}
+
+		TEST_CASE("Broadcast with backpressure")
+		{
+			String payload;
+			payload.pad(largeFrameSize, 'x');
+			REQUIRE_EQ(WebsocketConnection::broadcast(WebsocketFrame(payload, WS_FRAME_BINARY), F("weather")), 1U);
+
+			// Large frame cannot have been acknowledged yet, so that connection gets skipped
+			for(auto socket : sockets) {
+				if(socket->isSubscribed(F("weather"))) {
+					REQUIRE(socket->getPendingBytes() >= largeFrameSize);
+				} else {
+					REQUIRE(socket->getPendingBytes() < 1024);
+				}
+			}
+			REQUIRE_EQ(WebsocketConnection::broadcast(WebsocketFrame(F("after")), nullptr, 1024), 2U);
+			for(auto socket : sockets) {
+				REQUIRE_EQ(socket->getSkippedCount(), socket->isSubscribed(F("weather")) ? 1U : 0U);
+			}
+		}
+
+		timer.initializeMs<1000>([this]() { checkReceived(); });
+		timer.startOnce();
+	}
+
+	void checkReceived()
+	{
+		TEST_CASE("Broadcast frames received")
+		{
+			REQUIRE_EQ(received[0], F("+news;all;news;after;"));
+			REQUIRE_EQ(received[1], F("+news;+weather;all;news;weather;"));
+			REQUIRE_EQ(received[2], F("+news;-news;all;after;"));
+			REQUIRE_EQ(binaryLength[0], 0U);
+			REQUIRE_EQ(binaryLength[1], largeFrameSize);
+			REQUIRE_EQ(binaryLength[2], 0U);
+		}
+
+		for(auto& client : clients) {
+			client.close();
+		}
+		server->shutdown();
+		server = nullptr;
+		timer.initializeMs<1000>([this]() { complete(); });
+		timer.startOnce();
+	}
+
+private:
+	HttpServer* server{nullptr};
+	WebsocketClient clients[clientCount];
+	String received[clientCount];
+	size_t binaryLength[clientCount]{};
+	unsigned commandCount{0};
+	unsigned ackCount{0};
+	Timer timer;
+};
+
+void REGISTER_TEST(Websocket)
+{
+	registerGroup<WebsocketTest>();
+}
@@ -2,9 +2,17 @@
 
 #include "Network/Http/HttpCommon.h"
 #include "Network/Http/HttpHeaders.h"
+#include "Network/Http/HttpResourceTree.h"
+#include "Network/Http/AssetBundle.h"
+#include "Network/Http/Websocket/WebsocketFrame.h"
 #include <Data/WebConstants.h>
+#include <Data/StringBuilder.h>
+#include <Data/Stream/MemoryDataStream.h>
+#include <malloc_count.h>
 #include <Platform/Timers.h>
 
+IMPORT_FSTR_LOCAL(webAssets, ASSET_BUNDLE_BIN)
+
 class HttpTest : public TestGroup
 {
 public:
@@ -17,6 +25,9 @@ public:
 		testHttpCommon();
 		testHttpHeaders();
 		profileHttpHeaders();
+		testResourceTree();
+		testWebsocketFrame();
+		testAssetBundle();
 	}
 
 	void testHttpCommon()
@@ -117,6 +128,47 @@ public:
 		printHeaders(headers);
 		Serial << _F("  Elapsed: ") << timer.elapsedTime().toString() << endl;
 
+		TEST_CASE("Response header allocations")
+		{
+			// Previous method: String per line, each appended to a growing MemoryDataStream
+			auto allocCount = MallocCount::getAllocCount();
+			auto stream1 = new MemoryDataStream;
+			String statusLine = F("HTTP/1.1 ");
+			statusLine += unsigned(HTTP_STATUS_OK);
+			statusLine += ' ';
+			statusLine += toString(HTTP_STATUS_OK);
+			statusLine += "\r\n";
+			stream1->print(statusLine);
+			for(auto hdr : headers) {
+				stream1->print(String(hdr));
+			}
+			stream1->print("\r\n");
+			auto oldCount = MallocCount::getAllocCount() - allocCount;
+
+			// Serialise into a single block
+			allocCount = MallocCount::getAllocCount();
+			StringBuilder sb(256);
+			sb << _F("HTTP/1.1 ") << unsigned(HTTP_STATUS_OK) << ' ' << toString(HTTP_STATUS_OK) << "\r\n";
+			for(auto hdr : headers) {
+				headers.printTo(sb, hdr.key(), hdr.value());
+			}
+			sb << "\r\n";
+			auto stream2 = new MemoryDataStream(sb.moveString());
+			auto newCount = MallocCount::getAllocCount() - allocCount;
+
+			Serial << _F("  Allocations per response: ") << oldCount << _F(" before, ") << newCount << _F(" after")
+				   << endl;
+			REQUIRE(newCount < oldCount);
+
+			String s1;
+			String s2;
+			REQUIRE(stream1->moveString(s1));
+			REQUIRE(stream2->moveString(s2));
+			REQUIRE_EQ(s1, s2);
+			delete stream1;
+			delete stream2;
+		}
+
 		delete headersPtr;
 	}
 
@@ -190,6 +242,15 @@ public:
 			printHeaders(headers);
 		}
 
+		TEST_CASE("printTo")
+		{
+			StringBuilder sb;
+			for(auto hdr : headers) {
+				headers.printTo(sb, hdr.key(), hdr.value());
+			}
+			REQUIRE(sb.moveString() == FS_serialized);
+		}
+
 		TEST_CASE("setMultiple()")
 		{
 			HttpHeaders headers2;
@@ -209,6 +270,9 @@ public:
 			printHeaders(headers2);
 			REQUIRE(headers2.count() == 1);
 			REQUIRE(serialize(headers2) == FS_cookies);
+			StringBuilder sb;
+			headers2.printTo(sb, HTTP_HEADER_SET_COOKIE, headers2[HTTP_HEADER_SET_COOKIE]);
+			REQUIRE(sb.moveString() == FS_cookies);
 
 			// Append should work if field not already set
 			REQUIRE(headers2.append(HTTP_HEADER_CONTENT_LENGTH, "0") == true);
@@ -216,6 +280,116 @@ public:
 			REQUIRE(headers2.append(HTTP_HEADER_CONTENT_LENGTH, "1234") == false);
 		}
 	}
+
+	void testResourceTree()
+	{
+		HttpResourceTree tree;
+		auto addPath = [&](const String& path) {
+			auto res = new HttpResource;
+			tree.set(path, res);
+			return res;
+		};
+		auto resStatus = addPath(F("/api/status"));
+		auto resDevice = addPath(F("/api/device/{id}"));
+		auto resDeviceState = addPath(F("/api/device/{id}/state"));
+		auto resApi = addPath(F("/api/*"));
+		auto resStatic = addPath(F("/static/*"));
+		auto resDefault = tree.setDefault(new HttpResource);
+
+		auto check = [&](const String& path, HttpResource* expected, const String& name = nullptr,
+						 const String& value = nullptr) {
+			HttpParams params;
+			auto res = tree.route(path, params);
+			Serial << path << ": " << params << endl;
+			REQUIRE(res == expected);
+			if(name) {
+				REQUIRE_EQ(params[name], value);
+			}
+		};
+
+		TEST_CASE("HttpResourceTree routing")
+		{
+			check(F("/api/status"), resStatus);
+			check(F("/api/device/42"), resDevice, F("id"), F("42"));
+			check(F("/api/device/42/state"), resDeviceState, F("id"), F("42"));
+			check(F("/api/device/42/other"), resApi, F("*"), F("device/42/other"));
+			check(F("/static/js/app.js"), resStatic, F("*"), F("js/app.js"));
+			check(F("/index.html"), resDefault);
+		}
+
+		TEST_CASE("HttpResourceTree update")
+		{
+			auto resDeviceList = addPath(F("/api/device/list"));
+			check(F("/api/device/list"), resDeviceList);
+			REQUIRE(tree.remove(F("/api/device/{id}")));
+			check(F("/api/device/42"), resApi, F("*"), F("device/42"));
+			check(F("/api/device/42/state"), resDeviceState, F("id"), F("42"));
+
+			// Swap one pattern for another so entry count is unchanged
+			REQUIRE(tree.remove(F("/static/*")));
+			auto resFiles = addPath(F("/files/*"));
+			check(F("/files/js/app.js"), resFiles, F("*"), F("js/app.js"));
+			check(F("/static/js/app.js"), resDefault);
+
+			auto res = tree.extract(F("/files/*"));
+			REQUIRE(res == resFiles);
+			tree.set(F("/static/*"), res);
+			check(F("/static/js/app.js"), resFiles, F("*"), F("js/app.js"));
+			check(F("/files/js/app.js"), resDefault);
+		}
+	}
+
+	void testWebsocketFrame()
+	{
+		TEST_CASE("WebsocketFrame")
+		{
+			WebsocketFrame frame(F("hello"));
+			REQUIRE(frame);
+			REQUIRE_EQ(frame.getSize(), 7U);
+
+			std::unique_ptr<IDataSourceStream> stream(frame.createStream());
+			StreamRegion region;
+			REQUIRE(stream->getReadRegion(region));
+			REQUIRE_EQ(region.length, 7U);
+			REQUIRE_EQ(uint8_t(region.data[0]), 0x81); // FIN + TEXT
+			REQUIRE_EQ(region.data[1], 5);
+			REQUIRE(memcmp(&region.data[2], "hello", 5) == 0);
+
+			String payload;
+			payload.pad(300, 'x');
+			WebsocketFrame binFrame(payload, WS_FRAME_BINARY);
+			REQUIRE_EQ(binFrame.getSize(), payload.length() + 4);
+			REQUIRE(memcmp(binFrame.getPayload(), payload.c_str(), payload.length()) == 0);
+		}
+	}
+
+	void testAssetBundle()
+	{
+		TEST_CASE("AssetBundle")
+		{
+			AssetBundle bundle(webAssets);
+			REQUIRE(bundle.isValid());
+			REQUIRE_EQ(bundle.count(), 2U);
+
+			auto index = bundle.find(F("/index.html"));
+			REQUIRE(index);
+			REQUIRE_EQ(index.getMimeType(), F("text/html"));
+			REQUIRE(index.isCompressed());
+			REQUIRE_EQ(index.getETag().length(), 18U);
+
+			auto css = bundle.find(F("/css/style.css"));
+			REQUIRE(css);
+			REQUIRE_EQ(css.getPath(), F("/css/style.css"));
+			REQUIRE_EQ(css.getMimeType(), F("text/css"));
+			REQUIRE(!css.isCompressed());
+			std::unique_ptr<IDataSourceStream> stream(css.createStream());
+			REQUIRE_EQ(stream->readString(100), F("body { color: red; }\n"));
+
+			REQUIRE(!bundle.find(F("/")));
+			REQUIRE(!bundle.find(F("/css/style")));
+			REQUIRE(!bundle.find(F("/missing.html")));
+		}
+	}
 };
 
 void REGISTER_TEST(Http)
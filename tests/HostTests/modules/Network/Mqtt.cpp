@@ -0,0 +1,85 @@
+#include <HostTests.h>
+
+#include <Network/Mqtt/MqttTopicPool.h>
+#include <Network/Mqtt/MqttMessageStore.h>
+
+class MqttTest : public TestGroup
+{
+public:
+	MqttTest() : TestGroup(_F("MQTT"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Topic pool")
+		{
+			MqttTopicPool pool;
+			auto topic1 = pool.intern("sensors/temperature");
+			auto topic2 = pool.intern("sensors/temperature");
+			REQUIRE(topic1 != nullptr);
+			REQUIRE(topic1 == topic2);
+			REQUIRE_EQ(pool.getRefCount("sensors/temperature"), 2U);
+
+			// Unused entries are retained up to the pool limit
+			for(unsigned i = 0; i < MQTT_TOPIC_POOL_SIZE + 2; ++i) {
+				auto topic = pool.intern(String(i));
+				REQUIRE(pool.release(topic->c_str()));
+			}
+			REQUIRE_EQ(pool.count(), size_t(MQTT_TOPIC_POOL_SIZE + 1));
+
+			// Entries in use are never discarded
+			REQUIRE(pool.intern("sensors/temperature") == topic1);
+			REQUIRE(pool.release(topic1->c_str()));
+			REQUIRE(pool.release(topic1->c_str()));
+			REQUIRE(pool.release(topic2->c_str()));
+			REQUIRE_EQ(pool.getRefCount("sensors/temperature"), 0U);
+			REQUIRE_EQ(pool.count(), size_t(MQTT_TOPIC_POOL_SIZE));
+			REQUIRE(!pool.release("not in pool"));
+		}
+
+		TEST_CASE("Message store")
+		{
+			DEFINE_FSTR_LOCAL(fileName, "mqtt-queue.bin");
+			fileDelete(fileName);
+
+			String topic;
+			String content;
+			uint8_t flags;
+
+			{
+				MqttMessageStore store(getFileSystem(), fileName);
+				REQUIRE(store.isEmpty());
+				REQUIRE(store.push("a/b", "first", 2));
+				REQUIRE(store.push("c", nullptr, 0));
+				REQUIRE(store.push("d", "third", 1));
+				REQUIRE(store.pop(topic, content, flags));
+				REQUIRE_EQ(topic, "a/b");
+				REQUIRE_EQ(content, "first");
+				REQUIRE_EQ(flags, 2);
+			}
+
+			// Unread messages survive re-opening the file
+			{
+				MqttMessageStore store(getFileSystem(), fileName);
+				REQUIRE(!store.isEmpty());
+				REQUIRE(store.pop(topic, content, flags));
+				REQUIRE_EQ(topic, "c");
+				REQUIRE(content.length() == 0);
+				REQUIRE(store.pop(topic, content, flags));
+				REQUIRE_EQ(topic, "d");
+				REQUIRE_EQ(content, "third");
+				REQUIRE_EQ(flags, 1);
+				REQUIRE(store.isEmpty());
+				REQUIRE(!store.pop(topic, content, flags));
+			}
+
+			fileDelete(fileName);
+		}
+	}
+};
+
+void REGISTER_TEST(Mqtt)
+{
+	registerGroup<MqttTest>();
+}
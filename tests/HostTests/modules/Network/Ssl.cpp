@@ -0,0 +1,232 @@
+#include <HostTests.h>
+
+#include <Network/Ssl/Session.h>
+#include <Network/Ssl/Factory.h>
+#include <lwip/tcp.h>
+
+namespace
+{
+/*
+ * Stands in for an SSL adapter so Session can be exercised without a server.
+ * Records what the session offers for resumption on each client connection.
+ */
+class TestConnection : public Ssl::Connection
+{
+public:
+	using Connection::Connection;
+
+	bool isHandshakeDone() const override
+	{
+		return true;
+	}
+
+	int read(Ssl::InputBuffer&, uint8_t*&) override
+	{
+		return 0;
+	}
+
+	int write(const uint8_t*, size_t length) override
+	{
+		return length;
+	}
+
+	Ssl::CipherSuite getCipherSuite() const override
+	{
+		return Ssl::CipherSuite(0);
+	}
+
+	Ssl::SessionId getSessionId() const override;
+
+	String getSessionParameters() const override;
+
+	const Ssl::Certificate* getCertificate() const override
+	{
+		return nullptr;
+	}
+
+	void freeCertificate() override
+	{
+	}
+
+	String getErrorString(int) const override
+	{
+		return nullptr;
+	}
+
+	Ssl::Alert getAlert(int) const override
+	{
+		return Ssl::Alert::Invalid;
+	}
+};
+
+class TestFactory : public Ssl::Factory
+{
+public:
+	class TestContext : public Ssl::Context
+	{
+	public:
+		TestContext(Ssl::Session& session, TestFactory& factory) : Context(session), factory(factory)
+		{
+		}
+
+		bool init() override
+		{
+			return true;
+		}
+
+		Ssl::Connection* createClient(tcp_pcb* tcp) override
+		{
+			auto id = session.getSessionId();
+			factory.offeredId = id ? id->toString() : String(nullptr);
+			factory.offeredParameters = session.getSessionParameters();
+			return new TestConnection(*this, tcp);
+		}
+
+		Ssl::Connection* createServer(tcp_pcb*) override
+		{
+			return nullptr;
+		}
+
+		TestFactory& factory;
+	};
+
+	Ssl::Context* createContext(Ssl::Session& session) override
+	{
+		return new TestContext(session, *this);
+	}
+
+	// Adapter behaviour
+	Ssl::SessionId serverId;
+	String parameters; ///< Empty for adapters which can't resume across contexts, such as axTLS
+
+	// What the session offered on last connect
+	String offeredId;
+	String offeredParameters;
+};
+
+Ssl::SessionId TestConnection::getSessionId() const
+{
+	return static_cast<TestFactory::TestContext&>(context).factory.serverId;
+}
+
+String TestConnection::getSessionParameters() const
+{
+	return static_cast<TestFactory::TestContext&>(context).factory.parameters;
+}
+
+} // namespace
+
+class SslTest : public TestGroup
+{
+public:
+	SslTest() : TestGroup(_F("SSL"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Session cache")
+		{
+			Ssl::SessionCache cache(2, 60);
+			REQUIRE(cache.isEnabled());
+
+			auto makeId = [](uint8_t value) {
+				uint8_t buf[32];
+				memset(buf, value, sizeof(buf));
+				Ssl::SessionId id;
+				id.assign(buf, sizeof(buf));
+				return id;
+			};
+
+			REQUIRE(cache.find("a") == nullptr);
+			cache.store("a", makeId(1), "params-a");
+			cache.store("b", makeId(2), nullptr);
+			REQUIRE_EQ(cache.count(), 2U);
+
+			auto entry = cache.find("a");
+			REQUIRE(entry != nullptr);
+			REQUIRE(entry->id.toString() == makeId(1).toString());
+			REQUIRE(entry->parameters == "params-a");
+
+			// Invalid session IDs are not stored
+			cache.store("c", Ssl::SessionId{}, nullptr);
+			REQUIRE_EQ(cache.count(), 2U);
+
+			// Replaces least recently used entry
+			cache.store("c", makeId(3), nullptr);
+			REQUIRE_EQ(cache.count(), 2U);
+			REQUIRE(cache.find("b") == nullptr);
+			REQUIRE(cache.find("c") != nullptr);
+
+			cache.remove("c");
+			REQUIRE(cache.find("c") == nullptr);
+
+			cache.recordResumed();
+			auto& stats = cache.getStats();
+			Serial << cache;
+			REQUIRE_EQ(stats.lookups, 5U);
+			REQUIRE_EQ(stats.offered, 2U);
+			REQUIRE_EQ(stats.resumed, 1U);
+			REQUIRE_EQ(stats.evictions, 1U);
+			REQUIRE_EQ(cache.getHitRate(), 20U);
+
+			cache.setLimits(0, 60);
+			REQUIRE(!cache.isEnabled());
+			cache.store("a", makeId(1), nullptr);
+			REQUIRE(cache.find("a") == nullptr);
+		}
+
+		TEST_CASE("Session resumption")
+		{
+			auto savedFactory = Ssl::factory;
+			TestFactory testFactory;
+			Ssl::factory = &testFactory;
+			Ssl::sessionCache.setLimits(SSL_SESSION_CACHE_SIZE, SSL_SESSION_CACHE_TTL);
+			Ssl::sessionCache.resetStats();
+
+			tcp_pcb tcp{};
+			tcp.remote_port = 443;
+
+			uint8_t idValue[32];
+			memset(idValue, 0x5a, sizeof(idValue));
+			testFactory.serverId.assign(idValue, sizeof(idValue));
+
+			// Returns true if session was resumed
+			auto connect = [&]() {
+				Ssl::Session session;
+				session.hostName = F("example.com");
+				REQUIRE(session.onConnect(&tcp));
+				session.handshakeComplete(true);
+				return session.isResumed();
+			};
+
+			// Adapter without resumption parameters: nothing offered on the second connection
+			testFactory.parameters = nullptr;
+			REQUIRE(!connect());
+			REQUIRE(!connect());
+			REQUIRE(!testFactory.offeredId);
+			REQUIRE_EQ(Ssl::sessionCache.count(), 0U);
+
+			// Adapter which can restore a session
+			testFactory.parameters = F("master-secret");
+			REQUIRE(!connect());
+			REQUIRE(!testFactory.offeredId);
+			REQUIRE(connect());
+			REQUIRE(testFactory.offeredId == testFactory.serverId.toString());
+			REQUIRE(testFactory.offeredParameters == testFactory.parameters);
+
+			auto& stats = Ssl::sessionCache.getStats();
+			REQUIRE_EQ(stats.lookups, 4U);
+			REQUIRE_EQ(stats.resumed, 1U);
+
+			Ssl::sessionCache.clear();
+			Ssl::sessionCache.resetStats();
+			Ssl::factory = savedFactory;
+		}
+	}
+};
+
+void REGISTER_TEST(Ssl)
+{
+	registerGroup<SslTest>();
+}
@@ -89,6 +89,24 @@ public:
 			REQUIRE(map.count() == 0);
 			REQUIRE(objectCount == 0);
 		}
+
+		TEST_CASE("Hashed lookups")
+		{
+			REQUIRE(map.enableHashing());
+			for(unsigned i = 0; i < 50; ++i) {
+				map[String(i)] = new TestClass;
+			}
+			REQUIRE(map.count() == 50);
+			REQUIRE(map.contains("25"));
+			REQUIRE(map.remove("25"));
+			REQUIRE(!map.contains("25"));
+			REQUIRE(map.indexOf("26") == 25);
+			delete map.extract("0");
+			REQUIRE(map.indexOf("49") == 47);
+			REQUIRE(objectCount == 48);
+			map.clear();
+			REQUIRE(objectCount == 0);
+		}
 	}
 };
 
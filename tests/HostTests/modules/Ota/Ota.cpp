@@ -0,0 +1,341 @@
+#include <HostTests.h>
+#include <Ota/DeltaOutputStream.h>
+#include <Ota/PipelinedOutputStream.h>
+#include <Storage/ProgMem.h>
+#ifndef DISABLE_NETWORK
+#include <Network/TcpClient.h>
+#endif
+
+IMPORT_FSTR_LOCAL(deltaPatch, OTA_DELTA_PATCH)
+
+namespace
+{
+// Compare data written with reference content
+class VerifyStream : public ReadWriteStream
+{
+public:
+	VerifyStream(const FlashString& ref) : ref(ref)
+	{
+	}
+
+	size_t write(const uint8_t* data, size_t size) override
+	{
+		uint8_t buf[64];
+		for(size_t i = 0; i < size; i += sizeof(buf)) {
+			auto n = std::min(size - i, sizeof(buf));
+			if(ref.read(offset + i, buf, n) != n || memcmp(buf, &data[i], n) != 0) {
+				mismatch = true;
+			}
+		}
+		offset += size;
+		return size;
+	}
+
+	uint16_t readMemoryBlock(char*, int) override
+	{
+		return 0;
+	}
+
+	int available() override
+	{
+		return offset;
+	}
+
+	bool isFinished() override
+	{
+		return true;
+	}
+
+	bool matched() const
+	{
+		return !mismatch && offset == ref.length();
+	}
+
+private:
+	const FlashString& ref;
+	size_t offset{0};
+	bool mismatch{false};
+};
+
+/*
+ * RAM-backed device which behaves like NOR flash: writes can only clear bits
+ */
+class FlashRamDevice : public Storage::Device
+{
+public:
+	static constexpr size_t size{0x10000};
+	static constexpr size_t blockSize{0x1000};
+
+	String getName() const override
+	{
+		return F("flashRam");
+	}
+
+	size_t getBlockSize() const override
+	{
+		return blockSize;
+	}
+
+	storage_size_t getSize() const override
+	{
+		return size;
+	}
+
+	Type getType() const override
+	{
+		return Type::sysmem;
+	}
+
+	bool read(storage_size_t address, void* dst, size_t len) override
+	{
+		memcpy(dst, &data[address], len);
+		return true;
+	}
+
+	bool write(storage_size_t address, const void* src, size_t len) override
+	{
+		++writeCount;
+		auto bytes = static_cast<const uint8_t*>(src);
+		for(size_t i = 0; i < len; ++i) {
+			data[address + i] &= bytes[i];
+		}
+		return true;
+	}
+
+	bool erase_range(storage_size_t address, storage_size_t len) override
+	{
+		eraseCount += len / blockSize;
+		memset(&data[address], 0xFF, len);
+		return true;
+	}
+
+	// Content is garbage unless erased first
+	void reset()
+	{
+		memset(data, 0, sizeof(data));
+		writeCount = eraseCount = 0;
+	}
+
+	uint8_t data[size];
+	unsigned writeCount{0};
+	unsigned eraseCount{0};
+};
+
+uint8_t patternByte(size_t offset)
+{
+	return (offset * 7) ^ (offset >> 8);
+}
+
+// Number of blocks needed to hold the given number of bytes
+unsigned blockCount(size_t length)
+{
+	return (length + FlashRamDevice::blockSize - 1) / FlashRamDevice::blockSize;
+}
+
+} // namespace
+
+class OtaTest : public TestGroup
+{
+public:
+	OtaTest() : TestGroup(_F("OTA"))
+	{
+	}
+
+	void execute() override
+	{
+		Serial << _F("Patch ") << deltaPatch.length() << _F(" bytes, target ") << Resource::ut_template1_in_rst.length()
+			   << _F(" bytes") << endl;
+
+		// Source image is the unmodified file, target is the template
+		using App = Storage::Partition::SubType::App;
+		auto& partitions = Storage::progMem.editablePartitions();
+		auto source = partitions.add(F("delta-source"), Resource::unit_testing_rst, App::ota0);
+		auto wrongSource = partitions.add(F("delta-wrong"), Resource::ut_template1_in_rst, App::ota1);
+		REQUIRE(source);
+		REQUIRE(wrongSource);
+
+		TEST_CASE("Apply delta patch")
+		{
+			auto output = new VerifyStream(Resource::ut_template1_in_rst);
+			Ota::DeltaOutputStream stream(source, output);
+			// Feed patch in irregular chunks to exercise parser state handling
+			REQUIRE(writePatch(stream, 7));
+			REQUIRE(stream.isComplete());
+			REQUIRE_EQ(size_t(stream.available()), Resource::ut_template1_in_rst.length());
+			REQUIRE(output->matched());
+		}
+
+		TEST_CASE("Apply delta patch, larger chunks")
+		{
+			auto output = new VerifyStream(Resource::ut_template1_in_rst);
+			Ota::DeltaOutputStream stream(source, output);
+			REQUIRE(writePatch(stream, 256));
+			REQUIRE(stream.isComplete());
+			REQUIRE(output->matched());
+		}
+
+		TEST_CASE("Delta patch with wrong source")
+		{
+			Ota::DeltaOutputStream stream(wrongSource, new VerifyStream(Resource::ut_template1_in_rst));
+			REQUIRE(!writePatch(stream, 64));
+			REQUIRE(stream.hasError());
+			REQUIRE(!stream.isComplete());
+		}
+
+		TEST_CASE("Truncated delta patch")
+		{
+			Ota::DeltaOutputStream stream(source, new VerifyStream(Resource::ut_template1_in_rst));
+			uint8_t buf[16];
+			REQUIRE_EQ(deltaPatch.read(0, buf, sizeof(buf)), sizeof(buf));
+			REQUIRE_EQ(stream.write(buf, sizeof(buf)), sizeof(buf));
+			REQUIRE(!stream.isComplete());
+			REQUIRE(!stream.hasError());
+		}
+
+		flash->reset();
+		pipelinePart = flash->editablePartitions().add(F("pipeline"), App::ota0, 0, FlashRamDevice::size);
+		REQUIRE(pipelinePart);
+
+		TEST_CASE("Pipelined write, flash slower than sender")
+		{
+			// Nothing gets a chance to run in the background, so every full buffer after the first stalls
+			const size_t length = 3 * OTA_PIPELINE_BUFFER_SIZE + 100;
+			unsigned pauses{0};
+			unsigned resumes{0};
+			Ota::PipelinedOutputStream stream(pipelinePart);
+			stream.setFlowControl([&](bool pause) { ++(pause ? pauses : resumes); });
+			REQUIRE(writePattern(stream, 0, length));
+			REQUIRE(stream.close());
+
+			auto& stats = stream.getStats();
+			REQUIRE_EQ(stats.bytes, length);
+			REQUIRE_EQ(stats.stallCount, 2);
+			REQUIRE_EQ(stats.pauseCount, 3);
+			REQUIRE_EQ(pauses, 3U);
+			REQUIRE_EQ(resumes, 3U);
+			REQUIRE_EQ(flash->eraseCount, blockCount(length));
+			REQUIRE(verifyPattern(length));
+		}
+
+		TEST_CASE("Pipelined write with background flush")
+		{
+			flash->reset();
+			pipeline = std::make_unique<Ota::PipelinedOutputStream>(pipelinePart);
+			pipeline->setFlowControl([this](bool pause) { setPaused(pause); });
+			REQUIRE(writePattern(*pipeline, 0, OTA_PIPELINE_BUFFER_SIZE));
+			REQUIRE(isPaused());
+			REQUIRE_EQ(flash->writeCount, 0U);
+
+			timer.initializeMs<50>([this]() { checkPipeline(); });
+			timer.startOnce();
+			pending();
+		}
+	}
+
+	void checkPipeline()
+	{
+		// Background task has written the buffer, resumed the sender and erased ahead
+		REQUIRE(!isPaused());
+		REQUIRE_EQ(flash->writeCount, 1U);
+		size_t eraseLimit = 2 * OTA_PIPELINE_BUFFER_SIZE + OTA_PIPELINE_ERASE_AHEAD * FlashRamDevice::blockSize;
+		REQUIRE_EQ(flash->eraseCount, blockCount(std::min(eraseLimit, FlashRamDevice::size)));
+
+		const size_t length = OTA_PIPELINE_BUFFER_SIZE + 100;
+		REQUIRE(writePattern(*pipeline, OTA_PIPELINE_BUFFER_SIZE, 100));
+		REQUIRE(pipeline->close());
+		REQUIRE(!isPaused());
+
+		auto& stats = pipeline->getStats();
+		REQUIRE_EQ(stats.bytes, length);
+		REQUIRE_EQ(stats.stallCount, 0);
+		REQUIRE_EQ(stats.pauseCount, 1);
+		REQUIRE_EQ(flash->writeCount, 2U);
+		REQUIRE(verifyPattern(length));
+
+		pipeline.reset();
+		complete();
+	}
+
+	bool writePattern(ReadWriteStream& stream, size_t offset, size_t length)
+	{
+		// Irregular chunk size so writes straddle buffer boundaries
+		uint8_t buf[100];
+		for(size_t pos = 0; pos < length; pos += sizeof(buf)) {
+			auto n = std::min(length - pos, sizeof(buf));
+			for(size_t i = 0; i < n; ++i) {
+				buf[i] = patternByte(offset + pos + i);
+			}
+			if(stream.write(buf, n) != n) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool verifyPattern(size_t length)
+	{
+		for(size_t i = 0; i < length; ++i) {
+			if(flash->data[i] != patternByte(i)) {
+				debug_e("Mismatch @ 0x%04x", i);
+				return false;
+			}
+		}
+		return true;
+	}
+
+#ifndef DISABLE_NETWORK
+	// Flow control as connected by HttpUpgrader
+	bool isPaused() const
+	{
+		return client.isReceivePaused();
+	}
+
+	void setPaused(bool pause)
+	{
+		if(pause) {
+			client.pauseReceive();
+		} else {
+			client.resumeReceive();
+		}
+	}
+#else
+	bool isPaused() const
+	{
+		return paused;
+	}
+
+	void setPaused(bool pause)
+	{
+		paused = pause;
+	}
+#endif
+
+	bool writePatch(Ota::DeltaOutputStream& stream, size_t chunkSize)
+	{
+		uint8_t buf[256];
+		assert(chunkSize <= sizeof(buf));
+		for(size_t offset = 0; offset < deltaPatch.length(); offset += chunkSize) {
+			auto n = deltaPatch.read(offset, buf, chunkSize);
+			if(stream.write(buf, n) != n) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+private:
+	std::unique_ptr<FlashRamDevice> flash{new FlashRamDevice};
+	Storage::Partition pipelinePart;
+	std::unique_ptr<Ota::PipelinedOutputStream> pipeline;
+	SimpleTimer timer;
+#ifndef DISABLE_NETWORK
+	TcpClient client{false};
+#else
+	bool paused{false};
+#endif
+};
+
+void REGISTER_TEST(Ota)
+{
+	registerGroup<OtaTest>();
+}
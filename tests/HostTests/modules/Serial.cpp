@@ -1,6 +1,39 @@
 #include <HostTests.h>
 
 #include <driver/SerialBuffer.h>
+#include <HardwareSerial.h>
+
+#ifdef ARCH_HOST
+namespace
+{
+/*
+ * Data injected into receive buffer, with frames expected in response.
+ * Frames are separated by '|', and prefixed with '*' if they wrapped around the end of the buffer.
+ * Buffer positions assume a receive buffer size of 32 bytes.
+ */
+struct FrameStep {
+	uint16_t frameLength; ///< 0 for delimited lines
+	const char* data;
+	const char* expected;
+};
+
+constexpr size_t frameRxBufferSize{32};
+
+const FrameStep frameSteps[]{
+	{0, "one\ntwo\nthr", "one\n|two\n|"},
+	{0, "ee\n", "three\n|"},
+	{0, "0123456789abcdefghi\n", "*0123456789abcdefghi\n|"},
+	// Fills buffer without a delimiter so gets discarded
+	{0, "0123456789012345678901234567890", ""},
+	// Remainder of discarded line is dropped
+	{0, "tail\nok\n", "ok\n|"},
+	{4, "ABCDEFGHIJ", "ABCD|EFGH|"},
+	{4, "KL", "IJKL|"},
+	{4, "MNOPQRSTUVWX", "MNOP|QRST|*UVWX|"},
+};
+
+} // namespace
+#endif
 
 class SerialTest : public TestGroup
 {
@@ -56,7 +89,149 @@ public:
 			REQUIRE(txbuf.available() == 0);
 			REQUIRE(compareBuffer == readBuffer);
 		}
+
+		TEST_CASE("SerialBuffer wrapped frame")
+		{
+			SerialBuffer rxbuf;
+			rxbuf.resize(16);
+
+			// Move read position close to end of buffer
+			for(unsigned i = 0; i < 12; ++i) {
+				rxbuf.writeChar('-');
+			}
+			void* data;
+			REQUIRE_EQ(rxbuf.getReadData(data), 12U);
+			rxbuf.skipRead(12);
+
+			const char line[]{"$GPGGA,1*2A\r\n"};
+			const size_t length = strlen(line);
+			for(unsigned i = 0; i < length; ++i) {
+				REQUIRE_EQ(rxbuf.writeChar(line[i]), 1U);
+			}
+			REQUIRE_EQ(rxbuf.find('\n'), int(length - 1));
+
+			// Only part of frame is contiguous
+			REQUIRE_EQ(rxbuf.getReadData(data), 4U);
+
+			char frame[16];
+			rxbuf.peekData(frame, length);
+			REQUIRE(memcmp(frame, line, length) == 0);
+			REQUIRE_EQ(rxbuf.available(), length);
+		}
+
+#ifdef ARCH_HOST
+		TEST_CASE("Framed receive")
+		{
+			serial = std::make_unique<HardwareSerial>(UART1);
+			REQUIRE(serial->begin(115200, SERIAL_8N1, SERIAL_RX_ONLY));
+			REQUIRE_EQ(serial->setRxBufferSize(frameRxBufferSize), frameRxBufferSize);
+			serial->resetErrorCounts();
+			nextFrameStep();
+			pending();
+		}
+#endif
+	}
+
+#ifdef ARCH_HOST
+	/*
+	 * Emulate data arriving from the uart, as the host uart server does
+	 */
+	void inject(const char* data, uint16_t status)
+	{
+		auto uart = serial->getUart();
+		for(; *data != '\0'; ++data) {
+			REQUIRE(uart->rx_buffer->writeChar(*data) == 1);
+		}
+		uart->status |= status;
+		smg_uart_host_interrupt(uart);
+	}
+
+	void onFrame(HardwareSerial&, const char* frame, size_t length)
+	{
+		++frameCount;
+		// Frame is passed directly from receive buffer unless it wraps
+		void* data;
+		serial->getUart()->rx_buffer->getReadData(data);
+		if(frame != data) {
+			frames += '*';
+		}
+		frames.concat(frame, length);
+		frames += '|';
+	}
+
+	void nextFrameStep()
+	{
+		if(stepIndex >= ARRAY_SIZE(frameSteps)) {
+			checkErrorCounts();
+			return;
+		}
+
+		auto& step = frameSteps[stepIndex];
+		// Changing mode resets frame state, so only do it when necessary
+		if(stepIndex == 0 || step.frameLength != frameSteps[stepIndex - 1].frameLength) {
+			FrameReceivedDelegate delegate(&SerialTest::onFrame, this);
+			if(step.frameLength == 0) {
+				REQUIRE(serial->onLineReceived(delegate));
+			} else {
+				REQUIRE(serial->onFrameReceived(delegate, step.frameLength));
+			}
+		}
+
+		frames = "";
+		inject(step.data, UART_STATUS_RXFIFO_TOUT);
+
+		// Serial callback has been queued, so this runs after it
+		System.queueCallback([this]() {
+			Serial << _F("Frame step #") << stepIndex << endl;
+			REQUIRE_EQ(frames, frameSteps[stepIndex].expected);
+			++stepIndex;
+			nextFrameStep();
+		});
 	}
+
+	void checkErrorCounts()
+	{
+		REQUIRE_EQ(frameCount, 11U);
+		auto& counts = serial->getErrorCounts();
+		REQUIRE_EQ(counts.oversizeFrames, 1U);
+		REQUIRE_EQ(counts.overruns, 0U);
+		REQUIRE_EQ(counts.framingErrors, 0U);
+
+		REQUIRE(serial->onLineReceived(FrameReceivedDelegate(&SerialTest::onFrame, this)));
+		// Errors are latched by the uart and collected when received data is processed
+		inject("x\n", UART_STATUS_RXFIFO_TOUT | UART_STATUS_RXFIFO_OVF | UART_STATUS_FRM_ERR | UART_STATUS_PARITY_ERR |
+						   UART_STATUS_BRK_DET);
+		System.queueCallback([this]() {
+			auto& counts = serial->getErrorCounts();
+			REQUIRE_EQ(frameCount, 12U);
+			REQUIRE_EQ(counts.overruns, 1U);
+			REQUIRE_EQ(counts.framingErrors, 1U);
+			REQUIRE_EQ(counts.parityErrors, 1U);
+			REQUIRE_EQ(counts.breaks, 1U);
+			REQUIRE_EQ(counts.oversizeFrames, 1U);
+
+			unsigned status = serial->getStatus();
+			REQUIRE(bitRead(status, eSERS_Overflow));
+			REQUIRE(bitRead(status, eSERS_FramingError));
+			REQUIRE(bitRead(status, eSERS_ParityError));
+			REQUIRE(bitRead(status, eSERS_BreakDetected));
+			REQUIRE_EQ(serial->getStatus(), 0U);
+
+			serial->resetErrorCounts();
+			REQUIRE_EQ(serial->getErrorCounts().oversizeFrames, 0U);
+
+			serial->end();
+			serial.reset();
+			complete();
+		});
+	}
+
+private:
+	std::unique_ptr<HardwareSerial> serial;
+	String frames;
+	unsigned stepIndex{0};
+	unsigned frameCount{0};
+#endif
 };
 
 void REGISTER_TEST(Serial)
@@ -1,5 +1,8 @@
 #include <HostTests.h>
 #include <esp_spi_flash.h>
+#ifdef ARCH_HOST
+#include <spi_flash/flashmem.h>
+#endif
 
 namespace
 {
@@ -93,6 +96,30 @@ public:
 			Serial.println(sizeStr ?: unk);
 			REQUIRE(modeStr != nullptr && speedStr != nullptr && sizeStr != nullptr);
 		}
+
+#ifdef ARCH_HOST
+		TEST_CASE("Sector statistics")
+		{
+			auto sectorCount = flashmem_get_size_bytes() / INTERNAL_FLASH_SECTOR_SIZE;
+			FlashmemSectorStats stats[2];
+			REQUIRE(host_flashmem_get_stats(sectorCount - 2, stats[0]));
+			REQUIRE(host_flashmem_get_stats(sectorCount - 1, stats[1]));
+			REQUIRE(!host_flashmem_get_stats(sectorCount, stats[0]));
+
+			// Read straddling last two sectors counts against both
+			uint8_t buffer[16];
+			auto addr = (sectorCount - 1) * INTERNAL_FLASH_SECTOR_SIZE - sizeof(buffer) / 2;
+			REQUIRE_EQ(flashmem_read(buffer, addr, sizeof(buffer)), sizeof(buffer));
+
+			FlashmemSectorStats after;
+			REQUIRE(host_flashmem_get_stats(sectorCount - 2, after));
+			REQUIRE_EQ(after.reads, stats[0].reads + 1);
+			REQUIRE_EQ(after.writes, stats[0].writes);
+			REQUIRE(host_flashmem_get_stats(sectorCount - 1, after));
+			REQUIRE_EQ(after.reads, stats[1].reads + 1);
+			REQUIRE_EQ(after.erases, stats[1].erases);
+		}
+#endif
 	}
 };
 
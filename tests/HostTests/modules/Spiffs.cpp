@@ -25,6 +25,11 @@ public:
 		{
 			cycleFlash();
 		}
+
+		TEST_CASE("Directory emulation")
+		{
+			checkDirectories();
+		}
 	}
 
 	/*
@@ -72,6 +77,73 @@ public:
 		REQUIRE(testContent == content);
 	}
 
+	/*
+	 * Directories are derived from file paths, so listings must follow changes to files.
+	 * When built with SPIFFS_NAME_INDEX=1 this also checks the index is kept up to date.
+	 */
+	void checkDirectories()
+	{
+		REQUIRE_EQ(fileSystemFormat(), FS_OK);
+
+		DEFINE_FSTR_LOCAL(content, "Directory test");
+		REQUIRE_EQ(fileSetContent("dir1/a.txt", content), int(content.length()));
+		REQUIRE_EQ(fileSetContent("dir1/sub/b.txt", content), int(content.length()));
+		REQUIRE_EQ(fileSetContent("c.txt", content), int(content.length()));
+
+		REQUIRE_EQ(listDirectory(nullptr), "c.txt,dir1/");
+		REQUIRE_EQ(listDirectory("dir1"), "a.txt,sub/");
+		REQUIRE_EQ(listDirectory("dir1/sub"), "b.txt");
+		REQUIRE_EQ(listDirectory("nonexistent"), "");
+
+		REQUIRE_EQ(fileRename("dir1/sub/b.txt", "dir2/b.txt"), FS_OK);
+		REQUIRE_EQ(listDirectory(nullptr), "c.txt,dir1/,dir2/");
+		REQUIRE_EQ(listDirectory("dir1"), "a.txt");
+		REQUIRE(!fileExist("dir1/sub/b.txt"));
+		REQUIRE(content == fileGetContent("dir2/b.txt"));
+
+		REQUIRE_EQ(fileDelete("dir1/a.txt"), FS_OK);
+		REQUIRE_EQ(listDirectory(nullptr), "c.txt,dir2/");
+		REQUIRE(!fileExist("dir1/a.txt"));
+
+		// Listing must be the same after re-mounting
+		fileFreeFileSystem();
+		REQUIRE(spiffs_mount());
+		REQUIRE_EQ(listDirectory(nullptr), "c.txt,dir2/");
+		REQUIRE_EQ(fileGetSize("c.txt"), file_size_t(content.length()));
+	}
+
+	/*
+	 * Return sorted directory listing, with directory names suffixed by '/'
+	 */
+	String listDirectory(const char* path)
+	{
+		DirHandle dir;
+		if(fileOpenDir(path, dir) < 0) {
+			return nullptr;
+		}
+
+		Vector<String> names;
+		FileNameStat stat;
+		while(fileReadDir(dir, stat) >= 0) {
+			String name(stat.name.buffer);
+			if(stat.attr[FileAttribute::Directory]) {
+				name += '/';
+			}
+			names.add(name);
+		}
+		fileCloseDir(dir);
+
+		names.sort([](const String& s1, const String& s2) { return s1.compareTo(s2); });
+		String list;
+		for(auto& name : names) {
+			if(list) {
+				list += ',';
+			}
+			list += name;
+		}
+		return list;
+	}
+
 #ifdef ARCH_HOST
 	/*
 	 * Verify that a legacy volume (i.e. one generated with spiffy before IFS was introduced)
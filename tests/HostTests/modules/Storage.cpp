@@ -1,6 +1,7 @@
 #include <HostTests.h>
 #include <Storage.h>
 #include <Storage/Debug.h>
+#include <Storage/CachedDevice.h>
 
 class TestDevice : public Storage::Device
 {
@@ -88,7 +89,161 @@ public:
 	}
 };
 
+/*
+ * RAM-backed device which counts accesses
+ */
+class RamDevice : public Storage::Device
+{
+public:
+	static constexpr size_t size{0x4000};
+
+	RamDevice()
+	{
+		memset(data, 0xFF, sizeof(data));
+	}
+
+	String getName() const override
+	{
+		return F("ramDevice");
+	}
+
+	size_t getBlockSize() const override
+	{
+		return 0x1000;
+	}
+
+	storage_size_t getSize() const override
+	{
+		return size;
+	}
+
+	Type getType() const override
+	{
+		return Type::sysmem;
+	}
+
+	bool read(storage_size_t address, void* dst, size_t len) override
+	{
+		++readCount;
+		memcpy(dst, &data[address], len);
+		return true;
+	}
+
+	bool write(storage_size_t address, const void* src, size_t len) override
+	{
+		++writeCount;
+		memcpy(&data[address], src, len);
+		return true;
+	}
+
+	bool erase_range(storage_size_t address, storage_size_t len) override
+	{
+		memset(&data[address], 0xFF, len);
+		return true;
+	}
+
+	uint8_t data[size];
+	unsigned readCount{0};
+	unsigned writeCount{0};
+};
+
+class CachedDeviceTest : public TestGroup
+{
+public:
+	CachedDeviceTest() : TestGroup(_F("CachedDevice"))
+	{
+	}
+
+	void execute() override
+	{
+		auto ram = std::make_unique<RamDevice>();
+		ram->editablePartitions().add(F("test"), {Storage::Partition::Type::data, 0x80}, 0x1000, 0x2000);
+		Storage::CachedDevice cache(*ram, 256, 4, 64);
+
+		TEST_CASE("Partitions")
+		{
+			auto part = cache.partitions().find(F("test"));
+			REQUIRE(part);
+			REQUIRE_EQ(part.address(), 0x1000U);
+			REQUIRE_EQ(part.size(), 0x2000U);
+
+			// Access goes via cache
+			uint8_t value;
+			REQUIRE(part.read(0, &value, 1));
+			REQUIRE_EQ(cache.getStats().misses, 1U);
+			cache.invalidate();
+			cache.resetStats();
+			ram->readCount = 0;
+		}
+
+		TEST_CASE("Read cache")
+		{
+			uint8_t buf[16];
+			for(unsigned i = 0; i < 10; ++i) {
+				REQUIRE(cache.read(0x100 + i * sizeof(buf), buf, sizeof(buf)));
+			}
+			REQUIRE_EQ(ram->readCount, 1U);
+			auto& stats = cache.getStats();
+			REQUIRE_EQ(stats.misses, 1U);
+			REQUIRE_EQ(stats.hits, 9U);
+
+			// Straddles pages: one hit, one miss
+			REQUIRE(cache.read(0x1F8, buf, sizeof(buf)));
+			REQUIRE_EQ(ram->readCount, 2U);
+
+			// Fill cache so first page gets evicted
+			for(unsigned addr = 0x200; addr < 0x600; addr += 0x100) {
+				REQUIRE(cache.read(addr, buf, 1));
+			}
+			REQUIRE_EQ(stats.evictions, 1U);
+
+			// Larger than cache
+			auto big = std::make_unique<uint8_t[]>(0x1000);
+			REQUIRE(cache.read(0, big.get(), 0x1000));
+			REQUIRE_EQ(stats.bypassed, 1U);
+		}
+
+		TEST_CASE("Write combining")
+		{
+			cache.resetStats();
+			ram->writeCount = 0;
+			uint8_t buf[16];
+			for(unsigned i = 0; i < sizeof(buf); ++i) {
+				buf[i] = i;
+			}
+
+			uint8_t check[sizeof(buf)];
+			REQUIRE(cache.read(0x800, check, 1));
+			for(unsigned i = 0; i < 3; ++i) {
+				REQUIRE(cache.write(0x800 + i * sizeof(buf), buf, sizeof(buf)));
+			}
+			REQUIRE_EQ(ram->writeCount, 0U);
+
+			// Read must see buffered data
+			REQUIRE(cache.read(0x810, check, sizeof(check)));
+			REQUIRE_EQ(ram->writeCount, 1U);
+			REQUIRE(memcmp(buf, check, sizeof(buf)) == 0);
+
+			// Buffer flushed on reaching block boundary
+			REQUIRE(cache.write(0x830, buf, sizeof(buf)));
+			REQUIRE_EQ(ram->writeCount, 2U);
+
+			// Non-contiguous write flushes
+			REQUIRE(cache.write(0x900, buf, 4));
+			REQUIRE(cache.write(0x908, buf, 4));
+			REQUIRE_EQ(ram->writeCount, 3U);
+			REQUIRE(cache.sync());
+			REQUIRE_EQ(ram->writeCount, 4U);
+			REQUIRE(memcmp(&ram->data[0x908], buf, 4) == 0);
+
+			auto& stats = cache.getStats();
+			REQUIRE_EQ(stats.flushes, 4U);
+		}
+	}
+};
+
 void REGISTER_TEST(Storage)
 {
 	registerGroup<PartitionTest>();
+	registerGroup<CachedDeviceTest>();
 }
@@ -2,13 +2,18 @@
 #include <FlashString/TemplateStream.hpp>
 #include <Data/Stream/MemoryDataStream.h>
 #include <Data/Stream/LimitedMemoryStream.h>
+#include <Data/Stream/LimitedReadStream.h>
 #include <Data/Stream/XorOutputStream.h>
 #include <Data/Stream/SharedMemoryStream.h>
+#include <Data/Stream/FlashMemoryStream.h>
+#include <Data/Stream/JsonWriterStream.h>
+#include <Data/Stream/RopeStream.h>
 #include <Data/WebHelpers/base64.h>
 #include <malloc_count.h>
 
 #ifndef DISABLE_NETWORK
 #include <Data/Stream/ChunkedStream.h>
+#include <Data/Stream/DeflateOutputStream.h>
 #endif
 
 #ifndef DISABLE_NETWORK
@@ -107,6 +112,46 @@ public:
 			REQUIRE(FS_OUTPUT == s);
 		}
 
+		TEST_CASE("DeflateOutputStream")
+		{
+			using Format = DeflateOutputStream::Format;
+			for(auto format : {Format::gzip, Format::zlib}) {
+				DeflateOutputStream deflate(new FSTR::Stream(FS_abstract), format, 512, 8, 128);
+				REQUIRE(deflate.isValid());
+
+				// Read in odd-sized pieces so compressed output backs up in internal buffers
+				String compressed;
+				char buffer[100];
+				while(!deflate.isFinished()) {
+					auto len = deflate.readMemoryBlock(buffer, sizeof(buffer));
+					len = std::min(len, uint16_t(37));
+					compressed.concat(buffer, len);
+					deflate.seek(len);
+				}
+				debug_i("Compressed %u -> %u bytes", deflate.getInputLength(), compressed.length());
+				REQUIRE_EQ(deflate.getInputLength(), FS_abstract.length());
+				REQUIRE_EQ(deflate.getOutputLength(), compressed.length());
+				REQUIRE(compressed.length() < FS_abstract.length());
+
+				uzlib_init();
+				uzlib_uncomp state{};
+				uzlib_uncompress_init(&state, nullptr, 0);
+				state.source = reinterpret_cast<const uint8_t*>(compressed.c_str());
+				state.source_limit = state.source + compressed.length();
+				int res = (format == Format::gzip) ? uzlib_gzip_parse_header(&state) : uzlib_zlib_parse_header(&state);
+				REQUIRE(res >= 0);
+
+				String output;
+				REQUIRE(output.setLength(FS_abstract.length() + 16));
+				state.dest_start = state.dest = reinterpret_cast<uint8_t*>(output.begin());
+				state.dest_limit = state.dest + output.length();
+				res = uzlib_uncompress_chksum(&state);
+				REQUIRE_EQ(res, TINF_DONE);
+				output.setLength(state.dest - state.dest_start);
+				REQUIRE(FS_abstract == output);
+			}
+		}
+
 		TEST_CASE("MultipartStream / MultiStream")
 		{
 			unsigned itemIndex{0};
@@ -171,6 +216,23 @@ public:
 			debug_hex(DBG, "Text", unmaskedString.c_str(), unmaskedString.length());
 		}
 
+		TEST_CASE("LimitedReadStream")
+		{
+			auto mem = new MemoryDataStream();
+			mem->print("0123456789abcdef");
+			LimitedReadStream stream(mem, 4, 6);
+			REQUIRE(stream.isValid());
+			REQUIRE_EQ(stream.available(), 6);
+			REQUIRE_EQ(stream.readString(4), "4567");
+			REQUIRE_EQ(stream.readString(100), "89");
+			REQUIRE(stream.isFinished());
+
+			mem = new MemoryDataStream();
+			mem->print("0123");
+			LimitedReadStream badStream(mem, 10, 6);
+			REQUIRE(!badStream.isValid());
+		}
+
 		{
 			// STL may perform one-time memory allocation for mutexes, etc.
 			std::shared_ptr<const char[]> data(new char[18]);
@@ -213,6 +275,164 @@ public:
 			REQUIRE(data.use_count() == 1);
 		}
 
+		TEST_CASE("SharedMemoryStream::getReadRegion")
+		{
+			const char* message = "Wonderful data...";
+			const size_t msglen = strlen(message);
+			std::shared_ptr<char[]> data(new char[msglen]);
+			memcpy(data.get(), message, msglen);
+
+			StreamRegion region;
+			{
+				SharedMemoryStream<const char[]> stream(data, msglen);
+				stream.seek(4);
+				REQUIRE(stream.getReadRegion(region));
+				REQUIRE_EQ(region.length, msglen - 4);
+				REQUIRE(memcmp(region.data, &message[4], region.length) == 0);
+			}
+			// Region keeps content alive after stream destroyed
+			REQUIRE(data.use_count() == 2);
+			region.owner.reset();
+			REQUIRE(data.use_count() == 1);
+
+			LimitedMemoryStream mem(32);
+			REQUIRE(!mem.getReadRegion(region));
+		}
+
+		TEST_CASE("FlashMemoryStream::getReadRegion")
+		{
+			DEFINE_FSTR_LOCAL(FS_content, "Flash stream content");
+			String content(FS_content);
+			FlashMemoryStream stream(FS_content);
+			StreamRegion region;
+#if defined(ARCH_HOST) || defined(ARCH_RP2040)
+			stream.seek(6);
+			REQUIRE(stream.getReadRegion(region));
+			REQUIRE_EQ(region.length, content.length() - 6);
+			REQUIRE(memcmp(region.data, &content[6], region.length) == 0);
+			REQUIRE(!region.owner);
+
+			stream.seek(region.length);
+			REQUIRE(stream.getReadRegion(region));
+			REQUIRE_EQ(region.length, 0U);
+#else
+			REQUIRE(!stream.getReadRegion(region));
+#endif
+		}
+
+		TEST_CASE("JsonWriterStream")
+		{
+			constexpr unsigned itemCount{100};
+			unsigned index{0};
+			JsonWriterStream stream([&index](JsonWriterStream& json) -> bool {
+				if(index == 0) {
+					json.beginObject().add("title", "Line \"1\"\n").key("list").beginArray();
+				}
+				if(index < itemCount) {
+					json.beginObject().add("id", index).add("ok", index % 2 == 0).endObject();
+					++index;
+					return true;
+				}
+				if(index == itemCount) {
+					json.endArray().key("text");
+					json.value(new LimitedMemoryStream(const_cast<char*>("a\tb"), 3, 3, false));
+					++index;
+					return true;
+				}
+				json.endObject();
+				return false;
+			});
+
+			String expected = F("{\"title\":\"Line \\\"1\\\"\\n\",\"list\":[");
+			for(unsigned i = 0; i < itemCount; ++i) {
+				if(i != 0) {
+					expected += ',';
+				}
+				expected += F("{\"id\":");
+				expected += i;
+				expected += F(",\"ok\":");
+				expected += (i % 2 == 0) ? F("true") : F("false");
+				expected += '}';
+			}
+			expected += F("],\"text\":\"a\\tb\"}");
+
+			// Read in small chunks, consuming only part of each
+			String output;
+			char buffer[16];
+			while(!stream.isFinished()) {
+				auto len = stream.readMemoryBlock(buffer, sizeof(buffer));
+				len = std::min(len, uint16_t(10));
+				output.concat(buffer, len);
+				REQUIRE(stream.seek(len));
+			}
+
+			REQUIRE_EQ(output, expected);
+			REQUIRE_EQ(stream.getDepth(), 0U);
+			debug_i("JSON %u bytes, peak buffer %u", output.length(), stream.getPeakBufferLength());
+			REQUIRE(stream.getPeakBufferLength() < 100);
+		}
+
+		TEST_CASE("JsonWriterStream with invalid calls")
+		{
+			JsonWriterStream stream([](JsonWriterStream& json) -> bool {
+				// Mismatched closing brackets are ignored, dangling key gets null value
+				json.beginArray().endObject().beginObject().key("a").endArray().endObject().endArray();
+				return false;
+			});
+
+			String output;
+			char buffer[16];
+			while(!stream.isFinished()) {
+				auto len = stream.readMemoryBlock(buffer, sizeof(buffer));
+				output.concat(buffer, len);
+				REQUIRE(stream.seek(len));
+			}
+
+			REQUIRE_EQ(output, F("[{\"a\":null}]"));
+			REQUIRE_EQ(stream.getDepth(), 0U);
+		}
+
+		TEST_CASE("RopeStream")
+		{
+			DEFINE_FSTR_LOCAL(FS_header, "<html><body>");
+			const char* footer = "</body></html>";
+			const String bodyText = F("This content is moved, not copied. ");
+
+			RopeStream stream;
+			String body = bodyText;
+			REQUIRE(stream.append(FS_header));
+			REQUIRE(stream.append(std::move(body)));
+			REQUIRE(stream.append(FS_abstract));
+			for(char c = '0'; c <= '9'; ++c) {
+				REQUIRE(stream.append(&c, 1));
+			}
+			REQUIRE(stream.appendRef(footer, strlen(footer)));
+			// Copies are coalesced into one segment
+			REQUIRE_EQ(stream.getSegmentCount(), 5U);
+
+			String expected;
+			expected += FS_header;
+			expected += bodyText;
+			expected += FS_abstract;
+			expected += F("0123456789");
+			expected += footer;
+			REQUIRE_EQ(stream.available(), int(expected.length()));
+
+			// Read in small chunks, consuming only part of each
+			String output;
+			char buffer[16];
+			while(!stream.isFinished()) {
+				auto len = stream.readMemoryBlock(buffer, sizeof(buffer));
+				len = std::min(len, uint16_t(10));
+				output.concat(buffer, len);
+				REQUIRE(stream.seek(len));
+			}
+			REQUIRE_EQ(output, expected);
+
+			// Content already read cannot be revisited
+			REQUIRE(stream.seekFrom(0, SeekOrigin::Start) < 0);
+		}
+
 		auto memNow = MallocCount::getCurrent();
 		// auto memNow = system_get_free_heap_size();
 		REQUIRE_EQ(memStart, memNow);
@@ -1,6 +1,8 @@
 #include <HostTests.h>
 
 #include <Data/HexString.h>
+#include <Data/StringBuilder.h>
+#include <malloc_count.h>
 
 class StringTest : public TestGroup
 {
@@ -17,6 +19,7 @@ public:
 		testString();
 		testMove();
 		testMakeHexString();
+		testStringBuilder();
 	}
 
 	template <typename T> void templateTest(T)
@@ -212,6 +215,56 @@ public:
 			REQUIRE(makeHexString(hwaddr, 0, ':') == String::empty);
 		}
 	}
+
+	void testStringBuilder()
+	{
+		TEST_CASE("StringBuilder")
+		{
+			String ref;
+			StringBuilder sb;
+			auto allocCount = MallocCount::getAllocCount();
+			for(unsigned i = 0; i < 1000; ++i) {
+				sb << i << ',';
+			}
+			allocCount = MallocCount::getAllocCount() - allocCount;
+			for(unsigned i = 0; i < 1000; ++i) {
+				ref += i;
+				ref += ',';
+			}
+			debug_i("StringBuilder: %u allocations for %u chars", allocCount, sb.length());
+			REQUIRE(allocCount <= 16);
+			REQUIRE_EQ(sb.length(), ref.length());
+			REQUIRE(ref == sb.c_str());
+
+			String s = sb.moveString();
+			REQUIRE(s == ref);
+			REQUIRE_EQ(sb.length(), 0U);
+			sb << "abc";
+			REQUIRE(F("abc") == sb.c_str());
+		}
+
+		TEST_CASE("StackStringBuilder")
+		{
+			StackStringBuilder<32> sb;
+			auto allocCount = MallocCount::getAllocCount();
+			sb << _F("Temperature: ") << 25 << _F(" °C");
+			REQUIRE_EQ(MallocCount::getAllocCount(), allocCount);
+			REQUIRE(F("Temperature: 25 °C") == sb.c_str());
+
+			// Overflow to heap
+			String ref = sb.c_str();
+			for(unsigned i = 0; i < 10; ++i) {
+				sb << _F("0123456789");
+				ref += _F("0123456789");
+			}
+			REQUIRE(ref == sb.c_str());
+			REQUIRE(sb.moveString() == ref);
+
+			// Arena is re-used
+			sb << "abc";
+			REQUIRE(sb.moveString() == F("abc"));
+		}
+	}
 };
 
 void REGISTER_TEST(String)
@@ -1,5 +1,6 @@
 #include <HostTests.h>
 #include <esp_spi_flash.h>
+#include <malloc_count.h>
 
 /*
  * Various system functions must be available for all architectures.
@@ -18,6 +19,59 @@ public:
 			REQUIRE_NEQ(system_get_free_heap_size(), 0);
 		}
 
+		if(MallocCount::isProfileEnabled()) {
+			TEST_CASE("Allocation profile")
+			{
+				MallocCount::resetProfile();
+
+				static void* blocks[3];
+				for(auto& block : blocks) {
+					block = malloc(100);
+					REQUIRE(block != nullptr);
+				}
+				free(blocks[0]);
+
+				// Busier call site
+				static void* temp[5];
+				for(auto& block : temp) {
+					block = malloc(10);
+				}
+				for(auto block : temp) {
+					free(block);
+				}
+
+				MallocCount::SiteInfo sites[32];
+				auto count = MallocCount::getProfile(sites, ARRAY_SIZE(sites));
+				MallocCount::SiteInfo top;
+				auto topCount = MallocCount::getProfile(&top, 1);
+				auto site = std::find_if(sites, sites + count, [](const MallocCount::SiteInfo& site) {
+					return site.allocCount == 3 && site.totalBytes == 300;
+				});
+				REQUIRE(site != sites + count);
+				REQUIRE_EQ(site->freeCount, 1U);
+				REQUIRE_EQ(site->currentBytes, 200U);
+				REQUIRE_EQ(site->peakBytes, 300U);
+
+				// Buffer too small for all sites, so busiest is kept
+				REQUIRE(count >= 2);
+				REQUIRE_EQ(topCount, 1U);
+				auto byAllocCount = [](const MallocCount::SiteInfo& a, const MallocCount::SiteInfo& b) {
+					return a.allocCount < b.allocCount;
+				};
+				auto busiest = std::max_element(sites, sites + count, byAllocCount);
+				REQUIRE(top.allocCount >= 5);
+				REQUIRE_EQ(top.allocCount, busiest->allocCount);
+
+				uint32_t histogram[MallocCount::sizeHistogramBuckets];
+				MallocCount::getSizeHistogram(histogram);
+				REQUIRE(histogram[4] >= 3); // 65 - 128 bytes
+
+				free(blocks[1]);
+				free(blocks[2]);
+				MallocCount::printProfile(Serial);
+			}
+		}
+
 		TEST_CASE("Identification")
 		{
 			REQUIRE_NEQ(String(system_get_sdk_version()), nullptr);
@@ -39,6 +93,30 @@ public:
 			system_soft_wdt_feed();
 		}
 
+#ifdef ARCH_HOST
+		TEST_CASE("Task queue statistics")
+		{
+			const unsigned numCallbacks{20};
+
+			host_task_queue_stats_t stats;
+			REQUIRE(host_get_task_queue_stats(USER_TASK_PRIO_1, &stats, true));
+			REQUIRE(stats.capacity >= numCallbacks);
+			auto startCount = stats.count;
+
+			for(unsigned i = 0; i < numCallbacks; ++i) {
+				REQUIRE(System.queueCallback(TaskCallback([](void*) {})));
+			}
+
+			REQUIRE(host_get_task_queue_stats(USER_TASK_PRIO_1, &stats, false));
+			debug_i("Task queue: capacity %u, count %u, max %u, posted %u, dropped %u", stats.capacity, stats.count,
+					stats.max_count, stats.posted, stats.dropped);
+			REQUIRE_EQ(stats.posted, numCallbacks);
+			REQUIRE_EQ(stats.count, startCount + numCallbacks);
+			REQUIRE(stats.max_count >= stats.count);
+			REQUIRE_EQ(stats.dropped, 0U);
+		}
+#endif
+
 #ifndef ARCH_HOST
 		TEST_CASE("System restart")
 		{
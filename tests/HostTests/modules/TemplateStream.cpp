@@ -3,6 +3,7 @@
 #include <Data/Stream/MemoryDataStream.h>
 #include <Data/Stream/LimitedMemoryStream.h>
 #include <Data/Stream/SectionTemplate.h>
+#include <Services/Profiling/MinMaxTimes.h>
 
 #ifdef ARCH_HOST
 #include <IFS/Host/FileSystem.h>
@@ -22,6 +23,23 @@ DEFINE_FSTR_LOCAL(template3_1, "<html><head><title>Document Title</title><style>
 DEFINE_FSTR_LOCAL(template4, "{\"value\":12,\"var1\":\"{var1}\"}")
 DEFINE_FSTR_LOCAL(template4_1, "{\"value\":12,\"var1\":\"quoted variable\"}")
 
+namespace
+{
+String getTemplate1Value(const char* name)
+{
+	if(FS("emit_contents") == name) {
+		return "1";
+	}
+
+	if(memcmp(name, "emit_", 5) == 0) {
+		return "";
+	}
+
+	return nullptr;
+}
+
+} // namespace
+
 class TemplateStreamTest : public TestGroup
 {
 public:
@@ -102,18 +120,7 @@ public:
 			SectionTemplate tmpl(new FlashMemoryStream(Resource::ut_template1_in_rst));
 			REQUIRE(tmpl.sectionCount() == 1);
 			tmpl.setDoubleBraces(true);
-			tmpl.onGetValue([](const char* name) -> String {
-				debug_e("getValue(%s)", name);
-				if(FS("emit_contents") == name) {
-					return "1";
-				}
-
-				if(memcmp(name, "emit_", 5) == 0) {
-					return "";
-				}
-
-				return nullptr;
-			});
+			tmpl.onGetValue(getTemplate1Value);
 
 #ifdef ARCH_HOST
 			{
@@ -134,57 +141,180 @@ public:
 			check(tmpl, Resource::ut_template1_out1_rst);
 		}
 
+		TEST_CASE("Compiled template")
+		{
+			TemplateProgram program;
+			// Program is compiled on first use, then re-used
+			for(unsigned i = 0; i < 2; ++i) {
+				FSTR::TemplateStream tmpl(template1);
+				tmpl.setProgram(&program);
+				tmpl.setVar("var1", "value #1");
+				tmpl.setVar("var2", "value #2");
+				tmpl.setVar("var3", "[value #3]");
+				check(tmpl, template1, template1_2);
+			}
+			REQUIRE_EQ(program.getTagCount(0), 5U);
+		}
+
+		TEST_CASE("Compiled template with disabled output")
+		{
+			TemplateProgram program;
+			FSTR::TemplateStream tmpl(template2);
+			tmpl.setProgram(&program);
+			tmpl.onGetValue([&tmpl](const char* name) -> String {
+				if(FS("disable") == name) {
+					tmpl.enableOutput(false);
+					return "";
+				}
+				if(FS("enable") == name) {
+					tmpl.enableOutput(true);
+					return "";
+				}
+				return nullptr;
+			});
+
+			check(tmpl, template2, template2_1);
+		}
+
+		TEST_CASE("Compiled template (JSON)")
+		{
+			TemplateProgram program;
+			FSTR::TemplateStream tmpl(template4);
+			tmpl.setProgram(&program);
+			tmpl.setVar("var1", "quoted variable");
+			check(tmpl, template4, template4_1);
+			REQUIRE_EQ(program.getTagCount(0), 1U);
+		}
+
+		TEST_CASE("Compiled template fallback")
+		{
+			// No sections, so compilation fails and source is scanned instead
+			TemplateProgram program(0);
+			FSTR::TemplateStream tmpl(template1);
+			tmpl.setProgram(&program);
+			tmpl.setVar("var1", "value #1");
+			tmpl.setVar("var2", "value #2");
+			tmpl.setVar("var3", "[value #3]");
+			check(tmpl, template1, template1_2);
+			REQUIRE(!program.isCompiled(0));
+		}
+
+		TEST_CASE("Compiled ut_template1")
+		{
+			SectionTemplate tmpl(new FlashMemoryStream(Resource::ut_template1_in_rst));
+			TemplateProgram program(tmpl.sectionCount());
+			tmpl.setProgram(&program);
+			tmpl.setDoubleBraces(true);
+			tmpl.onGetValue(getTemplate1Value);
+			check(tmpl, Resource::ut_template1_out1_rst);
+			REQUIRE(program.isCompiled(0));
+
+			tmpl.gotoSection(0);
+			check(tmpl, Resource::ut_template1_out1_rst);
+		}
+
+		TEST_CASE("Fragmented read of variable [TMPL #1, #3, #4]")
+		{
+			checkFragmentedRead(nullptr);
+		}
+
+		TEST_CASE("Fragmented read of compiled variable")
+		{
+			TemplateProgram program;
+			checkFragmentedRead(&program);
+		}
+
+		TEST_CASE("Benchmark")
+		{
+			constexpr unsigned iterations{50};
+			TemplateProgram program;
+			size_t outputLength[2]{};
+			for(unsigned compiled = 0; compiled < 2; ++compiled) {
+				Profiling::MicroTimes times(compiled ? F("Compiled") : F("Scanned"));
+				for(unsigned i = 0; i < iterations; ++i) {
+					SectionTemplate tmpl(new FlashMemoryStream(Resource::ut_template1_in_rst));
+					if(compiled) {
+						tmpl.setProgram(&program);
+					}
+					tmpl.setDoubleBraces(true);
+					tmpl.onGetValue(getTemplate1Value);
+					times.start();
+					outputLength[compiled] = render(tmpl);
+					times.update();
+				}
+				Serial << times << endl;
+			}
+			REQUIRE_EQ(outputLength[0], Resource::ut_template1_out1_rst.length());
+			REQUIRE_EQ(outputLength[1], Resource::ut_template1_out1_rst.length());
+		}
+	}
+
+private:
+	void checkFragmentedRead(TemplateProgram* program)
+	{
 		auto addChar = [](String& s, char c, size_t count) {
 			auto len = s.length();
 			s.setLength(len + count);
 			memset(&s[len], c, count);
 		};
 
-		TEST_CASE("Fragmented read of variable [TMPL #1, #3, #4]")
-		{
-			constexpr size_t TEMPLATE_BUFFER_SIZE{100};
-			String input;
-			addChar(input, 'a', TEMPLATE_BUFFER_SIZE - 4);
-			input += _F("{varname}");
-			addChar(input, 'a', TEMPLATE_BUFFER_SIZE);
-			auto source = new LimitedMemoryStream(input.begin(), input.length(), input.length(), false);
-			TemplateStream tmpl(source);
-			PSTR_ARRAY(someValue, "Some value or other");
-			tmpl.setVar(F("varname"), someValue);
-
-			size_t outlen{0};
-			char output[TEMPLATE_BUFFER_SIZE * 3]{};
-			while(!tmpl.isFinished()) {
-				auto ptr = output + outlen;
-				size_t read1 = tmpl.readMemoryBlock(ptr, TEMPLATE_BUFFER_SIZE);
-				char tmp[read1];
-				memcpy(tmp, ptr, read1);
-				size_t read = tmpl.readMemoryBlock(ptr, TEMPLATE_BUFFER_SIZE);
-				CHECK_EQ(read, read1);
-				CHECK(memcmp(tmp, ptr, read) == 0);
-				if(read > 10) {
-					read -= 5;
-				}
-				tmpl.seek(read);
-				outlen += read;
+		constexpr size_t TEMPLATE_BUFFER_SIZE{100};
+		String input;
+		addChar(input, 'a', TEMPLATE_BUFFER_SIZE - 4);
+		input += _F("{varname}");
+		addChar(input, 'a', TEMPLATE_BUFFER_SIZE);
+		auto source = new LimitedMemoryStream(input.begin(), input.length(), input.length(), false);
+		TemplateStream tmpl(source);
+		PSTR_ARRAY(someValue, "Some value or other");
+		tmpl.setProgram(program);
+		tmpl.setVar(F("varname"), someValue);
+
+		size_t outlen{0};
+		char output[TEMPLATE_BUFFER_SIZE * 3]{};
+		while(!tmpl.isFinished()) {
+			auto ptr = output + outlen;
+			size_t read1 = tmpl.readMemoryBlock(ptr, TEMPLATE_BUFFER_SIZE);
+			char tmp[read1];
+			memcpy(tmp, ptr, read1);
+			size_t read = tmpl.readMemoryBlock(ptr, TEMPLATE_BUFFER_SIZE);
+			CHECK_EQ(read, read1);
+			CHECK(memcmp(tmp, ptr, read) == 0);
+			if(read > 10) {
+				read -= 5;
 			}
+			tmpl.seek(read);
+			outlen += read;
+		}
 
-			String expected;
-			addChar(expected, 'a', TEMPLATE_BUFFER_SIZE - 4);
-			expected += someValue;
-			addChar(expected, 'a', TEMPLATE_BUFFER_SIZE);
+		String expected;
+		addChar(expected, 'a', TEMPLATE_BUFFER_SIZE - 4);
+		expected += someValue;
+		addChar(expected, 'a', TEMPLATE_BUFFER_SIZE);
 
-			if(!expected.equals(output, outlen)) {
-				m_nputs(output, outlen);
-				m_puts("\r\n");
-				m_nputs(expected.c_str(), expected.length());
-				m_puts("\r\n");
-			}
-			REQUIRE(expected.equals(output, outlen));
+		if(!expected.equals(output, outlen)) {
+			m_nputs(output, outlen);
+			m_puts("\r\n");
+			m_nputs(expected.c_str(), expected.length());
+			m_puts("\r\n");
 		}
+		REQUIRE(expected.equals(output, outlen));
+	}
+
+	/*
+	 * Read entire template output, as when sending a response
+	 */
+	size_t render(TemplateStream& tmpl)
+	{
+		char buf[1024];
+		size_t length{0};
+		while(!tmpl.isFinished()) {
+			auto count = tmpl.readMemoryBlock(buf, sizeof(buf));
+			tmpl.seek(count);
+			length += count;
+		}
+		return length;
 	}
 
-private:
 	void check(TemplateStream& stream, const FlashString& tmpl, const FlashString& ref)
 	{
 		constexpr size_t maxLen{256};
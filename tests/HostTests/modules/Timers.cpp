@@ -371,6 +371,89 @@ public:
 	}
 };
 
+/*
+ * Run many timers concurrently to check scalability of the timer queue.
+ * Arm/disarm cost should not depend on the number of active timers.
+ */
+class TimerStressTest : public TestGroup
+{
+public:
+#ifdef ARCH_HOST
+	static constexpr unsigned timerCount = 2000;
+#else
+	static constexpr unsigned timerCount = 100;
+#endif
+	static constexpr unsigned periodicCount = timerCount / 10;
+	static constexpr unsigned runTimeMs = 1000;
+
+	TimerStressTest() : TestGroup(_F("Timer stress")), armTimes("arm"), disarmTimes("disarm")
+	{
+	}
+
+	void execute() override
+	{
+		timers.reset(new SimpleTimer[timerCount]);
+
+		// Long intervals, so none fire during profiling
+		for(unsigned i = 0; i < timerCount; ++i) {
+			auto& timer = timers[i];
+			timer.initializeMs(10000 + os_random() % 50000, [](void*) {});
+			armTimes.start();
+			timer.startOnce();
+			armTimes.update();
+		}
+		for(unsigned i = 0; i < timerCount; ++i) {
+			auto& timer = timers[i];
+			disarmTimes.start();
+			timer.stop();
+			disarmTimes.update();
+		}
+		Serial << timerCount << _F(" timers") << endl;
+		Serial << armTimes << endl << disarmTimes << endl;
+
+		// Mix of short periodic timers and long idle ones
+		for(unsigned i = 0; i < timerCount; ++i) {
+			auto& timer = timers[i];
+			if(i < periodicCount) {
+				timer.initializeMs(1 + i % 20, periodicCallback, this).start();
+			} else {
+				timer.initializeMs(60000 + i, [](void*) {}).startOnce();
+			}
+		}
+
+		elapsed.start();
+		doneTimer.initializeMs<runTimeMs>(
+			[](void* arg) {
+				auto self = static_cast<TimerStressTest*>(arg);
+				auto time = self->elapsed.elapsedTime();
+				for(unsigned i = 0; i < timerCount; ++i) {
+					self->timers[i].stop();
+				}
+				Serial << self->callbackCount << _F(" callbacks from ") << periodicCount << _F(" periodic timers in ")
+					   << time.toString() << endl;
+				self->timers.reset();
+				self->complete();
+			},
+			this);
+		doneTimer.startOnce();
+
+		pending();
+	}
+
+	static void periodicCallback(void* arg)
+	{
+		++static_cast<TimerStressTest*>(arg)->callbackCount;
+	}
+
+private:
+	std::unique_ptr<SimpleTimer[]> timers;
+	SimpleTimer doneTimer;
+	OneShotFastMs elapsed;
+	CpuCycleTimes armTimes;
+	CpuCycleTimes disarmTimes;
+	unsigned callbackCount{0};
+};
+
 void REGISTER_TEST(Timers)
 {
 	registerGroup<CallbackTimerApiTest<Timer1TestApi>>();
@@ -382,4 +465,5 @@ void REGISTER_TEST(Timers)
 	registerGroup<CallbackTimerSpeedTest<Timer>>();
 
 	registerGroup<CallbackTimerTest>();
+	registerGroup<TimerStressTest>();
 }
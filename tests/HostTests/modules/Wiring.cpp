@@ -115,6 +115,67 @@ public:
 				 [](auto& map) { map.sort([](const auto& e1, const auto& e2) { return e1.value() < e2.value(); }); });
 		}
 
+		TEST_CASE("HashMap<MimeType, size_t> hashed")
+		{
+			HashMap<MimeType, uint16_t> map;
+			REQUIRE(map.enableHashing());
+			fillMap(map);
+			REQUIRE_EQ(map.count(), 13);
+			REQUIRE(map.contains(MIME_SVG));
+			map.remove(MIME_SVG);
+			REQUIRE(!map.contains(MIME_SVG));
+			REQUIRE(map.contains(MIME_ICO));
+			map.sort([](const auto& e1, const auto& e2) { return e1.key() > e2.key(); });
+			for(unsigned i = 0; i < map.count(); ++i) {
+				REQUIRE_EQ(map.indexOf(map.keyAt(i)), int(i));
+			}
+		}
+
+		TEST_CASE("HashMap<String, unsigned> performance")
+		{
+			const unsigned entryCount{500};
+			String keys[entryCount];
+			for(unsigned i = 0; i < entryCount; ++i) {
+				keys[i] = F("config.key.");
+				keys[i] += String(os_random(), HEX);
+			}
+
+			auto check = [&](bool hashed) {
+				Serial << (hashed ? _F("Hashed") : _F("Linear")) << endl;
+
+				HashMap<String, unsigned> map;
+				if(hashed) {
+					REQUIRE(map.enableHashing());
+				}
+
+				CpuCycleTimer timer;
+				for(unsigned i = 0; i < entryCount; ++i) {
+					map[keys[i]] = i;
+				}
+				Serial << _F("  insert: ") << timer.elapsedTime().toString() << endl;
+
+				timer.start();
+				unsigned matched{0};
+				for(unsigned i = 0; i < entryCount; ++i) {
+					matched += (map[keys[i]] == i);
+				}
+				Serial << _F("  lookup: ") << timer.elapsedTime().toString() << endl;
+				REQUIRE_EQ(matched, entryCount);
+
+				timer.start();
+				for(unsigned i = 0; i < entryCount; i += 2) {
+					map.remove(keys[i]);
+				}
+				Serial << _F("  erase: ") << timer.elapsedTime().toString() << endl;
+				REQUIRE_EQ(map.count(), entryCount / 2);
+				REQUIRE(!map.contains(keys[0]));
+				REQUIRE_EQ(map[keys[1]], 1U);
+			};
+
+			check(false);
+			check(true);
+		}
+
 		TEST_CASE("std::map<MimeType, size_t>")
 		{
 			std::map<MimeType, uint16_t> map;